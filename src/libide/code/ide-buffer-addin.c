@@ -281,7 +281,11 @@ ide_buffer_addin_find_by_module_name (IdeBuffer   *buffer,
   plugin_info = peas_engine_get_plugin_info (peas_engine_get_default (), module_name);
 
   if (plugin_info != NULL)
-    ret = ide_extension_set_adapter_get_extension (set, plugin_info);
+    {
+      /* Addins may be withheld while the buffer is in large-file mode */
+      if (_ide_buffer_can_load_addin (buffer, plugin_info))
+        ret = ide_extension_set_adapter_get_extension (set, plugin_info);
+    }
   else
     g_warning ("Failed to locate addin named %s", module_name);
 
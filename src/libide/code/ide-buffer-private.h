@@ -35,6 +35,8 @@ void                    _ide_buffer_manager_buffer_saved     (IdeBufferManager
                                                               IdeBuffer            *buffer);
 void                    _ide_buffer_cancel_cursor_restore    (IdeBuffer            *self);
 gboolean                _ide_buffer_can_restore_cursor       (IdeBuffer            *self);
+gboolean                _ide_buffer_can_load_addin           (IdeBuffer            *self,
+                                                              PeasPluginInfo       *plugin_info);
 IdeExtensionSetAdapter *_ide_buffer_get_addins               (IdeBuffer            *self);
 IdeBuffer              *_ide_buffer_new                      (IdeBufferManager     *self,
                                                               GFile                *file,
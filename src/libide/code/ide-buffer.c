@@ -29,6 +29,7 @@
 #include <libide-threading.h>
 
 #include "ide-marshal.h"
+#include "ide-private.h"
 
 #include "ide-buffer.h"
 #include "ide-buffer-addin.h"
@@ -99,6 +100,7 @@ struct _IdeBuffer
 
   guint                   change_count;
   guint                   settling_source;
+  gsize                   charged;
   int                     hold;
   guint                   release_in_idle;
 
@@ -112,6 +114,8 @@ struct _IdeBuffer
   guint                   enable_addins : 1;
   guint                   changed_on_volume : 1;
   guint                   read_only : 1;
+  guint                   is_large_file : 1;
+  guint                   large_file_highlight_syntax : 1;
   guint                   has_encoding_error : 1;
   guint                   highlight_diagnostics : 1;
   GtkSourceNewlineType    newline_type : 2;
@@ -132,7 +136,11 @@ typedef struct
 {
   IdeNotification *notif;
   GFile           *file;
+  gint64           begin_time;
+  guint            max_lines;
   guint            highlight_syntax : 1;
+  guint            owns_notif : 1;
+  guint            attached : 1;
 } LoadState;
 
 typedef struct
@@ -140,6 +148,7 @@ typedef struct
   GFile           *file;
   IdeNotification *notif;
   GtkSourceFile   *source_file;
+  gint64           begin_time;
 } SaveState;
 
 typedef struct
@@ -167,6 +176,7 @@ enum {
   PROP_HAS_ENCODING_ERROR,
   PROP_HAS_SYMBOL_RESOLVERS,
   PROP_HIGHLIGHT_DIAGNOSTICS,
+  PROP_IS_LARGE_FILE,
   PROP_IS_TEMPORARY,
   PROP_LANGUAGE_ID,
   PROP_NEWLINE_TYPE,
@@ -202,9 +212,14 @@ static void     ide_buffer_save_file_cb            (GObject                *obje
 static void     ide_buffer_load_file_cb            (GObject                *object,
                                                     GAsyncResult           *result,
                                                     gpointer                user_data);
+static void     ide_buffer_load_file_query_info_cb (GObject                *object,
+                                                    GAsyncResult           *result,
+                                                    gpointer                user_data);
 static void     ide_buffer_progress_cb             (goffset                 current_num_bytes,
                                                     goffset                 total_num_bytes,
                                                     gpointer                user_data);
+static void     ide_buffer_set_is_large_file       (IdeBuffer              *self,
+                                                    gboolean                is_large_file);
 static void     ide_buffer_get_property            (GObject                *object,
                                                     guint                   prop_id,
                                                     GValue                 *value,
@@ -268,6 +283,52 @@ static gboolean settle_finish                      (IdeBuffer              *self
                                                     GAsyncResult           *result,
                                                     GError                **error);
 
+static IdeMemoryAccount *
+get_memory_account (void)
+{
+  static IdeMemoryAccount *account;
+
+  if (g_once_init_enter (&account))
+    g_once_init_leave (&account, ide_memory_account_get ("buffers", _("Buffers")));
+
+  return account;
+}
+
+static void
+ide_buffer_update_memory_account (IdeBuffer *self)
+{
+  gsize size;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_BUFFER (self));
+
+  /* The character count is cached by the text btree, which makes it a
+   * cheap approximation of the UTF-8 contents for mostly-ASCII sources.
+   */
+  size = gtk_text_buffer_get_char_count (GTK_TEXT_BUFFER (self));
+
+  if (size > self->charged)
+    ide_memory_account_charge (get_memory_account (), size - self->charged);
+  else
+    ide_memory_account_discharge (get_memory_account (), self->charged - size);
+
+  self->charged = size;
+}
+
+static void
+trace_file_mark (GFile      *file,
+                 gint64      begin_time,
+                 const char *name)
+{
+  g_autofree char *uri = NULL;
+
+  if (begin_time == 0 || !_ide_trace_has_mark ())
+    return;
+
+  uri = g_file_get_uri (file);
+  _ide_trace_mark (begin_time, g_get_monotonic_time (), "buffer", name, uri);
+}
+
 static void
 load_state_free (LoadState *state)
 {
@@ -311,6 +372,166 @@ clear_commit_func (gpointer data)
     hooks->user_data_destroy (hooks->user_data);
 }
 
+static inline gboolean
+addin_supports_large_files (PeasPluginInfo *plugin_info)
+{
+  /* Only addins which are cheap regardless of the buffer size opt-in
+   * to running while the buffer is in large-file mode.
+   */
+  return ide_str_equal0 ("true", peas_plugin_info_get_external_data (plugin_info, "Buffer-Addin-Large-Files"));
+}
+
+gboolean
+_ide_buffer_can_load_addin (IdeBuffer      *self,
+                            PeasPluginInfo *plugin_info)
+{
+  g_return_val_if_fail (IDE_IS_BUFFER (self), FALSE);
+  g_return_val_if_fail (plugin_info != NULL, FALSE);
+
+  return !self->is_large_file || addin_supports_large_files (plugin_info);
+}
+
+typedef struct
+{
+  IdeBuffer                         *self;
+  IdeExtensionSetAdapterForeachFunc  func;
+  gpointer                           user_data;
+} ForeachAddin;
+
+static void
+ide_buffer_foreach_addin_cb (IdeExtensionSetAdapter *set,
+                             PeasPluginInfo         *plugin_info,
+                             GObject                *exten,
+                             gpointer                user_data)
+{
+  ForeachAddin *foreach = user_data;
+
+  if (_ide_buffer_can_load_addin (foreach->self, plugin_info))
+    foreach->func (set, plugin_info, exten, foreach->user_data);
+}
+
+static void
+ide_buffer_foreach_addin (IdeBuffer                         *self,
+                          IdeExtensionSetAdapterForeachFunc  func,
+                          gpointer                           user_data)
+{
+  ForeachAddin foreach = { self, func, user_data };
+
+  g_assert (IDE_IS_BUFFER (self));
+  g_assert (self->addins != NULL);
+
+  ide_extension_set_adapter_foreach (self->addins,
+                                     ide_buffer_foreach_addin_cb,
+                                     &foreach);
+}
+
+static void
+ide_buffer_addin_added_cb (IdeExtensionSetAdapter *set,
+                           PeasPluginInfo         *plugin_info,
+                           GObject                *exten,
+                           gpointer                user_data)
+{
+  IdeBuffer *self = user_data;
+
+  if (_ide_buffer_can_load_addin (self, plugin_info))
+    _ide_buffer_addin_load_cb (set, plugin_info, exten, self);
+}
+
+static void
+ide_buffer_addin_removed_cb (IdeExtensionSetAdapter *set,
+                             PeasPluginInfo         *plugin_info,
+                             GObject                *exten,
+                             gpointer                user_data)
+{
+  IdeBuffer *self = user_data;
+
+  if (_ide_buffer_can_load_addin (self, plugin_info))
+    _ide_buffer_addin_unload_cb (set, plugin_info, exten, self);
+}
+
+static void
+ide_buffer_load_withheld_addin_cb (IdeExtensionSetAdapter *set,
+                                   PeasPluginInfo         *plugin_info,
+                                   GObject                *exten,
+                                   gpointer                user_data)
+{
+  if (!addin_supports_large_files (plugin_info))
+    _ide_buffer_addin_load_cb (set, plugin_info, exten, user_data);
+}
+
+static void
+ide_buffer_unload_withheld_addin_cb (IdeExtensionSetAdapter *set,
+                                     PeasPluginInfo         *plugin_info,
+                                     GObject                *exten,
+                                     gpointer                user_data)
+{
+  if (!addin_supports_large_files (plugin_info))
+    _ide_buffer_addin_unload_cb (set, plugin_info, exten, user_data);
+}
+
+static void
+ide_buffer_set_is_large_file (IdeBuffer *self,
+                              gboolean   is_large_file)
+{
+  gboolean has_addins;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_BUFFER (self));
+  g_assert (self->state == IDE_BUFFER_STATE_LOADING);
+
+  is_large_file = !!is_large_file;
+
+  if (is_large_file == self->is_large_file)
+    IDE_EXIT;
+
+  has_addins = self->addins != NULL && self->enable_addins;
+
+  IDE_TRACE_MSG ("%s large-file mode", is_large_file ? "Entering" : "Leaving");
+
+  /* Addins which do per-keystroke work (change monitors, spellcheck,
+   * diagnostics, etc) are unloaded while in large-file mode. They stay
+   * in the extension set so that they can be loaded again if the file
+   * shrinks below the limits on reload.
+   *
+   * This only changes while loading. The highlight engine is paused by
+   * the load operation, which keeps it paused while in large-file mode.
+   */
+  if (is_large_file)
+    {
+      if (has_addins)
+        ide_extension_set_adapter_foreach (self->addins,
+                                           ide_buffer_unload_withheld_addin_cb,
+                                           self);
+
+      self->is_large_file = TRUE;
+    }
+  else
+    {
+      self->is_large_file = FALSE;
+
+      if (has_addins)
+        ide_extension_set_adapter_foreach (self->addins,
+                                           ide_buffer_load_withheld_addin_cb,
+                                           self);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_IS_LARGE_FILE]);
+
+  IDE_EXIT;
+}
+
+static void
+ide_buffer_get_large_file_limits (guint64 *max_size,
+                                  guint   *max_lines)
+{
+  g_autoptr(GSettings) settings = g_settings_new ("org.gnome.builder.editor");
+
+  *max_size = g_settings_get_uint64 (settings, "large-file-size");
+  *max_lines = g_settings_get_uint (settings, "large-file-lines");
+}
+
 IdeBuffer *
 _ide_buffer_new (IdeBufferManager *buffer_manager,
                  GFile            *file,
@@ -353,9 +574,9 @@ _ide_buffer_set_file (IdeBuffer *self,
       if (self->addins != NULL && self->enable_addins)
         {
           IdeBufferFileLoad closure = { self, file };
-          ide_extension_set_adapter_foreach (self->addins,
-                                             _ide_buffer_addin_file_loaded_cb,
-                                             &closure);
+          ide_buffer_foreach_addin (self,
+                                    _ide_buffer_addin_file_loaded_cb,
+                                    &closure);
         }
 
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_FILE]);
@@ -486,9 +707,9 @@ ide_buffer_notify_language (IdeBuffer  *self,
       IdeBufferLanguageSet state = { self, lang_id };
 
       ide_extension_set_adapter_set_value (self->addins, state.language_id);
-      ide_extension_set_adapter_foreach (self->addins,
-                                         _ide_buffer_addin_language_set_cb,
-                                         &state);
+      ide_buffer_foreach_addin (self,
+                                _ide_buffer_addin_language_set_cb,
+                                &state);
     }
 
   if (self->symbol_resolvers)
@@ -588,6 +809,8 @@ ide_buffer_finalize (GObject *object)
 {
   IdeBuffer *self = (IdeBuffer *)object;
 
+  ide_memory_account_discharge (get_memory_account (), self->charged);
+
   g_clear_object (&self->file_settings_signals);
   g_clear_object (&self->source_file);
   g_clear_object (&self->readlink_file);
@@ -670,6 +893,10 @@ ide_buffer_get_property (GObject    *object,
       g_value_set_boolean (value, ide_buffer_get_is_temporary (self));
       break;
 
+    case PROP_IS_LARGE_FILE:
+      g_value_set_boolean (value, ide_buffer_get_is_large_file (self));
+      break;
+
     case PROP_READ_ONLY:
       g_value_set_boolean (value, ide_buffer_get_read_only (self));
       break;
@@ -1008,6 +1235,23 @@ ide_buffer_class_init (IdeBufferClass *klass)
                           FALSE,
                           (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * IdeBuffer:is-large-file:
+   *
+   * The "is-large-file" property is set to %TRUE when the file exceeds
+   * the size or line-count limits of the editor settings. Syntax
+   * highlighting and addins which have not opted-in with the
+   * `X-Buffer-Addin-Large-Files` plugin key are disabled while set.
+   *
+   * Since: 46
+   */
+  properties [PROP_IS_LARGE_FILE] =
+    g_param_spec_boolean ("is-large-file",
+                          "Is Large File",
+                          "If the buffer is in large-file mode",
+                          FALSE,
+                          (G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   /**
    * IdeBuffer:state:
    *
@@ -1305,15 +1549,13 @@ _ide_buffer_attach (IdeBuffer *self,
                                                 language_id);
   g_signal_connect (self->addins,
                     "extension-added",
-                    G_CALLBACK (_ide_buffer_addin_load_cb),
+                    G_CALLBACK (ide_buffer_addin_added_cb),
                     self);
   g_signal_connect (self->addins,
                     "extension-removed",
-                    G_CALLBACK (_ide_buffer_addin_unload_cb),
+                    G_CALLBACK (ide_buffer_addin_removed_cb),
                     self);
-  ide_extension_set_adapter_foreach (self->addins,
-                                     _ide_buffer_addin_load_cb,
-                                     self);
+  ide_buffer_foreach_addin (self, _ide_buffer_addin_load_cb, self);
 
   /* Setup our rename provider, if any */
   self->rename_provider = ide_extension_adapter_new (parent,
@@ -1434,6 +1676,26 @@ ide_buffer_get_is_temporary (IdeBuffer *self)
   return self->is_temporary;
 }
 
+/**
+ * ide_buffer_get_is_large_file:
+ * @self: an #IdeBuffer
+ *
+ * Checks if the buffer has been placed in large-file mode because the
+ * underlying file exceeded the configured size or line-count limits.
+ *
+ * Returns: %TRUE if the buffer is in large-file mode
+ *
+ * Since: 46
+ */
+gboolean
+ide_buffer_get_is_large_file (IdeBuffer *self)
+{
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), FALSE);
+  g_return_val_if_fail (IDE_IS_BUFFER (self), FALSE);
+
+  return self->is_large_file;
+}
+
 /**
  * ide_buffer_get_state:
  * @self: an #IdeBuffer
@@ -1518,6 +1780,8 @@ ide_buffer_load_file_cb (GObject      *object,
   g_assert (G_IS_FILE (state->file));
   g_assert (IDE_IS_NOTIFICATION (state->notif));
 
+  trace_file_mark (state->file, state->begin_time, "load");
+
   if (!gtk_source_file_loader_load_finish (loader, result, &error))
     {
       if (!should_ignore_load_error (self, error))
@@ -1525,6 +1789,8 @@ ide_buffer_load_file_cb (GObject      *object,
           g_debug ("Failure loading file: %s", error->message);
           ide_buffer_set_state (self, IDE_BUFFER_STATE_FAILED);
           ide_notification_set_progress (state->notif, 0.0);
+          if (state->attached)
+            ide_notification_withdraw (state->notif);
           ide_task_return_error (task, g_steal_pointer (&error));
           IDE_EXIT;
         }
@@ -1542,7 +1808,23 @@ ide_buffer_load_file_cb (GObject      *object,
   gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (self), FALSE);
   _ide_buffer_set_changed_on_volume (self, FALSE);
 
-  ide_highlight_engine_unpause (self->highlight_engine);
+  /* Files with many short lines can stay under the size limit but are
+   * just as costly for line-oriented addins.
+   */
+  if (!self->is_large_file &&
+      state->max_lines > 0 &&
+      gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (self)) > state->max_lines)
+    ide_buffer_set_is_large_file (self, TRUE);
+
+  if (state->attached)
+    ide_notification_withdraw (state->notif);
+
+  /* Large files keep the highlight engine paused until they are
+   * reloaded below the limits.
+   */
+  if (!self->is_large_file)
+    ide_highlight_engine_unpause (self->highlight_engine);
+
   ide_buffer_set_state (self, IDE_BUFFER_STATE_READY);
   ide_notification_set_progress (state->notif, 1.0);
   ide_task_return_boolean (task, TRUE);
@@ -1557,7 +1839,6 @@ _ide_buffer_load_file_async (IdeBuffer            *self,
                              GAsyncReadyCallback   callback,
                              gpointer              user_data)
 {
-  g_autoptr(GtkSourceFileLoader) loader = NULL;
   g_autoptr(IdeTask) task = NULL;
   LoadState *state;
 
@@ -1583,16 +1864,106 @@ _ide_buffer_load_file_async (IdeBuffer            *self,
 
   state = g_slice_new0 (LoadState);
   state->file = g_object_ref (ide_buffer_get_file (self));
+  state->begin_time = _ide_trace_has_mark () ? g_get_monotonic_time () : 0;
   state->notif = notif ? g_object_ref (notif) : ide_notification_new ();
-  state->highlight_syntax = gtk_source_buffer_get_highlight_syntax (GTK_SOURCE_BUFFER (self));
+  state->owns_notif = notif == NULL;
+
+  /* Highlighting is disabled while in large-file mode, so use the
+   * setting it had before entering large-file mode.
+   */
+  if (self->is_large_file)
+    state->highlight_syntax = self->large_file_highlight_syntax;
+  else
+    state->highlight_syntax = gtk_source_buffer_get_highlight_syntax (GTK_SOURCE_BUFFER (self));
   ide_task_set_task_data (task, state, load_state_free);
 
   ide_buffer_set_state (self, IDE_BUFFER_STATE_LOADING);
   _ide_buffer_set_has_encoding_error (self, FALSE);
 
-  /* Disable some features while we reload */
+  /* Disable some features while we reload. Large files already have
+   * the highlight engine paused from when they were loaded.
+   */
   gtk_source_buffer_set_highlight_syntax (GTK_SOURCE_BUFFER (self), FALSE);
-  ide_highlight_engine_pause (self->highlight_engine);
+  if (!self->is_large_file)
+    ide_highlight_engine_pause (self->highlight_engine);
+
+  /* Check the size before loading anything so that addins can be
+   * withheld before they see the contents of a large file.
+   */
+  g_file_query_info_async (state->file,
+                           G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_DEFAULT,
+                           cancellable,
+                           ide_buffer_load_file_query_info_cb,
+                           g_steal_pointer (&task));
+
+  /* Load file settings immediately so that we can increase the chance
+   * they are settled by the the load operation is finished. The modelines
+   * file settings will auto-monitor for IdeBufferManager::buffer-loaded
+   * and settle the file settings when we complete.
+   */
+  ide_buffer_reload_file_settings (self);
+
+  IDE_EXIT;
+}
+
+static void
+ide_buffer_load_file_query_info_cb (GObject      *object,
+                                    GAsyncResult *result,
+                                    gpointer      user_data)
+{
+  GFile *file = (GFile *)object;
+  g_autoptr(GtkSourceFileLoader) loader = NULL;
+  g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  gboolean is_large_file = FALSE;
+  guint64 max_size;
+  LoadState *state;
+  IdeBuffer *self;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (G_IS_FILE (file));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
+  g_assert (IDE_IS_BUFFER (self));
+  g_assert (state != NULL);
+
+  ide_buffer_get_large_file_limits (&max_size, &state->max_lines);
+
+  /* Errors are handled by the loader, which will fail the same way */
+  if ((info = g_file_query_info_finish (file, result, &error)) &&
+      g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE))
+    is_large_file = max_size > 0 && (guint64)g_file_info_get_size (info) > max_size;
+
+  ide_buffer_set_is_large_file (self, is_large_file);
+
+  /* Show progress for large files even when the caller did not provide
+   * a notification of their own, as loading may take a while.
+   */
+  if (is_large_file && state->owns_notif)
+    {
+      g_autoptr(IdeContext) context = ide_buffer_ref_context (self);
+      g_autofree char *title = ide_buffer_dup_title (self);
+      g_autofree char *body = g_strdup_printf (_("Syntax highlighting and some extensions are disabled for “%s” due to its size"), title);
+
+      if (context != NULL)
+        {
+          ide_notification_set_title (state->notif, _("Opening Large File"));
+          ide_notification_set_body (state->notif, body);
+          ide_notification_set_icon_name (state->notif, "document-open-symbolic");
+          ide_notification_set_has_progress (state->notif, TRUE);
+          ide_notification_attach (state->notif, IDE_OBJECT (context));
+          state->attached = TRUE;
+        }
+    }
 
   /* Create our loader, inheriting some values like encoding from the
    * source_file if previously set.
@@ -1614,20 +1985,13 @@ _ide_buffer_load_file_async (IdeBuffer            *self,
 
   gtk_source_file_loader_load_async (loader,
                                      G_PRIORITY_DEFAULT,
-                                     cancellable,
+                                     ide_task_get_cancellable (task),
                                      ide_buffer_progress_cb,
                                      g_object_ref (state->notif),
                                      g_object_unref,
                                      ide_buffer_load_file_cb,
                                      g_steal_pointer (&task));
 
-  /* Load file settings immediately so that we can increase the chance
-   * they are settled by the the load operation is finished. The modelines
-   * file settings will auto-monitor for IdeBufferManager::buffer-loaded
-   * and settle the file settings when we complete.
-   */
-  ide_buffer_reload_file_settings (self);
-
   IDE_EXIT;
 }
 
@@ -1660,9 +2024,13 @@ _ide_buffer_load_file_finish (IdeBuffer     *self,
   if (!ide_task_propagate_boolean (IDE_TASK (result), error))
     return FALSE;
 
-  /* Restore various buffer features we disabled while loading */
+  /* Restore various buffer features we disabled while loading, unless
+   * they are meant to stay off for large files.
+   */
   state = ide_task_get_task_data (IDE_TASK (result));
-  if (state->highlight_syntax)
+  if (self->is_large_file)
+    self->large_file_highlight_syntax = state->highlight_syntax;
+  else if (state->highlight_syntax)
     gtk_source_buffer_set_highlight_syntax (GTK_SOURCE_BUFFER (self), TRUE);
 
   /* Guess the syntax language now if necessary */
@@ -1676,9 +2044,9 @@ _ide_buffer_load_file_finish (IdeBuffer     *self,
   if (self->addins != NULL && self->enable_addins)
     {
       IdeBufferFileLoad closure = { self, state->file };
-      ide_extension_set_adapter_foreach (self->addins,
-                                         _ide_buffer_addin_file_loaded_cb,
-                                         &closure);
+      ide_buffer_foreach_addin (self,
+                                _ide_buffer_addin_file_loaded_cb,
+                                &closure);
     }
 
   return TRUE;
@@ -1710,6 +2078,8 @@ ide_buffer_save_file_cb (GObject      *object,
   g_assert (G_IS_FILE (state->file));
   g_assert (IDE_IS_NOTIFICATION (state->notif));
 
+  trace_file_mark (state->file, state->begin_time, "save");
+
   if (!gtk_source_file_saver_save_finish (saver, result, &error))
     {
       ide_notification_set_progress (state->notif, 0.0);
@@ -1730,9 +2100,9 @@ ide_buffer_save_file_cb (GObject      *object,
   if (self->addins != NULL && self->enable_addins)
     {
       IdeBufferFileSave closure = { self, state->file };
-      ide_extension_set_adapter_foreach (self->addins,
-                                         _ide_buffer_addin_file_saved_cb,
-                                         &closure);
+      ide_buffer_foreach_addin (self,
+                                _ide_buffer_addin_file_saved_cb,
+                                &closure);
     }
 
   if (self->buffer_manager != NULL)
@@ -1772,9 +2142,9 @@ ide_buffer_save_file_settle_cb (GObject      *object,
   if (self->addins != NULL && self->enable_addins)
     {
       IdeBufferFileSave closure = { self, state->file };
-      ide_extension_set_adapter_foreach (self->addins,
-                                         _ide_buffer_addin_save_file_cb,
-                                         &closure);
+      ide_buffer_foreach_addin (self,
+                                _ide_buffer_addin_save_file_cb,
+                                &closure);
     }
 
   saver = gtk_source_file_saver_new (GTK_SOURCE_BUFFER (self), state->source_file);
@@ -1870,6 +2240,7 @@ ide_buffer_save_file_async (IdeBuffer            *self,
   state = g_slice_new0 (SaveState);
   state->file = g_object_ref (file);
   state->notif = g_object_ref (local_notif);
+  state->begin_time = _ide_trace_has_mark () ? g_get_monotonic_time () : 0;
 
   task = ide_task_new (self, cancellable, callback, user_data);
   ide_task_set_source_tag (task, ide_buffer_save_file_async);
@@ -2565,12 +2936,13 @@ ide_buffer_settled_cb (gpointer user_data)
   g_assert (IDE_IS_BUFFER (self));
 
   self->settling_source = 0;
+  ide_buffer_update_memory_account (self);
   g_signal_emit (self, signals [CHANGE_SETTLED], 0);
 
   if (self->addins != NULL && self->enable_addins)
-    ide_extension_set_adapter_foreach (self->addins,
-                                       _ide_buffer_addin_change_settled_cb,
-                                       self);
+    ide_buffer_foreach_addin (self,
+                              _ide_buffer_addin_change_settled_cb,
+                              self);
 
   return G_SOURCE_REMOVE;
 }
@@ -3529,9 +3901,9 @@ ide_buffer_notify_style_scheme (IdeBuffer  *self,
 #undef GET_TAG
 
   if (self->addins != NULL && self->enable_addins)
-    ide_extension_set_adapter_foreach (self->addins,
-                                       _ide_buffer_addin_style_scheme_changed_cb,
-                                       self);
+    ide_buffer_foreach_addin (self,
+                              _ide_buffer_addin_style_scheme_changed_cb,
+                              self);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_STYLE_SCHEME_NAME]);
 
@@ -4317,9 +4689,9 @@ settle_async (IdeBuffer           *self,
   ide_task_set_task_data (task, n_active, g_free);
 
   if (self->addins != NULL && self->enable_addins)
-    ide_extension_set_adapter_foreach (self->addins,
-                                       settle_foreach_cb,
-                                       task);
+    ide_buffer_foreach_addin (self,
+                              settle_foreach_cb,
+                              task);
 
   if (*n_active == 0)
     ide_task_return_boolean (task, TRUE);
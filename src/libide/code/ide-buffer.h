@@ -93,6 +93,8 @@ IDE_AVAILABLE_IN_ALL
 IdeDiagnostics         *ide_buffer_get_diagnostics               (IdeBuffer               *self);
 IDE_AVAILABLE_IN_ALL
 IdeLocation            *ide_buffer_get_insert_location           (IdeBuffer               *self);
+IDE_AVAILABLE_IN_46
+gboolean                ide_buffer_get_is_large_file             (IdeBuffer               *self);
 IDE_AVAILABLE_IN_ALL
 gboolean                ide_buffer_get_is_temporary              (IdeBuffer               *self);
 IDE_AVAILABLE_IN_ALL
@@ -29,6 +29,8 @@
 
 #include <libide-plugins.h>
 
+#include "ide-private.h"
+
 #include "ide-buffer.h"
 #include "ide-buffer-private.h"
 #include "ide-highlight-engine.h"
@@ -394,7 +396,17 @@ ide_highlight_engine_worker (gint64   deadline,
 
   if (self->enabled)
     {
-      if (ide_highlight_engine_tick (self, deadline))
+      gint64 begin_time = _ide_trace_has_mark () ? g_get_monotonic_time () : 0;
+      gboolean ret = ide_highlight_engine_tick (self, deadline);
+
+      if (begin_time != 0)
+        _ide_trace_mark (begin_time,
+                         g_get_monotonic_time (),
+                         "highlight",
+                         "tick",
+                         self->highlighter ? G_OBJECT_TYPE_NAME (self->highlighter) : NULL);
+
+      if (ret)
         return G_SOURCE_CONTINUE;
     }
 
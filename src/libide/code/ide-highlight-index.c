@@ -22,10 +22,14 @@
 
 #include "config.h"
 
+#include <glib/gi18n.h>
 #include <string.h>
 
 #include "ide-highlight-index.h"
 
+/* Approximate cost of a key/value pair within the GHashTable */
+#define INDEX_ENTRY_SIZE (sizeof (gpointer) * 2 + sizeof (guint))
+
 G_DEFINE_BOXED_TYPE (IdeHighlightIndex, ide_highlight_index,
                      ide_highlight_index_ref, ide_highlight_index_unref)
 
@@ -35,11 +39,33 @@ struct _IdeHighlightIndex
   guint          count;
   gsize          chunk_size;
 
+  /* Bytes charged to the memory account */
+  gsize          charged;
+
   GStringChunk  *strings;
   GHashTable    *index;
   GVariant      *variant;
 };
 
+static IdeMemoryAccount *
+get_memory_account (void)
+{
+  static IdeMemoryAccount *account;
+
+  if (g_once_init_enter (&account))
+    g_once_init_leave (&account, ide_memory_account_get ("highlight-index", _("Highlight Indexes")));
+
+  return account;
+}
+
+static void
+ide_highlight_index_charge (IdeHighlightIndex *self,
+                            gsize              bytes)
+{
+  self->charged += bytes;
+  ide_memory_account_charge (get_memory_account (), bytes);
+}
+
 IdeHighlightIndex *
 ide_highlight_index_new (void)
 {
@@ -102,6 +128,10 @@ ide_highlight_index_new_from_variant (GVariant *variant)
                 }
             }
         }
+
+      ide_highlight_index_charge (self,
+                                  g_variant_get_size (self->variant) +
+                                  (self->count * INDEX_ENTRY_SIZE));
     }
 
   return self;
@@ -128,6 +158,8 @@ ide_highlight_index_insert (IdeHighlightIndex *self,
 
   key = g_string_chunk_insert (self->strings, word);
   g_hash_table_insert (self->index, key, tag);
+
+  ide_highlight_index_charge (self, strlen (word) + 1 + INDEX_ENTRY_SIZE);
 }
 
 /**
@@ -163,6 +195,8 @@ ide_highlight_index_finalize (IdeHighlightIndex *self)
 {
   IDE_ENTRY;
 
+  ide_memory_account_discharge (get_memory_account (), self->charged);
+
   g_clear_pointer (&self->strings, g_string_chunk_free);
   g_clear_pointer (&self->index, g_hash_table_unref);
   g_clear_pointer (&self->variant, g_variant_unref);
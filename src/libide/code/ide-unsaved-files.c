@@ -27,6 +27,7 @@
 #include <fcntl.h>
 #include <glib/gstdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <libide-io.h>
 #include <libide-threading.h>
@@ -49,6 +50,7 @@ struct _IdeUnsavedFiles
 {
   IdeObject  parent_instance;
   GMutex     mutex;
+  GMutex     save_mutex;
   GPtrArray *unsaved_files;
   gint64     sequence;
   gchar     *project_id;
@@ -143,35 +145,92 @@ unsaved_file_copy (const UnsavedFile *uf)
   return copy;
 }
 
+static gchar *
+unsaved_file_checksum (const UnsavedFile *uf)
+{
+  g_assert (uf != NULL);
+  g_assert (uf->content != NULL);
+
+  return g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, uf->content);
+}
+
 static gboolean
 unsaved_file_save (UnsavedFile  *uf,
                    const gchar  *path,
+                   gboolean     *written,
                    GError      **error)
 {
-  g_autoptr(GFile) file = NULL;
+  GStatBuf st;
 
   g_assert (uf != NULL);
   g_assert (uf->content != NULL);
   g_assert (path != NULL);
+  g_assert (written != NULL);
+
+  *written = FALSE;
+
+  /*
+   * Drafts are stored by the checksum of their contents so a draft which
+   * has not changed since the last save is already on disk and need not be
+   * written again. Objects are never modified once written, which also makes
+   * them safe to mmap() when restoring. An object left short by a crash is
+   * rewritten rather than trusted.
+   */
+  if (g_stat (path, &st) == 0 &&
+      S_ISREG (st.st_mode) &&
+      st.st_size == (goffset)g_bytes_get_size (uf->content))
+    return TRUE;
 
   /*
    * These files can be accessed by third-party programs. So we need to ensure
    * those programs see either the old version of the file or the new version
-   * of the file. g_file_replace_contents() conveniently provides the atomic
-   * rename() for us.
+   * of the file. They must also be on disk before the manifest referencing
+   * them is, so only unchanged drafts avoid the fsync().
+   */
+  if (!g_file_set_contents_full (path,
+                                 g_bytes_get_data (uf->content, NULL),
+                                 g_bytes_get_size (uf->content),
+                                 G_FILE_SET_CONTENTS_CONSISTENT | G_FILE_SET_CONTENTS_DURABLE,
+                                 0600,
+                                 error))
+    return FALSE;
+
+  *written = TRUE;
+
+  return TRUE;
+}
+
+static void
+sync_directory (const gchar *path)
+{
+  int fd;
+
+  g_assert (path != NULL);
+
+  /* Make the renames of new objects durable before referencing them */
+  if ((fd = g_open (path, O_RDONLY | O_DIRECTORY, 0)) != -1)
+    {
+      fsync (fd);
+      g_close (fd, NULL);
+    }
+}
+
+static gboolean
+is_object_name (const gchar *name)
+{
+  /* Anything else, such as the temporary files g_file_set_contents()
+   * creates before renaming, is not ours to remove.
    */
+  if (strlen (name) != 64)
+    return FALSE;
 
-  file = g_file_new_for_path (path);
+  for (const gchar *c = name; *c; c++)
+    {
+      if (!g_ascii_isxdigit (*c))
+        return FALSE;
+    }
 
-  return g_file_replace_contents (file,
-                                  g_bytes_get_data (uf->content, NULL),
-                                  g_bytes_get_size (uf->content),
-                                  NULL,
-                                  FALSE,
-                                  G_FILE_CREATE_REPLACE_DESTINATION,
-                                  NULL,
-                                  NULL,
-                                  error);
+  return TRUE;
 }
 
 static gchar *
@@ -190,6 +249,37 @@ hash_uri (const gchar *uri)
   return ret;
 }
 
+static gchar *
+get_objects_dir (const gchar *drafts_directory)
+{
+  g_assert (drafts_directory != NULL);
+
+  return g_build_filename (drafts_directory, "objects", NULL);
+}
+
+static void
+remove_unreferenced_objects (const gchar *objects_dir,
+                             GHashTable  *referenced)
+{
+  g_autoptr(GDir) dir = NULL;
+  const gchar *name;
+
+  g_assert (objects_dir != NULL);
+  g_assert (referenced != NULL);
+
+  if (!(dir = g_dir_open (objects_dir, 0, NULL)))
+    return;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      if (is_object_name (name) && !g_hash_table_contains (referenced, name))
+        {
+          g_autofree gchar *path = g_build_filename (objects_dir, name, NULL);
+          g_unlink (path);
+        }
+    }
+}
+
 static gchar *
 get_buffers_dir (IdeContext *context)
 {
@@ -205,20 +295,32 @@ ide_unsaved_files_save_worker (IdeTask      *task,
                                GCancellable *cancellable)
 {
   g_autofree gchar *manifest_path = NULL;
+  g_autofree gchar *objects_dir = NULL;
+  g_autoptr(GHashTable) referenced = NULL;
   g_autoptr(GString) manifest = NULL;
   g_autoptr(GError) write_error = NULL;
+  g_autoptr(GMutexLocker) locker = NULL;
+  IdeUnsavedFiles *self = source_object;
   AsyncState *state = task_data;
+  gboolean needs_sync = FALSE;
 
   IDE_ENTRY;
 
   g_assert (IDE_IS_TASK (task));
-  g_assert (IDE_IS_UNSAVED_FILES (source_object));
+  g_assert (IDE_IS_UNSAVED_FILES (self));
   g_assert (state != NULL);
   g_assert (state->drafts_directory != NULL);
   g_assert (state->unsaved_files != NULL);
 
+  /* Overlapping saves would otherwise remove objects which the other save
+   * has just written but not yet referenced from its manifest.
+   */
+  locker = g_mutex_locker_new (&self->save_mutex);
+
+  objects_dir = get_objects_dir (state->drafts_directory);
+
   /* ensure that the directory exists */
-  if (g_mkdir_with_parents (state->drafts_directory, 0700) != 0)
+  if (g_mkdir_with_parents (objects_dir, 0700) != 0)
     {
       ide_task_return_new_error (task,
                                  G_IO_ERROR,
@@ -229,6 +331,7 @@ ide_unsaved_files_save_worker (IdeTask      *task,
 
   manifest = g_string_new (NULL);
   manifest_path = g_build_filename (state->drafts_directory, "manifest", NULL);
+  referenced = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   for (guint i = 0; i < state->unsaved_files->len; i++)
     {
@@ -236,28 +339,50 @@ ide_unsaved_files_save_worker (IdeTask      *task,
       g_autoptr(GError) error = NULL;
       g_autofree gchar *path = NULL;
       g_autofree gchar *uri = NULL;
-      g_autofree gchar *hash = NULL;
+      g_autofree gchar *checksum = NULL;
+      gboolean written;
 
       uri = g_file_get_uri (uf->file);
+      checksum = unsaved_file_checksum (uf);
+      path = g_build_filename (objects_dir, checksum, NULL);
 
-      IDE_TRACE_MSG ("saving draft for unsaved file \"%s\"", uri);
+      IDE_TRACE_MSG ("saving draft for unsaved file \"%s\" as %s", uri, checksum);
 
-      g_string_append_printf (manifest, "%s\n", uri);
+      if (!unsaved_file_save (uf, path, &written, &error))
+        {
+          ide_object_warning (source_object,
+                              /* translators: %s is replaced with the error message */
+                              _("Failed to save draft: %s"),
+                              error->message);
+          continue;
+        }
 
-      hash = hash_uri (uri);
-      path = g_build_filename (state->drafts_directory, hash, NULL);
+      needs_sync |= written;
 
-      if (!unsaved_file_save (uf, path, &error))
-        ide_object_warning (source_object,
-                            /* translators: %s is replaced with the error message */
-                            _("Failed to save draft: %s"),
-                            error->message);
+      g_string_append_printf (manifest, "%s\t%s\n", uri, checksum);
+      g_hash_table_add (referenced, g_steal_pointer (&checksum));
     }
 
-  if (!g_file_set_contents (manifest_path, manifest->str, manifest->len, &write_error))
-    ide_task_return_error (task, g_steal_pointer (&write_error));
-  else
-    ide_task_return_boolean (task, TRUE);
+  if (needs_sync)
+    sync_directory (objects_dir);
+
+  /* The manifest is what makes the new objects reachable, so it is only
+   * committed once every object it references is durable.
+   */
+  if (!g_file_set_contents_full (manifest_path,
+                                 manifest->str,
+                                 manifest->len,
+                                 G_FILE_SET_CONTENTS_CONSISTENT | G_FILE_SET_CONTENTS_DURABLE,
+                                 0600,
+                                 &write_error))
+    {
+      ide_task_return_error (task, g_steal_pointer (&write_error));
+      IDE_EXIT;
+    }
+
+  remove_unreferenced_objects (objects_dir, referenced);
+
+  ide_task_return_boolean (task, TRUE);
 
   IDE_EXIT;
 }
@@ -346,6 +471,7 @@ ide_unsaved_files_restore_worker (IdeTask      *task,
   AsyncState *state = task_data;
   g_autofree gchar *manifest_contents = NULL;
   g_autofree gchar *manifest_path = NULL;
+  g_autofree gchar *objects_dir = NULL;
   g_autoptr(GError) read_error = NULL;
   IdeLineReader reader;
   gchar *line;
@@ -359,6 +485,7 @@ ide_unsaved_files_restore_worker (IdeTask      *task,
   g_assert (state != NULL);
 
   manifest_path = g_build_filename (state->drafts_directory, "manifest", NULL);
+  objects_dir = get_objects_dir (state->drafts_directory);
 
   g_debug ("Loading drafts manifest %s", manifest_path);
 
@@ -389,27 +516,38 @@ ide_unsaved_files_restore_worker (IdeTask      *task,
     {
       g_autoptr(GFile) file = NULL;
       g_autoptr(GError) error = NULL;
-      g_autofree gchar *contents = NULL;
+      g_autoptr(GMappedFile) mapped = NULL;
       g_autofree gchar *hash = NULL;
       g_autofree gchar *path = NULL;
       UnsavedFile *unsaved;
-      gsize data_len = 0;
+      gchar *tab;
 
       line[line_len] = '\0';
 
       if (ide_str_empty0 (line))
         continue;
 
+      /* Manifests are "uri\tchecksum" lines, older ones only contain the
+       * uri and the draft is stored by the hash of the uri.
+       */
+      if ((tab = strchr (line, '\t')))
+        {
+          *tab = '\0';
+          path = g_build_filename (objects_dir, tab + 1, NULL);
+        }
+      else
+        {
+          hash = hash_uri (line);
+          path = g_build_filename (state->drafts_directory, hash, NULL);
+        }
+
       file = g_file_new_for_uri (line);
       if (file == NULL || !g_file_query_exists (file, NULL))
         continue;
 
-      hash = hash_uri (line);
-      path = g_build_filename (state->drafts_directory, hash, NULL);
-
       g_debug ("Loading draft for \"%s\" from \"%s\"", line, path);
 
-      if (!g_file_get_contents (path, &contents, &data_len, &error))
+      if (!(mapped = g_mapped_file_new (path, FALSE, &error)))
         {
           ide_object_warning (source_object,
                               /* translators: the first %s is the path, th second is the error message */
@@ -420,7 +558,7 @@ ide_unsaved_files_restore_worker (IdeTask      *task,
 
       unsaved = g_slice_new0 (UnsavedFile);
       unsaved->file = g_object_ref (file);
-      unsaved->content = g_bytes_new_take (g_steal_pointer (&contents), data_len);
+      unsaved->content = g_mapped_file_get_bytes (mapped);
 
       g_ptr_array_add (state->unsaved_files, g_steal_pointer (&unsaved));
     }
@@ -506,10 +644,12 @@ ide_unsaved_files_move_to_front_locked (IdeUnsavedFiles *self,
 }
 
 static void
-ide_unsaved_files_remove_draft_locked (IdeUnsavedFiles *self,
-                                       GFile           *file)
+ide_unsaved_files_remove_draft_locked (IdeUnsavedFiles   *self,
+                                       const UnsavedFile *unsaved)
 {
   g_autofree gchar *drafts_directory = NULL;
+  g_autofree gchar *objects_dir = NULL;
+  g_autofree gchar *checksum = NULL;
   g_autofree gchar *uri = NULL;
   g_autofree gchar *hash = NULL;
   g_autofree gchar *path = NULL;
@@ -518,15 +658,33 @@ ide_unsaved_files_remove_draft_locked (IdeUnsavedFiles *self,
 
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (IDE_IS_UNSAVED_FILES (self));
-  g_assert (G_IS_FILE (file));
+  g_assert (unsaved != NULL);
 
   drafts_directory = get_drafts_directory (self);
-  uri = g_file_get_uri (file);
+  uri = g_file_get_uri (unsaved->file);
+
+  g_debug ("Removing draft for \"%s\"", uri);
+
+  /* Drafts from older manifests */
   hash = hash_uri (uri);
   path = g_build_filename (drafts_directory, hash, NULL);
+  g_unlink (path);
 
-  g_debug ("Removing draft for \"%s\"", uri);
+  /* Objects are shared between files with identical contents, so only
+   * remove the object if no other unsaved file still references it.
+   */
+  for (guint i = 0; i < self->unsaved_files->len; i++)
+    {
+      const UnsavedFile *other = g_ptr_array_index (self->unsaved_files, i);
+
+      if (other != unsaved && g_bytes_equal (other->content, unsaved->content))
+        IDE_EXIT;
+    }
 
+  objects_dir = get_objects_dir (drafts_directory);
+  checksum = unsaved_file_checksum (unsaved);
+  g_clear_pointer (&path, g_free);
+  path = g_build_filename (objects_dir, checksum, NULL);
   g_unlink (path);
 
   IDE_EXIT;
@@ -550,7 +708,7 @@ ide_unsaved_files_remove (IdeUnsavedFiles *self,
 
       if (g_file_equal (file, unsaved->file))
         {
-          ide_unsaved_files_remove_draft_locked (self, file);
+          ide_unsaved_files_remove_draft_locked (self, unsaved);
           g_ptr_array_remove_index_fast (self->unsaved_files, i);
           break;
         }
@@ -862,6 +1020,7 @@ ide_unsaved_files_finalize (GObject *object)
   g_clear_pointer (&self->unsaved_files, g_ptr_array_unref);
   g_clear_pointer (&self->project_id, g_free);
   g_mutex_clear (&self->mutex);
+  g_mutex_clear (&self->save_mutex);
 
   G_OBJECT_CLASS (ide_unsaved_files_parent_class)->finalize (object);
 }
@@ -889,6 +1048,7 @@ static void
 ide_unsaved_files_init (IdeUnsavedFiles *self)
 {
   g_mutex_init (&self->mutex);
+  g_mutex_init (&self->save_mutex);
   self->unsaved_files = g_ptr_array_new_with_free_func (unsaved_file_free);
 }
 
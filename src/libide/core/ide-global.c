@@ -241,11 +241,13 @@ ide_gettext (const gchar *message)
 }
 
 static IdeTraceVTable trace_vtable;
+static int marks_enabled = TRUE;
 
 void
 _ide_trace_init (IdeTraceVTable *vtable)
 {
   trace_vtable = *vtable;
+  g_atomic_int_set (&marks_enabled, TRUE);
   if (trace_vtable.load)
     trace_vtable.load ();
 }
@@ -282,6 +284,76 @@ _ide_trace_log (GLogLevelFlags  log_level,
     trace_vtable.log (log_level, domain, message);
 }
 
+/*
+ * _ide_trace_mark:
+ *
+ * Records a span of time which may be exported to a profiler capture.
+ * Unlike ide_trace_function(), this is available when Builder has not
+ * been compiled with tracing so that it may be used to measure specific
+ * events such as startup.
+ */
+void
+_ide_trace_mark (gint64       begin_time_usec,
+                 gint64       end_time_usec,
+                 const gchar *group,
+                 const gchar *name,
+                 const gchar *message)
+{
+  if (end_time_usec < begin_time_usec)
+    end_time_usec = begin_time_usec;
+
+  if (trace_vtable.mark && g_atomic_int_get (&marks_enabled))
+    trace_vtable.mark (begin_time_usec, end_time_usec, group, name, message);
+}
+
+/*
+ * _ide_trace_counter:
+ *
+ * Records the current value of a counter such as the depth of a queue.
+ * Counters are defined lazily by the trace backend the first time that
+ * @group and @name are seen. Like _ide_trace_mark(), this is a no-op
+ * unless marks are enabled.
+ */
+void
+_ide_trace_counter (const gchar *group,
+                    const gchar *name,
+                    gint64       value)
+{
+  if (trace_vtable.counter && g_atomic_int_get (&marks_enabled))
+    trace_vtable.counter (group, name, value);
+}
+
+/*
+ * _ide_trace_has_mark:
+ *
+ * Checks if marks are recorded so that callers may avoid formatting
+ * messages that would be discarded.
+ */
+gboolean
+_ide_trace_has_mark (void)
+{
+  return trace_vtable.mark != NULL && g_atomic_int_get (&marks_enabled);
+}
+
+gboolean
+_ide_trace_get_marks_enabled (void)
+{
+  return g_atomic_int_get (&marks_enabled);
+}
+
+/*
+ * _ide_trace_set_marks_enabled:
+ *
+ * Toggles recording of marks and counters at runtime so that a capture
+ * may be limited to the workload of interest. This is safe to call from
+ * any thread.
+ */
+void
+_ide_trace_set_marks_enabled (gboolean enabled)
+{
+  g_atomic_int_set (&marks_enabled, !!enabled);
+}
+
 static gchar **
 get_environ_from_stdout (GSubprocess *subprocess)
 {
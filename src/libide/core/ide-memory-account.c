@@ -0,0 +1,557 @@
+/* ide-memory-account.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ide-memory-account"
+
+#include "config.h"
+
+#include "ide-debug.h"
+#include "ide-global.h"
+#include "ide-macros.h"
+#include "ide-memory-account.h"
+
+/**
+ * SECTION:ide-memory-account
+ * @title: IdeMemoryAccount
+ * @short_description: track memory used by a subsystem
+ *
+ * #IdeMemoryAccount is a process-wide counter of the bytes consumed by a
+ * subsystem such as buffers, highlight indexes, or cache entries.
+ *
+ * Subsystems charge and discharge the account as they allocate and free
+ * their data, which may be done from any thread. Subsystems whose usage
+ * can only be polled, such as helper daemons, connect to
+ * #IdeMemoryAccount::sample and update the account when asked.
+ *
+ * An account may be given a budget. When the charged bytes exceed the
+ * budget, #IdeMemoryAccount::over-budget is emitted on the main thread so
+ * that caches may evict entries.
+ *
+ * Since: 46
+ */
+
+struct _IdeMemoryAccount
+{
+  GObject  parent_instance;
+
+  char    *name;
+  char    *title;
+
+  /* Atomically updated from any thread */
+  gssize   bytes;
+  gsize    budget;
+  int      flush_queued;
+};
+
+enum {
+  PROP_0,
+  PROP_BUDGET,
+  PROP_BYTES,
+  PROP_NAME,
+  PROP_TITLE,
+  N_PROPS
+};
+
+enum {
+  OVER_BUDGET,
+  SAMPLE,
+  N_SIGNALS
+};
+
+G_DEFINE_FINAL_TYPE (IdeMemoryAccount, ide_memory_account, G_TYPE_OBJECT)
+
+static GParamSpec *properties [N_PROPS];
+static guint signals [N_SIGNALS];
+static GMutex accounts_mutex;
+static GHashTable *accounts_by_name;
+static GListStore *accounts;
+
+static gboolean
+ide_memory_account_flush_cb (gpointer data)
+{
+  IdeMemoryAccount *self = data;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_MEMORY_ACCOUNT (self));
+
+  g_atomic_int_set (&self->flush_queued, FALSE);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_BYTES]);
+
+  if (ide_memory_account_is_over_budget (self))
+    g_signal_emit (self, signals [OVER_BUDGET], 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ide_memory_account_queue_flush (IdeMemoryAccount *self)
+{
+  g_assert (IDE_IS_MEMORY_ACCOUNT (self));
+
+  /* Coalesce notifications so that charging is cheap from hot paths */
+  if (g_atomic_int_compare_and_exchange (&self->flush_queued, FALSE, TRUE))
+    g_idle_add_full (G_PRIORITY_LOW,
+                     ide_memory_account_flush_cb,
+                     g_object_ref (self),
+                     g_object_unref);
+}
+
+static void
+ide_memory_account_ensure_locked (void)
+{
+  if (accounts_by_name == NULL)
+    {
+      accounts_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+      accounts = g_list_store_new (IDE_TYPE_MEMORY_ACCOUNT);
+    }
+}
+
+static gboolean
+ide_memory_account_append_cb (gpointer data)
+{
+  IdeMemoryAccount *self = data;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_MEMORY_ACCOUNT (self));
+
+  g_list_store_append (accounts, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ide_memory_account_finalize (GObject *object)
+{
+  IdeMemoryAccount *self = (IdeMemoryAccount *)object;
+
+  g_clear_pointer (&self->name, g_free);
+  g_clear_pointer (&self->title, g_free);
+
+  G_OBJECT_CLASS (ide_memory_account_parent_class)->finalize (object);
+}
+
+static void
+ide_memory_account_get_property (GObject    *object,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  IdeMemoryAccount *self = IDE_MEMORY_ACCOUNT (object);
+
+  switch (prop_id)
+    {
+    case PROP_BUDGET:
+      g_value_set_uint64 (value, ide_memory_account_get_budget (self));
+      break;
+
+    case PROP_BYTES:
+      g_value_set_uint64 (value, ide_memory_account_get_bytes (self));
+      break;
+
+    case PROP_NAME:
+      g_value_set_string (value, self->name);
+      break;
+
+    case PROP_TITLE:
+      g_value_set_string (value, self->title);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ide_memory_account_set_property (GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  IdeMemoryAccount *self = IDE_MEMORY_ACCOUNT (object);
+
+  switch (prop_id)
+    {
+    case PROP_BUDGET:
+      ide_memory_account_set_budget (self, g_value_get_uint64 (value));
+      break;
+
+    case PROP_NAME:
+      self->name = g_value_dup_string (value);
+      break;
+
+    case PROP_TITLE:
+      self->title = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ide_memory_account_class_init (IdeMemoryAccountClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = ide_memory_account_finalize;
+  object_class->get_property = ide_memory_account_get_property;
+  object_class->set_property = ide_memory_account_set_property;
+
+  /**
+   * IdeMemoryAccount:budget:
+   *
+   * The number of bytes the subsystem should stay within, or 0 for
+   * no limit.
+   *
+   * Since: 46
+   */
+  properties [PROP_BUDGET] =
+    g_param_spec_uint64 ("budget", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * IdeMemoryAccount:bytes:
+   *
+   * The number of bytes currently charged to the account.
+   *
+   * Since: 46
+   */
+  properties [PROP_BYTES] =
+    g_param_spec_uint64 ("bytes", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_NAME] =
+    g_param_spec_string ("name", NULL, NULL,
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_TITLE] =
+    g_param_spec_string ("title", NULL, NULL,
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  /**
+   * IdeMemoryAccount::over-budget:
+   *
+   * Emitted on the main thread after the account has been charged
+   * beyond its budget. Caches should evict entries in response.
+   *
+   * Since: 46
+   */
+  signals [OVER_BUDGET] =
+    g_signal_new ("over-budget",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 0);
+
+  /**
+   * IdeMemoryAccount::sample:
+   *
+   * Emitted on the main thread when an up-to-date value is requested,
+   * so that subsystems which can only poll their usage may update the
+   * account.
+   *
+   * Since: 46
+   */
+  signals [SAMPLE] =
+    g_signal_new ("sample",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE, 0);
+}
+
+static void
+ide_memory_account_init (IdeMemoryAccount *self)
+{
+}
+
+/**
+ * ide_memory_account_get:
+ * @name: the name of the account such as "buffers"
+ * @title: (nullable): a translated title for the account
+ *
+ * Gets the account named @name, creating it if necessary.
+ *
+ * Accounts live for the lifetime of the process, so callers may keep
+ * the result in a static variable. This function is thread-safe.
+ *
+ * Returns: (transfer none): an #IdeMemoryAccount
+ *
+ * Since: 46
+ */
+IdeMemoryAccount *
+ide_memory_account_get (const char *name,
+                        const char *title)
+{
+  IdeMemoryAccount *self;
+
+  g_return_val_if_fail (name != NULL, NULL);
+
+  g_mutex_lock (&accounts_mutex);
+
+  ide_memory_account_ensure_locked ();
+
+  if (!(self = g_hash_table_lookup (accounts_by_name, name)))
+    {
+      self = g_object_new (IDE_TYPE_MEMORY_ACCOUNT,
+                           "name", name,
+                           "title", title ? title : name,
+                           NULL);
+      g_hash_table_insert (accounts_by_name, self->name, self);
+
+      if (IDE_IS_MAIN_THREAD ())
+        g_list_store_append (accounts, self);
+      else
+        g_idle_add_full (G_PRIORITY_DEFAULT,
+                         ide_memory_account_append_cb,
+                         g_object_ref (self),
+                         g_object_unref);
+    }
+
+  g_mutex_unlock (&accounts_mutex);
+
+  return self;
+}
+
+/**
+ * ide_memory_account_list:
+ *
+ * Gets a #GListModel of the registered #IdeMemoryAccount.
+ *
+ * This function may only be called from the main thread.
+ *
+ * Returns: (transfer none): a #GListModel of #IdeMemoryAccount
+ *
+ * Since: 46
+ */
+GListModel *
+ide_memory_account_list (void)
+{
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
+
+  g_mutex_lock (&accounts_mutex);
+  ide_memory_account_ensure_locked ();
+  g_mutex_unlock (&accounts_mutex);
+
+  return G_LIST_MODEL (accounts);
+}
+
+/**
+ * ide_memory_account_sample_all:
+ *
+ * Emits #IdeMemoryAccount::sample for every account so that polled
+ * subsystems, such as helper daemons, are up to date.
+ *
+ * Since: 46
+ */
+void
+ide_memory_account_sample_all (void)
+{
+  GListModel *model;
+  guint n_items;
+
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+
+  model = ide_memory_account_list ();
+  n_items = g_list_model_get_n_items (model);
+
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr(IdeMemoryAccount) self = g_list_model_get_item (model, i);
+
+      g_signal_emit (self, signals [SAMPLE], 0);
+    }
+}
+
+/**
+ * ide_memory_account_report:
+ *
+ * Samples all accounts and formats them in the same style as the
+ * support log, suitable for printing from the command line.
+ *
+ * Returns: (transfer full): a newly allocated string
+ *
+ * Since: 46
+ */
+char *
+ide_memory_account_report (void)
+{
+  GListModel *model;
+  GString *str;
+  guint n_items;
+
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
+
+  ide_memory_account_sample_all ();
+
+  model = ide_memory_account_list ();
+  n_items = g_list_model_get_n_items (model);
+  str = g_string_new (NULL);
+
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr(IdeMemoryAccount) self = g_list_model_get_item (model, i);
+      g_autofree char *format = g_format_size (ide_memory_account_get_bytes (self));
+      guint64 budget = ide_memory_account_get_budget (self);
+
+      g_string_append_printf (str, "[runtime.memory.%s]\n", self->name);
+      g_string_append_printf (str, "title = \"%s\"\n", self->title);
+      g_string_append_printf (str, "bytes = %"G_GUINT64_FORMAT"\n", ide_memory_account_get_bytes (self));
+      g_string_append_printf (str, "size = \"%s\"\n", format);
+      g_string_append_printf (str, "budget = %"G_GUINT64_FORMAT"\n", budget);
+      g_string_append (str, "\n");
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+const char *
+ide_memory_account_get_name (IdeMemoryAccount *self)
+{
+  g_return_val_if_fail (IDE_IS_MEMORY_ACCOUNT (self), NULL);
+
+  return self->name;
+}
+
+const char *
+ide_memory_account_get_title (IdeMemoryAccount *self)
+{
+  g_return_val_if_fail (IDE_IS_MEMORY_ACCOUNT (self), NULL);
+
+  return self->title;
+}
+
+guint64
+ide_memory_account_get_bytes (IdeMemoryAccount *self)
+{
+  gssize bytes;
+
+  g_return_val_if_fail (IDE_IS_MEMORY_ACCOUNT (self), 0);
+
+  bytes = (gssize)g_atomic_pointer_get (&self->bytes);
+
+  return MAX (0, bytes);
+}
+
+guint64
+ide_memory_account_get_budget (IdeMemoryAccount *self)
+{
+  g_return_val_if_fail (IDE_IS_MEMORY_ACCOUNT (self), 0);
+
+  return (gsize)g_atomic_pointer_get (&self->budget);
+}
+
+/**
+ * ide_memory_account_set_budget:
+ * @self: a #IdeMemoryAccount
+ * @budget: the budget in bytes, or 0 for no limit
+ *
+ * Sets the budget for the account.
+ *
+ * If the account is already over the new budget then
+ * #IdeMemoryAccount::over-budget is emitted shortly after.
+ *
+ * Since: 46
+ */
+void
+ide_memory_account_set_budget (IdeMemoryAccount *self,
+                               guint64           budget)
+{
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (IDE_IS_MEMORY_ACCOUNT (self));
+
+  budget = MIN (budget, G_MAXSIZE);
+
+  if (budget != ide_memory_account_get_budget (self))
+    {
+      g_atomic_pointer_set (&self->budget, (gsize)budget);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_BUDGET]);
+
+      if (ide_memory_account_is_over_budget (self))
+        ide_memory_account_queue_flush (self);
+    }
+}
+
+gboolean
+ide_memory_account_is_over_budget (IdeMemoryAccount *self)
+{
+  guint64 budget;
+
+  g_return_val_if_fail (IDE_IS_MEMORY_ACCOUNT (self), FALSE);
+
+  budget = ide_memory_account_get_budget (self);
+
+  return budget > 0 && ide_memory_account_get_bytes (self) > budget;
+}
+
+/**
+ * ide_memory_account_charge:
+ * @self: a #IdeMemoryAccount
+ * @bytes: the number of bytes allocated
+ *
+ * Adds @bytes to the account. This function is thread-safe.
+ *
+ * Since: 46
+ */
+void
+ide_memory_account_charge (IdeMemoryAccount *self,
+                           gsize             bytes)
+{
+  g_return_if_fail (IDE_IS_MEMORY_ACCOUNT (self));
+
+  if (bytes == 0)
+    return;
+
+  g_atomic_pointer_add (&self->bytes, (gssize)bytes);
+  ide_memory_account_queue_flush (self);
+}
+
+/**
+ * ide_memory_account_discharge:
+ * @self: a #IdeMemoryAccount
+ * @bytes: the number of bytes released
+ *
+ * Removes @bytes from the account. This function is thread-safe.
+ *
+ * Since: 46
+ */
+void
+ide_memory_account_discharge (IdeMemoryAccount *self,
+                              gsize             bytes)
+{
+  g_return_if_fail (IDE_IS_MEMORY_ACCOUNT (self));
+
+  if (bytes == 0)
+    return;
+
+  g_atomic_pointer_add (&self->bytes, -(gssize)bytes);
+  ide_memory_account_queue_flush (self);
+}
@@ -0,0 +1,67 @@
+/* ide-memory-account.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#if !defined (IDE_CORE_INSIDE) && !defined (IDE_CORE_COMPILATION)
+# error "Only <libide-core.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+
+#include "ide-version-macros.h"
+
+G_BEGIN_DECLS
+
+#define IDE_TYPE_MEMORY_ACCOUNT (ide_memory_account_get_type())
+
+IDE_AVAILABLE_IN_46
+G_DECLARE_FINAL_TYPE (IdeMemoryAccount, ide_memory_account, IDE, MEMORY_ACCOUNT, GObject)
+
+IDE_AVAILABLE_IN_46
+IdeMemoryAccount *ide_memory_account_get            (const char       *name,
+                                                     const char       *title);
+IDE_AVAILABLE_IN_46
+GListModel       *ide_memory_account_list           (void);
+IDE_AVAILABLE_IN_46
+void              ide_memory_account_sample_all     (void);
+IDE_AVAILABLE_IN_46
+char             *ide_memory_account_report         (void);
+IDE_AVAILABLE_IN_46
+const char       *ide_memory_account_get_name       (IdeMemoryAccount *self);
+IDE_AVAILABLE_IN_46
+const char       *ide_memory_account_get_title      (IdeMemoryAccount *self);
+IDE_AVAILABLE_IN_46
+guint64           ide_memory_account_get_bytes      (IdeMemoryAccount *self);
+IDE_AVAILABLE_IN_46
+guint64           ide_memory_account_get_budget     (IdeMemoryAccount *self);
+IDE_AVAILABLE_IN_46
+void              ide_memory_account_set_budget     (IdeMemoryAccount *self,
+                                                     guint64           budget);
+IDE_AVAILABLE_IN_46
+gboolean          ide_memory_account_is_over_budget (IdeMemoryAccount *self);
+IDE_AVAILABLE_IN_46
+void              ide_memory_account_charge         (IdeMemoryAccount *self,
+                                                     gsize             bytes);
+IDE_AVAILABLE_IN_46
+void              ide_memory_account_discharge      (IdeMemoryAccount *self,
+                                                     gsize             bytes);
+
+G_END_DECLS
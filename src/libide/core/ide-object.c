@@ -24,6 +24,7 @@
 
 #include "ide-context.h"
 #include "ide-object.h"
+#include "ide-object-private.h"
 #include "ide-macros.h"
 #include "ide-marshal.h"
 
@@ -50,6 +51,19 @@
  * when used properly.
  */
 
+/* Mutations of the tree are serialized with the #GRecMutex of each object
+ * involved. Readers, which are far more common (such as looking up the
+ * #IdeContext from a worker thread), only take the short-lived bit-lock
+ * (@read_lock) which guards the @parent pointer and the @children queue.
+ * Writers take the bit-lock only for the few instructions it takes to
+ * publish their change.
+ *
+ * Iterating children works from a snapshot of the children copied while
+ * holding the bit-lock. That way callbacks are run without any lock held
+ * and cannot block writers (or other readers) from other threads.
+ */
+#define READ_LOCK_BIT 0
+
 typedef struct
 {
   GRecMutex     mutex;
@@ -57,6 +71,7 @@ typedef struct
   IdeObject    *parent;
   GQueue        children;
   GList         link;
+  gint          read_lock;
   guint         in_destruction : 1;
   guint         destroyed : 1;
 } IdeObjectPrivate;
@@ -92,6 +107,8 @@ static guint signals [N_SIGNALS];
 static GQueue finalizer_queue = G_QUEUE_INIT;
 static GMutex finalizer_mutex;
 static GSource *finalizer_source;
+static guint n_lock_contended;
+static guint n_read_lock_contended;
 
 static gboolean
 ide_object_finalizer_source_check (GSource *source)
@@ -121,7 +138,11 @@ static GSourceFuncs finalizer_source_funcs = {
 static inline void
 ide_object_private_lock (IdeObjectPrivate *priv)
 {
-  g_rec_mutex_lock (&priv->mutex);
+  if G_UNLIKELY (!g_rec_mutex_trylock (&priv->mutex))
+    {
+      g_atomic_int_inc (&n_lock_contended);
+      g_rec_mutex_lock (&priv->mutex);
+    }
 }
 
 static inline void
@@ -130,6 +151,64 @@ ide_object_private_unlock (IdeObjectPrivate *priv)
   g_rec_mutex_unlock (&priv->mutex);
 }
 
+static inline void
+ide_object_private_read_lock (IdeObjectPrivate *priv)
+{
+  if G_UNLIKELY (!g_bit_trylock (&priv->read_lock, READ_LOCK_BIT))
+    {
+      g_atomic_int_inc (&n_read_lock_contended);
+      g_bit_lock (&priv->read_lock, READ_LOCK_BIT);
+    }
+}
+
+static inline void
+ide_object_private_read_unlock (IdeObjectPrivate *priv)
+{
+  g_bit_unlock (&priv->read_lock, READ_LOCK_BIT);
+}
+
+/*
+ * Copies the children of @priv into a new array holding a full reference
+ * to each child so that they may be iterated without holding any lock.
+ */
+static GPtrArray *
+ide_object_private_snapshot (IdeObjectPrivate *priv)
+{
+  GPtrArray *ret;
+
+  ide_object_private_read_lock (priv);
+
+  ret = g_ptr_array_new_full (priv->children.length, g_object_unref);
+  for (const GList *iter = priv->children.head; iter; iter = iter->next)
+    g_ptr_array_add (ret, g_object_ref (iter->data));
+
+  ide_object_private_read_unlock (priv);
+
+  return ret;
+}
+
+/**
+ * _ide_object_get_lock_stats:
+ * @n_contended: (out): location for the number of contended object locks
+ * @n_read_contended: (out): location for the number of contended reads
+ *
+ * Gets the number of times, process-wide, that a thread had to wait for
+ * another thread while acquiring the lock of an #IdeObject, either for
+ * mutating the object tree or for reading it.
+ *
+ * This is meant for debugging lock contention within Builder.
+ */
+void
+_ide_object_get_lock_stats (guint *n_contended,
+                            guint *n_read_contended)
+{
+  if (n_contended != NULL)
+    *n_contended = g_atomic_int_get (&n_lock_contended);
+
+  if (n_read_contended != NULL)
+    *n_read_contended = g_atomic_int_get (&n_read_lock_contended);
+}
+
 static gboolean
 check_disposition (IdeObject        *child,
                    IdeObject        *parent,
@@ -187,6 +266,19 @@ ide_object_real_add (IdeObject         *self,
   if (!check_disposition (child, self, NULL))
     goto unlock;
 
+  if (location != IDE_OBJECT_START &&
+      location != IDE_OBJECT_END &&
+      location != IDE_OBJECT_BEFORE_SIBLING &&
+      location != IDE_OBJECT_AFTER_SIBLING)
+    {
+      g_critical ("Invalid location to add object child");
+      goto unlock;
+    }
+
+  g_object_ref (child);
+
+  ide_object_private_read_lock (priv);
+
   switch (location)
     {
     case IDE_OBJECT_START:
@@ -206,12 +298,14 @@ ide_object_real_add (IdeObject         *self,
       break;
 
     default:
-      g_critical ("Invalid location to add object child");
-      goto unlock;
+      g_assert_not_reached ();
     }
 
+  ide_object_private_read_unlock (priv);
+
+  ide_object_private_read_lock (child_priv);
   child_priv->parent = self;
-  g_object_ref (child);
+  ide_object_private_read_unlock (child_priv);
 
   if (IDE_OBJECT_GET_CLASS (child)->parent_set)
     IDE_OBJECT_GET_CLASS (child)->parent_set (child, self);
@@ -246,8 +340,13 @@ ide_object_real_remove (IdeObject *self,
       return;
     }
 
+  ide_object_private_read_lock (priv);
   g_queue_unlink (&priv->children, &child_priv->link);
+  ide_object_private_read_unlock (priv);
+
+  ide_object_private_read_lock (child_priv);
   child_priv->parent = NULL;
+  ide_object_private_read_unlock (child_priv);
 
   if (IDE_OBJECT_GET_CLASS (child)->parent_set)
     IDE_OBJECT_GET_CLASS (child)->parent_set (child, NULL);
@@ -576,9 +675,9 @@ ide_object_get_n_children (IdeObject *self)
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), 0);
 
-  ide_object_private_lock (priv);
+  ide_object_private_read_lock (priv);
   ret = priv->children.length;
-  ide_object_private_unlock (priv);
+  ide_object_private_read_unlock (priv);
 
   return ret;
 }
@@ -603,11 +702,11 @@ ide_object_get_nth_child (IdeObject *self,
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), 0);
 
-  ide_object_private_lock (priv);
+  ide_object_private_read_lock (priv);
   ret = g_list_nth_data (priv->children.head, nth);
   if (ret != NULL)
     g_object_ref (ret);
-  ide_object_private_unlock (priv);
+  ide_object_private_read_unlock (priv);
 
   g_return_val_if_fail (!ret || IDE_IS_OBJECT (ret), NULL);
 
@@ -626,20 +725,20 @@ guint
 ide_object_get_position (IdeObject *self)
 {
   IdeObjectPrivate *priv = ide_object_get_instance_private (self);
+  g_autoptr(IdeObject) parent = NULL;
   guint ret = 0;
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), 0);
 
-  ide_object_private_lock (priv);
-
-  if (priv->parent != NULL)
+  if ((parent = ide_object_ref_parent (self)))
     {
-      IdeObjectPrivate *parent_priv = ide_object_get_instance_private (priv->parent);
+      IdeObjectPrivate *parent_priv = ide_object_get_instance_private (parent);
+
+      ide_object_private_read_lock (parent_priv);
       ret = g_list_position (parent_priv->children.head, &priv->link);
+      ide_object_private_read_unlock (parent_priv);
     }
 
-  ide_object_private_unlock (priv);
-
   return ret;
 }
 
@@ -726,9 +825,9 @@ ide_object_get_parent (IdeObject *self)
   g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
   g_return_val_if_fail (IDE_IS_OBJECT (self), NULL);
 
-  ide_object_private_lock (priv);
+  ide_object_private_read_lock (priv);
   ret = priv->parent;
-  ide_object_private_unlock (priv);
+  ide_object_private_read_unlock (priv);
 
   return g_steal_pointer (&ret);
 }
@@ -749,9 +848,12 @@ ide_object_ref_parent (IdeObject *self)
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), NULL);
 
-  ide_object_private_lock (priv);
+  /* The parent cannot be finalized while it is still set as our parent
+   * because it must remove us (which requires our read lock) first.
+   */
+  ide_object_private_read_lock (priv);
   ret = priv->parent ? g_object_ref (priv->parent) : NULL;
-  ide_object_private_unlock (priv);
+  ide_object_private_read_unlock (priv);
 
   return g_steal_pointer (&ret);
 }
@@ -772,9 +874,9 @@ ide_object_is_root (IdeObject *self)
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), FALSE);
 
-  ide_object_private_lock (priv);
+  ide_object_private_read_lock (priv);
   ret = priv->parent == NULL;
-  ide_object_private_unlock (priv);
+  ide_object_private_read_unlock (priv);
 
   return ret;
 }
@@ -958,9 +1060,10 @@ unlock:
  *
  * Calls @callback for each child of @self.
  *
- * @callback is allowed to remove children from @self, but only as long as they are
- * the child passed to callback (or child itself). See g_queue_foreach() for more
- * details about what is allowed.
+ * The children are iterated from a snapshot taken when this function is
+ * called and @callback is executed without holding the lock for @self.
+ * Therefore @callback is allowed to add or remove children from @self,
+ * although such changes will not be reflected during the iteration.
  */
 void
 ide_object_foreach (IdeObject *self,
@@ -968,13 +1071,15 @@ ide_object_foreach (IdeObject *self,
                     gpointer   user_data)
 {
   IdeObjectPrivate *priv = ide_object_get_instance_private (self);
+  g_autoptr(GPtrArray) snapshot = NULL;
 
   g_return_if_fail (IDE_IS_OBJECT (self));
   g_return_if_fail (callback != NULL);
 
-  ide_object_private_lock (priv);
-  g_queue_foreach (&priv->children, callback, user_data);
-  ide_object_private_unlock (priv);
+  snapshot = ide_object_private_snapshot (priv);
+
+  for (guint i = 0; i < snapshot->len; i++)
+    callback (g_ptr_array_index (snapshot, i), user_data);
 }
 
 static void
@@ -1067,16 +1172,16 @@ IdeObject *
 ide_object_ref_root (IdeObject *self)
 {
   IdeObject *cur;
+  IdeObject *parent;
 
   g_return_val_if_fail (IDE_IS_OBJECT (self), NULL);
 
   cur = g_object_ref (self);
 
-  while (!ide_object_is_root (cur))
+  while ((parent = ide_object_ref_parent (cur)))
     {
-      IdeObject *tmp = cur;
-      cur = ide_object_ref_parent (tmp);
-      g_object_unref (tmp);
+      g_object_unref (cur);
+      cur = parent;
     }
 
   return g_steal_pointer (&cur);
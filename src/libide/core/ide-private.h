@@ -34,13 +34,32 @@ typedef struct
   void (*log)      (GLogLevelFlags  log_level,
                     const gchar    *domain,
                     const gchar    *message);
+  void (*mark)     (gint64          begin_time_usec,
+                    gint64          end_time_usec,
+                    const gchar    *group,
+                    const gchar    *name,
+                    const gchar    *message);
+  void (*counter)  (const gchar    *group,
+                    const gchar    *name,
+                    gint64          value);
 } IdeTraceVTable;
 
-void                 _ide_trace_init     (IdeTraceVTable *vtable);
-void                 _ide_trace_log      (GLogLevelFlags  log_level,
-                                          const gchar    *domain,
-                                          const gchar    *message);
-void                 _ide_trace_shutdown (void);
-const gchar * const *_ide_host_environ   (void);
+void                 _ide_trace_init              (IdeTraceVTable *vtable);
+void                 _ide_trace_log               (GLogLevelFlags  log_level,
+                                                   const gchar    *domain,
+                                                   const gchar    *message);
+void                 _ide_trace_mark              (gint64          begin_time_usec,
+                                                   gint64          end_time_usec,
+                                                   const gchar    *group,
+                                                   const gchar    *name,
+                                                   const gchar    *message);
+void                 _ide_trace_counter           (const gchar    *group,
+                                                   const gchar    *name,
+                                                   gint64          value);
+gboolean             _ide_trace_has_mark          (void);
+gboolean             _ide_trace_get_marks_enabled (void);
+void                 _ide_trace_set_marks_enabled (gboolean        enabled);
+void                 _ide_trace_shutdown          (void);
+const gchar * const *_ide_host_environ            (void);
 
 G_END_DECLS
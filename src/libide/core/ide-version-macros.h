@@ -43,6 +43,7 @@
 #define IDE_VERSION_43 (G_ENCODE_VERSION (43, 0))
 #define IDE_VERSION_44 (G_ENCODE_VERSION (44, 0))
 #define IDE_VERSION_45 (G_ENCODE_VERSION (45, 0))
+#define IDE_VERSION_46 (G_ENCODE_VERSION (46, 0))
 
 #if IDE_MAJOR_VERSION == IDE_VERSION_43
 # define IDE_VERSION_PREV_STABLE (IDE_VERSION_43)
@@ -132,3 +133,16 @@
 #else
 # define IDE_AVAILABLE_IN_45 _IDE_EXTERN
 #endif
+
+#if IDE_VERSION_MIN_REQUIRED >= IDE_VERSION_46
+# define IDE_DEPRECATED_IN_46 IDE_DEPRECATED
+# define IDE_DEPRECATED_IN_46_FOR(f) IDE_DEPRECATED_FOR(f)
+#else
+# define IDE_DEPRECATED_IN_46 _IDE_EXTERN
+# define IDE_DEPRECATED_IN_46_FOR(f) _IDE_EXTERN
+#endif
+#if IDE_VERSION_MAX_ALLOWED < IDE_VERSION_46
+# define IDE_AVAILABLE_IN_46 IDE_UNAVAILABLE(46, 0)
+#else
+# define IDE_AVAILABLE_IN_46 _IDE_EXTERN
+#endif
@@ -34,6 +34,7 @@
 #include "ide-log.h"
 #include "ide-log-item.h"
 #include "ide-macros.h"
+#include "ide-memory-account.h"
 #include "ide-notification.h"
 #include "ide-notifications.h"
 #include "ide-object.h"
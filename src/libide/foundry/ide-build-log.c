@@ -22,9 +22,12 @@
 
 #include "config.h"
 
+#include <glib/gi18n.h>
 #include <libide-core.h>
 #include <string.h>
 
+#include "ide-private.h"
+
 #include "ide-build-log.h"
 #include "ide-build-log-private.h"
 
@@ -54,15 +57,30 @@ typedef struct
 
 G_DEFINE_FINAL_TYPE (IdeBuildLog, ide_build_log, G_TYPE_OBJECT)
 
+static IdeMemoryAccount *
+get_memory_account (void)
+{
+  static IdeMemoryAccount *account;
+
+  if (g_once_init_enter (&account))
+    g_once_init_leave (&account, ide_memory_account_get ("build-log", _("Build Log Backlog")));
+
+  return account;
+}
+
 static gboolean
 emit_log_from_main (gpointer user_data)
 {
   IdeBuildLog *self = user_data;
   g_autoptr(GPtrArray) ar = g_ptr_array_new ();
   gpointer item;
+  gint64 begin_time = 0;
 
   g_assert (IDE_IS_BUILD_LOG (self));
 
+  if (_ide_trace_has_mark ())
+    begin_time = g_get_monotonic_time ();
+
   /*
    * Pull up to DISPATCH_MAX items from the log queue. We have an upper
    * bound here so that we don't stall the main loop. Additionally, we
@@ -101,9 +119,17 @@ emit_log_from_main (gpointer user_data)
           observer->callback (stream, message, message_len, observer->data);
         }
 
+      ide_memory_account_discharge (get_memory_account (), message_len + 1);
+
       g_free (message);
     }
 
+  if (begin_time != 0 && ar->len > 0)
+    {
+      g_autofree char *message = g_strdup_printf ("%u lines", ar->len);
+      _ide_trace_mark (begin_time, g_get_monotonic_time (), "build-log", "dispatch", message);
+    }
+
   return G_SOURCE_CONTINUE;
 }
 
@@ -111,6 +137,16 @@ static void
 ide_build_log_finalize (GObject *object)
 {
   IdeBuildLog *self = (IdeBuildLog *)object;
+  gpointer item;
+
+  /* Release anything that was never dispatched to observers */
+  while ((item = g_async_queue_try_pop (self->log_queue)))
+    {
+      char *message = POINTER_UNMARK (item);
+
+      ide_memory_account_discharge (get_memory_account (), strlen (message) + 1);
+      g_free (message);
+    }
 
   g_clear_pointer (&self->log_queue, g_async_queue_unref);
   g_clear_pointer (&self->log_source, g_source_destroy);
@@ -162,6 +198,8 @@ ide_build_log_via_main (IdeBuildLog       *self,
    * main loop).
    */
 
+  ide_memory_account_charge (get_memory_account (), message_len + 1);
+
   g_async_queue_lock (self->log_queue);
   g_async_queue_push_unlocked (self->log_queue, copied);
   g_source_set_ready_time (self->log_source, 0);
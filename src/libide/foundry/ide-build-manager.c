@@ -36,6 +36,7 @@
 
 #include "ide-build-manager.h"
 #include "ide-build-private.h"
+#include "ide-build-profile-private.h"
 #include "ide-build-target.h"
 #include "ide-build-target-provider.h"
 #include "ide-config-manager.h"
@@ -43,8 +44,11 @@
 #include "ide-device-info.h"
 #include "ide-device-manager.h"
 #include "ide-device.h"
+#include "ide-compile-commands.h"
 #include "ide-foundry-compat.h"
 #include "ide-pipeline.h"
+#include "ide-pipeline-private.h"
+#include "ide-run-context.h"
 #include "ide-runtime-manager.h"
 #include "ide-runtime-private.h"
 #include "ide-runtime.h"
@@ -75,6 +79,7 @@ struct _IdeBuildManager
   IdeObject         parent_instance;
 
   GCancellable     *cancellable;
+  GSettings        *settings;
 
   IdePipeline      *pipeline;
   GDateTime        *last_build_time;
@@ -95,6 +100,26 @@ struct _IdeBuildManager
 
   GTimer           *running_time;
 
+  /* Cached compile_commands.json for the single-file compile path,
+   * reloaded when the path or its modification time changes.
+   */
+  IdeCompileCommands *compile_commands;
+  char             *compile_commands_path;
+  guint64           compile_commands_mtime;
+
+  /* Cancels the single-file compile in flight, only one may run at a
+   * time as they all write to the pipeline PTY.
+   */
+  GCancellable     *compile_file_cancellable;
+
+  /* Modification time of .ninja_log when the last build was profiled */
+  guint64           profile_log_mtime;
+
+  /* GFile -> DiagnosticCounts, so that compiling a single file can
+   * replace what was previously counted for that file.
+   */
+  GHashTable       *diagnostics_by_file;
+
   guint             diagnostic_count;
   guint             error_count;
   guint             warning_count;
@@ -117,6 +142,13 @@ typedef struct
   IdePipelinePhase  phase;
 } BuildState;
 
+typedef struct
+{
+  guint diagnostic_count;
+  guint error_count;
+  guint warning_count;
+} DiagnosticCounts;
+
 static void initable_iface_init                           (GInitableIface  *iface);
 static void ide_build_manager_set_can_build               (IdeBuildManager *self,
                                                            gboolean         can_build);
@@ -136,6 +168,8 @@ static void ide_build_manager_action_invalidate           (IdeBuildManager *self
                                                            GVariant        *param);
 static void ide_build_manager_action_default_build_target (IdeBuildManager *self,
                                                            GVariant        *param);
+static void ide_build_manager_action_compile_file         (IdeBuildManager *self,
+                                                           GVariant        *param);
 
 IDE_DEFINE_ACTION_GROUP (IdeBuildManager, ide_build_manager, {
   { "build", ide_build_manager_action_build },
@@ -146,6 +180,7 @@ IDE_DEFINE_ACTION_GROUP (IdeBuildManager, ide_build_manager, {
   { "rebuild", ide_build_manager_action_rebuild },
   { "default-build-target", ide_build_manager_action_default_build_target, "s", "''" },
   { "invalidate", ide_build_manager_action_invalidate },
+  { "compile-file", ide_build_manager_action_compile_file, "s" },
 })
 
 G_DEFINE_TYPE_EXTENDED (IdeBuildManager, ide_build_manager, IDE_TYPE_OBJECT, G_TYPE_FLAG_FINAL,
@@ -171,6 +206,7 @@ enum {
   BUILD_STARTED,
   BUILD_FINISHED,
   BUILD_FAILED,
+  COMPILE_FILE_STARTED,
   N_SIGNALS
 };
 
@@ -216,6 +252,24 @@ ide_build_manager_action_default_build_target (IdeBuildManager *self,
                                         g_variant_new_string (str ? str : ""));
 }
 
+static void
+ide_build_manager_action_compile_file (IdeBuildManager *self,
+                                       GVariant        *param)
+{
+  g_autoptr(GFile) file = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+  g_assert (g_variant_is_of_type (param, G_VARIANT_TYPE_STRING));
+
+  file = g_file_new_for_uri (g_variant_get_string (param, NULL));
+
+  ide_build_manager_compile_file_async (self, file, NULL, NULL, NULL);
+
+  IDE_EXIT;
+}
+
 static void
 ide_build_manager_rediagnose (IdeBuildManager *self)
 {
@@ -299,6 +353,7 @@ ide_build_manager_reset_info (IdeBuildManager *self)
   self->diagnostic_count = 0;
   self->warning_count = 0;
   self->error_count = 0;
+  g_hash_table_remove_all (self->diagnostics_by_file);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_ERROR_COUNT]);
   g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_HAS_DIAGNOSTICS]);
@@ -313,6 +368,8 @@ ide_build_manager_handle_diagnostic (IdeBuildManager *self,
                                      IdePipeline     *pipeline)
 {
   IdeDiagnosticSeverity severity;
+  DiagnosticCounts *counts = NULL;
+  GFile *file;
 
   IDE_ENTRY;
 
@@ -320,6 +377,16 @@ ide_build_manager_handle_diagnostic (IdeBuildManager *self,
   g_assert (diagnostic != NULL);
   g_assert (IDE_IS_PIPELINE (pipeline));
 
+  if ((file = ide_diagnostic_get_file (diagnostic)) &&
+      !(counts = g_hash_table_lookup (self->diagnostics_by_file, file)))
+    {
+      counts = g_new0 (DiagnosticCounts, 1);
+      g_hash_table_insert (self->diagnostics_by_file, g_object_ref (file), counts);
+    }
+
+  if (counts != NULL)
+    counts->diagnostic_count++;
+
   self->diagnostic_count++;
   if (self->diagnostic_count == 1)
     g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_HAS_DIAGNOSTICS]);
@@ -328,11 +395,15 @@ ide_build_manager_handle_diagnostic (IdeBuildManager *self,
 
   if (severity == IDE_DIAGNOSTIC_WARNING)
     {
+      if (counts != NULL)
+        counts->warning_count++;
       self->warning_count++;
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_WARNING_COUNT]);
     }
   else if (severity == IDE_DIAGNOSTIC_ERROR || severity == IDE_DIAGNOSTIC_FATAL)
     {
+      if (counts != NULL)
+        counts->error_count++;
       self->error_count++;
       g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_ERROR_COUNT]);
     }
@@ -340,6 +411,35 @@ ide_build_manager_handle_diagnostic (IdeBuildManager *self,
   IDE_EXIT;
 }
 
+/*
+ * ide_build_manager_forget_diagnostics:
+ *
+ * Removes what was counted for diagnostics in @file, so that compiling
+ * @file again does not count them twice.
+ */
+static void
+ide_build_manager_forget_diagnostics (IdeBuildManager *self,
+                                      GFile           *file)
+{
+  DiagnosticCounts *counts;
+
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+  g_assert (G_IS_FILE (file));
+
+  if (!(counts = g_hash_table_lookup (self->diagnostics_by_file, file)))
+    return;
+
+  self->diagnostic_count -= counts->diagnostic_count;
+  self->warning_count -= counts->warning_count;
+  self->error_count -= counts->error_count;
+
+  g_hash_table_remove (self->diagnostics_by_file, file);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_ERROR_COUNT]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_HAS_DIAGNOSTICS]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_WARNING_COUNT]);
+}
+
 static void
 ide_build_manager_update_action_enabled (IdeBuildManager *self)
 {
@@ -413,6 +513,132 @@ ide_build_manager_pipeline_started (IdeBuildManager  *self,
   IDE_EXIT;
 }
 
+static void
+ide_build_manager_profile_cb (GObject      *object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  g_autoptr(IdeBuildManager) self = user_data;
+  g_autoptr(IdeBuildProfile) profile = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *report = NULL;
+  guint64 mtime = 0;
+
+  IDE_ENTRY;
+
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+
+  profile = _ide_build_profile_load_finish (result, &mtime, &error);
+
+  if (mtime != 0)
+    self->profile_log_mtime = mtime;
+
+  /* Not every build system leaves a .ninja_log behind */
+  if (profile == NULL)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        g_debug ("Failed to profile build: %s", error->message);
+      IDE_EXIT;
+    }
+
+  if (profile->n_steps == 0 || ide_object_in_destruction (IDE_OBJECT (self)))
+    IDE_EXIT;
+
+  report = _ide_build_profile_to_string (profile);
+  ide_object_message (self, "%s", report);
+
+  IDE_EXIT;
+}
+
+typedef struct
+{
+  IdeBuildManager *self;
+  char            *builddir;
+} Profile;
+
+static void
+profile_free (Profile *profile)
+{
+  g_clear_object (&profile->self);
+  g_clear_pointer (&profile->builddir, g_free);
+  g_slice_free (Profile, profile);
+}
+
+static void
+ide_build_manager_profile_head_commit_cb (GObject      *object,
+                                          GAsyncResult *result,
+                                          gpointer      user_data)
+{
+  IdeVcs *vcs = (IdeVcs *)object;
+  Profile *profile = user_data;
+  g_autoptr(IdeContext) context = NULL;
+  g_autofree char *history_path = NULL;
+  g_autofree char *commit_id = NULL;
+  IdeBuildManager *self;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_VCS (vcs));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (profile != NULL);
+  g_assert (IDE_IS_BUILD_MANAGER (profile->self));
+
+  self = profile->self;
+
+  /* Not every VCS knows about commits, the history is still useful */
+  commit_id = ide_vcs_get_head_commit_finish (vcs, result, NULL);
+
+  if (!ide_object_in_destruction (IDE_OBJECT (self)) &&
+      (context = ide_object_ref_context (IDE_OBJECT (self))))
+    {
+      history_path = ide_context_cache_filename (context, "build-profile", "history", NULL);
+
+      _ide_build_profile_load_async (profile->builddir,
+                                     history_path,
+                                     commit_id,
+                                     self->profile_log_mtime,
+                                     self->cancellable,
+                                     ide_build_manager_profile_cb,
+                                     g_object_ref (self));
+    }
+
+  profile_free (profile);
+
+  IDE_EXIT;
+}
+
+static void
+ide_build_manager_profile (IdeBuildManager *self,
+                           IdePipeline     *pipeline)
+{
+  g_autoptr(IdeContext) context = NULL;
+  Profile *profile;
+  const char *builddir;
+  IdeVcs *vcs;
+
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+  g_assert (IDE_IS_PIPELINE (pipeline));
+
+  if (!(builddir = ide_pipeline_get_builddir (pipeline)) ||
+      !(context = ide_object_ref_context (IDE_OBJECT (self))))
+    return;
+
+  vcs = ide_vcs_from_context (context);
+
+  profile = g_slice_new0 (Profile);
+  profile->self = g_object_ref (self);
+  profile->builddir = g_strdup (builddir);
+
+  /* The commit is recorded with the duration so that the history shows
+   * which change made the build slower.
+   */
+  ide_vcs_get_head_commit_async (vcs,
+                                 self->cancellable,
+                                 ide_build_manager_profile_head_commit_cb,
+                                 profile);
+}
+
 static void
 ide_build_manager_pipeline_finished (IdeBuildManager *self,
                                      gboolean         failed,
@@ -430,6 +656,9 @@ ide_build_manager_pipeline_finished (IdeBuildManager *self,
   else
     g_signal_emit (self, signals [BUILD_FINISHED], 0, pipeline);
 
+  if (!failed)
+    ide_build_manager_profile (self, pipeline);
+
   IDE_EXIT;
 }
 
@@ -691,6 +920,7 @@ ide_build_manager_invalidate_pipeline (IdeBuildManager *self)
   self->diagnostic_count = 0;
   self->error_count = 0;
   self->warning_count = 0;
+  g_hash_table_remove_all (self->diagnostics_by_file);
 
   /* Don't setup anything new if we're in shutdown or we haven't
    * been told we are allowed to start.
@@ -768,6 +998,40 @@ ide_build_manager_vcs_changed (IdeBuildManager *self,
     ide_build_manager_invalidate_pipeline (self);
 }
 
+static void
+ide_build_manager_buffer_saved_cb (IdeBuildManager  *self,
+                                   IdeBuffer        *buffer,
+                                   IdeBufferManager *buffer_manager)
+{
+  g_autofree char *name = NULL;
+  GFile *file;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+  g_assert (IDE_IS_BUFFER (buffer));
+  g_assert (IDE_IS_BUFFER_MANAGER (buffer_manager));
+
+  if (!g_settings_get_boolean (self->settings, "compile-on-save"))
+    IDE_EXIT;
+
+  /* Leave the file alone while a build is running, it will be
+   * compiled by the build anyway.
+   */
+  if (self->pipeline == NULL ||
+      !ide_pipeline_is_ready (self->pipeline) ||
+      ide_pipeline_get_busy (self->pipeline))
+    IDE_EXIT;
+
+  file = ide_buffer_get_file (buffer);
+  name = g_file_get_basename (file);
+
+  if (ide_path_is_c_like (name) || ide_path_is_cpp_like (name))
+    ide_build_manager_compile_file_async (self, file, NULL, NULL, NULL);
+
+  IDE_EXIT;
+}
+
 static gboolean
 initable_init (GInitable     *initable,
                GCancellable  *cancellable,
@@ -776,6 +1040,7 @@ initable_init (GInitable     *initable,
   IdeBuildManager *self = (IdeBuildManager *)initable;
   IdeConfigManager *config_manager;
   IdeDeviceManager *device_manager;
+  IdeBufferManager *buffer_manager;
   IdeContext *context;
   IdeVcs *vcs;
 
@@ -785,6 +1050,7 @@ initable_init (GInitable     *initable,
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
   context = ide_object_get_context (IDE_OBJECT (self));
+  buffer_manager = ide_buffer_manager_from_context (context);
   config_manager = ide_config_manager_from_context (context);
   device_manager = ide_device_manager_from_context (context);
   vcs = ide_vcs_from_context (context);
@@ -809,6 +1075,12 @@ initable_init (GInitable     *initable,
                            self,
                            G_CONNECT_SWAPPED);
 
+  g_signal_connect_object (buffer_manager,
+                           "buffer-saved",
+                           G_CALLBACK (ide_build_manager_buffer_saved_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   ide_build_manager_invalidate_pipeline (self);
 
   IDE_RETURN (TRUE);
@@ -883,10 +1155,15 @@ ide_build_manager_finalize (GObject *object)
   ide_clear_and_destroy_object (&self->pipeline);
   g_clear_object (&self->pipeline_signals);
   g_clear_object (&self->cancellable);
+  g_clear_object (&self->compile_file_cancellable);
+  g_clear_object (&self->settings);
   g_clear_pointer (&self->last_build_time, g_date_time_unref);
   g_clear_pointer (&self->running_time, g_timer_destroy);
   g_clear_pointer (&self->branch_name, g_free);
   g_clear_pointer (&self->default_build_target, g_free);
+  g_clear_pointer (&self->compile_commands_path, g_free);
+  g_clear_object (&self->compile_commands);
+  g_clear_pointer (&self->diagnostics_by_file, g_hash_table_unref);
   g_clear_handle_id (&self->timer_source, g_source_remove);
 
   G_OBJECT_CLASS (ide_build_manager_parent_class)->finalize (object);
@@ -1146,6 +1423,31 @@ ide_build_manager_class_init (IdeBuildManagerClass *klass)
   g_signal_set_va_marshaller (signals [BUILD_FINISHED],
                               G_TYPE_FROM_CLASS (klass),
                               ide_marshal_VOID__OBJECTv);
+
+  /**
+   * IdeBuildManager::compile-file-started:
+   * @self: An #IdeBuildManager
+   * @file: a #GFile
+   *
+   * The "compile-file-started" signal is emitted right before @file is
+   * compiled by ide_build_manager_compile_file_async().
+   *
+   * Diagnostics previously reported for @file are stale and should be
+   * discarded, the compile will report them again.
+   *
+   * Since: 46
+   */
+  signals [COMPILE_FILE_STARTED] =
+    g_signal_new ("compile-file-started",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  ide_marshal_VOID__OBJECT,
+                  G_TYPE_NONE, 1, G_TYPE_FILE);
+  g_signal_set_va_marshaller (signals [COMPILE_FILE_STARTED],
+                              G_TYPE_FROM_CLASS (klass),
+                              ide_marshal_VOID__OBJECTv);
 }
 
 static void
@@ -1234,7 +1536,12 @@ ide_build_manager_init (IdeBuildManager *self)
   ide_build_manager_update_action_enabled (self);
 
   self->cancellable = g_cancellable_new ();
+  self->settings = g_settings_new ("org.gnome.builder.build");
   self->needs_rediagnose = TRUE;
+  self->diagnostics_by_file = g_hash_table_new_full (g_file_hash,
+                                                     (GEqualFunc)g_file_equal,
+                                                     g_object_unref,
+                                                     g_free);
 
   self->pipeline_signals = g_signal_group_new (IDE_TYPE_PIPELINE);
 
@@ -1812,6 +2119,383 @@ ide_build_manager_clean_finish (IdeBuildManager  *self,
   IDE_RETURN (ret);
 }
 
+typedef struct
+{
+  IdePipeline *pipeline;
+  GFile       *file;
+  char        *path;
+  guint64      mtime;
+} CompileFile;
+
+static void
+compile_file_free (CompileFile *state)
+{
+  g_clear_object (&state->pipeline);
+  g_clear_object (&state->file);
+  g_clear_pointer (&state->path, g_free);
+  g_slice_free (CompileFile, state);
+}
+
+/* Turns the command from the compilation database into one that only
+ * checks the translation unit. We do not want to write object files or
+ * dependency files behind the back of the build system.
+ */
+static char **
+make_syntax_only_argv (const char * const *argv)
+{
+  static const char *drop_with_arg[] = { "-o", "-MF", "-MQ", "-MT" };
+  static const char *drop_joined[] = { "-MF", "-MQ", "-MT" };
+  static const char *drop[] = { "-c", "-MD", "-MMD" };
+  g_autoptr(GStrvBuilder) builder = g_strv_builder_new ();
+
+  for (guint i = 0; argv[i]; i++)
+    {
+      gboolean skip = FALSE;
+
+      for (guint j = 0; j < G_N_ELEMENTS (drop_with_arg); j++)
+        {
+          if (g_str_equal (argv[i], drop_with_arg[j]))
+            {
+              if (argv[i+1] != NULL)
+                i++;
+              skip = TRUE;
+              break;
+            }
+        }
+
+      /* -MFfoo.d, -MQfoo.o, -MTfoo.o */
+      for (guint j = 0; !skip && j < G_N_ELEMENTS (drop_joined); j++)
+        skip = g_str_has_prefix (argv[i], drop_joined[j]);
+
+      for (guint j = 0; !skip && j < G_N_ELEMENTS (drop); j++)
+        skip = g_str_equal (argv[i], drop[j]);
+
+      if (!skip)
+        g_strv_builder_add (builder, argv[i]);
+    }
+
+  g_strv_builder_add (builder, "-fsyntax-only");
+
+  return g_strv_builder_end (builder);
+}
+
+static void
+ide_build_manager_compile_file_wait_cb (GObject      *object,
+                                        GAsyncResult *result,
+                                        gpointer      user_data)
+{
+  IdeSubprocess *subprocess = (IdeSubprocess *)object;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_SUBPROCESS (subprocess));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  /* Diagnostics have already been extracted from the PTY by the pipeline */
+  if (!ide_subprocess_wait_check_finish (subprocess, result, &error))
+    ide_task_return_error (task, g_steal_pointer (&error));
+  else
+    ide_task_return_boolean (task, TRUE);
+
+  IDE_EXIT;
+}
+
+static void
+ide_build_manager_compile_file_run (IdeBuildManager *self,
+                                    IdeTask         *task)
+{
+  g_autoptr(IdeRunContext) run_context = NULL;
+  g_autoptr(IdeSubprocess) subprocess = NULL;
+  g_autoptr(GFile) directory = NULL;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) argv = NULL;
+  g_auto(GStrv) check_argv = NULL;
+  g_autofree char *name = NULL;
+  CompileFile *state;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_BUILD_MANAGER (self));
+  g_assert (IDE_IS_TASK (task));
+  g_assert (IDE_IS_COMPILE_COMMANDS (self->compile_commands));
+
+  state = ide_task_get_task_data (task);
+  name = g_file_get_basename (state->file);
+
+  /* The output goes to the pipeline PTY, so don't mix it up with the
+   * output of a build which started while we were loading.
+   */
+  if (ide_pipeline_get_busy (state->pipeline))
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_BUSY,
+                                 "Cannot compile file while the pipeline is busy");
+      IDE_EXIT;
+    }
+
+  if (!ide_path_is_c_like (name) && !ide_path_is_cpp_like (name))
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_NOT_SUPPORTED,
+                                 "Only C and C++ files may be compiled individually");
+      IDE_EXIT;
+    }
+
+  if (!(argv = ide_compile_commands_lookup_command (self->compile_commands,
+                                                    state->file,
+                                                    &directory,
+                                                    &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  check_argv = make_syntax_only_argv ((const char * const *)argv);
+
+  run_context = ide_run_context_new ();
+  ide_pipeline_prepare_run_context (state->pipeline, run_context);
+  ide_run_context_set_cwd (run_context, g_file_peek_path (directory));
+  ide_run_context_append_args (run_context, (const char * const *)check_argv);
+  _ide_pipeline_attach_pty_to_run_context (state->pipeline, run_context);
+
+  /* Replace, rather than add to, what the last build or compile of
+   * this file reported.
+   */
+  ide_build_manager_forget_diagnostics (self, state->file);
+  g_signal_emit (self, signals [COMPILE_FILE_STARTED], 0, state->file);
+
+  if (!(subprocess = ide_run_context_spawn (run_context, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  ide_subprocess_send_signal_upon_cancel (subprocess,
+                                          ide_task_get_cancellable (task),
+                                          SIGKILL);
+  ide_subprocess_wait_check_async (subprocess,
+                                   ide_task_get_cancellable (task),
+                                   ide_build_manager_compile_file_wait_cb,
+                                   g_object_ref (task));
+
+  IDE_EXIT;
+}
+
+static void
+ide_build_manager_compile_file_load_cb (GObject      *object,
+                                        GAsyncResult *result,
+                                        gpointer      user_data)
+{
+  IdeCompileCommands *compile_commands = (IdeCompileCommands *)object;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  IdeBuildManager *self;
+  CompileFile *state;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_COMPILE_COMMANDS (compile_commands));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
+  if (!ide_compile_commands_load_finish (compile_commands, result, &error))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  g_set_object (&self->compile_commands, compile_commands);
+  g_set_str (&self->compile_commands_path, state->path);
+  self->compile_commands_mtime = state->mtime;
+
+  ide_build_manager_compile_file_run (self, task);
+
+  IDE_EXIT;
+}
+
+static void
+ide_build_manager_compile_file_query_cb (GObject      *object,
+                                         GAsyncResult *result,
+                                         gpointer      user_data)
+{
+  GFile *file = (GFile *)object;
+  g_autoptr(IdeCompileCommands) compile_commands = NULL;
+  g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  IdeBuildManager *self;
+  CompileFile *state;
+
+  IDE_ENTRY;
+
+  g_assert (G_IS_FILE (file));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
+  if (!(info = g_file_query_info_finish (file, result, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  state->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+  if (self->compile_commands != NULL &&
+      self->compile_commands_mtime == state->mtime &&
+      ide_str_equal0 (self->compile_commands_path, state->path))
+    {
+      ide_build_manager_compile_file_run (self, task);
+      IDE_EXIT;
+    }
+
+  compile_commands = ide_compile_commands_new ();
+  ide_compile_commands_load_async (compile_commands,
+                                   file,
+                                   ide_task_get_cancellable (task),
+                                   ide_build_manager_compile_file_load_cb,
+                                   g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
+/**
+ * ide_build_manager_compile_file_async:
+ * @self: a #IdeBuildManager
+ * @file: a #GFile of a C or C++ source file
+ * @cancellable: (nullable): a #GCancellable or %NULL
+ * @callback: (nullable): a callback to execute upon completion, or %NULL
+ * @user_data: closure data for @callback
+ *
+ * Checks a single translation unit without running the build pipeline.
+ *
+ * The command for @file is taken from the compile_commands.json in the
+ * build directory and run within the build runtime with -fsyntax-only so
+ * that no build artifacts are modified. Diagnostics are extracted by the
+ * pipeline's error formats just as they would be for a full build.
+ *
+ * This is much faster than a build for large projects where the build
+ * tool must first check the entire dependency graph.
+ *
+ * As the output is written to the pipeline's PTY, this fails with
+ * %G_IO_ERROR_BUSY while the pipeline is busy, and a compile which is
+ * still in progress is cancelled when another is requested.
+ *
+ * Diagnostics previously counted for @file are replaced by those of this
+ * compile, see #IdeBuildManager::compile-file-started.
+ *
+ * Since: 46
+ */
+void
+ide_build_manager_compile_file_async (IdeBuildManager     *self,
+                                      GFile               *file,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+  g_autoptr(GFile) commands_file = NULL;
+  g_autoptr(GCancellable) compile_cancellable = NULL;
+  CompileFile *state;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (IDE_IS_BUILD_MANAGER (self));
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  /* Only one compile may write to the pipeline PTY at a time */
+  if (self->compile_file_cancellable != NULL)
+    g_cancellable_cancel (self->compile_file_cancellable);
+
+  compile_cancellable = g_cancellable_new ();
+  ide_cancellable_chain (compile_cancellable, cancellable);
+  ide_cancellable_chain (compile_cancellable, self->cancellable);
+  g_set_object (&self->compile_file_cancellable, compile_cancellable);
+  cancellable = compile_cancellable;
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, ide_build_manager_compile_file_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+
+  if (self->pipeline == NULL || !ide_pipeline_is_ready (self->pipeline))
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_PENDING,
+                                 "Cannot compile file, pipeline has not yet been prepared");
+      IDE_EXIT;
+    }
+
+  if (ide_pipeline_get_busy (self->pipeline))
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_BUSY,
+                                 "Cannot compile file while the pipeline is busy");
+      IDE_EXIT;
+    }
+
+  state = g_slice_new0 (CompileFile);
+  state->pipeline = g_object_ref (self->pipeline);
+  state->file = g_object_ref (file);
+  state->path = ide_pipeline_build_builddir_path (self->pipeline, "compile_commands.json", NULL);
+  ide_task_set_task_data (task, state, compile_file_free);
+
+  commands_file = g_file_new_for_path (state->path);
+
+  g_file_query_info_async (commands_file,
+                           G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_LOW,
+                           cancellable,
+                           ide_build_manager_compile_file_query_cb,
+                           g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
+/**
+ * ide_build_manager_compile_file_finish:
+ * @self: a #IdeBuildManager
+ * @result: a #GAsyncResult
+ * @error: a location for a #GError, or %NULL
+ *
+ * Completes an asynchronous request to ide_build_manager_compile_file_async().
+ *
+ * Returns: %TRUE if the file compiled without errors; otherwise %FALSE
+ *   and @error is set.
+ *
+ * Since: 46
+ */
+gboolean
+ide_build_manager_compile_file_finish (IdeBuildManager  *self,
+                                       GAsyncResult     *result,
+                                       GError          **error)
+{
+  gboolean ret;
+
+  IDE_ENTRY;
+
+  g_return_val_if_fail (IDE_IS_BUILD_MANAGER (self), FALSE);
+  g_return_val_if_fail (IDE_IS_TASK (result), FALSE);
+
+  ret = ide_task_propagate_boolean (IDE_TASK (result), error);
+
+  IDE_RETURN (ret);
+}
+
 static void
 ide_build_manager_rebuild_cb (GObject      *object,
                               GAsyncResult *result,
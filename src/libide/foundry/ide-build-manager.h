@@ -102,5 +102,15 @@ IDE_AVAILABLE_IN_ALL
 GListModel       *ide_build_manager_list_targets_finish (IdeBuildManager      *self,
                                                          GAsyncResult         *result,
                                                          GError              **error);
+IDE_AVAILABLE_IN_46
+void              ide_build_manager_compile_file_async  (IdeBuildManager      *self,
+                                                         GFile                *file,
+                                                         GCancellable         *cancellable,
+                                                         GAsyncReadyCallback   callback,
+                                                         gpointer              user_data);
+IDE_AVAILABLE_IN_46
+gboolean          ide_build_manager_compile_file_finish (IdeBuildManager      *self,
+                                                         GAsyncResult         *result,
+                                                         GError              **error);
 
 G_END_DECLS
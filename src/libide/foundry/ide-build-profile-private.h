@@ -0,0 +1,78 @@
+/* ide-build-profile-private.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _IdeBuildProfile IdeBuildProfile;
+
+typedef struct
+{
+  char   *name;
+  gint64  usec;
+  guint   count;
+} IdeBuildProfileItem;
+
+struct _IdeBuildProfile
+{
+  /* Wall-clock and accumulated time of the last ninja invocation */
+  gint64     wall_usec;
+  gint64     total_usec;
+  guint      n_steps;
+
+  /* Wall-clock time of the previous profiled build, or -1, along with
+   * the VCS commit each build was made from, if known.
+   */
+  gint64     previous_wall_usec;
+  char      *commit_id;
+  char      *previous_commit_id;
+
+  /* Longest part of the build which could not be parallelized, found
+   * by walking back from the last step to finish through steps which
+   * ended before it started.
+   */
+  gint64     critical_usec;
+
+  /* Arrays of IdeBuildProfileItem sorted by cost, longest first */
+  GPtrArray *critical_path;
+  GPtrArray *slowest_steps;
+  GPtrArray *slowest_targets;
+  GPtrArray *slowest_includes;
+};
+
+void             _ide_build_profile_load_async  (const char           *builddir,
+                                                 const char           *history_path,
+                                                 const char           *commit_id,
+                                                 guint64               last_mtime,
+                                                 GCancellable         *cancellable,
+                                                 GAsyncReadyCallback   callback,
+                                                 gpointer              user_data);
+IdeBuildProfile *_ide_build_profile_load_finish (GAsyncResult         *result,
+                                                 guint64              *mtime,
+                                                 GError              **error);
+char            *_ide_build_profile_to_string   (const IdeBuildProfile *self);
+void             _ide_build_profile_free        (IdeBuildProfile      *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (IdeBuildProfile, _ide_build_profile_free)
+
+G_END_DECLS
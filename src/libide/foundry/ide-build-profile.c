@@ -0,0 +1,700 @@
+/* ide-build-profile.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ide-build-profile"
+
+#include "config.h"
+
+#include <glib/gi18n.h>
+#include <json-glib/json-glib.h>
+#include <string.h>
+
+#include <libide-io.h>
+#include <libide-threading.h>
+
+#include "ide-build-profile-private.h"
+
+#define MAX_ITEMS       10
+#define MAX_HISTORY     100
+
+typedef struct
+{
+  char    *builddir;
+  char    *history_path;
+  char    *commit_id;
+  guint64  last_mtime;
+  guint64  mtime;
+} Load;
+
+typedef struct
+{
+  char   *output;
+  gint64  begin;
+  gint64  end;
+} Step;
+
+static void
+clear_step (gpointer data)
+{
+  Step *step = data;
+
+  g_clear_pointer (&step->output, g_free);
+}
+
+static void
+load_free (Load *load)
+{
+  g_clear_pointer (&load->builddir, g_free);
+  g_clear_pointer (&load->history_path, g_free);
+  g_clear_pointer (&load->commit_id, g_free);
+  g_slice_free (Load, load);
+}
+
+static void
+ide_build_profile_item_free (IdeBuildProfileItem *item)
+{
+  g_clear_pointer (&item->name, g_free);
+  g_slice_free (IdeBuildProfileItem, item);
+}
+
+static IdeBuildProfileItem *
+ide_build_profile_item_new (const char *name,
+                            gint64      usec,
+                            guint       count)
+{
+  IdeBuildProfileItem *item;
+
+  item = g_slice_new0 (IdeBuildProfileItem);
+  item->name = g_strdup (name);
+  item->usec = usec;
+  item->count = count;
+
+  return item;
+}
+
+void
+_ide_build_profile_free (IdeBuildProfile *self)
+{
+  g_clear_pointer (&self->critical_path, g_ptr_array_unref);
+  g_clear_pointer (&self->slowest_steps, g_ptr_array_unref);
+  g_clear_pointer (&self->slowest_targets, g_ptr_array_unref);
+  g_clear_pointer (&self->slowest_includes, g_ptr_array_unref);
+  g_clear_pointer (&self->commit_id, g_free);
+  g_clear_pointer (&self->previous_commit_id, g_free);
+  g_slice_free (IdeBuildProfile, self);
+}
+
+static int
+compare_item_by_cost (gconstpointer a,
+                      gconstpointer b)
+{
+  const IdeBuildProfileItem *item_a = *(const IdeBuildProfileItem * const *)a;
+  const IdeBuildProfileItem *item_b = *(const IdeBuildProfileItem * const *)b;
+
+  if (item_a->usec > item_b->usec)
+    return -1;
+  else if (item_a->usec < item_b->usec)
+    return 1;
+  else
+    return 0;
+}
+
+static int
+compare_step_by_end (gconstpointer a,
+                     gconstpointer b)
+{
+  const Step *step_a = a;
+  const Step *step_b = b;
+
+  if (step_a->end < step_b->end)
+    return -1;
+  else if (step_a->end > step_b->end)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+truncate_items (GPtrArray *items)
+{
+  g_ptr_array_sort (items, compare_item_by_cost);
+
+  if (items->len > MAX_ITEMS)
+    g_ptr_array_set_size (items, MAX_ITEMS);
+}
+
+static const char *
+get_string_member (JsonObject *object,
+                   const char *name)
+{
+  JsonNode *node;
+
+  if (object == NULL ||
+      !(node = json_object_get_member (object, name)) ||
+      !JSON_NODE_HOLDS_VALUE (node) ||
+      json_node_get_value_type (node) != G_TYPE_STRING)
+    return NULL;
+
+  return json_node_get_string (node);
+}
+
+/*
+ * Clang's -ftime-trace writes a trace next to each object file, replacing
+ * the ".o" suffix with ".json". Each "Source" event is the time spent in
+ * the frontend parsing an included file (including its own includes).
+ */
+static void
+ide_build_profile_add_time_trace (GHashTable *includes,
+                                  const char *path)
+{
+  g_autoptr(JsonParser) parser = NULL;
+  JsonObject *root_obj;
+  JsonArray *events;
+  JsonNode *root;
+  JsonNode *node;
+  guint n_events;
+
+  g_assert (includes != NULL);
+  g_assert (path != NULL);
+
+  parser = json_parser_new_immutable ();
+
+  if (!g_file_test (path, G_FILE_TEST_IS_REGULAR) ||
+      !json_parser_load_from_file (parser, path, NULL))
+    return;
+
+  if (!(root = json_parser_get_root (parser)) ||
+      !JSON_NODE_HOLDS_OBJECT (root) ||
+      !(root_obj = json_node_get_object (root)) ||
+      !(node = json_object_get_member (root_obj, "traceEvents")) ||
+      !JSON_NODE_HOLDS_ARRAY (node))
+    return;
+
+  events = json_node_get_array (node);
+  n_events = json_array_get_length (events);
+
+  for (guint i = 0; i < n_events; i++)
+    {
+      JsonNode *event_node = json_array_get_element (events, i);
+      IdeBuildProfileItem *item;
+      JsonObject *event;
+      JsonNode *args;
+      JsonNode *dur;
+      const char *detail;
+
+      if (!JSON_NODE_HOLDS_OBJECT (event_node) ||
+          !(event = json_node_get_object (event_node)) ||
+          !ide_str_equal0 ("Source", get_string_member (event, "name")) ||
+          !(args = json_object_get_member (event, "args")) ||
+          !JSON_NODE_HOLDS_OBJECT (args) ||
+          !(detail = get_string_member (json_node_get_object (args), "detail")) ||
+          !(dur = json_object_get_member (event, "dur")) ||
+          !JSON_NODE_HOLDS_VALUE (dur))
+        continue;
+
+      if (!(item = g_hash_table_lookup (includes, detail)))
+        {
+          item = ide_build_profile_item_new (detail, 0, 0);
+          g_hash_table_insert (includes, item->name, item);
+        }
+
+      item->usec += json_node_get_int (dur);
+      item->count++;
+    }
+}
+
+static char *
+time_trace_path (const char *builddir,
+                 const char *output)
+{
+  g_autofree char *base = NULL;
+  const char *dot;
+
+  if (!(dot = strrchr (output, '.')) ||
+      !(ide_str_equal0 (dot, ".o") || ide_str_equal0 (dot, ".obj")))
+    return NULL;
+
+  base = g_strndup (output, dot - output);
+
+  if (g_path_is_absolute (base))
+    return g_strconcat (base, ".json", NULL);
+  else
+    return g_strconcat (builddir, G_DIR_SEPARATOR_S, base, ".json", NULL);
+}
+
+/*
+ * Meson places the objects of a target in "<target>.p/" next to the
+ * target itself, and CMake in "CMakeFiles/<target>.dir/". Anything else
+ * is attributed to the directory it is generated in.
+ */
+static char *
+target_for_output (GHashTable *meson_targets,
+                   const char *output)
+{
+  const char *p;
+  const char *dir;
+
+  if ((p = strstr (output, ".p/")))
+    return g_strndup (output, p - output);
+
+  if (g_hash_table_contains (meson_targets, output))
+    return g_strdup (output);
+
+  if ((p = strstr (output, "CMakeFiles/")) &&
+      (dir = strstr (p, ".dir/")))
+    {
+      g_autofree char *prefix = g_strndup (output, p - output);
+      g_autofree char *name = g_strndup (p + strlen ("CMakeFiles/"),
+                                         dir - p - strlen ("CMakeFiles/"));
+
+      return g_strconcat (prefix, name, NULL);
+    }
+
+  return g_path_get_dirname (output);
+}
+
+static void
+ide_build_profile_add_targets (IdeBuildProfile *self,
+                               GArray          *steps)
+{
+  g_autoptr(GHashTable) meson_targets = NULL;
+  g_autoptr(GHashTable) targets = NULL;
+  GHashTableIter iter;
+  IdeBuildProfileItem *item;
+
+  g_assert (self != NULL);
+  g_assert (steps != NULL);
+
+  /* The link step of a meson target outputs the target itself, so
+   * collect the names first to group it with the objects.
+   */
+  meson_targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (guint i = 0; i < steps->len; i++)
+    {
+      const Step *step = &g_array_index (steps, Step, i);
+      const char *p;
+
+      if ((p = strstr (step->output, ".p/")))
+        g_hash_table_add (meson_targets, g_strndup (step->output, p - step->output));
+    }
+
+  targets = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                   (GDestroyNotify)ide_build_profile_item_free);
+
+  for (guint i = 0; i < steps->len; i++)
+    {
+      const Step *step = &g_array_index (steps, Step, i);
+      g_autofree char *target = target_for_output (meson_targets, step->output);
+
+      if (!(item = g_hash_table_lookup (targets, target)))
+        {
+          item = ide_build_profile_item_new (target, 0, 0);
+          g_hash_table_insert (targets, item->name, item);
+        }
+
+      item->usec += step->end - step->begin;
+      item->count++;
+    }
+
+  g_hash_table_iter_init (&iter, targets);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&item))
+    {
+      g_hash_table_iter_steal (&iter);
+      g_ptr_array_add (self->slowest_targets, item);
+    }
+}
+
+static void
+ide_build_profile_update_history (IdeBuildProfile *self,
+                                  const char      *history_path)
+{
+  g_autofree char *contents = NULL;
+  g_autoptr(GString) str = NULL;
+  g_autoptr(GPtrArray) lines = NULL;
+  g_autofree char *dir = NULL;
+  IdeLineReader reader;
+  gsize line_len;
+  gsize len;
+  char *line;
+
+  g_assert (self != NULL);
+  g_assert (history_path != NULL);
+
+  lines = g_ptr_array_new_with_free_func (g_free);
+
+  if (g_file_get_contents (history_path, &contents, &len, NULL))
+    {
+      ide_line_reader_init (&reader, contents, len);
+      while ((line = ide_line_reader_next (&reader, &line_len)))
+        {
+          if (line_len > 0)
+            g_ptr_array_add (lines, g_strndup (line, line_len));
+        }
+    }
+
+  /* Each line is "<unix time>\t<wall usec>\t<commit id>", the commit
+   * id being empty when the project is not in a VCS.
+   */
+  if (lines->len > 0)
+    {
+      const char *last = g_ptr_array_index (lines, lines->len - 1);
+      g_auto(GStrv) parts = g_strsplit (last, "\t", 3);
+
+      if (g_strv_length (parts) >= 2)
+        self->previous_wall_usec = g_ascii_strtoll (parts[1], NULL, 10);
+
+      if (g_strv_length (parts) >= 3 && parts[2][0] != 0)
+        self->previous_commit_id = g_strdup (parts[2]);
+    }
+
+  g_ptr_array_add (lines,
+                   g_strdup_printf ("%"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT"\t%s",
+                                    g_get_real_time () / G_USEC_PER_SEC,
+                                    self->wall_usec,
+                                    self->commit_id ? self->commit_id : ""));
+
+  str = g_string_new (NULL);
+  for (guint i = lines->len > MAX_HISTORY ? lines->len - MAX_HISTORY : 0; i < lines->len; i++)
+    g_string_append_printf (str, "%s\n", (const char *)g_ptr_array_index (lines, i));
+
+  dir = g_path_get_dirname (history_path);
+  g_mkdir_with_parents (dir, 0750);
+  g_file_set_contents (history_path, str->str, str->len, NULL);
+}
+
+static void
+ide_build_profile_load_worker (IdeTask      *task,
+                               gpointer      source_object,
+                               gpointer      task_data,
+                               GCancellable *cancellable)
+{
+  Load *load = task_data;
+  g_autoptr(IdeBuildProfile) self = NULL;
+  g_autoptr(GHashTable) includes = NULL;
+  g_autoptr(GMappedFile) mapped = NULL;
+  g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(GArray) steps = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autofree char *path = NULL;
+  IdeLineReader reader;
+  gint64 begin = G_MAXINT64;
+  gint64 end = 0;
+  gint64 last_end = 0;
+  gsize line_len;
+  char *line;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_TASK (task));
+  g_assert (load != NULL);
+  g_assert (load->builddir != NULL);
+
+  path = g_build_filename (load->builddir, ".ninja_log", NULL);
+  file = g_file_new_for_path (path);
+
+  if (!(info = g_file_query_info (file, G_FILE_ATTRIBUTE_TIME_MODIFIED, 0, cancellable, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  load->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+  if (load->mtime == load->last_mtime)
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_NOT_FOUND,
+                                 "No build has happened since the last profile");
+      IDE_EXIT;
+    }
+
+  if (!(mapped = g_mapped_file_new (path, FALSE, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  /* Lines are "<start msec>\t<end msec>\t<mtime>\t<output>\t<hash>" with
+   * times relative to when ninja started. Ninja appends to the log, so a
+   * step ending before the previous step means a new invocation began and
+   * only steps from the last invocation are kept.
+   */
+  steps = g_array_new (FALSE, FALSE, sizeof (Step));
+  g_array_set_clear_func (steps, clear_step);
+  ide_line_reader_init (&reader,
+                        g_mapped_file_get_contents (mapped),
+                        g_mapped_file_get_length (mapped));
+
+  while ((line = ide_line_reader_next (&reader, &line_len)))
+    {
+      g_auto(GStrv) parts = NULL;
+      g_autofree char *copy = NULL;
+      Step step;
+
+      if (line_len == 0 || line[0] == '#')
+        continue;
+
+      copy = g_strndup (line, line_len);
+      parts = g_strsplit (copy, "\t", 5);
+
+      if (g_strv_length (parts) < 4)
+        continue;
+
+      step.begin = g_ascii_strtoll (parts[0], NULL, 10) * 1000;
+      step.end = g_ascii_strtoll (parts[1], NULL, 10) * 1000;
+
+      if (step.end < last_end)
+        g_array_set_size (steps, 0);
+      last_end = step.end;
+
+      step.output = g_strdup (parts[3]);
+      g_array_append_val (steps, step);
+    }
+
+  self = g_slice_new0 (IdeBuildProfile);
+  self->previous_wall_usec = -1;
+  self->commit_id = g_strdup (load->commit_id);
+  self->critical_path = g_ptr_array_new_with_free_func ((GDestroyNotify)ide_build_profile_item_free);
+  self->slowest_steps = g_ptr_array_new_with_free_func ((GDestroyNotify)ide_build_profile_item_free);
+  self->slowest_targets = g_ptr_array_new_with_free_func ((GDestroyNotify)ide_build_profile_item_free);
+  self->slowest_includes = g_ptr_array_new_with_free_func ((GDestroyNotify)ide_build_profile_item_free);
+  self->n_steps = steps->len;
+
+  includes = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                    (GDestroyNotify)ide_build_profile_item_free);
+
+  for (guint i = 0; i < steps->len; i++)
+    {
+      const Step *step = &g_array_index (steps, Step, i);
+      g_autofree char *trace = NULL;
+
+      begin = MIN (begin, step->begin);
+      end = MAX (end, step->end);
+      self->total_usec += step->end - step->begin;
+
+      g_ptr_array_add (self->slowest_steps,
+                       ide_build_profile_item_new (step->output, step->end - step->begin, 1));
+
+      if ((trace = time_trace_path (load->builddir, step->output)))
+        ide_build_profile_add_time_trace (includes, trace);
+    }
+
+  if (steps->len > 0)
+    self->wall_usec = end - begin;
+
+  ide_build_profile_add_targets (self, steps);
+
+  /* Walk back from the last step to complete, each time choosing the
+   * step which completed most recently before the current one started.
+   * Without the dependency graph that is the step it most likely waited
+   * on, giving an approximation of the critical path.
+   */
+  g_array_sort (steps, compare_step_by_end);
+
+  for (guint i = steps->len; i > 0;)
+    {
+      const Step *step = &g_array_index (steps, Step, i - 1);
+      guint lo = 0;
+      guint hi = i - 1;
+
+      g_ptr_array_add (self->critical_path,
+                       ide_build_profile_item_new (step->output, step->end - step->begin, 1));
+      self->critical_usec += step->end - step->begin;
+
+      while (lo < hi)
+        {
+          guint mid = (lo + hi) / 2;
+
+          if (g_array_index (steps, Step, mid).end <= step->begin)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      i = lo;
+    }
+
+  if (includes != NULL)
+    {
+      GHashTableIter iter;
+      IdeBuildProfileItem *item;
+
+      g_hash_table_iter_init (&iter, includes);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&item))
+        {
+          g_hash_table_iter_steal (&iter);
+          g_ptr_array_add (self->slowest_includes, item);
+        }
+    }
+
+  truncate_items (self->critical_path);
+  truncate_items (self->slowest_steps);
+  truncate_items (self->slowest_targets);
+  truncate_items (self->slowest_includes);
+
+  if (load->history_path != NULL && self->n_steps > 0)
+    ide_build_profile_update_history (self, load->history_path);
+
+  ide_task_return_pointer (task, g_steal_pointer (&self), _ide_build_profile_free);
+
+  IDE_EXIT;
+}
+
+/**
+ * _ide_build_profile_load_async:
+ * @builddir: the build directory containing .ninja_log
+ * @history_path: (nullable): a file to record build durations in
+ * @commit_id: (nullable): the VCS commit being built, recorded in the history
+ * @last_mtime: modification time of .ninja_log at the last profile, or 0
+ *
+ * Profiles the last ninja invocation in @builddir using the durations
+ * recorded in .ninja_log along with any clang -ftime-trace output found
+ * next to the object files that were built. Steps are also grouped by
+ * the target they belong to.
+ *
+ * If .ninja_log has not changed since @last_mtime, the operation fails
+ * with %G_IO_ERROR_NOT_FOUND.
+ */
+void
+_ide_build_profile_load_async (const char          *builddir,
+                               const char          *history_path,
+                               const char          *commit_id,
+                               guint64              last_mtime,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+  Load *load;
+
+  g_return_if_fail (builddir != NULL);
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  load = g_slice_new0 (Load);
+  load->builddir = g_strdup (builddir);
+  load->history_path = g_strdup (history_path);
+  load->commit_id = g_strdup (commit_id);
+  load->last_mtime = last_mtime;
+
+  task = ide_task_new (NULL, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, _ide_build_profile_load_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+  ide_task_set_task_data (task, load, load_free);
+  ide_task_run_in_thread (task, ide_build_profile_load_worker);
+}
+
+IdeBuildProfile *
+_ide_build_profile_load_finish (GAsyncResult  *result,
+                                guint64       *mtime,
+                                GError       **error)
+{
+  Load *load;
+
+  g_return_val_if_fail (IDE_IS_TASK (result), NULL);
+
+  load = ide_task_get_task_data (IDE_TASK (result));
+
+  if (mtime != NULL)
+    *mtime = load->mtime;
+
+  return ide_task_propagate_pointer (IDE_TASK (result), error);
+}
+
+static void
+append_items (GString    *str,
+              const char *title,
+              GPtrArray  *items,
+              gboolean    count_steps)
+{
+  if (items->len == 0)
+    return;
+
+  g_string_append_printf (str, "\n%s\n", title);
+
+  for (guint i = 0; i < items->len; i++)
+    {
+      const IdeBuildProfileItem *item = g_ptr_array_index (items, i);
+
+      g_string_append_printf (str, "  %8.2lf s  %s",
+                              item->usec / (double)G_USEC_PER_SEC,
+                              item->name);
+
+      if (item->count > 1)
+        {
+          g_string_append_c (str, ' ');
+
+          if (count_steps)
+            /* translators: %u is replaced with the number of build steps of a target */
+            g_string_append_printf (str, ngettext ("(%u step)", "(%u steps)", item->count), item->count);
+          else
+            /* translators: %u is replaced with the number of times an include was parsed */
+            g_string_append_printf (str, ngettext ("(%u time)", "(%u times)", item->count), item->count);
+        }
+
+      g_string_append_c (str, '\n');
+    }
+}
+
+char *
+_ide_build_profile_to_string (const IdeBuildProfile *self)
+{
+  g_autoptr(GString) str = NULL;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  str = g_string_new (NULL);
+
+  g_string_append_printf (str,
+                          /* translators: the values are the duration of the build, the number of steps,
+                           * the total duration of all steps, and the duration of the critical path */
+                          _("Build took %.2lf seconds for %u steps (%.2lf seconds of work, critical path %.2lf seconds)"),
+                          self->wall_usec / (double)G_USEC_PER_SEC,
+                          self->n_steps,
+                          self->total_usec / (double)G_USEC_PER_SEC,
+                          self->critical_usec / (double)G_USEC_PER_SEC);
+
+  if (self->previous_wall_usec >= 0)
+    /* translators: %+.2lf is replaced with the difference in seconds, such as +1.50 */
+    g_string_append_printf (str, _(", %+.2lf seconds compared to the previous build"),
+                            (self->wall_usec - self->previous_wall_usec) / (double)G_USEC_PER_SEC);
+
+  /* Show the commits being compared when they differ, so that a
+   * regression can be attributed to the changes between them.
+   */
+  if (self->previous_wall_usec >= 0 &&
+      self->commit_id != NULL &&
+      self->previous_commit_id != NULL &&
+      !ide_str_equal0 (self->commit_id, self->previous_commit_id))
+    /* translators: the values are abbreviated commit identifiers of the previous and current build */
+    g_string_append_printf (str, _(" (%.12s → %.12s)"),
+                            self->previous_commit_id,
+                            self->commit_id);
+
+  g_string_append_c (str, '\n');
+
+  append_items (str, _("Slowest steps on the critical path:"), self->critical_path, FALSE);
+  append_items (str, _("Slowest targets:"), self->slowest_targets, TRUE);
+  append_items (str, _("Slowest steps:"), self->slowest_steps, FALSE);
+  append_items (str, _("Most expensive includes:"), self->slowest_includes, FALSE);
+
+  return g_string_free (g_steal_pointer (&str), FALSE);
+}
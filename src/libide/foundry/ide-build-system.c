@@ -34,6 +34,7 @@
 #include "ide-build-manager.h"
 #include "ide-pipeline.h"
 #include "ide-build-system.h"
+#include "ide-compile-commands-private.h"
 #include "ide-config.h"
 #include "ide-device.h"
 #include "ide-foundry-compat.h"
@@ -529,13 +530,39 @@ ide_build_system_get_build_flags_for_files_finish (IdeBuildSystem  *self,
 
   if (ret != NULL)
     {
+      g_autoptr(GHashTable) processed = NULL;
       GHashTableIter iter;
       gchar **flags;
 
+      /* Most files in a directory share the same flags, so only translate
+       * each distinct set of flags once and copy the result for the rest.
+       */
+      processed = g_hash_table_new_full (_ide_compile_commands_flags_hash,
+                                         _ide_compile_commands_flags_equal,
+                                         (GDestroyNotify)g_strfreev,
+                                         NULL);
+
       g_hash_table_iter_init (&iter, ret);
 
       while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&flags))
-        ide_build_system_post_process_build_flags (self, flags);
+        {
+          gchar **translated;
+
+          if (flags == NULL)
+            continue;
+
+          if ((translated = g_hash_table_lookup (processed, flags)))
+            {
+              g_hash_table_iter_replace (&iter, g_strdupv (translated));
+            }
+          else
+            {
+              gchar **original = g_strdupv (flags);
+
+              ide_build_system_post_process_build_flags (self, flags);
+              g_hash_table_insert (processed, original, flags);
+            }
+        }
     }
 
   IDE_RETURN (ret);
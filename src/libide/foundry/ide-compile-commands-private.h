@@ -0,0 +1,34 @@
+/* ide-compile-commands-private.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+void     _ide_compile_commands_filter_c    (GFile                *directory,
+                                            const gchar * const  *system_includes,
+                                            gchar              ***argv);
+guint    _ide_compile_commands_flags_hash  (gconstpointer         data);
+gboolean _ide_compile_commands_flags_equal (gconstpointer         a,
+                                            gconstpointer         b);
+
+G_END_DECLS
@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "ide-compile-commands.h"
+#include "ide-compile-commands-private.h"
 
 /**
  * SECTION:ide-compile-commands
@@ -68,6 +69,19 @@ struct _IdeCompileCommands
    */
   GPtrArray *vala_info;
 
+  /*
+   * Filtered flags are cached on each CompileInfo and interned here so
+   * that files sharing the same flags (most files of a directory) share
+   * a single vector. The cache is dropped if the system includes used
+   * to filter change. Since lookups may happen from worker threads, the
+   * cache is protected by flags_mutex.
+   */
+  GMutex      flags_mutex;
+  GHashTable *interned_flags;
+  gchar     **flags_system_includes;
+  guint       n_hits;
+  guint       n_misses;
+
   /*
    * The has_loaded field determines if we've had a load (async or sync
    * variant) operation called. We can only do this safely once because
@@ -77,11 +91,21 @@ struct _IdeCompileCommands
   guint has_loaded : 1;
 };
 
+typedef enum
+{
+  FLAGS_RAW,
+  FLAGS_C,
+  FLAGS_VALA,
+  N_FLAGS_KIND
+} FlagsKind;
+
 typedef struct
 {
   GFile *directory;
   GFile *file;
   gchar *command;
+  /* Borrowed from interned_flags, protected by flags_mutex */
+  gchar **flags[N_FLAGS_KIND];
 } CompileInfo;
 
 G_DEFINE_FINAL_TYPE (IdeCompileCommands, ide_compile_commands, G_TYPE_OBJECT)
@@ -107,6 +131,10 @@ ide_compile_commands_finalize (GObject *object)
 
   g_clear_pointer (&self->info_by_file, g_hash_table_unref);
   g_clear_pointer (&self->vala_info, g_ptr_array_unref);
+  g_clear_pointer (&self->interned_flags, g_hash_table_unref);
+  g_clear_pointer (&self->flags_system_includes, g_strfreev);
+
+  g_mutex_clear (&self->flags_mutex);
 
   G_OBJECT_CLASS (ide_compile_commands_parent_class)->finalize (object);
 }
@@ -119,9 +147,40 @@ ide_compile_commands_class_init (IdeCompileCommandsClass *klass)
   object_class->finalize = ide_compile_commands_finalize;
 }
 
+/**
+ * _ide_compile_commands_flags_hash:
+ * @data: a %NULL-terminated array of compiler flags
+ *
+ * Hashes a set of compiler flags so they can be used as #GHashTable keys
+ * along with _ide_compile_commands_flags_equal().
+ */
+guint
+_ide_compile_commands_flags_hash (gconstpointer data)
+{
+  const gchar * const *flags = data;
+  guint hash = 5381;
+
+  for (guint i = 0; flags[i]; i++)
+    hash = (hash << 5) + hash + g_str_hash (flags[i]);
+
+  return hash;
+}
+
+gboolean
+_ide_compile_commands_flags_equal (gconstpointer a,
+                                   gconstpointer b)
+{
+  return g_strv_equal ((const gchar * const *)a, (const gchar * const *)b);
+}
+
 static void
 ide_compile_commands_init (IdeCompileCommands *self)
 {
+  g_mutex_init (&self->flags_mutex);
+  self->interned_flags = g_hash_table_new_full (_ide_compile_commands_flags_hash,
+                                                _ide_compile_commands_flags_equal,
+                                                (GDestroyNotify)g_strfreev,
+                                                NULL);
 }
 
 /**
@@ -427,14 +486,12 @@ suffix_is_vala (const gchar *suffix)
 }
 
 static gchar *
-ide_compile_commands_resolve (IdeCompileCommands *self,
-                              const CompileInfo  *info,
-                              const gchar        *path)
+resolve_in_directory (GFile       *directory,
+                      const gchar *path)
 {
   g_autoptr(GFile) file = NULL;
 
-  g_assert (IDE_IS_COMPILE_COMMANDS (self));
-  g_assert (info != NULL);
+  g_assert (G_IS_FILE (directory));
 
   if (path == NULL)
     return NULL;
@@ -442,23 +499,44 @@ ide_compile_commands_resolve (IdeCompileCommands *self,
   if (g_path_is_absolute (path))
     return g_strdup (path);
 
-  file = g_file_resolve_relative_path (info->directory, path);
+  file = g_file_resolve_relative_path (directory, path);
   if (file != NULL)
     return g_file_get_path (file);
 
   return NULL;
 }
 
-static void
-ide_compile_commands_filter_c (IdeCompileCommands   *self,
-                               const CompileInfo    *info,
-                               const gchar * const  *system_includes,
-                               gchar              ***argv)
+static gchar *
+ide_compile_commands_resolve (IdeCompileCommands *self,
+                              const CompileInfo  *info,
+                              const gchar        *path)
 {
-  g_autoptr(GPtrArray) ar = NULL;
-
   g_assert (IDE_IS_COMPILE_COMMANDS (self));
   g_assert (info != NULL);
+
+  return resolve_in_directory (info->directory, path);
+}
+
+/*
+ * _ide_compile_commands_filter_c:
+ * @directory: the directory the command is run from
+ * @system_includes: (nullable): include directories to prepend
+ * @argv: (inout): the compiler command line
+ *
+ * Replaces @argv with the subset of flags which are useful to tooling
+ * such as clang, resolving relative include paths against @directory.
+ *
+ * This is shared with build systems which provide compiler flags
+ * without a compile_commands.json so that they keep the same flags.
+ */
+void
+_ide_compile_commands_filter_c (GFile                *directory,
+                                const gchar * const  *system_includes,
+                                gchar              ***argv)
+{
+  g_autoptr(GPtrArray) ar = NULL;
+
+  g_assert (G_IS_FILE (directory));
   g_assert (argv != NULL);
 
   if (*argv == NULL)
@@ -486,7 +564,7 @@ ide_compile_commands_filter_c (IdeCompileCommands   *self,
         case 'I': /* -I/usr/include, -I /usr/include */
           if (param[2] != '\0')
             next = &param[2];
-          resolved = ide_compile_commands_resolve (self, info, next);
+          resolved = resolve_in_directory (directory, next);
           if (resolved != NULL)
             g_ptr_array_add (ar, g_strdup_printf ("-I%s", resolved));
           break;
@@ -521,7 +599,7 @@ ide_compile_commands_filter_c (IdeCompileCommands   *self,
                     ide_str_equal0 (param, "-isystem")))
             {
               g_ptr_array_add (ar, g_strdup (param));
-              g_ptr_array_add (ar, ide_compile_commands_resolve (self, info, next));
+              g_ptr_array_add (ar, resolve_in_directory (directory, next));
             }
           break;
         }
@@ -533,6 +611,18 @@ ide_compile_commands_filter_c (IdeCompileCommands   *self,
   *argv = (gchar **)g_ptr_array_free (g_steal_pointer (&ar), FALSE);
 }
 
+static void
+ide_compile_commands_filter_c (IdeCompileCommands   *self,
+                               const CompileInfo    *info,
+                               const gchar * const  *system_includes,
+                               gchar              ***argv)
+{
+  g_assert (IDE_IS_COMPILE_COMMANDS (self));
+  g_assert (info != NULL);
+
+  _ide_compile_commands_filter_c (info->directory, system_includes, argv);
+}
+
 static void
 ide_compile_commands_filter_vala (IdeCompileCommands   *self,
                                   const CompileInfo    *info,
@@ -651,6 +741,145 @@ find_with_alternates (IdeCompileCommands *self,
   return NULL;
 }
 
+static gboolean
+system_includes_equal (const gchar * const *a,
+                       const gchar * const *b)
+{
+  if (a == NULL || b == NULL)
+    return (a == NULL || a[0] == NULL) && (b == NULL || b[0] == NULL);
+
+  return g_strv_equal (a, b);
+}
+
+static void
+clear_cached_flags (gpointer data,
+                    gpointer user_data)
+{
+  CompileInfo *info = data;
+
+  for (guint i = 0; i < N_FLAGS_KIND; i++)
+    info->flags[i] = NULL;
+}
+
+static void
+clear_cached_flags_foreach (gpointer key,
+                            gpointer value,
+                            gpointer user_data)
+{
+  clear_cached_flags (value, user_data);
+}
+
+/*
+ * Returns a copy of the filtered flags for @info, parsing and filtering
+ * the command only the first time. Identical results are interned so
+ * they are stored only once.
+ */
+static gchar **
+ide_compile_commands_get_flags (IdeCompileCommands   *self,
+                                CompileInfo          *info,
+                                FlagsKind             kind,
+                                const gchar * const  *system_includes,
+                                GError              **error)
+{
+  G_GNUC_UNUSED g_autoptr(GMutexLocker) locker = NULL;
+  g_auto(GStrv) argv = NULL;
+  gchar **interned = NULL;
+  gint argc = 0;
+
+  g_assert (IDE_IS_COMPILE_COMMANDS (self));
+  g_assert (info != NULL);
+  g_assert (kind < N_FLAGS_KIND);
+
+  locker = g_mutex_locker_new (&self->flags_mutex);
+
+  if (!system_includes_equal ((const gchar * const *)self->flags_system_includes, system_includes))
+    {
+      if (self->info_by_file != NULL)
+        g_hash_table_foreach (self->info_by_file, clear_cached_flags_foreach, NULL);
+      if (self->vala_info != NULL)
+        g_ptr_array_foreach (self->vala_info, clear_cached_flags, NULL);
+      g_hash_table_remove_all (self->interned_flags);
+      g_strfreev (self->flags_system_includes);
+      self->flags_system_includes = g_strdupv ((gchar **)system_includes);
+    }
+
+  if (info->flags[kind] != NULL)
+    {
+      self->n_hits++;
+      return g_strdupv (info->flags[kind]);
+    }
+
+  self->n_misses++;
+
+  if (!g_shell_parse_argv (info->command, &argc, &argv, error))
+    return NULL;
+
+  if (kind == FLAGS_C)
+    ide_compile_commands_filter_c (self, info, system_includes, &argv);
+  else if (kind == FLAGS_VALA)
+    ide_compile_commands_filter_vala (self, info, &argv);
+
+  if (!g_hash_table_lookup_extended (self->interned_flags, argv, (gpointer *)&interned, NULL))
+    {
+      interned = g_steal_pointer (&argv);
+      g_hash_table_add (self->interned_flags, interned);
+    }
+
+  info->flags[kind] = interned;
+
+  return g_strdupv (interned);
+}
+
+/**
+ * ide_compile_commands_lookup_command:
+ * @self: An #IdeCompileCommands
+ * @file: a #GFile representing the file to lookup
+ * @directory: (out) (optional) (transfer full): A location for a #GFile, or %NULL
+ * @error: A location for a #GError, or %NULL
+ *
+ * Locates the complete, unfiltered command used to compile @file.
+ *
+ * Unlike ide_compile_commands_lookup(), the result contains the compiler
+ * and every argument from the compilation database, suitable to run the
+ * compilation again.
+ *
+ * Returns: (nullable) (transfer full): A string array or %NULL if
+ *   there was a failure to locate or parse the command.
+ *
+ * Since: 46
+ */
+gchar **
+ide_compile_commands_lookup_command (IdeCompileCommands  *self,
+                                     GFile               *file,
+                                     GFile              **directory,
+                                     GError             **error)
+{
+  const CompileInfo *info;
+  g_auto(GStrv) argv = NULL;
+  gint argc = 0;
+
+  g_return_val_if_fail (IDE_IS_COMPILE_COMMANDS (self), NULL);
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  if (self->info_by_file == NULL ||
+      !(info = g_hash_table_lookup (self->info_by_file, file)))
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NOT_FOUND,
+                           "Failed to locate command for requested file");
+      return NULL;
+    }
+
+  if (!g_shell_parse_argv (info->command, &argc, &argv, error))
+    return NULL;
+
+  if (directory != NULL)
+    *directory = g_file_dup (info->directory);
+
+  return g_steal_pointer (&argv);
+}
+
 /**
  * ide_compile_commands_lookup:
  * @self: An #IdeCompileCommands
@@ -675,7 +904,7 @@ ide_compile_commands_lookup (IdeCompileCommands   *self,
                              GError              **error)
 {
   g_autofree gchar *base = NULL;
-  const CompileInfo *info;
+  CompileInfo *info;
   const gchar *dot;
 
   g_return_val_if_fail (IDE_IS_COMPILE_COMMANDS (self), NULL);
@@ -684,18 +913,18 @@ ide_compile_commands_lookup (IdeCompileCommands   *self,
   base = g_file_get_basename (file);
   dot = strrchr (base, '.');
 
-  if (NULL != (info = find_with_alternates (self, file)))
+  if (NULL != (info = (CompileInfo *)find_with_alternates (self, file)))
     {
       g_auto(GStrv) argv = NULL;
-      gint argc = 0;
-
-      if (!g_shell_parse_argv (info->command, &argc, &argv, error))
-        return NULL;
+      FlagsKind kind = FLAGS_RAW;
 
       if (ide_path_is_c_like (dot) || ide_path_is_cpp_like (dot))
-        ide_compile_commands_filter_c (self, info, system_includes, &argv);
+        kind = FLAGS_C;
       else if (suffix_is_vala (dot))
-        ide_compile_commands_filter_vala (self, info, &argv);
+        kind = FLAGS_VALA;
+
+      if (!(argv = ide_compile_commands_get_flags (self, info, kind, system_includes, error)))
+        return NULL;
 
       if (directory != NULL)
         *directory = g_file_dup (info->directory);
@@ -714,15 +943,12 @@ ide_compile_commands_lookup (IdeCompileCommands   *self,
       for (guint i = 0; i < self->vala_info->len; i++)
         {
           g_auto(GStrv) argv = NULL;
-          gint argc = 0;
 
           info = g_ptr_array_index (self->vala_info, i);
 
-          if (!g_shell_parse_argv (info->command, &argc, &argv, NULL))
+          if (!(argv = ide_compile_commands_get_flags (self, info, FLAGS_VALA, system_includes, NULL)))
             continue;
 
-          ide_compile_commands_filter_vala (self, info, &argv);
-
           if (directory != NULL)
             *directory = g_object_ref (info->directory);
 
@@ -737,3 +963,37 @@ ide_compile_commands_lookup (IdeCompileCommands   *self,
 
   return NULL;
 }
+
+/**
+ * ide_compile_commands_get_stats:
+ * @self: An #IdeCompileCommands
+ * @n_hits: (out) (optional): location for the number of cached lookups
+ * @n_misses: (out) (optional): location for the number of uncached lookups
+ * @n_unique: (out) (optional): location for the number of distinct
+ *   flag vectors currently cached
+ *
+ * Gets statistics about the flags cache used by ide_compile_commands_lookup().
+ *
+ * Since: 46
+ */
+void
+ide_compile_commands_get_stats (IdeCompileCommands *self,
+                                guint              *n_hits,
+                                guint              *n_misses,
+                                guint              *n_unique)
+{
+  G_GNUC_UNUSED g_autoptr(GMutexLocker) locker = NULL;
+
+  g_return_if_fail (IDE_IS_COMPILE_COMMANDS (self));
+
+  locker = g_mutex_locker_new (&self->flags_mutex);
+
+  if (n_hits != NULL)
+    *n_hits = self->n_hits;
+
+  if (n_misses != NULL)
+    *n_misses = self->n_misses;
+
+  if (n_unique != NULL)
+    *n_unique = g_hash_table_size (self->interned_flags);
+}
@@ -56,5 +56,15 @@ gchar              **ide_compile_commands_lookup      (IdeCompileCommands   *sel
                                                        const gchar * const  *system_includes,
                                                        GFile               **directory,
                                                        GError              **error);
+IDE_AVAILABLE_IN_46
+gchar              **ide_compile_commands_lookup_command (IdeCompileCommands  *self,
+                                                          GFile               *file,
+                                                          GFile              **directory,
+                                                          GError             **error);
+IDE_AVAILABLE_IN_46
+void                 ide_compile_commands_get_stats   (IdeCompileCommands   *self,
+                                                       guint                *n_hits,
+                                                       guint                *n_misses,
+                                                       guint                *n_unique);
 
 G_END_DECLS
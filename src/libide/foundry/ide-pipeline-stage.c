@@ -40,6 +40,7 @@ typedef struct
   GDestroyNotify       observer_data_destroy;
   IdeTask             *queued_build;
   gchar               *stdout_path;
+  gchar               *resource;
   GOutputStream       *stdout_stream;
   gint                 n_pause;
   IdePipelinePhase     phase;
@@ -48,6 +49,7 @@ typedef struct
   guint                transient : 1;
   guint                check_stdout : 1;
   guint                active : 1;
+  guint                concurrent : 1;
 } IdePipelineStagePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (IdePipelineStage, ide_pipeline_stage, IDE_TYPE_OBJECT)
@@ -57,8 +59,10 @@ enum {
   PROP_ACTIVE,
   PROP_CHECK_STDOUT,
   PROP_COMPLETED,
+  PROP_CONCURRENT,
   PROP_DISABLED,
   PROP_NAME,
+  PROP_RESOURCE,
   PROP_STDOUT_PATH,
   PROP_TRANSIENT,
   N_PROPS
@@ -260,6 +264,7 @@ ide_pipeline_stage_finalize (GObject *object)
 
   g_clear_pointer (&priv->name, g_free);
   g_clear_pointer (&priv->stdout_path, g_free);
+  g_clear_pointer (&priv->resource, g_free);
   g_clear_object (&priv->queued_build);
   g_clear_object (&priv->stdout_stream);
 
@@ -288,6 +293,10 @@ ide_pipeline_stage_get_property (GObject    *object,
       g_value_set_boolean (value, ide_pipeline_stage_get_completed (self));
       break;
 
+    case PROP_CONCURRENT:
+      g_value_set_boolean (value, ide_pipeline_stage_get_concurrent (self));
+      break;
+
     case PROP_DISABLED:
       g_value_set_boolean (value, ide_pipeline_stage_get_disabled (self));
       break;
@@ -296,6 +305,10 @@ ide_pipeline_stage_get_property (GObject    *object,
       g_value_set_string (value, ide_pipeline_stage_get_name (self));
       break;
 
+    case PROP_RESOURCE:
+      g_value_set_string (value, ide_pipeline_stage_get_resource (self));
+      break;
+
     case PROP_STDOUT_PATH:
       g_value_set_string (value, ide_pipeline_stage_get_stdout_path (self));
       break;
@@ -331,6 +344,10 @@ ide_pipeline_stage_set_property (GObject      *object,
       ide_pipeline_stage_set_completed (self, g_value_get_boolean (value));
       break;
 
+    case PROP_CONCURRENT:
+      ide_pipeline_stage_set_concurrent (self, g_value_get_boolean (value));
+      break;
+
     case PROP_DISABLED:
       ide_pipeline_stage_set_disabled (self, g_value_get_boolean (value));
       break;
@@ -339,6 +356,10 @@ ide_pipeline_stage_set_property (GObject      *object,
       ide_pipeline_stage_set_name (self, g_value_get_string (value));
       break;
 
+    case PROP_RESOURCE:
+      ide_pipeline_stage_set_resource (self, g_value_get_string (value));
+      break;
+
     case PROP_STDOUT_PATH:
       ide_pipeline_stage_set_stdout_path (self, g_value_get_string (value));
       break;
@@ -412,6 +433,28 @@ ide_pipeline_stage_class_init (IdePipelineStageClass *klass)
                           FALSE,
                           (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * IdePipelineStage:concurrent:
+   *
+   * If the build stage may run at the same time as the neighboring stages
+   * which are also concurrent, even when they are attached to another phase.
+   *
+   * Set this for stages which only depend on the non-concurrent stages
+   * ordered before them, such as downloading sources or creating
+   * directories. Concurrent stages still wait for all non-concurrent stages
+   * before them to complete, and stages after them wait for the whole group.
+   * Use #IdePipelineStage:resource to order a concurrent stage after another
+   * concurrent stage it depends on.
+   *
+   * Since: 46
+   */
+  properties [PROP_CONCURRENT] =
+    g_param_spec_boolean ("concurrent",
+                          "Concurrent",
+                          "If the stage may run alongside other concurrent stages",
+                          FALSE,
+                          (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   /**
    * IdePipelineStage:disabled:
    *
@@ -443,6 +486,25 @@ ide_pipeline_stage_class_init (IdePipelineStageClass *klass)
                          NULL,
                          (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * IdePipelineStage:resource:
+   *
+   * An identifier for a resource the stage requires exclusive access to,
+   * such as a directory it writes into.
+   *
+   * Concurrent stages sharing a resource are never run at the same time.
+   * The later stage waits until the earlier one has completed, which is how
+   * a concurrent stage declares a dependency on another one.
+   *
+   * Since: 46
+   */
+  properties [PROP_RESOURCE] =
+    g_param_spec_string ("resource",
+                         "Resource",
+                         "A resource the stage requires exclusive access to",
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   /**
    * IdePipelineStage:stdout-path:
    *
@@ -1125,6 +1187,93 @@ ide_pipeline_stage_set_disabled (IdePipelineStage *self,
     }
 }
 
+/**
+ * ide_pipeline_stage_get_concurrent:
+ * @self: a #IdePipelineStage
+ *
+ * Gets the #IdePipelineStage:concurrent property.
+ *
+ * Returns: %TRUE if the stage may run alongside other concurrent stages
+ *
+ * Since: 46
+ */
+gboolean
+ide_pipeline_stage_get_concurrent (IdePipelineStage *self)
+{
+  IdePipelineStagePrivate *priv = ide_pipeline_stage_get_instance_private (self);
+
+  g_return_val_if_fail (IDE_IS_PIPELINE_STAGE (self), FALSE);
+
+  return priv->concurrent;
+}
+
+/**
+ * ide_pipeline_stage_set_concurrent:
+ * @self: a #IdePipelineStage
+ * @concurrent: if the stage may run concurrently
+ *
+ * Sets the #IdePipelineStage:concurrent property.
+ *
+ * Since: 46
+ */
+void
+ide_pipeline_stage_set_concurrent (IdePipelineStage *self,
+                                   gboolean          concurrent)
+{
+  IdePipelineStagePrivate *priv = ide_pipeline_stage_get_instance_private (self);
+
+  g_return_if_fail (IDE_IS_PIPELINE_STAGE (self));
+
+  concurrent = !!concurrent;
+
+  if (priv->concurrent != concurrent)
+    {
+      priv->concurrent = concurrent;
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_CONCURRENT]);
+    }
+}
+
+/**
+ * ide_pipeline_stage_get_resource:
+ * @self: a #IdePipelineStage
+ *
+ * Gets the #IdePipelineStage:resource property.
+ *
+ * Returns: (nullable): the resource identifier or %NULL
+ *
+ * Since: 46
+ */
+const gchar *
+ide_pipeline_stage_get_resource (IdePipelineStage *self)
+{
+  IdePipelineStagePrivate *priv = ide_pipeline_stage_get_instance_private (self);
+
+  g_return_val_if_fail (IDE_IS_PIPELINE_STAGE (self), NULL);
+
+  return priv->resource;
+}
+
+/**
+ * ide_pipeline_stage_set_resource:
+ * @self: a #IdePipelineStage
+ * @resource: (nullable): a resource identifier or %NULL
+ *
+ * Sets the #IdePipelineStage:resource property.
+ *
+ * Since: 46
+ */
+void
+ide_pipeline_stage_set_resource (IdePipelineStage *self,
+                                 const gchar      *resource)
+{
+  IdePipelineStagePrivate *priv = ide_pipeline_stage_get_instance_private (self);
+
+  g_return_if_fail (IDE_IS_PIPELINE_STAGE (self));
+
+  if (g_set_str (&priv->resource, resource))
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_RESOURCE]);
+}
+
 gboolean
 ide_pipeline_stage_get_check_stdout (IdePipelineStage *self)
 {
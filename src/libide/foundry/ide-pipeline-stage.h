@@ -158,6 +158,16 @@ gboolean     ide_pipeline_stage_get_disabled     (IdePipelineStage     *self);
 IDE_AVAILABLE_IN_ALL
 void         ide_pipeline_stage_set_disabled     (IdePipelineStage     *self,
                                                   gboolean              disabled);
+IDE_AVAILABLE_IN_46
+gboolean     ide_pipeline_stage_get_concurrent   (IdePipelineStage     *self);
+IDE_AVAILABLE_IN_46
+void         ide_pipeline_stage_set_concurrent   (IdePipelineStage     *self,
+                                                  gboolean              concurrent);
+IDE_AVAILABLE_IN_46
+const gchar *ide_pipeline_stage_get_resource     (IdePipelineStage     *self);
+IDE_AVAILABLE_IN_46
+void         ide_pipeline_stage_set_resource     (IdePipelineStage     *self,
+                                                  const gchar          *resource);
 IDE_AVAILABLE_IN_ALL
 gboolean     ide_pipeline_stage_get_check_stdout (IdePipelineStage     *self);
 IDE_AVAILABLE_IN_ALL
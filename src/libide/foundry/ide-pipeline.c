@@ -255,6 +255,12 @@ struct _IdePipeline
    */
   IdePipelineStage *current_stage;
 
+  /*
+   * The group of concurrent stages being built, if any. current_stage
+   * then points at the earliest stage of the group still running.
+   */
+  struct _ConcurrentBuild *concurrent;
+
   /*
    * The index of our current PipelineEntry. This should start at -1
    * to indicate that no stage is currently active.
@@ -366,6 +372,20 @@ typedef struct
   };
 } TaskData;
 
+typedef struct
+{
+  IdePipelineStage *stage;
+  IdePipelinePhase  phase;
+} ConcurrentStage;
+
+typedef struct _ConcurrentBuild
+{
+  IdeTask *task;
+  GError  *error;
+  /* Array of ConcurrentStage still running, in pipeline order */
+  GArray  *running;
+} ConcurrentBuild;
+
 static void ide_pipeline_queue_flush  (IdePipeline         *self);
 static void ide_pipeline_tick_build   (IdePipeline         *self,
                                        IdeTask             *task);
@@ -868,6 +888,8 @@ ide_pipeline_get_phase (IdePipeline *self)
     return IDE_PIPELINE_PHASE_NONE;
   else if (self->failed)
     return IDE_PIPELINE_PHASE_FAILED;
+  else if (self->concurrent != NULL && self->concurrent->running->len > 0)
+    return g_array_index (self->concurrent->running, ConcurrentStage, 0).phase & IDE_PIPELINE_PHASE_MASK;
   else if ((guint)self->position < self->pipeline->len)
     return g_array_index (self->pipeline, PipelineEntry, self->position).phase & IDE_PIPELINE_PHASE_MASK;
   else
@@ -1942,6 +1964,228 @@ ide_pipeline_stage_build_cb (GObject      *object,
   IDE_EXIT;
 }
 
+static void
+clear_concurrent_stage (gpointer data)
+{
+  ConcurrentStage *running = data;
+
+  g_clear_object (&running->stage);
+}
+
+static void
+concurrent_build_free (ConcurrentBuild *state)
+{
+  g_clear_object (&state->task);
+  g_clear_error (&state->error);
+  g_clear_pointer (&state->running, g_array_unref);
+  g_slice_free (ConcurrentBuild, state);
+}
+
+static void complete_queued_before_phase (IdePipeline      *self,
+                                          IdePipelinePhase  phase);
+
+static void
+ide_pipeline_concurrent_build_cb (GObject      *object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+  IdePipelineStage *stage = (IdePipelineStage *)object;
+  ConcurrentBuild *state = user_data;
+  g_autoptr(GError) error = NULL;
+  IdePipeline *self;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_PIPELINE_STAGE (stage));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (state != NULL);
+  g_assert (IDE_IS_TASK (state->task));
+  g_assert (state->running->len > 0);
+
+  self = ide_task_get_source_object (state->task);
+  g_assert (IDE_IS_PIPELINE (self));
+  g_assert (self->concurrent == state);
+
+  for (guint i = 0; i < state->running->len; i++)
+    {
+      if (g_array_index (state->running, ConcurrentStage, i).stage == stage)
+        {
+          g_array_remove_index (state->running, i);
+          break;
+        }
+    }
+
+  if (!_ide_pipeline_stage_build_with_query_finish (stage, result, &error))
+    {
+      g_debug ("stage of type %s failed: %s",
+               G_OBJECT_TYPE_NAME (stage),
+               error->message);
+
+      if (state->error == NULL)
+        state->error = g_steal_pointer (&error);
+    }
+
+  ide_pipeline_stage_set_completed (stage, error == NULL && state->error == NULL);
+
+  IDE_TRACE_MSG ("Concurrent stage %s finished, %u remaining",
+                 G_OBJECT_TYPE_NAME (stage), state->running->len);
+
+  if (state->running->len > 0)
+    {
+      const ConcurrentStage *earliest = &g_array_index (state->running, ConcurrentStage, 0);
+
+      /* Requests for the phases the group has completed need not wait
+       * for the rest of it.
+       */
+      if (state->error == NULL)
+        complete_queued_before_phase (self, earliest->phase);
+
+      self->current_stage = earliest->stage;
+
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MESSAGE]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_PHASE]);
+
+      IDE_EXIT;
+    }
+
+  self->concurrent = NULL;
+
+  if (state->error != NULL)
+    {
+      self->failed = TRUE;
+      ide_task_return_error (state->task, g_steal_pointer (&state->error));
+    }
+  else
+    {
+      ide_pipeline_tick_build (self, state->task);
+    }
+
+  concurrent_build_free (state);
+
+  IDE_EXIT;
+}
+
+static guint
+ide_pipeline_get_max_concurrent (IdePipeline *self)
+{
+  int parallelism = -1;
+
+  g_assert (IDE_IS_PIPELINE (self));
+
+  if (self->config != NULL)
+    parallelism = ide_config_get_parallelism (self->config);
+
+  if (parallelism <= 0)
+    return g_get_num_processors ();
+
+  return parallelism;
+}
+
+/*
+ * Starts the stage at self->position along with the concurrent stages that
+ * directly follow it, leaving self->position at the last stage started.
+ *
+ * A concurrent stage only depends on the non-concurrent stages ordered
+ * before it, so the group may span several phases (for example, creating
+ * the flatpak workspace, updating git submodules and downloading flatpak
+ * dependencies). The group ends at the first non-concurrent stage, at a
+ * stage outside of the requested phases, or at a stage claiming a resource
+ * already claimed within the group. The next tick happens once all of them
+ * complete so that later stages see the whole group as a single dependency.
+ * Queued requests for earlier phases complete as soon as the stages of
+ * those phases have, and the phase reported is that of the earliest stage
+ * still running.
+ */
+static void
+ide_pipeline_build_concurrent (IdePipeline  *self,
+                               IdeTask      *task,
+                               GPtrArray    *targets,
+                               GCancellable *cancellable)
+{
+  g_autoptr(GHashTable) resources = NULL;
+  g_autoptr(GArray) stages = NULL;
+  ConcurrentBuild *state;
+  guint max_concurrent;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_PIPELINE (self));
+  g_assert (IDE_IS_TASK (task));
+  g_assert (self->position >= 0);
+  g_assert ((guint)self->position < self->pipeline->len);
+  g_assert (self->concurrent == NULL);
+
+  max_concurrent = ide_pipeline_get_max_concurrent (self);
+  resources = g_hash_table_new (g_str_hash, g_str_equal);
+  stages = g_array_new (FALSE, FALSE, sizeof (ConcurrentStage));
+  g_array_set_clear_func (stages, clear_concurrent_stage);
+
+  for (guint position = self->position;
+       position < self->pipeline->len && stages->len < max_concurrent;
+       position++)
+    {
+      const PipelineEntry *entry = &g_array_index (self->pipeline, PipelineEntry, position);
+      ConcurrentStage running;
+      const char *resource;
+
+      if (ide_pipeline_stage_get_disabled (entry->stage))
+        continue;
+
+      if (((entry->phase & IDE_PIPELINE_PHASE_MASK) & self->requested_mask) == 0 ||
+          !ide_pipeline_stage_get_concurrent (entry->stage))
+        break;
+
+      if ((resource = ide_pipeline_stage_get_resource (entry->stage)))
+        {
+          if (g_hash_table_contains (resources, resource))
+            break;
+          g_hash_table_add (resources, (char *)resource);
+        }
+
+      running.stage = g_object_ref (entry->stage);
+      running.phase = entry->phase;
+      g_array_append_val (stages, running);
+
+      self->position = position;
+    }
+
+  g_assert (stages->len > 0);
+
+  IDE_TRACE_MSG ("Running %u stages concurrently", stages->len);
+
+#ifdef IDE_ENABLE_TRACE
+  for (guint i = 0; i < stages->len; i++)
+    IDE_TRACE_MSG ("  Starting %s (%s)",
+                   G_OBJECT_TYPE_NAME (g_array_index (stages, ConcurrentStage, i).stage),
+                   ide_pipeline_stage_get_name (g_array_index (stages, ConcurrentStage, i).stage));
+#endif
+
+  self->current_stage = g_array_index (stages, ConcurrentStage, 0).stage;
+
+  state = g_slice_new0 (ConcurrentBuild);
+  state->task = g_object_ref (task);
+  state->running = g_array_copy (stages);
+
+  /* The copy shares the stage references, which it now owns */
+  g_array_set_clear_func (stages, NULL);
+  g_array_set_clear_func (state->running, clear_concurrent_stage);
+
+  self->concurrent = state;
+
+  /* Stages may complete synchronously and remove themselves from
+   * state->running, so iterate over our own array.
+   */
+  for (guint i = 0; i < stages->len; i++)
+    _ide_pipeline_stage_build_with_query_async (g_array_index (stages, ConcurrentStage, i).stage,
+                                                self,
+                                                targets,
+                                                cancellable,
+                                                ide_pipeline_concurrent_build_cb,
+                                                state);
+
+  IDE_EXIT;
+}
+
 static void
 ide_pipeline_try_chain (IdePipeline      *self,
                         IdePipelineStage *stage,
@@ -2099,6 +2343,16 @@ ide_pipeline_tick_build (IdePipeline *self,
           else if (td->type == TASK_REBUILD)
             targets = td->rebuild.targets;
 
+          if (ide_pipeline_stage_get_concurrent (entry->stage))
+            {
+              ide_pipeline_build_concurrent (self, task, targets, cancellable);
+
+              g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_MESSAGE]);
+              g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_PHASE]);
+
+              IDE_EXIT;
+            }
+
           /*
            * We might be able to chain upcoming stages to this stage and avoid
            * duplicate work. This will also advance self->position based on
@@ -41,6 +41,7 @@ typedef struct
   int priority;
   IdeRunCommandKind kind : 8;
   guint can_default : 1;
+  guint can_parallelize : 1;
 } IdeRunCommandPrivate;
 
 enum {
@@ -48,6 +49,7 @@ enum {
   PROP_ARGV,
   PROP_SHELL_COMMAND,
   PROP_CAN_DEFAULT,
+  PROP_CAN_PARALLELIZE,
   PROP_CWD,
   PROP_DISPLAY_NAME,
   PROP_ENVIRON,
@@ -207,6 +209,10 @@ ide_run_command_get_property (GObject    *object,
       g_value_set_boolean (value, ide_run_command_get_can_default (self));
       break;
 
+    case PROP_CAN_PARALLELIZE:
+      g_value_set_boolean (value, ide_run_command_get_can_parallelize (self));
+      break;
+
     case PROP_CWD:
       g_value_set_string (value, ide_run_command_get_cwd (self));
       break;
@@ -288,6 +294,10 @@ ide_run_command_set_property (GObject      *object,
       ide_run_command_set_can_default (self, g_value_get_boolean (value));
       break;
 
+    case PROP_CAN_PARALLELIZE:
+      ide_run_command_set_can_parallelize (self, g_value_get_boolean (value));
+      break;
+
     case PROP_CWD:
       ide_run_command_set_cwd (self, g_value_get_string (value));
       break;
@@ -356,6 +366,22 @@ ide_run_command_class_init (IdeRunCommandClass *klass)
                           FALSE,
                           (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * IdeRunCommand:can-parallelize:
+   *
+   * If the command may run at the same time as other commands.
+   *
+   * Build systems should set this to %FALSE for tests which are known to
+   * interfere with other tests, such as meson tests declared with
+   * `is_parallel: false`. Such tests are then run on their own.
+   *
+   * Since: 46
+   */
+  properties [PROP_CAN_PARALLELIZE] =
+    g_param_spec_boolean ("can-parallelize", NULL, NULL,
+                          TRUE,
+                          (G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
+
   properties [PROP_HAS_CATEGORY] =
     g_param_spec_boolean ("has-category", NULL, NULL,
                           FALSE,
@@ -430,6 +456,9 @@ ide_run_command_class_init (IdeRunCommandClass *klass)
 static void
 ide_run_command_init (IdeRunCommand *self)
 {
+  IdeRunCommandPrivate *priv = ide_run_command_get_instance_private (self);
+
+  priv->can_parallelize = TRUE;
 }
 
 IdeRunCommand *
@@ -707,6 +736,52 @@ ide_run_command_set_can_default (IdeRunCommand *self,
     }
 }
 
+/**
+ * ide_run_command_get_can_parallelize:
+ * @self: a #IdeRunCommand
+ *
+ * Gets the #IdeRunCommand:can-parallelize property.
+ *
+ * Returns: %TRUE if the command may run alongside other commands
+ *
+ * Since: 46
+ */
+gboolean
+ide_run_command_get_can_parallelize (IdeRunCommand *self)
+{
+  IdeRunCommandPrivate *priv = ide_run_command_get_instance_private (self);
+
+  g_return_val_if_fail (IDE_IS_RUN_COMMAND (self), TRUE);
+
+  return priv->can_parallelize;
+}
+
+/**
+ * ide_run_command_set_can_parallelize:
+ * @self: a #IdeRunCommand
+ * @can_parallelize: if the command may run alongside other commands
+ *
+ * Sets the #IdeRunCommand:can-parallelize property.
+ *
+ * Since: 46
+ */
+void
+ide_run_command_set_can_parallelize (IdeRunCommand *self,
+                                     gboolean       can_parallelize)
+{
+  IdeRunCommandPrivate *priv = ide_run_command_get_instance_private (self);
+
+  g_return_if_fail (IDE_IS_RUN_COMMAND (self));
+
+  can_parallelize = !!can_parallelize;
+
+  if (can_parallelize != priv->can_parallelize)
+    {
+      priv->can_parallelize = can_parallelize;
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_CAN_PARALLELIZE]);
+    }
+}
+
 const char *
 ide_run_command_getenv (IdeRunCommand *self,
                         const char    *key)
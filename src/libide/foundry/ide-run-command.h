@@ -122,6 +122,11 @@ gboolean            ide_run_command_get_can_default  (IdeRunCommand      *self);
 IDE_AVAILABLE_IN_ALL
 void                ide_run_command_set_can_default  (IdeRunCommand      *self,
                                                       gboolean            can_default);
+IDE_AVAILABLE_IN_46
+gboolean            ide_run_command_get_can_parallelize (IdeRunCommand      *self);
+IDE_AVAILABLE_IN_46
+void                ide_run_command_set_can_parallelize (IdeRunCommand      *self,
+                                                         gboolean            can_parallelize);
 IDE_AVAILABLE_IN_ALL
 void                ide_run_command_prepare_to_run   (IdeRunCommand      *self,
                                                       IdeRunContext      *run_context,
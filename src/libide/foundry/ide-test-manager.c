@@ -41,7 +41,7 @@
 #include "ide-test-manager.h"
 #include "ide-test-private.h"
 
-#define MAX_UNIT_TESTS 4
+#define DURATIONS_FORMAT "a{sd}"
 
 /**
  * SECTION:ide-test-manager
@@ -66,6 +66,11 @@ struct _IdeTestManager
   IdePtyIntercept     intercept;
   int                 pty_producer;
   guint               n_active;
+
+  /* Test id to duration in seconds of the last run, persisted in the
+   * project cache so that run-all can start the slowest tests first.
+   */
+  GHashTable         *durations;
 };
 
 typedef struct
@@ -74,8 +79,18 @@ typedef struct
   GPtrArray   *tests;
   VtePty      *pty;
   guint        n_active;
+  guint        max_parallel;
+  guint        fail_fast : 1;
+  guint        failed : 1;
 } RunAll;
 
+typedef struct
+{
+  IdeTask *task;
+  IdeTest *test;
+  gint64   begin_time;
+} RunOne;
+
 static void ide_test_manager_actions_cancel   (IdeTestManager *self,
                                                GVariant       *param);
 static void ide_test_manager_actions_test     (IdeTestManager *self,
@@ -132,6 +147,168 @@ run_all_free (RunAll *state)
   g_slice_free (RunAll, state);
 }
 
+static void
+run_one_free (RunOne *state)
+{
+  g_clear_object (&state->task);
+  g_clear_object (&state->test);
+  g_slice_free (RunOne, state);
+}
+
+static char *
+get_durations_path (IdeTestManager *self)
+{
+  IdeContext *context = ide_object_get_context (IDE_OBJECT (self));
+
+  return ide_context_cache_filename (context, "tests", "durations.gvariant", NULL);
+}
+
+static void
+ide_test_manager_load_durations (IdeTestManager *self)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  g_autoptr(GVariant) variant = NULL;
+  GVariantIter iter;
+  const char *id;
+  gdouble duration;
+  gsize len;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TEST_MANAGER (self));
+
+  if (self->durations != NULL)
+    return;
+
+  self->durations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  path = get_durations_path (self);
+
+  if (!g_file_get_contents (path, &contents, &len, NULL))
+    return;
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (DURATIONS_FORMAT),
+                                     g_steal_pointer (&contents), len, FALSE,
+                                     g_free, NULL);
+  variant = g_variant_ref_sink (g_variant_get_normal_form (variant));
+
+  g_variant_iter_init (&iter, variant);
+  while (g_variant_iter_next (&iter, "{&sd}", &id, &duration))
+    g_hash_table_insert (self->durations,
+                         g_strdup (id),
+                         g_memdup2 (&duration, sizeof duration));
+}
+
+static void
+ide_test_manager_save_durations (IdeTestManager *self)
+{
+  g_autoptr(GVariant) variant = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autoptr(GFile) parent = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autofree char *path = NULL;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TEST_MANAGER (self));
+
+  if (self->durations == NULL)
+    return;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (DURATIONS_FORMAT));
+  g_hash_table_iter_init (&iter, self->durations);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_variant_builder_add (&builder, "{sd}", key, *(gdouble *)value);
+  variant = g_variant_ref_sink (g_variant_builder_end (&builder));
+  bytes = g_variant_get_data_as_bytes (variant);
+
+  path = get_durations_path (self);
+  file = g_file_new_for_path (path);
+  parent = g_file_get_parent (file);
+
+  g_file_make_directory_with_parents (parent, NULL, NULL);
+  g_file_replace_contents_bytes_async (file, bytes, NULL, FALSE,
+                                       G_FILE_CREATE_REPLACE_DESTINATION,
+                                       NULL, NULL, NULL);
+}
+
+static gdouble
+ide_test_manager_get_duration (IdeTestManager *self,
+                               IdeTest        *test)
+{
+  const gdouble *duration;
+
+  g_assert (IDE_IS_TEST_MANAGER (self));
+  g_assert (IDE_IS_TEST (test));
+
+  /* Tests we have never timed sort first so we learn their duration */
+  if (self->durations == NULL ||
+      !(duration = g_hash_table_lookup (self->durations, ide_test_get_id (test))))
+    return G_MAXDOUBLE;
+
+  return *duration;
+}
+
+static gboolean
+test_can_parallelize (IdeTest *test)
+{
+  IdeRunCommand *run_command = ide_test_get_run_command (test);
+
+  return run_command == NULL || ide_run_command_get_can_parallelize (run_command);
+}
+
+static int
+compare_by_duration (gconstpointer a,
+                     gconstpointer b,
+                     gpointer      user_data)
+{
+  IdeTestManager *self = user_data;
+  IdeTest *test_a = *(IdeTest **)a;
+  IdeTest *test_b = *(IdeTest **)b;
+  gboolean pa = test_can_parallelize (test_a);
+  gboolean pb = test_can_parallelize (test_b);
+  gdouble da;
+  gdouble db;
+
+  /* Sort ascending, tests are popped from the tail of the array. Tests
+   * which cannot run in parallel go to the head so that they run one at
+   * a time once every other test has completed.
+   */
+  if (pa != pb)
+    return pa ? 1 : -1;
+
+  da = ide_test_manager_get_duration (self, test_a);
+  db = ide_test_manager_get_duration (self, test_b);
+
+  if (da < db)
+    return -1;
+  else if (da > db)
+    return 1;
+  else
+    return 0;
+}
+
+static guint
+get_max_parallel (IdeTestManager *self)
+{
+  g_autoptr(IdeSettings) settings = NULL;
+  IdeContext *context;
+  int n_parallel;
+
+  g_assert (IDE_IS_TEST_MANAGER (self));
+
+  context = ide_object_get_context (IDE_OBJECT (self));
+  settings = ide_context_ref_settings (context, "org.gnome.builder.project");
+  n_parallel = ide_settings_get_int (settings, "unit-test-parallelism");
+
+  if (n_parallel <= 0)
+    n_parallel = g_get_num_processors ();
+
+  return MAX (1, n_parallel);
+}
+
 static GCancellable *
 get_cancellable (IdeTestManager *self)
 {
@@ -225,6 +402,7 @@ ide_test_manager_destroy (IdeObject *object)
   g_clear_object (&self->cancellable);
   g_clear_object (&self->filtered);
   g_clear_object (&self->tests);
+  g_clear_pointer (&self->durations, g_hash_table_unref);
 
   g_clear_object (&self->pty);
   fd = pty_fd_steal (&self->pty_producer);
@@ -331,13 +509,84 @@ ide_test_manager_init (IdeTestManager *self)
   self->tests = ide_cached_list_model_new (G_LIST_MODEL (map));
 }
 
+static void ide_test_manager_run_all_cb (GObject      *object,
+                                         GAsyncResult *result,
+                                         gpointer      user_data);
+static void ide_test_manager_run_next   (IdeTestManager *self,
+                                         IdeTask        *task);
+
+static void
+ide_test_manager_run_pending (IdeTestManager *self,
+                              IdeTask        *task)
+{
+  RunAll *state;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TEST_MANAGER (self));
+  g_assert (IDE_IS_TASK (task));
+
+  state = ide_task_get_task_data (task);
+
+  g_assert (state != NULL);
+  g_assert (state->tests != NULL);
+
+  while (state->tests->len > 0 && state->n_active < state->max_parallel)
+    {
+      IdeTest *test = g_ptr_array_index (state->tests, state->tests->len-1);
+
+      /* Wait for the running tests to complete so that this one runs
+       * alone, it is started again from ide_test_manager_run_all_cb().
+       */
+      if (!test_can_parallelize (test))
+        {
+          if (state->n_active == 0)
+            ide_test_manager_run_next (self, task);
+          break;
+        }
+
+      ide_test_manager_run_next (self, task);
+    }
+}
+
+static void
+ide_test_manager_run_next (IdeTestManager *self,
+                           IdeTask        *task)
+{
+  RunOne *run_one;
+  RunAll *state;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TEST_MANAGER (self));
+  g_assert (IDE_IS_TASK (task));
+
+  state = ide_task_get_task_data (task);
+
+  g_assert (state != NULL);
+  g_assert (state->tests != NULL);
+  g_assert (state->tests->len > 0);
+
+  run_one = g_slice_new0 (RunOne);
+  run_one->task = g_object_ref (task);
+  run_one->test = g_ptr_array_steal_index (state->tests, state->tests->len-1);
+  run_one->begin_time = g_get_monotonic_time ();
+
+  state->n_active++;
+
+  ide_test_manager_run_async (self,
+                              run_one->test,
+                              ide_task_get_cancellable (task),
+                              ide_test_manager_run_all_cb,
+                              run_one);
+}
+
 static void
 ide_test_manager_run_all_cb (GObject      *object,
                              GAsyncResult *result,
                              gpointer      user_data)
 {
   IdeTestManager *self = (IdeTestManager *)object;
-  g_autoptr(IdeTask) task = user_data;
+  RunOne *run_one = user_data;
+  g_autoptr(IdeTask) task = NULL;
   g_autoptr(GError) error = NULL;
   GCancellable *cancellable;
   RunAll *state;
@@ -347,8 +596,10 @@ ide_test_manager_run_all_cb (GObject      *object,
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (IDE_IS_TEST_MANAGER (self));
   g_assert (G_IS_ASYNC_RESULT (result));
-  g_assert (IDE_IS_TASK (task));
+  g_assert (run_one != NULL);
+  g_assert (IDE_IS_TASK (run_one->task));
 
+  task = g_object_ref (run_one->task);
   cancellable = ide_task_get_cancellable (task);
   state = ide_task_get_task_data (task);
 
@@ -359,24 +610,36 @@ ide_test_manager_run_all_cb (GObject      *object,
   if (!ide_test_manager_run_finish (self, result, &error))
     g_message ("%s", error->message);
 
-  if (state->tests->len > 0 &&
-      !g_cancellable_is_cancelled (cancellable))
-    {
-      g_autoptr(IdeTest) next_test = g_ptr_array_steal_index (state->tests, state->tests->len-1);
+  if (ide_test_get_status (run_one->test) == IDE_TEST_STATUS_FAILED)
+    state->failed = TRUE;
 
-      state->n_active++;
+  /* Only record complete runs, a cancelled test says nothing about
+   * how long it takes.
+   */
+  if (self->durations != NULL &&
+      !g_cancellable_is_cancelled (cancellable) &&
+      ide_test_get_status (run_one->test) != IDE_TEST_STATUS_NONE)
+    {
+      gdouble duration = (g_get_monotonic_time () - run_one->begin_time) / (gdouble)G_USEC_PER_SEC;
 
-      ide_test_manager_run_async (self,
-                                  next_test,
-                                  cancellable,
-                                  ide_test_manager_run_all_cb,
-                                  g_object_ref (task));
+      g_hash_table_insert (self->durations,
+                           g_strdup (ide_test_get_id (run_one->test)),
+                           g_memdup2 (&duration, sizeof duration));
     }
 
+  g_clear_pointer (&run_one, run_one_free);
+
   state->n_active--;
 
+  if (!(state->fail_fast && state->failed) &&
+      !g_cancellable_is_cancelled (cancellable))
+    ide_test_manager_run_pending (self, task);
+
   if (state->n_active == 0)
-    ide_task_return_boolean (task, TRUE);
+    {
+      ide_test_manager_save_durations (self);
+      ide_task_return_boolean (task, TRUE);
+    }
 
   IDE_EXIT;
 }
@@ -396,6 +659,14 @@ ide_test_manager_emit_end_test_all (IdeTestManager *self)
  *
  * Executes all tests in an undefined order.
  *
+ * Tests are run concurrently, up to the number of processors or the
+ * "unit-test-parallelism" project setting. Tests which took the longest
+ * on a previous run are started first so that long tests do not end up
+ * running alone at the end. Tests whose #IdeRunCommand:can-parallelize
+ * is %FALSE are run last, one at a time. If the "unit-test-fail-fast"
+ * project setting is enabled, no new tests are started after the first
+ * failure.
+ *
  * Upon completion, @callback will be executed which must call
  * ide_test_manager_run_all_finish() to get the result.
  *
@@ -410,11 +681,13 @@ ide_test_manager_run_all_async (IdeTestManager      *self,
 {
   g_autoptr(IdeTask) task = NULL;
   g_autoptr(GPtrArray) ar = NULL;
+  g_autoptr(IdeSettings) settings = NULL;
   IdeBuildManager *build_manager;
   IdePipeline *pipeline;
   GListModel *tests;
   IdeContext *context;
   RunAll *state;
+  guint max_parallel;
   guint n_items;
 
   IDE_ENTRY;
@@ -450,28 +723,25 @@ ide_test_manager_run_all_async (IdeTestManager      *self,
   tests = ide_test_manager_list_tests (self);
   n_items = g_list_model_get_n_items (tests);
 
+  ide_test_manager_load_durations (self);
+
   ar = g_ptr_array_new_with_free_func (g_object_unref);
   for (guint i = n_items; i > 0; i--)
     g_ptr_array_add (ar, g_list_model_get_item (tests, i-1));
+  g_ptr_array_sort_with_data (ar, compare_by_duration, self);
+
+  settings = ide_context_ref_settings (context, "org.gnome.builder.project");
+  max_parallel = get_max_parallel (self);
 
   state = g_slice_new0 (RunAll);
   state->tests = g_ptr_array_ref (ar);
   state->pipeline = g_object_ref (pipeline);
   state->n_active = 0;
+  state->max_parallel = max_parallel;
+  state->fail_fast = ide_settings_get_boolean (settings, "unit-test-fail-fast");
   ide_task_set_task_data (task, state, run_all_free);
 
-  for (guint i = 0; i < MAX_UNIT_TESTS && ar->len > 0; i++)
-    {
-      g_autoptr(IdeTest) test = g_ptr_array_steal_index (state->tests, ar->len-1);
-
-      state->n_active++;
-
-      ide_test_manager_run_async (self,
-                                  test,
-                                  cancellable,
-                                  ide_test_manager_run_all_cb,
-                                  g_object_ref (task));
-    }
+  ide_test_manager_run_pending (self, task);
 
   if (state->n_active == 0)
     ide_task_return_boolean (task, TRUE);
@@ -29,6 +29,8 @@
 
 #include <libide-projects.h>
 
+#include "ide-private.h"
+
 #include "ide-application.h"
 #include "ide-application-credits.h"
 #include "ide-application-private.h"
@@ -381,6 +383,26 @@ ide_application_actions_contexts (GSimpleAction *action,
   IDE_EXIT;
 }
 
+static void
+ide_application_actions_trace_marks (GSimpleAction *action,
+                                     GVariant      *state,
+                                     gpointer       user_data)
+{
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (G_IS_SIMPLE_ACTION (action));
+  g_assert (g_variant_is_of_type (state, G_VARIANT_TYPE_BOOLEAN));
+
+  _ide_trace_set_marks_enabled (g_variant_get_boolean (state));
+  g_simple_action_set_state (action, state);
+
+  g_debug ("Trace marks %s",
+           g_variant_get_boolean (state) ? "enabled" : "disabled");
+
+  IDE_EXIT;
+}
+
 static const GActionEntry IdeApplicationActions[] = {
   { "about:types", ide_application_actions_stats },
   { "about:contexts", ide_application_actions_contexts },
@@ -399,6 +421,7 @@ _ide_application_init_actions (IdeApplication *self)
 {
   g_autoptr(GAction) style_action = NULL;
   g_autoptr(GAction) style_scheme_action = NULL;
+  g_autoptr(GSimpleAction) trace_marks_action = NULL;
 
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (IDE_IS_APPLICATION (self));
@@ -413,6 +436,18 @@ _ide_application_init_actions (IdeApplication *self)
 
   style_scheme_action = g_settings_create_action (self->editor_settings, "style-scheme-name");
   g_action_map_add_action (G_ACTION_MAP (self), style_scheme_action);
+
+  /* Allows toggling profiler marks on a running instance, such as with
+   * `gapplication action org.gnome.Builder trace-marks`.
+   */
+  trace_marks_action = g_simple_action_new_stateful ("trace-marks",
+                                                     NULL,
+                                                     g_variant_new_boolean (_ide_trace_get_marks_enabled ()));
+  g_signal_connect (trace_marks_action,
+                    "change-state",
+                    G_CALLBACK (ide_application_actions_trace_marks),
+                    self);
+  g_action_map_add_action (G_ACTION_MAP (self), G_ACTION (trace_marks_action));
 }
 
 static void
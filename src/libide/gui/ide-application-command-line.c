@@ -60,6 +60,7 @@ _ide_application_add_option_entries (IdeApplication *self)
 {
   static const GOptionEntry main_entries[] = {
     { "preferences", 0, 0, G_OPTION_ARG_NONE, NULL, N_("Show the application preferences") },
+    { "memory-report", 0, 0, G_OPTION_ARG_NONE, NULL, N_("Print memory used by each subsystem of the running instance") },
     { "project", 'p', 0, G_OPTION_ARG_FILENAME, NULL, N_("Open project in new workbench"), N_("FILE")  },
 
     /* The following are handled in main(), but needed here so that --help
@@ -151,6 +152,17 @@ _ide_application_command_line (IdeApplication          *self,
       return;
     }
 
+  /* The command-line is forwarded over D-Bus to the primary instance,
+   * so this reports the memory of the already running application.
+   */
+  if (g_variant_dict_contains (dict, "memory-report"))
+    {
+      g_autofree char *report = ide_memory_account_report ();
+
+      g_application_command_line_print (cmdline, "%s", report);
+      return;
+    }
+
   /*
    * Allow any plugin that has registered a command-line handler to
    * handle the command-line options. They may return an exit status
@@ -24,10 +24,25 @@
 
 #include <libide-plugins.h>
 
+#include "ide-private.h"
+
 #include "ide-application.h"
 #include "ide-application-addin.h"
 #include "ide-application-private.h"
 
+/* Keys (without the X- prefix) a plugin may use to delay being loaded
+ * until something in the workbench needs it. Values are separated with
+ * "," or ";" and file triggers may contain glob patterns. Action triggers
+ * are "prefix.name" relative to the workbench action muxer, which is
+ * "context.workbench" from within a workspace.
+ */
+static const char *trigger_keys[] = {
+  [IDE_PLUGIN_TRIGGER_LANGUAGE] = "Activate-On-Language",
+  [IDE_PLUGIN_TRIGGER_BUILD_SYSTEM] = "Activate-On-Build-System",
+  [IDE_PLUGIN_TRIGGER_FILE] = "Activate-On-File",
+  [IDE_PLUGIN_TRIGGER_ACTION] = "Activate-On-Action",
+};
+
 static void
 ide_application_changed_plugin_cb (GSettings      *settings,
                                    const gchar    *key,
@@ -225,6 +240,24 @@ _ide_application_load_plugin (IdeApplication *self,
     peas_engine_load_plugin (engine, plugin_info);
 }
 
+static void
+ide_application_plugins_load_plugin_cb (IdeApplication *self,
+                                        PeasPluginInfo *plugin_info,
+                                        PeasEngine     *engine)
+{
+  gint64 begin_time = g_get_monotonic_time ();
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_APPLICATION (self));
+  g_assert (plugin_info != NULL);
+  g_assert (PEAS_IS_ENGINE (engine));
+
+  /* Dependencies are loaded from within the default handler, so loads
+   * nest and we pop the matching begin time in the after handler.
+   */
+  g_array_append_val (self->plugin_load_times, begin_time);
+}
+
 static void
 ide_application_plugins_load_plugin_after_cb (IdeApplication *self,
                                               PeasPluginInfo *plugin_info,
@@ -243,6 +276,15 @@ ide_application_plugins_load_plugin_after_cb (IdeApplication *self,
   module_dir = peas_plugin_info_get_module_dir (plugin_info);
   module_name = peas_plugin_info_get_module_name (plugin_info);
 
+  if (self->plugin_load_times->len > 0)
+    {
+      guint last = self->plugin_load_times->len - 1;
+      gint64 begin_time = g_array_index (self->plugin_load_times, gint64, last);
+
+      g_array_set_size (self->plugin_load_times, last);
+      _ide_trace_mark (begin_time, g_get_monotonic_time (), "plugins", "load", module_name);
+    }
+
   g_debug ("Loaded plugin \"%s\" with module-dir \"%s\"",
            module_name, module_dir);
 
@@ -258,12 +300,49 @@ ide_application_plugins_load_plugin_after_cb (IdeApplication *self,
    * Only register resources if the path is to an embedded resource
    * or if it's not builtin (and therefore maybe doesn't use .gresource
    * files). That helps reduce the number IOPS we do.
+   *
+   * Plugins activated by an action had theirs registered when they were
+   * deferred, see ide_application_plugins_add_action_resources().
    */
-  if (g_str_has_prefix (data_dir, "resource://") ||
-      !peas_plugin_info_is_builtin (plugin_info))
+  if ((g_str_has_prefix (data_dir, "resource://") ||
+       !peas_plugin_info_is_builtin (plugin_info)) &&
+      !g_object_get_data (G_OBJECT (plugin_info), "IDE_RESOURCES_ADDED"))
     _ide_application_add_resources (self, data_dir);
 }
 
+/*
+ * ide_application_plugins_add_action_resources:
+ *
+ * The menus and shortcuts of a plugin activated by an action are what
+ * the user activates it with, so they must be there before the plugin
+ * is loaded. That is only possible for plugins with resources embedded
+ * into the application, others get them once loaded.
+ */
+static void
+ide_application_plugins_add_action_resources (IdeApplication *self,
+                                              PeasPluginInfo *plugin_info)
+{
+  g_autoptr(GHashTable) circular = NULL;
+  const char *data_dir;
+
+  g_assert (IDE_IS_APPLICATION (self));
+  g_assert (plugin_info != NULL);
+
+  data_dir = peas_plugin_info_get_data_dir (plugin_info);
+
+  if (ide_str_empty0 (peas_plugin_info_get_external_data (plugin_info, trigger_keys[IDE_PLUGIN_TRIGGER_ACTION])) ||
+      !g_str_has_prefix (data_dir, "resource://"))
+    return;
+
+  /* Don't show menus for plugins which could never be activated */
+  circular = g_hash_table_new (g_str_hash, g_str_equal);
+  if (!ide_application_can_load_plugin (self, plugin_info, circular))
+    return;
+
+  _ide_application_add_resources (self, data_dir);
+  g_object_set_data (G_OBJECT (plugin_info), "IDE_RESOURCES_ADDED", GINT_TO_POINTER (TRUE));
+}
+
 static void
 ide_application_plugins_unload_plugin_after_cb (IdeApplication *self,
                                                 PeasPluginInfo *plugin_info,
@@ -286,6 +365,60 @@ ide_application_plugins_unload_plugin_after_cb (IdeApplication *self,
            module_name, module_dir);
 }
 
+static gboolean
+ide_application_plugin_has_triggers (PeasPluginInfo *plugin_info)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (trigger_keys); i++)
+    {
+      if (!ide_str_empty0 (peas_plugin_info_get_external_data (plugin_info, trigger_keys[i])))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+ide_application_plugin_matches_trigger (PeasPluginInfo   *plugin_info,
+                                        IdePluginTrigger  trigger,
+                                        const char       *value)
+{
+  g_autofree char *delimit = NULL;
+  g_auto(GStrv) values = NULL;
+  const char *data;
+
+  if (!(data = peas_plugin_info_get_external_data (plugin_info, trigger_keys[trigger])))
+    return FALSE;
+
+  delimit = g_strdelimit (g_strdup (data), ";,", ';');
+  values = g_strsplit (delimit, ";", 0);
+
+  for (guint i = 0; values[i]; i++)
+    {
+      const char *item = g_strstrip (values[i]);
+
+      if (item[0] == 0)
+        continue;
+
+      switch (trigger)
+        {
+        case IDE_PLUGIN_TRIGGER_FILE:
+          if (g_pattern_match_simple (item, value))
+            return TRUE;
+          break;
+
+        case IDE_PLUGIN_TRIGGER_LANGUAGE:
+        case IDE_PLUGIN_TRIGGER_BUILD_SYSTEM:
+        case IDE_PLUGIN_TRIGGER_ACTION:
+        default:
+          if (g_str_equal (item, value))
+            return TRUE;
+          break;
+        }
+    }
+
+  return FALSE;
+}
+
 /**
  * _ide_application_load_plugins_for_startup:
  *
@@ -298,6 +431,7 @@ void
 _ide_application_load_plugins_for_startup (IdeApplication *self)
 {
   PeasEngine *engine;
+  gint64 begin_time;
   guint n_items;
 
   IDE_ENTRY;
@@ -306,6 +440,13 @@ _ide_application_load_plugins_for_startup (IdeApplication *self)
   g_assert (IDE_IS_APPLICATION (self));
 
   engine = peas_engine_get_default ();
+  begin_time = g_get_monotonic_time ();
+
+  g_signal_connect_object (engine,
+                           "load-plugin",
+                           G_CALLBACK (ide_application_plugins_load_plugin_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
 
   g_signal_connect_object (engine,
                            "load-plugin",
@@ -354,6 +495,8 @@ _ide_application_load_plugins_for_startup (IdeApplication *self)
         _ide_application_load_plugin (self, plugin_info);
     }
 
+  _ide_trace_mark (begin_time, g_get_monotonic_time (), "startup", "load-plugins-for-startup", NULL);
+
   IDE_EXIT;
 }
 
@@ -368,12 +511,15 @@ void
 _ide_application_load_plugins (IdeApplication *self)
 {
   g_autofree gchar *user_plugins_dir = NULL;
+  g_autofree gchar *message = NULL;
   PeasEngine *engine;
+  gint64 begin_time;
   guint n_items;
 
   g_assert (IDE_IS_APPLICATION (self));
 
   engine = peas_engine_get_default ();
+  begin_time = g_get_monotonic_time ();
 
   /* Now that we have gotten past our startup plugins (which must be
    * embedded into the gnome-builder executable, we can enable the
@@ -422,9 +568,134 @@ _ide_application_load_plugins (IdeApplication *self)
     {
       g_autoptr(PeasPluginInfo) plugin_info = g_list_model_get_item (G_LIST_MODEL (engine), i);
 
-      if (!peas_plugin_info_is_loaded (plugin_info))
+      if (peas_plugin_info_is_loaded (plugin_info))
+        continue;
+
+      if (ide_application_plugin_has_triggers (plugin_info))
+        {
+          ide_application_plugins_add_action_resources (self, plugin_info);
+          g_ptr_array_add (self->deferred_plugins, g_steal_pointer (&plugin_info));
+        }
+      else
         _ide_application_load_plugin (self, plugin_info);
     }
+
+  message = g_strdup_printf ("%u plugins deferred", self->deferred_plugins->len);
+  _ide_trace_mark (begin_time, g_get_monotonic_time (), "startup", "load-plugins", message);
+
+  g_debug ("Loaded plugins in %.3lf seconds, %s",
+           (g_get_monotonic_time () - begin_time) / (double)G_USEC_PER_SEC,
+           message);
+}
+
+/**
+ * _ide_application_activate_plugins:
+ * @self: a #IdeApplication
+ * @trigger: the kind of trigger
+ * @value: the language, build system, file name or action which fired
+ *
+ * Loads the plugins that were deferred at startup and have declared
+ * a matching "X-Activate-On-*" key in their .plugin manifest.
+ */
+void
+_ide_application_activate_plugins (IdeApplication   *self,
+                                   IdePluginTrigger  trigger,
+                                   const char       *value)
+{
+  g_autoptr(GPtrArray) matched = NULL;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (IDE_IS_APPLICATION (self));
+  g_return_if_fail (trigger < G_N_ELEMENTS (trigger_keys));
+
+  if (self->deferred_plugins->len == 0 || ide_str_empty0 (value))
+    IDE_EXIT;
+
+  /* Collect first as loading a plugin may load deferred dependencies */
+  matched = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = self->deferred_plugins->len; i > 0; i--)
+    {
+      PeasPluginInfo *plugin_info = g_ptr_array_index (self->deferred_plugins, i - 1);
+
+      if (peas_plugin_info_is_loaded (plugin_info) ||
+          ide_application_plugin_matches_trigger (plugin_info, trigger, value))
+        g_ptr_array_add (matched, g_ptr_array_steal_index (self->deferred_plugins, i - 1));
+    }
+
+  for (guint i = 0; i < matched->len; i++)
+    {
+      PeasPluginInfo *plugin_info = g_ptr_array_index (matched, i);
+
+      if (peas_plugin_info_is_loaded (plugin_info))
+        continue;
+
+      g_debug ("Activating plugin \"%s\" for %s \"%s\"",
+               peas_plugin_info_get_module_name (plugin_info),
+               trigger_keys[trigger],
+               value);
+
+      _ide_application_load_plugin (self, plugin_info);
+    }
+
+  IDE_EXIT;
+}
+
+/**
+ * _ide_application_list_deferred_plugins:
+ * @self: a #IdeApplication
+ *
+ * Returns: (transfer container) (element-type PeasPluginInfo): the
+ *   plugins which have not been loaded yet because none of their
+ *   triggers have fired
+ */
+GPtrArray *
+_ide_application_list_deferred_plugins (IdeApplication *self)
+{
+  GPtrArray *ret;
+
+  g_return_val_if_fail (IDE_IS_APPLICATION (self), NULL);
+
+  ret = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; i < self->deferred_plugins->len; i++)
+    {
+      PeasPluginInfo *plugin_info = g_ptr_array_index (self->deferred_plugins, i);
+
+      if (!peas_plugin_info_is_loaded (plugin_info))
+        g_ptr_array_add (ret, g_object_ref (plugin_info));
+    }
+
+  return ret;
+}
+
+/**
+ * _ide_application_complete_startup:
+ * @self: a #IdeApplication
+ *
+ * Records the end of the startup timeline, which is when the first
+ * buffer has been loaded and may be edited.
+ */
+void
+_ide_application_complete_startup (IdeApplication *self)
+{
+  g_return_if_fail (IDE_IS_APPLICATION (self));
+
+  if (self->startup_completed)
+    return;
+
+  self->startup_completed = TRUE;
+
+  _ide_trace_mark (self->startup_begin_time,
+                   g_get_monotonic_time (),
+                   "startup",
+                   "first-buffer",
+                   NULL);
+
+  g_debug ("First buffer loaded %.3lf seconds after startup",
+           (g_get_monotonic_time () - self->startup_begin_time) / (double)G_USEC_PER_SEC);
 }
 
 static void
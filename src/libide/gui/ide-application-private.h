@@ -30,6 +30,14 @@
 
 G_BEGIN_DECLS
 
+typedef enum
+{
+  IDE_PLUGIN_TRIGGER_LANGUAGE,
+  IDE_PLUGIN_TRIGGER_BUILD_SYSTEM,
+  IDE_PLUGIN_TRIGGER_FILE,
+  IDE_PLUGIN_TRIGGER_ACTION,
+} IdePluginTrigger;
+
 struct _IdeApplication
 {
   AdwApplication parent_instance;
@@ -49,6 +57,17 @@ struct _IdeApplication
    */
   GHashTable *plugin_settings;
 
+  /* Plugins declaring X-Activate-On-* triggers are not loaded with the
+   * rest of the plugins but when one of their triggers fires.
+   */
+  GPtrArray *deferred_plugins;
+
+  /* Begin time of plugins being loaded (dependencies nest) so that we
+   * can record the startup timeline.
+   */
+  GArray *plugin_load_times;
+  gint64 startup_begin_time;
+
   /* Addins which are created and destroyed with the application. We
    * create them in ::startup() (after early stage operations have
    * completed) and destroy them in ::shutdown().
@@ -101,12 +120,16 @@ struct _IdeApplication
 
   /* If all our typelibs were loaded successfully */
   guint loaded_typelibs : 1;
+
+  /* If we recorded the end of the startup timeline */
+  guint startup_completed : 1;
 };
 
 IdeApplication *_ide_application_new                      (gboolean                 standalone);
 void            _ide_application_init_color               (IdeApplication          *self);
 void            _ide_application_init_actions             (IdeApplication          *self);
 void            _ide_application_init_settings            (IdeApplication          *self);
+void            _ide_application_init_memory_budgets      (IdeApplication          *self);
 void            _ide_application_load_addins              (IdeApplication          *self);
 void            _ide_application_unload_addins            (IdeApplication          *self);
 void            _ide_application_load_plugin              (IdeApplication          *self,
@@ -114,6 +137,11 @@ void            _ide_application_load_plugin              (IdeApplication
 void            _ide_application_add_option_entries       (IdeApplication          *self);
 void            _ide_application_load_plugins_for_startup (IdeApplication          *self);
 void            _ide_application_load_plugins             (IdeApplication          *self);
+void            _ide_application_activate_plugins         (IdeApplication          *self,
+                                                           IdePluginTrigger         trigger,
+                                                           const char              *value);
+GPtrArray      *_ide_application_list_deferred_plugins    (IdeApplication          *self);
+void            _ide_application_complete_startup         (IdeApplication          *self);
 void            _ide_application_command_line             (IdeApplication          *self,
                                                            GApplicationCommandLine *cmdline);
 void            _ide_application_add_resources            (IdeApplication          *self,
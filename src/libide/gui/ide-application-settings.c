@@ -161,6 +161,79 @@ _ide_application_init_settings (IdeApplication *self)
     }
 }
 
+static void
+apply_memory_budgets (IdeApplication *self,
+                      guint           position,
+                      guint           n_items)
+{
+  g_autoptr(GVariant) budgets = NULL;
+  GListModel *accounts;
+
+  g_assert (IDE_IS_APPLICATION (self));
+
+  accounts = ide_memory_account_list ();
+  budgets = g_settings_get_value (self->settings, "memory-budgets");
+
+  for (guint i = position; i < position + n_items; i++)
+    {
+      g_autoptr(IdeMemoryAccount) account = g_list_model_get_item (accounts, i);
+      guint64 budget = 0;
+
+      /* Accounts without an entry have no budget */
+      g_variant_lookup (budgets, ide_memory_account_get_name (account), "t", &budget);
+      ide_memory_account_set_budget (account, budget);
+    }
+}
+
+static void
+on_memory_accounts_changed_cb (IdeApplication *self,
+                               guint           position,
+                               guint           removed,
+                               guint           added,
+                               GListModel     *accounts)
+{
+  g_assert (IDE_IS_APPLICATION (self));
+  g_assert (G_IS_LIST_MODEL (accounts));
+
+  apply_memory_budgets (self, position, added);
+}
+
+static void
+on_memory_budgets_changed_cb (IdeApplication *self,
+                              const char     *key,
+                              GSettings      *settings)
+{
+  g_assert (IDE_IS_APPLICATION (self));
+  g_assert (G_IS_SETTINGS (settings));
+
+  apply_memory_budgets (self, 0, g_list_model_get_n_items (ide_memory_account_list ()));
+}
+
+void
+_ide_application_init_memory_budgets (IdeApplication *self)
+{
+  GListModel *accounts;
+
+  g_return_if_fail (IDE_IS_APPLICATION (self));
+
+  /* Subsystems create their accounts lazily, so apply budgets to
+   * new accounts as they are registered too.
+   */
+  accounts = ide_memory_account_list ();
+  g_signal_connect_object (accounts,
+                           "items-changed",
+                           G_CALLBACK (on_memory_accounts_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (self->settings,
+                           "changed::memory-budgets",
+                           G_CALLBACK (on_memory_budgets_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  apply_memory_budgets (self, 0, g_list_model_get_n_items (accounts));
+}
+
 void
 ide_application_set_style_scheme (IdeApplication *self,
                                   const char     *style_scheme)
@@ -231,6 +231,9 @@ ide_application_startup (GApplication *app)
   /* Load color settings (Night Light, Dark Mode, etc) */
   _ide_application_init_color (self);
 
+  /* Apply memory budgets so caches evict when they grow too large */
+  _ide_application_init_memory_budgets (self);
+
   /* And now we can load the rest of our plugins for startup. */
   _ide_application_load_plugins (self);
 
@@ -514,6 +517,8 @@ ide_application_dispose (GObject *object)
   g_clear_pointer (&self->started_at, g_date_time_unref);
   g_clear_pointer (&self->workbenches, g_ptr_array_unref);
   g_clear_pointer (&self->plugin_settings, g_hash_table_unref);
+  g_clear_pointer (&self->deferred_plugins, g_ptr_array_unref);
+  g_clear_pointer (&self->plugin_load_times, g_array_unref);
   g_clear_pointer (&self->plugin_gresources, g_hash_table_unref);
   g_clear_pointer (&self->css_providers, g_hash_table_unref);
   g_clear_pointer (&self->argv, g_strfreev);
@@ -587,6 +592,9 @@ ide_application_init (IdeApplication *self)
   self->menu_merge_ids = g_hash_table_new (g_str_hash, g_str_equal);
   self->menu_manager = ide_menu_manager_new ();
   self->started_at = g_date_time_new_now_local ();
+  self->startup_begin_time = g_get_monotonic_time ();
+  self->deferred_plugins = g_ptr_array_new_with_free_func (g_object_unref);
+  self->plugin_load_times = g_array_new (FALSE, FALSE, sizeof (gint64));
   self->workspace_type = IDE_TYPE_PRIMARY_WORKSPACE;
   self->workbenches = g_ptr_array_new_with_free_func (g_object_unref);
   self->settings = g_settings_new ("org.gnome.builder");
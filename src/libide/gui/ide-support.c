@@ -156,6 +156,13 @@ ide_get_support_log (void)
     }
   g_string_append (str, "\n");
 
+  /*
+   * Log memory used by each subsystem.
+   */
+  tmp = ide_memory_account_report ();
+  g_string_append (str, tmp);
+  g_free (tmp);
+
   /*
    * Log the environment variables.
    */
@@ -241,6 +241,49 @@ ide_workbench_addin_can_open (IdeWorkbenchAddin *self,
   return FALSE;
 }
 
+/**
+ * ide_workbench_addin_can_open_with_info:
+ * @self: an #IdeWorkbenchAddin
+ * @file: a #GFile
+ * @info: a #GFileInfo queried by the workbench for @file
+ * @priority: (out): a location for the priority
+ *
+ * Like ide_workbench_addin_can_open() but provides the #GFileInfo the
+ * workbench queried for @file, which contains at least the content-type
+ * and size, if they could be determined. Addins which need more than the
+ * content-type may use this instead of blocking on I/O.
+ *
+ * Returns: %TRUE if @self can open @file
+ *
+ * Since: 46
+ */
+gboolean
+ide_workbench_addin_can_open_with_info (IdeWorkbenchAddin *self,
+                                        GFile             *file,
+                                        GFileInfo         *info,
+                                        gint              *priority)
+{
+  const char *content_type = NULL;
+  gint real_priority;
+
+  g_return_val_if_fail (IDE_IS_WORKBENCH_ADDIN (self), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (G_IS_FILE_INFO (info), FALSE);
+
+  if (priority == NULL)
+    priority = &real_priority;
+  else
+    *priority = 0;
+
+  if (IDE_WORKBENCH_ADDIN_GET_IFACE (self)->can_open_with_info)
+    return IDE_WORKBENCH_ADDIN_GET_IFACE (self)->can_open_with_info (self, file, info, priority);
+
+  if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
+    content_type = g_file_info_get_content_type (info);
+
+  return ide_workbench_addin_can_open (self, file, content_type, priority);
+}
+
 void
 ide_workbench_addin_open_async (IdeWorkbenchAddin   *self,
                                 GFile               *file,
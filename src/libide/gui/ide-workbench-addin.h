@@ -89,6 +89,10 @@ struct _IdeWorkbenchAddinInterface
                                           IdeSession            *session);
   void          (*restore_session)       (IdeWorkbenchAddin     *self,
                                           IdeSession            *session);
+  gboolean      (*can_open_with_info)    (IdeWorkbenchAddin     *self,
+                                          GFile                 *file,
+                                          GFileInfo             *info,
+                                          gint                  *priority);
 };
 
 IDE_AVAILABLE_IN_ALL
@@ -131,6 +135,11 @@ gboolean           ide_workbench_addin_can_open              (IdeWorkbenchAddin
                                                               GFile                *file,
                                                               const gchar          *content_type,
                                                               gint                 *priority);
+IDE_AVAILABLE_IN_46
+gboolean           ide_workbench_addin_can_open_with_info    (IdeWorkbenchAddin    *self,
+                                                              GFile                *file,
+                                                              GFileInfo            *info,
+                                                              gint                 *priority);
 IDE_AVAILABLE_IN_ALL
 void               ide_workbench_addin_open_async            (IdeWorkbenchAddin    *self,
                                                               GFile                *file,
@@ -34,6 +34,7 @@
 #include "ide-build-private.h"
 #include "ide-context-private.h"
 #include "ide-foundry-init.h"
+#include "ide-object-private.h"
 #include "ide-thread-private.h"
 #include "ide-transfer-manager-private.h"
 
@@ -92,6 +93,7 @@ typedef struct
   GFile              *file;
   gchar              *hint;
   gchar              *content_type;
+  GFileInfo          *info;
   PanelPosition      *position;
   IdeBufferOpenFlags  flags;
   gint                at_line;
@@ -175,6 +177,7 @@ open_free (Open *o)
   g_clear_object (&o->file);
   g_clear_pointer (&o->hint, g_free);
   g_clear_pointer (&o->content_type, g_free);
+  g_clear_object (&o->info);
   g_slice_free (Open, o);
 }
 
@@ -209,6 +212,52 @@ ide_workbench_from_context (IdeContext *context)
   return IDE_WORKBENCH (g_object_get_data (G_OBJECT (context), "WORKBENCH"));
 }
 
+static void
+ide_workbench_load_buffer_cb (IdeWorkbench     *self,
+                              IdeBuffer        *buffer,
+                              IdeBufferManager *bufmgr)
+{
+  g_autofree char *name = NULL;
+  GtkSourceLanguage *language;
+  GFile *file;
+
+  g_assert (IDE_IS_WORKBENCH (self));
+  g_assert (IDE_IS_BUFFER (buffer));
+  g_assert (IDE_IS_BUFFER_MANAGER (bufmgr));
+
+  if (!(file = ide_buffer_get_file (buffer)) ||
+      !(name = g_file_get_basename (file)))
+    return;
+
+  /* Activate plugins before the buffer is loaded so that its addins are
+   * created along with everything else rather than trickling in later.
+   */
+  _ide_application_activate_plugins (IDE_APPLICATION_DEFAULT, IDE_PLUGIN_TRIGGER_FILE, name);
+
+  if ((language = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), name, NULL)))
+    _ide_application_activate_plugins (IDE_APPLICATION_DEFAULT,
+                                       IDE_PLUGIN_TRIGGER_LANGUAGE,
+                                       gtk_source_language_get_id (language));
+}
+
+static void
+ide_workbench_buffer_loaded_cb (IdeWorkbench     *self,
+                                IdeBuffer        *buffer,
+                                IdeBufferManager *bufmgr)
+{
+  g_assert (IDE_IS_WORKBENCH (self));
+  g_assert (IDE_IS_BUFFER (buffer));
+  g_assert (IDE_IS_BUFFER_MANAGER (bufmgr));
+
+  /* Content sniffing may have found a different language than the file
+   * name suggested when the buffer started loading.
+   */
+  _ide_application_activate_plugins (IDE_APPLICATION_DEFAULT,
+                                     IDE_PLUGIN_TRIGGER_LANGUAGE,
+                                     ide_buffer_get_language_id (buffer));
+  _ide_application_complete_startup (IDE_APPLICATION_DEFAULT);
+}
+
 static void
 ide_workbench_set_context (IdeWorkbench *self,
                            IdeContext   *context)
@@ -231,6 +280,17 @@ ide_workbench_set_context (IdeWorkbench *self,
   /* Make sure we have access to buffer manager early */
   bufmgr = ide_object_ensure_child_typed (IDE_OBJECT (context), IDE_TYPE_BUFFER_MANAGER);
 
+  g_signal_connect_object (bufmgr,
+                           "load-buffer",
+                           G_CALLBACK (ide_workbench_load_buffer_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (bufmgr,
+                           "buffer-loaded",
+                           G_CALLBACK (ide_workbench_buffer_loaded_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   /* And use a fallback build system if one is not already available */
   if ((build_system = ide_context_peek_child_typed (context, IDE_TYPE_BUILD_SYSTEM)))
     self->build_system = g_object_ref (build_system);
@@ -238,6 +298,168 @@ ide_workbench_set_context (IdeWorkbench *self,
     self->build_system = ide_object_ensure_child_typed (IDE_OBJECT (context), IDE_TYPE_FALLBACK_BUILD_SYSTEM);
 }
 
+typedef struct
+{
+  IdeWorkbench *self;
+  GActionGroup *placeholder;
+  char         *prefix;
+  char         *name;
+} DeferredAction;
+
+static void
+deferred_action_free (DeferredAction *state)
+{
+  g_clear_object (&state->self);
+  g_clear_object (&state->placeholder);
+  g_clear_pointer (&state->prefix, g_free);
+  g_clear_pointer (&state->name, g_free);
+  g_slice_free (DeferredAction, state);
+}
+
+static gboolean
+ide_workbench_activate_deferred_action (gpointer data)
+{
+  DeferredAction *state = data;
+  g_autofree char *action_name = NULL;
+  IdeActionMuxer *muxer;
+
+  g_assert (IDE_IS_WORKBENCH (state->self));
+  g_assert (state->prefix != NULL);
+  g_assert (state->name != NULL);
+
+  if (state->self->unloaded)
+    return G_SOURCE_REMOVE;
+
+  action_name = g_strdup_printf ("%s.%s", state->prefix, state->name);
+
+  _ide_application_activate_plugins (IDE_APPLICATION_DEFAULT,
+                                     IDE_PLUGIN_TRIGGER_ACTION,
+                                     action_name);
+
+  /* Addins usually replace the placeholder by inserting their action
+   * group under the same prefix. If it is still there, the plugin
+   * provides the action some other way (or failed to load) so remove
+   * ours to not end up back here.
+   */
+  muxer = ide_action_mixin_get_action_muxer (state->self);
+
+  if (ide_action_muxer_get_action_group (muxer, state->prefix) == state->placeholder)
+    {
+      g_auto(GStrv) remaining = NULL;
+
+      g_action_map_remove_action (G_ACTION_MAP (state->placeholder), state->name);
+      remaining = g_action_group_list_actions (state->placeholder);
+
+      if (remaining[0] == NULL)
+        ide_action_muxer_insert_action_group (muxer, state->prefix, NULL);
+    }
+
+  if (g_action_group_has_action (G_ACTION_GROUP (muxer), action_name))
+    g_action_group_activate_action (G_ACTION_GROUP (muxer), action_name, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ide_workbench_deferred_action_cb (GSimpleAction *action,
+                                  GVariant      *param,
+                                  gpointer       user_data)
+{
+  IdeWorkbench *self = user_data;
+  DeferredAction *state;
+
+  g_assert (G_IS_SIMPLE_ACTION (action));
+  g_assert (IDE_IS_WORKBENCH (self));
+
+  /* Loading the plugin replaces the action group which is currently
+   * being activated, so do that once the activation has completed.
+   */
+  state = g_slice_new0 (DeferredAction);
+  state->self = g_object_ref (self);
+  state->placeholder = g_object_ref (g_object_get_data (G_OBJECT (action), "PLACEHOLDER"));
+  state->prefix = g_strdup (g_object_get_data (G_OBJECT (state->placeholder), "PREFIX"));
+  state->name = g_strdup (g_action_get_name (G_ACTION (action)));
+
+  g_idle_add_full (G_PRIORITY_HIGH,
+                   ide_workbench_activate_deferred_action,
+                   state,
+                   (GDestroyNotify)deferred_action_free);
+}
+
+static void
+ide_workbench_add_deferred_actions (IdeWorkbench *self)
+{
+  g_autoptr(GHashTable) placeholders = NULL;
+  g_autoptr(GPtrArray) deferred = NULL;
+  IdeActionMuxer *muxer;
+
+  g_assert (IDE_IS_WORKBENCH (self));
+
+  muxer = ide_action_mixin_get_action_muxer (self);
+  deferred = _ide_application_list_deferred_plugins (IDE_APPLICATION_DEFAULT);
+  placeholders = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+  /* Plugins activated by an action get parameterless placeholder
+   * actions under the prefix they declared in X-Activate-On-Action,
+   * which activate the plugin and then forward to the real action.
+   */
+  for (guint i = 0; i < deferred->len; i++)
+    {
+      PeasPluginInfo *plugin_info = g_ptr_array_index (deferred, i);
+      g_autofree char *delimit = NULL;
+      g_auto(GStrv) names = NULL;
+      const char *data;
+
+      if (!(data = peas_plugin_info_get_external_data (plugin_info, "Activate-On-Action")))
+        continue;
+
+      delimit = g_strdelimit (g_strdup (data), ";,", ';');
+      names = g_strsplit (delimit, ";", 0);
+
+      for (guint j = 0; names[j]; j++)
+        {
+          g_autoptr(GSimpleAction) action = NULL;
+          g_autofree char *prefix = NULL;
+          const char *detailed = g_strstrip (names[j]);
+          GSimpleActionGroup *group;
+          const char *dot;
+
+          if (!(dot = strchr (detailed, '.')) ||
+              dot == detailed ||
+              !g_action_name_is_valid (dot + 1))
+            {
+              if (detailed[0] != 0)
+                g_warning ("Plugin \"%s\" has invalid action \"%s\" in X-Activate-On-Action",
+                           peas_plugin_info_get_module_name (plugin_info), detailed);
+              continue;
+            }
+
+          prefix = g_strndup (detailed, dot - detailed);
+
+          if (!(group = g_hash_table_lookup (placeholders, prefix)))
+            {
+              /* Never shadow an action group which is already there */
+              if (ide_action_muxer_get_action_group (muxer, prefix) != NULL)
+                continue;
+
+              group = g_simple_action_group_new ();
+              g_object_set_data_full (G_OBJECT (group), "PREFIX", g_strdup (prefix), g_free);
+              g_hash_table_insert (placeholders, g_strdup (prefix), group);
+              ide_action_muxer_insert_action_group (muxer, prefix, G_ACTION_GROUP (group));
+            }
+
+          action = g_simple_action_new (dot + 1, NULL);
+          g_object_set_data (G_OBJECT (action), "PLACEHOLDER", group);
+          g_signal_connect_object (action,
+                                   "activate",
+                                   G_CALLBACK (ide_workbench_deferred_action_cb),
+                                   self,
+                                   0);
+          g_action_map_add_action (G_ACTION_MAP (group), G_ACTION (action));
+        }
+    }
+}
+
 static void
 ide_workbench_addin_added_workspace_cb (IdeWorkspace      *workspace,
                                         IdeWorkbenchAddin *addin)
@@ -405,6 +627,8 @@ ide_workbench_constructed (GObject *object)
                                     "parent", self->context,
                                     NULL);
 
+  ide_workbench_add_deferred_actions (self);
+
   self->addins = peas_extension_set_new (peas_engine_get_default (),
                                          IDE_TYPE_WORKBENCH_ADDIN,
                                          NULL);
@@ -1382,10 +1606,16 @@ ide_workbench_action_object_tree (gpointer    instance,
                                   GVariant   *param)
 {
   IdeWorkbench *self = instance;
+  guint n_contended = 0;
+  guint n_read_contended = 0;
 
   g_assert (IDE_IS_WORKBENCH (self));
 
   print_object_tree (IDE_OBJECT (self->context), NULL);
+
+  _ide_object_get_lock_stats (&n_contended, &n_read_contended);
+  g_print ("\nLock contention: %u (tree mutations), %u (tree reads)\n",
+           n_contended, n_read_contended);
 }
 
 static void
@@ -2073,10 +2303,10 @@ sort_by_priority (gconstpointer a,
   gint prio_a = 0;
   gint prio_b = 0;
 
-  if (!ide_workbench_addin_can_open (addin_a, o->file, o->content_type, &prio_a))
+  if (!ide_workbench_addin_can_open_with_info (addin_a, o->file, o->info, &prio_a))
     return 1;
 
-  if (!ide_workbench_addin_can_open (addin_b, o->file, o->content_type, &prio_b))
+  if (!ide_workbench_addin_can_open_with_info (addin_b, o->file, o->info, &prio_b))
     return -1;
 
   if (prio_a < prio_b)
@@ -2112,8 +2342,15 @@ ide_workbench_open_query_info_cb (GObject      *object,
   g_assert (o->addins != NULL);
   g_assert (o->addins->len > 0);
 
+  /* Addins get an empty info if the query failed so they do not
+   * need to handle %NULL.
+   */
   if ((info = g_file_query_info_finish (file, result, &error)))
     o->content_type = g_strdup (g_file_info_get_content_type (info));
+  else
+    info = g_file_info_new ();
+
+  o->info = g_object_ref (info);
 
   /* Remove unsupported addins while iterating backwards so that
    * we can preserve the ordering of the array as we go.
@@ -2123,7 +2360,7 @@ ide_workbench_open_query_info_cb (GObject      *object,
       IdeWorkbenchAddin *addin = g_ptr_array_index (o->addins, i - 1);
       gint prio = G_MAXINT;
 
-      if (!ide_workbench_addin_can_open (addin, o->file, o->content_type, &prio))
+      if (!ide_workbench_addin_can_open_with_info (addin, o->file, o->info, &prio))
         {
           g_ptr_array_remove_index_fast (o->addins, i - 1);
           if (o->preferred == addin)
@@ -2285,7 +2522,8 @@ ide_workbench_open_at_async (IdeWorkbench        *self,
   ide_task_set_task_data (task, o, open_free);
 
   g_file_query_info_async (file,
-                           G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+                           G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE","
+                           G_FILE_ATTRIBUTE_STANDARD_SIZE,
                            G_FILE_QUERY_INFO_NONE,
                            G_PRIORITY_DEFAULT,
                            cancellable,
@@ -2532,6 +2770,7 @@ ide_workbench_set_build_system (IdeWorkbench   *self,
                                 IdeBuildSystem *build_system)
 {
   g_autoptr(IdeBuildSystem) local_build_system = NULL;
+  g_autofree char *id = NULL;
   IdeBuildManager *build_manager;
 
   g_return_if_fail (IDE_IS_WORKBENCH (self));
@@ -2561,6 +2800,12 @@ ide_workbench_set_build_system (IdeWorkbench   *self,
                       (GFunc)remove_non_matching_build_systems_cb,
                       build_system);
 
+  /* Load plugins which only apply to this build system before the
+   * pipeline is created so their pipeline addins take part.
+   */
+  id = ide_build_system_get_id (build_system);
+  _ide_application_activate_plugins (IDE_APPLICATION_DEFAULT, IDE_PLUGIN_TRIGGER_BUILD_SYSTEM, id);
+
   /* Ask the build-manager to setup a new pipeline */
   if ((build_manager = ide_context_peek_child_typed (self->context, IDE_TYPE_BUILD_MANAGER)))
     ide_build_manager_invalidate (build_manager);
@@ -31,6 +31,8 @@ typedef struct
   gpointer      key;
   gpointer      value;
   gint64        evict_at;
+  gsize         size;
+  GList         lru_link;
 } CacheItem;
 
 typedef struct
@@ -57,6 +59,7 @@ struct _IdeTaskCache
   GBoxedFreeFunc        key_destroy_func;
   GBoxedCopyFunc        value_copy_func;
   GBoxedFreeFunc        value_destroy_func;
+  IdeTaskCacheSizeFunc  size_func;
 
   IdeTaskCacheCallback  populate_callback;
   gpointer              populate_callback_data;
@@ -73,6 +76,10 @@ struct _IdeTaskCache
   guint                 evict_source_id;
 
   gint64                time_to_live_usec;
+
+  IdeTaskCacheStats     stats;
+
+  guint                 evictable : 1;
 };
 
 G_DEFINE_FINAL_TYPE (IdeTaskCache, ide_task_cache, G_TYPE_OBJECT)
@@ -94,6 +101,22 @@ enum {
 
 static GParamSpec *properties [LAST_PROP];
 
+/* Entries from every evictable cache, most recently used first. Caches
+ * are only used from the main thread, so this needs no locking.
+ */
+static GQueue lru;
+
+static IdeMemoryAccount *
+get_memory_account (void)
+{
+  static IdeMemoryAccount *account;
+
+  if (g_once_init_enter (&account))
+    g_once_init_leave (&account, ide_memory_account_get ("task-cache", _("Cached Results")));
+
+  return account;
+}
+
 static gboolean
 evict_source_check (GSource *source)
 {
@@ -171,6 +194,16 @@ cache_item_free (gpointer data)
 {
   CacheItem *item = data;
 
+  if (item->lru_link.data != NULL)
+    {
+      ide_memory_account_discharge (get_memory_account (), item->size);
+      g_queue_unlink (&lru, &item->lru_link);
+      item->lru_link.data = NULL;
+    }
+
+  item->self->stats.size -= item->size;
+  item->self->stats.n_items--;
+
   g_clear_pointer (&item->key, item->self->key_destroy_func);
   g_clear_pointer (&item->value, item->self->value_destroy_func);
   item->self = NULL;
@@ -219,6 +252,23 @@ cache_item_new (IdeTaskCache  *self,
   if (self->time_to_live_usec > 0)
     ret->evict_at = g_get_monotonic_time () + self->time_to_live_usec;
 
+  ret->size = sizeof *ret;
+  if (self->size_func != NULL)
+    ret->size += self->size_func (ret->value);
+
+  /* Only entries which may be evicted count against the budget, otherwise
+   * the budget could only be met by evicting everything else.
+   */
+  if (self->evictable)
+    {
+      ide_memory_account_charge (get_memory_account (), ret->size);
+      ret->lru_link.data = ret;
+      g_queue_push_head_link (&lru, &ret->lru_link);
+    }
+
+  self->stats.size += ret->size;
+  self->stats.n_items++;
+
   return ret;
 }
 
@@ -275,7 +325,7 @@ ide_task_cache_evict_full (IdeTaskCache  *self,
 
   if ((item = g_hash_table_lookup (self->cache, key)))
     {
-      if (check_heap)
+      if (check_heap && self->time_to_live_usec > 0)
         {
           gsize i;
 
@@ -328,6 +378,27 @@ ide_task_cache_evict_all (IdeTaskCache *self)
     evict_source_rearm (self->evict_source);
 }
 
+static gpointer
+ide_task_cache_lookup (IdeTaskCache  *self,
+                       gconstpointer  key)
+{
+  CacheItem *item;
+
+  g_assert (IDE_IS_TASK_CACHE (self));
+
+  if (!(item = g_hash_table_lookup (self->cache, key)))
+    return NULL;
+
+  /* Move to the front so it is the last to be evicted */
+  if (item->lru_link.data != NULL)
+    {
+      g_queue_unlink (&lru, &item->lru_link);
+      g_queue_push_head_link (&lru, &item->lru_link);
+    }
+
+  return item->value;
+}
+
 /**
  * ide_task_cache_peek:
  * @self: An #IdeTaskCache
@@ -336,6 +407,9 @@ ide_task_cache_evict_all (IdeTaskCache *self)
  * Peeks to see @key is contained in the cache and returns the
  * matching #GObject if it does.
  *
+ * Like ide_task_cache_get_async(), this marks the entry as recently used
+ * so that it is the last to be evicted.
+ *
  * The reference count of the resulting #GObject is not incremented.
  * For that reason, it is important to remember that this function
  * may only be called from the main thread.
@@ -347,14 +421,9 @@ gpointer
 ide_task_cache_peek (IdeTaskCache  *self,
                      gconstpointer  key)
 {
-  CacheItem *item;
-
   g_return_val_if_fail (IDE_IS_TASK_CACHE (self), NULL);
 
-  if (NULL != (item = g_hash_table_lookup (self->cache, key)))
-    return item->value;
-
-  return NULL;
+  return ide_task_cache_lookup (self, key);
 }
 
 static void
@@ -399,7 +468,10 @@ ide_task_cache_populate (IdeTaskCache  *self,
   if (g_hash_table_contains (self->cache, key))
     ide_task_cache_evict (self, key);
   g_hash_table_insert (self->cache, item->key, item);
-  ide_heap_insert_val (self->evict_heap, item);
+
+  /* Only entries which expire need to be ordered by expiration */
+  if (self->time_to_live_usec > 0)
+    ide_heap_insert_val (self->evict_heap, item);
 
   if (self->evict_source != NULL)
     evict_source_rearm (self->evict_source);
@@ -576,8 +648,9 @@ ide_task_cache_get_async (IdeTaskCache        *self,
   /*
    * If we have the answer, return it now.
    */
-  if (!force_update && (ret = ide_task_cache_peek (self, key)))
+  if (!force_update && (ret = ide_task_cache_lookup (self, key)))
     {
+      self->stats.hits++;
       g_task_return_pointer (task,
                              self->value_copy_func (ret),
                              self->value_destroy_func);
@@ -602,10 +675,17 @@ ide_task_cache_get_async (IdeTaskCache        *self,
    * The in_flight hashtable will have a bit set if we have queued
    * an operation for this key.
    */
-  if (!g_hash_table_contains (self->in_flight, key))
+  if (g_hash_table_contains (self->in_flight, key))
+    {
+      /* Single-flight, this request will share the populate result */
+      self->stats.coalesced++;
+    }
+  else
     {
       g_autoptr(GCancellable) fetch_cancellable = NULL;
 
+      self->stats.misses++;
+
       fetch_cancellable = g_cancellable_new ();
       fetch_task = g_task_new (self,
                                fetch_cancellable,
@@ -673,6 +753,7 @@ ide_task_cache_do_eviction (gpointer user_data)
         {
           ide_heap_extract (self->evict_heap, NULL);
           ide_task_cache_evict_full (self, item->key, FALSE);
+          self->stats.expired++;
           continue;
         }
 
@@ -682,6 +763,34 @@ ide_task_cache_do_eviction (gpointer user_data)
   return G_SOURCE_CONTINUE;
 }
 
+static void
+ide_task_cache_over_budget_cb (IdeMemoryAccount *account,
+                               gpointer          user_data)
+{
+  guint count = 0;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_MEMORY_ACCOUNT (account));
+
+  /* The budget is shared by all caches, so evict the least recently used
+   * entries regardless of which cache they belong to. Entries are charged
+   * by their size, so large entries bring us back within budget sooner.
+   */
+  while (lru.tail != NULL &&
+         ide_memory_account_is_over_budget (account))
+    {
+      CacheItem *item = lru.tail->data;
+      IdeTaskCache *self = item->self;
+
+      ide_task_cache_evict_full (self, item->key, TRUE);
+      self->stats.evicted++;
+      count++;
+    }
+
+  if (count > 0)
+    g_debug ("Evicted %u items from task caches to satisfy memory budget", count);
+}
+
 static void
 ide_task_cache_install_evict_source (IdeTaskCache *self)
 {
@@ -784,8 +893,13 @@ ide_task_cache_dispose (GObject *object)
       count = g_hash_table_size (self->cache);
       g_clear_pointer (&self->cache, g_hash_table_unref);
 
-      g_debug ("Evicted cache of %"G_GINT64_FORMAT" items from %s",
-               count, self->name ?: "unnamed cache");
+      g_debug ("Evicted cache of %"G_GINT64_FORMAT" items from %s "
+               "(hits=%"G_GUINT64_FORMAT" misses=%"G_GUINT64_FORMAT" "
+               "coalesced=%"G_GUINT64_FORMAT" expired=%"G_GUINT64_FORMAT" "
+               "evicted=%"G_GUINT64_FORMAT")",
+               count, self->name ?: "unnamed cache",
+               self->stats.hits, self->stats.misses, self->stats.coalesced,
+               self->stats.expired, self->stats.evicted);
     }
 
   if (self->queued != NULL)
@@ -950,6 +1064,11 @@ ide_task_cache_class_init (IdeTaskCacheClass *klass)
                          (G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_properties (object_class, LAST_PROP, properties);
+
+  g_signal_connect (get_memory_account (),
+                    "over-budget",
+                    G_CALLBACK (ide_task_cache_over_budget_cb),
+                    NULL);
 }
 
 void
@@ -1040,3 +1159,70 @@ ide_task_cache_set_name (IdeTaskCache *self,
       g_source_set_name (self->evict_source, full_name);
     }
 }
+
+/**
+ * ide_task_cache_set_size_func: (skip)
+ * @self: a #IdeTaskCache
+ * @size_func: (nullable): a function to estimate the size of values
+ *
+ * Sets the function used to estimate how many bytes each cached value
+ * retains. This is reported by ide_task_cache_get_stats() and, if the
+ * cache is evictable, charged to the "task-cache" #IdeMemoryAccount.
+ *
+ * This only affects values added after calling this function.
+ *
+ * Since: 46
+ */
+void
+ide_task_cache_set_size_func (IdeTaskCache         *self,
+                              IdeTaskCacheSizeFunc  size_func)
+{
+  g_return_if_fail (IDE_IS_TASK_CACHE (self));
+
+  self->size_func = size_func;
+}
+
+/**
+ * ide_task_cache_set_evictable: (skip)
+ * @self: a #IdeTaskCache
+ * @evictable: if entries may be evicted to satisfy the memory budget
+ *
+ * Sets whether entries may be evicted when the "task-cache"
+ * #IdeMemoryAccount exceeds its budget, least recently used first across
+ * all evictable caches.
+ *
+ * Only caches whose entries can be populated again on demand should be
+ * evictable. Caches which are read with ide_task_cache_get_values() act
+ * as the store of record and must not be.
+ *
+ * This only affects values added after calling this function.
+ *
+ * Since: 46
+ */
+void
+ide_task_cache_set_evictable (IdeTaskCache *self,
+                              gboolean      evictable)
+{
+  g_return_if_fail (IDE_IS_TASK_CACHE (self));
+
+  self->evictable = !!evictable;
+}
+
+/**
+ * ide_task_cache_get_stats: (skip)
+ * @self: a #IdeTaskCache
+ * @stats: (out caller-allocates): location for the statistics
+ *
+ * Gets counters describing how effective the cache has been.
+ *
+ * Since: 46
+ */
+void
+ide_task_cache_get_stats (IdeTaskCache      *self,
+                          IdeTaskCacheStats *stats)
+{
+  g_return_if_fail (IDE_IS_TASK_CACHE (self));
+  g_return_if_fail (stats != NULL);
+
+  *stats = self->stats;
+}
@@ -53,6 +53,44 @@ typedef void (*IdeTaskCacheCallback) (IdeTaskCache  *self,
                                       GTask         *task,
                                       gpointer       user_data);
 
+/**
+ * IdeTaskCacheSizeFunc:
+ * @value: a value stored in the cache
+ *
+ * Estimates the number of bytes retained by @value, which is charged to
+ * the "task-cache" #IdeMemoryAccount while @value is in the cache.
+ *
+ * Returns: the approximate size of @value in bytes
+ *
+ * Since: 46
+ */
+typedef gsize (*IdeTaskCacheSizeFunc) (gconstpointer value);
+
+/**
+ * IdeTaskCacheStats:
+ * @n_items: the number of entries in the cache
+ * @size: the approximate number of bytes retained by the entries
+ * @hits: requests answered from the cache
+ * @misses: requests which required populating the cache
+ * @coalesced: requests which joined a populate already in flight
+ * @expired: entries evicted because their time-to-live elapsed
+ * @evicted: entries evicted to satisfy the memory budget
+ *
+ * Counters describing how an #IdeTaskCache has been used.
+ *
+ * Since: 46
+ */
+typedef struct
+{
+  guint   n_items;
+  gsize   size;
+  guint64 hits;
+  guint64 misses;
+  guint64 coalesced;
+  guint64 expired;
+  guint64 evicted;
+} IdeTaskCacheStats;
+
 IDE_AVAILABLE_IN_ALL
 IdeTaskCache *ide_task_cache_new        (GHashFunc              key_hash_func,
                                          GEqualFunc             key_equal_func,
@@ -67,6 +105,15 @@ IdeTaskCache *ide_task_cache_new        (GHashFunc              key_hash_func,
 IDE_AVAILABLE_IN_ALL
 void          ide_task_cache_set_name   (IdeTaskCache          *self,
                                          const gchar           *name);
+IDE_AVAILABLE_IN_46
+void          ide_task_cache_set_size_func (IdeTaskCache          *self,
+                                            IdeTaskCacheSizeFunc   size_func);
+IDE_AVAILABLE_IN_46
+void          ide_task_cache_set_evictable (IdeTaskCache          *self,
+                                            gboolean               evictable);
+IDE_AVAILABLE_IN_46
+void          ide_task_cache_get_stats     (IdeTaskCache          *self,
+                                            IdeTaskCacheStats     *stats);
 IDE_AVAILABLE_IN_ALL
 void          ide_task_cache_get_async  (IdeTaskCache          *self,
                                          gconstpointer          key,
@@ -31,26 +31,45 @@
 #include <libide-projects.h>
 #include <libide-threading.h>
 
+#include "ide-private.h"
+
 #include "ide-marshal.h"
 
 #include "ide-lsp-client.h"
 #include "ide-lsp-diagnostic.h"
 #include "ide-lsp-enums.h"
+#include "ide-lsp-metrics-private.h"
 #include "ide-lsp-workspace-edit.h"
 
+/* Error code a server replies with when it honored $/cancelRequest */
+#define LSP_REQUEST_CANCELLED (-32800)
+
 typedef struct
 {
   JsonrpcClient *client;
   GVariant      *id;
 } AsyncCall;
 
+typedef struct
+{
+  IdeLspClient  *self;
+  IdeTask       *task;
+  IdeLspMetrics *metrics;
+  GCancellable  *cancellable;
+  GVariant      *id;
+  char          *supersede_key;
+  gint64         begin_time;
+  gulong         cancelled_handler;
+  guint          superseded : 1;
+  guint          completed : 1;
+} ClientCall;
+
 typedef struct
 {
   GList         link;
-  IdeTask      *task;
+  ClientCall   *call;
   gchar        *method;
   GVariant     *params;
-  GCancellable *cancellable;
 } PendingMessage;
 
 typedef struct
@@ -68,6 +87,8 @@ typedef struct
   IdeLspTrace     trace;
   gboolean        initialized;
   GQueue          pending_messages;
+  GHashTable     *metrics_by_method;
+  GHashTable     *calls_by_supersede_key;
   guint           use_markdown_in_diagnostics : 1;
   guint           text_document_sync : 2;
 } IdeLspClientPrivate;
@@ -123,6 +144,168 @@ static void ide_lsp_client_call_cb (GObject      *object,
                                     GAsyncResult *result,
                                     gpointer      user_data);
 
+static void
+client_call_finalize (gpointer data)
+{
+  ClientCall *call = data;
+
+  g_assert (call->cancelled_handler == 0);
+
+  g_clear_object (&call->self);
+  g_clear_object (&call->task);
+  g_clear_object (&call->metrics);
+  g_clear_object (&call->cancellable);
+  g_clear_pointer (&call->id, g_variant_unref);
+  g_clear_pointer (&call->supersede_key, g_free);
+}
+
+static ClientCall *
+client_call_ref (ClientCall *call)
+{
+  return g_atomic_rc_box_acquire (call);
+}
+
+static void
+client_call_unref (gpointer data)
+{
+  g_atomic_rc_box_release_full (data, client_call_finalize);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ClientCall, client_call_unref);
+
+static void
+client_call_complete (ClientCall   *call,
+                      GVariant     *reply,
+                      const GError *error)
+{
+  IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (call->self);
+  g_autoptr(GError) local_error = NULL;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (call != NULL);
+  g_assert (!call->completed);
+  g_assert (IDE_IS_TASK (call->task));
+  g_assert (IDE_IS_LSP_METRICS (call->metrics));
+
+  call->completed = TRUE;
+
+  if (call->supersede_key != NULL &&
+      g_hash_table_lookup (priv->calls_by_supersede_key, call->supersede_key) == call)
+    g_hash_table_remove (priv->calls_by_supersede_key, call->supersede_key);
+
+  if (call->cancelled_handler != 0)
+    {
+      g_cancellable_disconnect (call->cancellable, call->cancelled_handler);
+      call->cancelled_handler = 0;
+    }
+
+  if (g_cancellable_is_cancelled (call->cancellable))
+    {
+      guint64 expected = ide_lsp_metrics_get_percentile (call->metrics, .50);
+      gint64 saved = 0;
+
+      /* Only count work that the server did not have to finish. That is
+       * everything if the request was never sent, otherwise the remainder
+       * of a typical call if the server acknowledged the cancellation.
+       */
+      if (call->id == NULL)
+        saved = expected;
+      else if (g_error_matches (error, JSONRPC_CLIENT_ERROR, LSP_REQUEST_CANCELLED))
+        saved = MAX (0, (gint64)expected - (g_get_monotonic_time () - call->begin_time));
+
+      _ide_lsp_metrics_cancelled (call->metrics, call->superseded, saved);
+
+      /* The caller has already been notified of cancellation, so drop any
+       * late reply without inspecting it.
+       */
+      local_error = g_error_new_literal (G_IO_ERROR,
+                                         G_IO_ERROR_CANCELLED,
+                                         _("The operation has been cancelled"));
+      error = local_error;
+      reply = NULL;
+    }
+
+  /* Round-trip includes time spent queued waiting for initialization */
+  _ide_lsp_metrics_end (call->metrics,
+                        call->begin_time,
+                        reply ? g_variant_get_size (reply) : 0,
+                        error);
+
+  if (_ide_trace_has_mark ())
+    _ide_trace_mark (call->begin_time,
+                     g_get_monotonic_time (),
+                     "lsp",
+                     call->superseded ? "superseded" : "call",
+                     ide_lsp_metrics_get_method (call->metrics));
+
+  if (error != NULL)
+    ide_task_return_error (call->task, g_error_copy (error));
+  else
+    ide_task_return_pointer (call->task,
+                             reply ? g_variant_ref (reply) : NULL,
+                             g_variant_unref);
+}
+
+static void pending_message_fail (PendingMessage *message);
+
+static gboolean
+client_call_cancelled_cb (gpointer data)
+{
+  ClientCall *call = data;
+  IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (call->self);
+  g_autoptr(GVariant) params = NULL;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+
+  if (call->completed)
+    return G_SOURCE_REMOVE;
+
+  /* Requests still waiting for initialization are never sent */
+  if (call->id == NULL)
+    {
+      for (const GList *iter = priv->pending_messages.head; iter; iter = iter->next)
+        {
+          PendingMessage *message = iter->data;
+
+          if (message->call == call)
+            {
+              g_queue_unlink (&priv->pending_messages, &message->link);
+              pending_message_fail (message);
+              break;
+            }
+        }
+
+      return G_SOURCE_REMOVE;
+    }
+
+  if (priv->rpc_client == NULL)
+    return G_SOURCE_REMOVE;
+
+  IDE_TRACE_MSG ("Cancelling %s request",
+                 ide_lsp_metrics_get_method (call->metrics));
+
+  params = JSONRPC_MESSAGE_NEW ("id", JSONRPC_MESSAGE_PUT_VARIANT (call->id));
+  jsonrpc_client_send_notification_async (priv->rpc_client,
+                                          "$/cancelRequest",
+                                          params,
+                                          NULL, NULL, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+client_call_cancelled (GCancellable *cancellable,
+                       ClientCall   *call)
+{
+  /* This may be called from any thread, and with the cancellable locked,
+   * so notify the language server from the main loop.
+   */
+  g_idle_add_full (G_PRIORITY_HIGH,
+                   client_call_cancelled_cb,
+                   client_call_ref (call),
+                   client_call_unref);
+}
+
 static GParamSpec *properties [N_PROPS];
 static guint signals [N_SIGNALS];
 
@@ -155,21 +338,21 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (AsyncCall, async_call_unref);
 static void
 pending_message_fail (PendingMessage *message)
 {
+  g_autoptr(GError) error = NULL;
+
   g_assert (message != NULL);
   g_assert (message->link.prev == NULL);
   g_assert (message->link.next == NULL);
   g_assert (message->link.data == message);
-  g_assert (IDE_IS_TASK (message->task));
-  g_assert (!message->cancellable || G_IS_CANCELLABLE (message->cancellable));
+  g_assert (message->call != NULL);
   g_assert (message->method != NULL);
 
-  ide_task_return_new_error (message->task,
-                             G_IO_ERROR,
-                             G_IO_ERROR_CANCELLED,
-                             _("The operation has been cancelled"));
+  error = g_error_new_literal (G_IO_ERROR,
+                               G_IO_ERROR_CANCELLED,
+                               _("The operation has been cancelled"));
+  client_call_complete (message->call, NULL, error);
 
-  g_clear_object (&message->task);
-  g_clear_object (&message->cancellable);
+  g_clear_pointer (&message->call, client_call_unref);
   g_clear_pointer (&message->method, g_free);
   g_clear_pointer (&message->params, g_variant_unref);
   g_slice_free (PendingMessage, message);
@@ -179,23 +362,29 @@ static void
 pending_message_submit (PendingMessage *message,
                         JsonrpcClient  *rpc_client)
 {
+  ClientCall *call;
+
   g_assert (JSONRPC_IS_CLIENT (rpc_client));
   g_assert (message != NULL);
   g_assert (message->link.prev == NULL);
   g_assert (message->link.next == NULL);
   g_assert (message->link.data == message);
-  g_assert (IDE_IS_TASK (message->task));
-  g_assert (!message->cancellable || G_IS_CANCELLABLE (message->cancellable));
+  g_assert (message->call != NULL);
   g_assert (message->method != NULL);
 
-  jsonrpc_client_call_async (rpc_client,
-                             message->method,
-                             message->params,
-                             message->cancellable,
-                             ide_lsp_client_call_cb,
-                             g_steal_pointer (&message->task));
+  call = g_steal_pointer (&message->call);
+
+  /* Cancellation is handled by ClientCall so that the reply to a
+   * $/cancelRequest can be observed.
+   */
+  jsonrpc_client_call_with_id_async (rpc_client,
+                                     message->method,
+                                     message->params,
+                                     &call->id,
+                                     NULL,
+                                     ide_lsp_client_call_cb,
+                                     call);
 
-  g_clear_object (&message->cancellable);
   g_clear_pointer (&message->method, g_free);
   g_clear_pointer (&message->params, g_variant_unref);
   g_slice_free (PendingMessage, message);
@@ -213,6 +402,12 @@ ide_lsp_client_supports_buffer (IdeLspClient *self,
   g_assert (IDE_IS_LSP_CLIENT (self));
   g_assert (IDE_IS_BUFFER (buffer));
 
+  /* Synchronizing every keystroke of a large file with the language
+   * server costs more than anything it can provide in return.
+   */
+  if (ide_buffer_get_is_large_file (buffer))
+    return FALSE;
+
   language = gtk_source_buffer_get_language (GTK_SOURCE_BUFFER (buffer));
   if (language != NULL)
     language_id = gtk_source_language_get_id (language);
@@ -1288,6 +1483,17 @@ ide_lsp_client_destroy (IdeObject *object)
       pending_message_fail (message);
     }
 
+  /* Metrics are only listed while the language server is running */
+  if (priv->metrics_by_method != NULL)
+    {
+      GHashTableIter iter;
+      IdeLspMetrics *metrics;
+
+      g_hash_table_iter_init (&iter, priv->metrics_by_method);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&metrics))
+        _ide_lsp_metrics_remove (metrics);
+    }
+
   IDE_OBJECT_CLASS (ide_lsp_client_parent_class)->destroy (object);
 }
 
@@ -1304,6 +1510,8 @@ ide_lsp_client_finalize (GObject *object)
   g_clear_pointer (&priv->server_capabilities, g_variant_unref);
   g_clear_pointer (&priv->languages, g_ptr_array_unref);
   g_clear_pointer (&priv->root_uri, g_free);
+  g_clear_pointer (&priv->metrics_by_method, g_hash_table_unref);
+  g_clear_pointer (&priv->calls_by_supersede_key, g_hash_table_unref);
   g_clear_object (&priv->rpc_client);
   g_clear_object (&priv->buffer_manager_signals);
   g_clear_object (&priv->project_signals);
@@ -1571,6 +1779,8 @@ ide_lsp_client_init (IdeLspClient *self)
                                                      (GEqualFunc)g_file_equal,
                                                      g_object_unref,
                                                      (GDestroyNotify)g_object_unref);
+  priv->metrics_by_method = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  priv->calls_by_supersede_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   priv->buffer_manager_signals = g_signal_group_new (IDE_TYPE_BUFFER_MANAGER);
 
@@ -2069,23 +2279,21 @@ ide_lsp_client_call_cb (GObject      *object,
                         gpointer      user_data)
 {
   JsonrpcClient *client = (JsonrpcClient *)object;
+  g_autoptr(ClientCall) call = user_data;
   g_autoptr(GVariant) reply = NULL;
   g_autoptr(GError) error = NULL;
-  g_autoptr(IdeTask) task = user_data;
 
   IDE_ENTRY;
 
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (JSONRPC_IS_CLIENT (client));
   g_assert (G_IS_ASYNC_RESULT (result));
-  g_assert (IDE_IS_TASK (task));
+  g_assert (call != NULL);
 
-  if (!jsonrpc_client_call_finish (client, result, &reply, &error))
-    ide_task_return_error (task, g_steal_pointer (&error));
-  else
-    ide_task_return_pointer (task,
-                             g_steal_pointer (&reply),
-                             g_variant_unref);
+  jsonrpc_client_call_finish (client, result, &reply, &error);
+
+  if (!call->completed)
+    client_call_complete (call, reply, error);
 
   IDE_EXIT;
 }
@@ -2094,8 +2302,7 @@ static void
 ide_lsp_client_queue_message (IdeLspClient *self,
                               const char   *method,
                               GVariant     *params,
-                              GCancellable *cancellable,
-                              IdeTask      *task)
+                              ClientCall   *call)
 
 {
   IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (self);
@@ -2105,23 +2312,146 @@ ide_lsp_client_queue_message (IdeLspClient *self,
 
   g_assert (IDE_IS_LSP_CLIENT (self));
   g_assert (method != NULL);
-  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
-  g_assert (IDE_IS_TASK (task));
+  g_assert (call != NULL);
 
   IDE_TRACE_MSG ("Queuing LSP call to method %s", method);
 
   pending = g_slice_new0 (PendingMessage);
   pending->link.data = pending;
-  pending->task = g_steal_pointer (&task);
+  pending->call = client_call_ref (call);
   pending->method = g_strdup (method);
   pending->params = params ? g_variant_ref (params) : NULL;
-  g_set_object (&pending->cancellable, cancellable);
 
   g_queue_push_tail_link (&priv->pending_messages, &pending->link);
 
   IDE_EXIT;
 }
 
+static char *
+create_supersede_key (const char          *method,
+                      GVariant            *params,
+                      GAsyncReadyCallback  callback)
+{
+  const char *uri = NULL;
+
+  if (params == NULL ||
+      !JSONRPC_MESSAGE_PARSE (params,
+                              "textDocument", "{",
+                                "uri", JSONRPC_MESSAGE_GET_STRING (&uri),
+                              "}"))
+    return NULL;
+
+  /* Including the callback keeps separate consumers of the same method,
+   * such as the symbol tree and the highlighter, from superseding each
+   * other.
+   */
+  return g_strdup_printf ("%s %s %p", method, uri, callback);
+}
+
+static void
+ide_lsp_client_call_internal (IdeLspClient        *self,
+                              const char          *method,
+                              GVariant            *params,
+                              gboolean             supersede,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data,
+                              gpointer             source_tag)
+{
+  IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (self);
+  g_autoptr(GVariant) sunk_params = NULL;
+  g_autoptr(GCancellable) call_cancellable = NULL;
+  g_autoptr(ClientCall) call = NULL;
+  g_autoptr(IdeTask) task = NULL;
+  IdeLspMetrics *metrics;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_LSP_CLIENT (self));
+  g_assert (method != NULL);
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  if (params != NULL)
+    sunk_params = g_variant_ref_sink (params);
+
+  /* Our own cancellable allows superseding a request without affecting
+   * the caller's cancellable, which may be shared with other operations.
+   */
+  call_cancellable = g_cancellable_new ();
+  ide_cancellable_chain (call_cancellable, cancellable);
+
+  task = ide_task_new (self, call_cancellable, callback, user_data);
+  ide_task_set_source_tag (task, source_tag);
+  ide_task_set_return_on_cancel (task, TRUE);
+
+  if (priv->rpc_client == NULL)
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_NOT_CONNECTED,
+                                 _("No connection to language server"));
+      IDE_EXIT;
+    }
+
+  if (!(metrics = g_hash_table_lookup (priv->metrics_by_method, method)))
+    {
+      metrics = _ide_lsp_metrics_new (priv->name ? priv->name : G_OBJECT_TYPE_NAME (self), method);
+      g_hash_table_insert (priv->metrics_by_method, g_strdup (method), metrics);
+    }
+
+  call = g_atomic_rc_box_new0 (ClientCall);
+  call->self = g_object_ref (self);
+  call->task = g_object_ref (task);
+  call->metrics = g_object_ref (metrics);
+  call->cancellable = g_object_ref (call_cancellable);
+  call->begin_time = g_get_monotonic_time ();
+
+  /* Payload sizes are estimated from the serialized GVariant */
+  _ide_lsp_metrics_begin (metrics, params ? g_variant_get_size (params) : 0);
+
+  if (supersede &&
+      (call->supersede_key = create_supersede_key (method, params, callback)))
+    {
+      ClientCall *previous = g_hash_table_lookup (priv->calls_by_supersede_key, call->supersede_key);
+
+      g_hash_table_insert (priv->calls_by_supersede_key,
+                           g_strdup (call->supersede_key),
+                           call);
+
+      if (previous != NULL)
+        {
+          previous->superseded = TRUE;
+          g_cancellable_cancel (previous->cancellable);
+        }
+    }
+
+  call->cancelled_handler = g_cancellable_connect (call->cancellable,
+                                                   G_CALLBACK (client_call_cancelled),
+                                                   client_call_ref (call),
+                                                   client_call_unref);
+
+  if (!priv->initialized &&
+      !(g_str_equal (method, "initialize") || g_str_equal (method, "initialized")))
+    {
+      ide_lsp_client_queue_message (self, method, params, call);
+      IDE_EXIT;
+    }
+
+  /* Cancellation is handled by ClientCall so that the reply to a
+   * $/cancelRequest can be observed.
+   */
+  jsonrpc_client_call_with_id_async (priv->rpc_client,
+                                     method,
+                                     params,
+                                     &call->id,
+                                     NULL,
+                                     ide_lsp_client_call_cb,
+                                     client_call_ref (call));
+
+  IDE_EXIT;
+}
+
 /**
  * ide_lsp_client_call_async:
  * @self: An #IdeLspClient
@@ -2144,9 +2474,6 @@ ide_lsp_client_call_async (IdeLspClient        *self,
                            gpointer             user_data)
 {
   IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (self);
-  g_autoptr(IdeTask) task = NULL;
-
-  IDE_ENTRY;
 
   g_return_if_fail (IDE_IS_MAIN_THREAD ());
   g_return_if_fail (IDE_IS_LSP_CLIENT (self));
@@ -2154,37 +2481,64 @@ ide_lsp_client_call_async (IdeLspClient        *self,
   g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (!priv->rpc_client || JSONRPC_IS_CLIENT (priv->rpc_client));
 
-  task = ide_task_new (self, cancellable, callback, user_data);
-  ide_task_set_source_tag (task, ide_lsp_client_call_async);
-
-  if (priv->rpc_client == NULL)
-    {
-      ide_task_return_new_error (task,
-                                 G_IO_ERROR,
-                                 G_IO_ERROR_NOT_CONNECTED,
-                                 _("No connection to language server"));
-      IDE_EXIT;
-    }
+  ide_lsp_client_call_internal (self,
+                                method,
+                                params,
+                                FALSE,
+                                cancellable,
+                                callback,
+                                user_data,
+                                ide_lsp_client_call_async);
+}
 
-  if (!priv->initialized &&
-      !(g_str_equal (method, "initialize") || g_str_equal (method, "initialized")))
-    {
-      ide_lsp_client_queue_message (self,
-                                    method,
-                                    params,
-                                    cancellable,
-                                    g_steal_pointer (&task));
-      IDE_EXIT;
-    }
+/**
+ * ide_lsp_client_call_superseding_async:
+ * @self: An #IdeLspClient
+ * @method: the method to call
+ * @params: (nullable) (transfer none): An #GVariant or %NULL
+ * @cancellable: (nullable): A cancellable or %NULL
+ * @callback: the callback to receive the result, or %NULL
+ * @user_data: user data for @callback
+ *
+ * Like ide_lsp_client_call_async() but for requests whose result is
+ * obsolete once a newer request has been made, such as completion or
+ * hover while typing.
+ *
+ * A previous call with the same @method, `textDocument` and @callback
+ * that has not yet completed is cancelled and the language server is
+ * asked to stop working on it with `$/cancelRequest`. Its callback is
+ * notified with %G_IO_ERROR_CANCELLED and the late reply is dropped.
+ *
+ * Complete the request with ide_lsp_client_call_finish().
+ *
+ * If @params is floating, it's floating reference is consumed.
+ *
+ * Since: 46
+ */
+void
+ide_lsp_client_call_superseding_async (IdeLspClient        *self,
+                                       const char          *method,
+                                       GVariant            *params,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  IdeLspClientPrivate *priv = ide_lsp_client_get_instance_private (self);
 
-  jsonrpc_client_call_async (priv->rpc_client,
-                             method,
-                             params,
-                             cancellable,
-                             ide_lsp_client_call_cb,
-                             g_steal_pointer (&task));
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (IDE_IS_LSP_CLIENT (self));
+  g_return_if_fail (method != NULL);
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (!priv->rpc_client || JSONRPC_IS_CLIENT (priv->rpc_client));
 
-  IDE_EXIT;
+  ide_lsp_client_call_internal (self,
+                                method,
+                                params,
+                                TRUE,
+                                cancellable,
+                                callback,
+                                user_data,
+                                ide_lsp_client_call_superseding_async);
 }
 
 gboolean
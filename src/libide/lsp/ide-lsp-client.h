@@ -88,6 +88,13 @@ void          ide_lsp_client_call_async                 (IdeLspClient         *s
                                                          GCancellable         *cancellable,
                                                          GAsyncReadyCallback   callback,
                                                          gpointer              user_data);
+IDE_AVAILABLE_IN_46
+void          ide_lsp_client_call_superseding_async     (IdeLspClient         *self,
+                                                         const char           *method,
+                                                         GVariant             *params,
+                                                         GCancellable         *cancellable,
+                                                         GAsyncReadyCallback   callback,
+                                                         gpointer              user_data);
 IDE_AVAILABLE_IN_ALL
 gboolean      ide_lsp_client_call_finish                (IdeLspClient         *self,
                                                          GAsyncResult         *result,
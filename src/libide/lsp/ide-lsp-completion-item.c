@@ -36,8 +36,24 @@ struct _IdeLspCompletionItem
   const gchar *label;
   const gchar *detail;
   guint kind;
+  guint detail_loaded : 1;
 };
 
+static const char *
+ide_lsp_completion_item_load_detail (IdeLspCompletionItem *self)
+{
+  /* Only rows that are displayed need the detail, so avoid looking it
+   * up for every item that is created while filtering.
+   */
+  if (!self->detail_loaded)
+    {
+      self->detail_loaded = TRUE;
+      g_variant_lookup (self->variant, "detail", "&s", &self->detail);
+    }
+
+  return self->detail;
+}
+
 static char *
 ide_lsp_completion_item_get_typed_text (GtkSourceCompletionProposal *proposal)
 {
@@ -92,7 +108,6 @@ ide_lsp_completion_item_new (GVariant *variant)
   self->variant = g_variant_ref_sink (variant);
 
   g_variant_lookup (variant, "label", "&s", &self->label);
-  g_variant_lookup (variant, "detail", "&s", &self->detail);
 
   if (JSONRPC_MESSAGE_PARSE (variant, "kind", JSONRPC_MESSAGE_GET_INT64 (&kind)))
     self->kind = ide_lsp_decode_completion_kind (kind);
@@ -123,7 +138,7 @@ ide_lsp_completion_item_get_detail (IdeLspCompletionItem *self)
 {
   g_return_val_if_fail (IDE_IS_LSP_COMPLETION_ITEM (self), NULL);
 
-  return self->detail;
+  return ide_lsp_completion_item_load_detail (self);
 }
 
 void
@@ -156,6 +171,8 @@ ide_lsp_completion_item_display (IdeLspCompletionItem    *self,
       }
 
     case GTK_SOURCE_COMPLETION_COLUMN_COMMENT:
+      ide_lsp_completion_item_load_detail (self);
+
       if (self->detail != NULL && self->detail[0] != 0)
         {
           const char *endptr = strchr (self->detail, '\n');
@@ -176,7 +193,7 @@ ide_lsp_completion_item_display (IdeLspCompletionItem    *self,
       /* TODO: If there is markdown, we *could* use a markedview here
        * and set_child() with the WebKit view.
        */
-      gtk_source_completion_cell_set_text (cell, self->detail);
+      gtk_source_completion_cell_set_text (cell, ide_lsp_completion_item_load_detail (self));
       break;
 
     default:
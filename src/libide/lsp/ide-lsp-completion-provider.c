@@ -235,6 +235,7 @@ ide_lsp_completion_provider_complete_cb (GObject      *object,
   g_autoptr(IdeTask) task = user_data;
   g_autoptr(GError) error = NULL;
   IdeLspCompletionResults *ret;
+  const char *word;
 
   IDE_ENTRY;
 
@@ -257,10 +258,13 @@ ide_lsp_completion_provider_complete_cb (GObject      *object,
            G_OBJECT_TYPE_NAME (self),
            g_list_model_get_n_items (G_LIST_MODEL (ret)));
 
-  if (!ide_str_empty0 (priv->word))
+  /* The user may have continued typing while waiting for the reply */
+  word = priv->refilter_word ? priv->refilter_word : priv->word;
+
+  if (!ide_str_empty0 (word))
     {
-      IDE_TRACE_MSG ("Filtering results to %s", priv->word);
-      ide_lsp_completion_results_refilter (ret, priv->word);
+      IDE_TRACE_MSG ("Filtering results to %s", word);
+      ide_lsp_completion_results_refilter (ret, word);
     }
 
   ide_task_return_object (task, g_steal_pointer (&ret));
@@ -268,6 +272,40 @@ ide_lsp_completion_provider_complete_cb (GObject      *object,
   IDE_EXIT;
 }
 
+static GVariant *
+create_completion_params (GtkSourceCompletionContext *context,
+                          int                         trigger_kind)
+{
+  g_autofree char *uri = NULL;
+  GtkSourceBuffer *buffer;
+  GtkTextIter iter, end;
+  int line;
+  int column;
+
+  g_assert (GTK_SOURCE_IS_COMPLETION_CONTEXT (context));
+
+  gtk_source_completion_context_get_bounds (context, &iter, &end);
+
+  buffer = gtk_source_completion_context_get_buffer (context);
+  uri = ide_buffer_dup_uri (IDE_BUFFER (buffer));
+
+  line = gtk_text_iter_get_line (&iter);
+  column = gtk_text_iter_get_line_offset (&iter);
+
+  return JSONRPC_MESSAGE_NEW (
+    "textDocument", "{",
+      "uri", JSONRPC_MESSAGE_PUT_STRING (uri),
+    "}",
+    "position", "{",
+      "line", JSONRPC_MESSAGE_PUT_INT32 (line),
+      "character", JSONRPC_MESSAGE_PUT_INT32 (column),
+    "}",
+    "context", "{",
+      "triggerKind", JSONRPC_MESSAGE_PUT_INT32 (trigger_kind),
+    "}"
+  );
+}
+
 static void
 ide_lsp_completion_provider_populate_async (GtkSourceCompletionProvider *provider,
                                             GtkSourceCompletionContext  *context,
@@ -280,12 +318,7 @@ ide_lsp_completion_provider_populate_async (GtkSourceCompletionProvider *provide
   GtkSourceCompletionActivation activation;
   g_autoptr(IdeTask) task = NULL;
   g_autoptr(GVariant) params = NULL;
-  g_autofree char *uri = NULL;
-  GtkTextIter iter, end;
-  GtkSourceBuffer *buffer;
   gint trigger_kind;
-  gint line;
-  gint column;
 
   IDE_ENTRY;
 
@@ -313,8 +346,6 @@ ide_lsp_completion_provider_populate_async (GtkSourceCompletionProvider *provide
       IDE_EXIT;
     }
 
-  gtk_source_completion_context_get_bounds (context, &iter, &end);
-
   activation = gtk_source_completion_context_get_activation (context);
 
   if (activation == GTK_SOURCE_COMPLETION_ACTIVATION_INTERACTIVE)
@@ -324,31 +355,14 @@ ide_lsp_completion_provider_populate_async (GtkSourceCompletionProvider *provide
 
   priv->word = gtk_source_completion_context_get_word (context);
 
-  buffer = gtk_source_completion_context_get_buffer (context);
-  uri = ide_buffer_dup_uri (IDE_BUFFER (buffer));
-
-  line = gtk_text_iter_get_line (&iter);
-  column = gtk_text_iter_get_line_offset (&iter);
-
-  params = JSONRPC_MESSAGE_NEW (
-    "textDocument", "{",
-      "uri", JSONRPC_MESSAGE_PUT_STRING (uri),
-    "}",
-    "position", "{",
-      "line", JSONRPC_MESSAGE_PUT_INT32 (line),
-      "character", JSONRPC_MESSAGE_PUT_INT32 (column),
-    "}",
-    "context", "{",
-      "triggerKind", JSONRPC_MESSAGE_PUT_INT32 (trigger_kind),
-    "}"
-  );
+  params = create_completion_params (context, trigger_kind);
 
-  ide_lsp_client_call_async (priv->client,
-                             "textDocument/completion",
-                             params,
-                             cancellable,
-                             ide_lsp_completion_provider_complete_cb,
-                             g_steal_pointer (&task));
+  ide_lsp_client_call_superseding_async (priv->client,
+                                         "textDocument/completion",
+                                         params,
+                                         cancellable,
+                                         ide_lsp_completion_provider_complete_cb,
+                                         g_steal_pointer (&task));
 
   IDE_EXIT;
 }
@@ -370,6 +384,36 @@ ide_lsp_completion_provider_populate_finish (GtkSourceCompletionProvider  *provi
   IDE_RETURN (ret);
 }
 
+static void
+ide_lsp_completion_provider_refresh_cb (GObject      *object,
+                                        GAsyncResult *result,
+                                        gpointer      user_data)
+{
+  IdeLspCompletionProvider *self = (IdeLspCompletionProvider *)object;
+  g_autoptr(GtkSourceCompletionContext) context = user_data;
+  g_autoptr(IdeLspCompletionResults) results = NULL;
+  g_autoptr(GError) error = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_LSP_COMPLETION_PROVIDER (self));
+  g_assert (IDE_IS_TASK (result));
+  g_assert (GTK_SOURCE_IS_COMPLETION_CONTEXT (context));
+
+  if (!(results = ide_task_propagate_object (IDE_TASK (result), &error)))
+    {
+      if (!ide_error_ignore (error))
+        g_debug ("Failed to refresh completion results: %s", error->message);
+      IDE_EXIT;
+    }
+
+  gtk_source_completion_context_set_proposals_for_provider (context,
+                                                            GTK_SOURCE_COMPLETION_PROVIDER (self),
+                                                            G_LIST_MODEL (results));
+
+  IDE_EXIT;
+}
+
 static void
 ide_lsp_completion_provider_refilter (GtkSourceCompletionProvider *provider,
                                       GtkSourceCompletionContext  *context,
@@ -378,6 +422,8 @@ ide_lsp_completion_provider_refilter (GtkSourceCompletionProvider *provider,
   IdeLspCompletionProvider *self = (IdeLspCompletionProvider *)provider;
   IdeLspCompletionProviderPrivate *priv = ide_lsp_completion_provider_get_instance_private (self);
   IdeLspCompletionResults *results = (IdeLspCompletionResults *)model;
+  g_autoptr(GVariant) params = NULL;
+  g_autoptr(IdeTask) task = NULL;
 
   g_assert (IDE_IS_LSP_COMPLETION_PROVIDER (self));
   g_assert (GTK_SOURCE_IS_COMPLETION_CONTEXT (context));
@@ -386,7 +432,27 @@ ide_lsp_completion_provider_refilter (GtkSourceCompletionProvider *provider,
   g_clear_pointer (&priv->refilter_word, g_free);
   priv->refilter_word = gtk_source_completion_context_get_word (context);
 
+  /* Complete results only ever need filtering as the user types */
   ide_lsp_completion_results_refilter (results, priv->refilter_word);
+
+  if (!ide_lsp_completion_results_get_is_incomplete (results) || priv->client == NULL)
+    return;
+
+  /* The server asked to be queried again as typing continues. Keep showing
+   * the filtered results until the new ones replace them, and supersede any
+   * request still in flight for a shorter word.
+   */
+  task = ide_task_new (self, NULL, ide_lsp_completion_provider_refresh_cb, g_object_ref (context));
+  ide_task_set_source_tag (task, ide_lsp_completion_provider_refilter);
+
+  params = create_completion_params (context, 3);
+
+  ide_lsp_client_call_superseding_async (priv->client,
+                                         "textDocument/completion",
+                                         params,
+                                         NULL,
+                                         ide_lsp_completion_provider_complete_cb,
+                                         g_steal_pointer (&task));
 }
 
 static void
@@ -29,9 +29,27 @@
 
 struct _IdeLspCompletionResults
 {
-  GObject   parent_instance;
-  GVariant *results;
-  GArray   *items;
+  GObject      parent_instance;
+
+  /* The array of completionItem from the reply. It owns the strings in
+   * @keywords so they must not outlive it.
+   */
+  GVariant    *results;
+
+  /* The text to filter each result by, indexed by position in @results.
+   * Keeping this apart from the variant means refiltering never decodes
+   * a completionItem, which matters with servers that reply with tens of
+   * thousands of them. Everything else is decoded by IdeLspCompletionItem
+   * only when a row is displayed.
+   */
+  const char **keywords;
+  guint        n_results;
+
+  /* Matches for @filter, sorted by priority */
+  GArray      *items;
+  char        *filter;
+
+  guint        is_incomplete : 1;
 };
 
 typedef struct
@@ -50,8 +68,10 @@ ide_lsp_completion_results_finalize (GObject *object)
 {
   IdeLspCompletionResults *self = (IdeLspCompletionResults *)object;
 
+  g_clear_pointer (&self->keywords, g_free);
   g_clear_pointer (&self->results, g_variant_unref);
   g_clear_pointer (&self->items, g_array_unref);
+  g_clear_pointer (&self->filter, g_free);
 
   G_OBJECT_CLASS (ide_lsp_completion_results_parent_class)->finalize (object);
 }
@@ -70,21 +90,60 @@ ide_lsp_completion_results_init (IdeLspCompletionResults *self)
   self->items = g_array_new (FALSE, FALSE, sizeof (Item));
 }
 
+static void
+ide_lsp_completion_results_load_keywords (IdeLspCompletionResults *self)
+{
+  g_assert (IDE_IS_LSP_COMPLETION_RESULTS (self));
+
+  if (self->results == NULL || !g_variant_is_container (self->results))
+    return;
+
+  self->n_results = g_variant_n_children (self->results);
+  self->keywords = g_new0 (const char *, self->n_results);
+
+  for (guint i = 0; i < self->n_results; i++)
+    {
+      g_autoptr(GVariant) child = g_variant_get_child_value (self->results, i);
+      g_autoptr(GVariant) unboxed = NULL;
+      const char *keyword = NULL;
+
+      if (g_variant_is_of_type (child, G_VARIANT_TYPE_VARIANT))
+        unboxed = g_variant_get_variant (child);
+      else
+        unboxed = g_steal_pointer (&child);
+
+      if (!g_variant_is_of_type (unboxed, G_VARIANT_TYPE_VARDICT))
+        continue;
+
+      /* Strings borrowed with "&s" remain valid as long as @results,
+       * whether it is serialized or not.
+       */
+      if (!g_variant_lookup (unboxed, "filterText", "&s", &keyword))
+        g_variant_lookup (unboxed, "label", "&s", &keyword);
+
+      self->keywords[i] = keyword;
+    }
+}
+
 IdeLspCompletionResults *
 ide_lsp_completion_results_new (GVariant *results)
 {
   IdeLspCompletionResults *self;
   g_autoptr(GVariant) items = NULL;
+  gboolean is_incomplete = FALSE;
 
   g_return_val_if_fail (results != NULL, NULL);
 
   self = g_object_new (IDE_TYPE_LSP_COMPLETION_RESULTS, NULL);
   self->results = g_variant_ref_sink (results);
 
-  /* Possibly unwrap the {items: []} style result. */
+  /* Possibly unwrap the {isIncomplete: bool, items: []} style result. */
   if (g_variant_is_of_type (results, G_VARIANT_TYPE_VARDICT) &&
       (items = g_variant_lookup_value (results, "items", NULL)))
     {
+      g_variant_lookup (results, "isIncomplete", "b", &is_incomplete);
+      self->is_incomplete = !!is_incomplete;
+
       g_clear_pointer (&self->results, g_variant_unref);
 
       if (g_variant_is_of_type (items, G_VARIANT_TYPE_VARIANT))
@@ -93,7 +152,11 @@ ide_lsp_completion_results_new (GVariant *results)
         self->results = g_steal_pointer (&items);
     }
 
-  ide_lsp_completion_results_refilter (self, NULL);
+  ide_lsp_completion_results_load_keywords (self);
+
+  g_array_set_size (self->items, self->n_results);
+  for (guint i = 0; i < self->n_results; i++)
+    g_array_index (self->items, Item, i) = (Item) { .index = i };
 
   return self;
 }
@@ -125,6 +188,9 @@ ide_lsp_completion_results_get_item (GListModel *model,
   g_assert (IDE_IS_LSP_COMPLETION_RESULTS (self));
   g_assert (self->results != NULL);
 
+  if (position >= self->items->len)
+    return NULL;
+
   item = &g_array_index (self->items, Item, position);
   child = g_variant_get_child_value (self->results, item->index);
 
@@ -143,7 +209,17 @@ static gint
 compare_items (const Item *a,
                const Item *b)
 {
-  return (gint)a->priority - (gint)b->priority;
+  /* Fall back to the order of the server for equally good matches */
+  if (a->priority < b->priority)
+    return -1;
+  else if (a->priority > b->priority)
+    return 1;
+  else if (a->index < b->index)
+    return -1;
+  else if (a->index > b->index)
+    return 1;
+  else
+    return 0;
 }
 
 void
@@ -151,56 +227,92 @@ ide_lsp_completion_results_refilter (IdeLspCompletionResults *self,
                                      const char              *typed_text)
 {
   g_autofree gchar *query = NULL;
-  GVariantIter iter;
-  GVariant *node;
-  guint index = 0;
+  gboolean fast_refilter;
   guint old_len;
+  guint pos = 0;
 
   g_return_if_fail (IDE_IS_LSP_COMPLETION_RESULTS (self));
 
-  if ((old_len = self->items->len))
-    g_array_remove_range (self->items, 0, old_len);
+  if (ide_str_empty0 (typed_text))
+    typed_text = NULL;
 
-  if (self->results == NULL)
+  if (g_strcmp0 (typed_text, self->filter) == 0)
     return;
 
-  if (typed_text == NULL || *typed_text == 0)
+  /* Adding characters to the typed text can only remove matches, so only
+   * the previous matches need to be checked again.
+   */
+  fast_refilter = self->filter != NULL &&
+                  typed_text != NULL &&
+                  g_str_has_prefix (typed_text, self->filter);
+
+  g_free (self->filter);
+  self->filter = g_strdup (typed_text);
+
+  old_len = self->items->len;
+
+  if (typed_text == NULL)
     {
-      guint n_items = g_variant_n_children (self->results);
+      g_array_set_size (self->items, self->n_results);
 
-      for (guint i = 0; i < n_items; i++)
-        {
-          Item item = { .index = i };
-          g_array_append_val (self->items, item);
-        }
+      for (guint i = 0; i < self->n_results; i++)
+        g_array_index (self->items, Item, i) = (Item) { .index = i };
 
-      g_list_model_items_changed (G_LIST_MODEL (self), 0, old_len, n_items);
+      g_list_model_items_changed (G_LIST_MODEL (self), 0, old_len, self->n_results);
 
       return;
     }
 
   query = g_utf8_casefold (typed_text, -1);
 
-  g_variant_iter_init (&iter, self->results);
-
-  while (g_variant_iter_loop (&iter, "v", &node))
+  if (fast_refilter)
     {
-      const gchar *label;
-      guint priority;
+      for (guint i = 0; i < old_len; i++)
+        {
+          Item item = g_array_index (self->items, Item, i);
 
-      if (!g_variant_lookup (node, "label", "&s", &label))
-        continue;
+          if (gtk_source_completion_fuzzy_match (self->keywords[item.index], query, &item.priority))
+            g_array_index (self->items, Item, pos++) = item;
+        }
+    }
+  else
+    {
+      g_array_set_size (self->items, self->n_results);
 
-      if (gtk_source_completion_fuzzy_match (label, query, &priority))
+      for (guint i = 0; i < self->n_results; i++)
         {
-          Item item = { .index = index, .priority = priority };
-          g_array_append_val (self->items, item);
-        }
+          Item item = { .index = i };
+
+          if (self->keywords[i] == NULL)
+            continue;
 
-      index++;
+          if (gtk_source_completion_fuzzy_match (self->keywords[i], query, &item.priority))
+            g_array_index (self->items, Item, pos++) = item;
+        }
     }
 
+  g_array_set_size (self->items, pos);
   g_array_sort (self->items, (GCompareFunc)compare_items);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), 0, old_len, index);
+  g_list_model_items_changed (G_LIST_MODEL (self), 0, old_len, pos);
+}
+
+/**
+ * ide_lsp_completion_results_get_is_incomplete:
+ * @self: a #IdeLspCompletionResults
+ *
+ * Gets whether the language server marked the results as incomplete,
+ * meaning that further typing should request new results rather than
+ * only filtering these.
+ *
+ * Returns: %TRUE if the results are incomplete
+ *
+ * Since: 46
+ */
+gboolean
+ide_lsp_completion_results_get_is_incomplete (IdeLspCompletionResults *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_COMPLETION_RESULTS (self), FALSE);
+
+  return self->is_incomplete;
 }
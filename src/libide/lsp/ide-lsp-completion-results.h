@@ -34,9 +34,11 @@ IDE_AVAILABLE_IN_ALL
 G_DECLARE_FINAL_TYPE (IdeLspCompletionResults, ide_lsp_completion_results, IDE, LSP_COMPLETION_RESULTS, GObject)
 
 IDE_AVAILABLE_IN_ALL
-IdeLspCompletionResults *ide_lsp_completion_results_new      (GVariant                *results);
+IdeLspCompletionResults *ide_lsp_completion_results_new               (GVariant                *results);
 IDE_AVAILABLE_IN_ALL
-void                     ide_lsp_completion_results_refilter (IdeLspCompletionResults *self,
-                                                              const char              *typed_text);
+void                     ide_lsp_completion_results_refilter          (IdeLspCompletionResults *self,
+                                                                       const char              *typed_text);
+IDE_AVAILABLE_IN_46
+gboolean                 ide_lsp_completion_results_get_is_incomplete (IdeLspCompletionResults *self);
 
 G_END_DECLS
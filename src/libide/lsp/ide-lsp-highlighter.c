@@ -49,7 +49,6 @@ typedef struct
 
   guint               queued_update;
 
-  guint               active : 1;
   guint               dirty : 1;
 } IdeLspHighlighterPrivate;
 
@@ -111,10 +110,9 @@ ide_lsp_highlighter_document_symbol_cb (GObject      *object,
   g_assert (G_IS_ASYNC_RESULT (result));
   g_assert (IDE_IS_LSP_HIGHLIGHTER (self));
 
-  priv->active = FALSE;
-
   if (!ide_lsp_client_call_finish (client, result, &return_value, &error))
     {
+      /* A cancelled request was superseded by a newer one */
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_debug ("%s", error->message);
       IDE_EXIT;
@@ -223,15 +221,14 @@ ide_lsp_highlighter_update_symbols (gpointer data)
         "}"
       );
 
-      priv->active = TRUE;
       priv->dirty = FALSE;
 
-      ide_lsp_client_call_async (priv->client,
-                                      "textDocument/documentSymbol",
-                                      params,
-                                      NULL,
-                                      ide_lsp_highlighter_document_symbol_cb,
-                                      g_object_ref (self));
+      ide_lsp_client_call_superseding_async (priv->client,
+                                             "textDocument/documentSymbol",
+                                             params,
+                                             NULL,
+                                             ide_lsp_highlighter_document_symbol_cb,
+                                             g_object_ref (self));
     }
 
   return G_SOURCE_REMOVE;
@@ -250,10 +247,11 @@ ide_lsp_highlighter_queue_update (IdeLspHighlighter *self)
 
   /*
    * Queue an update to get the newest symbol list (which we'll use to build
-   * the highlight index).
+   * the highlight index). A request still in flight is superseded rather
+   * than waited upon, since its symbols are already out of date.
    */
 
-  if (priv->queued_update == 0 && priv->active == FALSE)
+  if (priv->queued_update == 0)
     priv->queued_update = g_timeout_add (DELAY_TIMEOUT_MSEC,
                                          ide_lsp_highlighter_update_symbols,
                                          self);
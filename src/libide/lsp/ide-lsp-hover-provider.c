@@ -412,12 +412,12 @@ ide_lsp_hover_provider_populate_async (GtkSourceHoverProvider *provider,
 
   g_assert (IDE_IS_LSP_CLIENT (priv->client));
 
-  ide_lsp_client_call_async (priv->client,
-                             "textDocument/hover",
-                             params,
-                             cancellable,
-                             ide_lsp_hover_provider_hover_cb,
-                             g_steal_pointer (&task));
+  ide_lsp_client_call_superseding_async (priv->client,
+                                         "textDocument/hover",
+                                         params,
+                                         cancellable,
+                                         ide_lsp_hover_provider_hover_cb,
+                                         g_steal_pointer (&task));
 
   IDE_EXIT;
 }
@@ -0,0 +1,40 @@
+/* ide-lsp-metrics-private.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "ide-lsp-metrics.h"
+
+G_BEGIN_DECLS
+
+IdeLspMetrics *_ide_lsp_metrics_new       (const char    *client_name,
+                                           const char    *method);
+void           _ide_lsp_metrics_remove    (IdeLspMetrics *self);
+void           _ide_lsp_metrics_begin     (IdeLspMetrics *self,
+                                           gsize          bytes_out);
+void           _ide_lsp_metrics_end       (IdeLspMetrics *self,
+                                           gint64         begin_time,
+                                           gsize          bytes_in,
+                                           const GError  *error);
+void           _ide_lsp_metrics_cancelled (IdeLspMetrics *self,
+                                           gboolean       superseded,
+                                           gint64         saved_usec);
+
+G_END_DECLS
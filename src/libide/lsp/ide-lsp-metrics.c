@@ -0,0 +1,733 @@
+/* ide-lsp-metrics.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ide-lsp-metrics"
+
+#include "config.h"
+
+#include <json-glib/json-glib.h>
+
+#include "ide-lsp-metrics-private.h"
+
+/**
+ * SECTION:ide-lsp-metrics
+ * @title: IdeLspMetrics
+ * @short_description: latency and throughput of a language server method
+ *
+ * #IdeLspMetrics collects statistics for calls to a single method of a
+ * single #IdeLspClient, such as "textDocument/completion" to clangd.
+ *
+ * Latencies are kept in a histogram with four buckets per power of two
+ * so that percentiles may be estimated within 25% without retaining
+ * every sample. Payload sizes are the serialized size of the #GVariant
+ * exchanged with the client, which approximates the JSON on the wire.
+ *
+ * Metrics for running clients are available from ide_lsp_metrics_list().
+ *
+ * Since: 46
+ */
+
+#define N_BUCKETS 128
+
+struct _IdeLspMetrics
+{
+  GObject  parent_instance;
+
+  char    *client_name;
+  char    *method;
+
+  guint64  n_calls;
+  guint64  n_failed;
+  guint64  n_cancelled;
+  guint64  n_superseded;
+  guint64  saved_usec;
+  guint64  bytes_in;
+  guint64  bytes_out;
+  guint64  total_usec;
+  guint64  n_samples;
+  guint    n_in_flight;
+
+  guint32  histogram[N_BUCKETS];
+};
+
+enum {
+  PROP_0,
+  PROP_BYTES_IN,
+  PROP_BYTES_OUT,
+  PROP_CANCELLATION_RATE,
+  PROP_CLIENT_NAME,
+  PROP_METHOD,
+  PROP_N_CALLS,
+  PROP_N_CANCELLED,
+  PROP_N_FAILED,
+  PROP_N_IN_FLIGHT,
+  PROP_N_SUPERSEDED,
+  PROP_P50,
+  PROP_P95,
+  PROP_P99,
+  PROP_SAVED_USEC,
+  N_PROPS
+};
+
+G_DEFINE_FINAL_TYPE (IdeLspMetrics, ide_lsp_metrics, G_TYPE_OBJECT)
+
+static GParamSpec *properties [N_PROPS];
+static GListStore *all_metrics;
+
+static inline guint
+latency_to_bucket (gint64 usec)
+{
+  guint octave;
+  guint sub;
+
+  if (usec < 4)
+    return MAX (usec, 0);
+
+  /* The leading bit selects the octave and the next two bits select
+   * one of four linear steps within it.
+   */
+  octave = g_bit_storage (usec) - 1;
+  sub = (usec >> (octave - 2)) & 3;
+
+  return MIN (4 * (octave - 1) + sub, N_BUCKETS - 1);
+}
+
+static inline guint64
+bucket_to_latency (guint bucket)
+{
+  guint octave;
+  guint sub;
+
+  if (bucket < 4)
+    return bucket;
+
+  octave = bucket / 4 + 1;
+  sub = bucket % 4;
+
+  /* Upper bound of the bucket so that percentiles are not optimistic */
+  return ((guint64)(4 + sub + 1) << (octave - 2)) - 1;
+}
+
+static void
+ide_lsp_metrics_finalize (GObject *object)
+{
+  IdeLspMetrics *self = (IdeLspMetrics *)object;
+
+  g_clear_pointer (&self->client_name, g_free);
+  g_clear_pointer (&self->method, g_free);
+
+  G_OBJECT_CLASS (ide_lsp_metrics_parent_class)->finalize (object);
+}
+
+static void
+ide_lsp_metrics_get_property (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  IdeLspMetrics *self = IDE_LSP_METRICS (object);
+
+  switch (prop_id)
+    {
+    case PROP_BYTES_IN:
+      g_value_set_uint64 (value, self->bytes_in);
+      break;
+
+    case PROP_BYTES_OUT:
+      g_value_set_uint64 (value, self->bytes_out);
+      break;
+
+    case PROP_CANCELLATION_RATE:
+      g_value_set_double (value, ide_lsp_metrics_get_cancellation_rate (self));
+      break;
+
+    case PROP_CLIENT_NAME:
+      g_value_set_string (value, self->client_name);
+      break;
+
+    case PROP_METHOD:
+      g_value_set_string (value, self->method);
+      break;
+
+    case PROP_N_CALLS:
+      g_value_set_uint64 (value, self->n_calls);
+      break;
+
+    case PROP_N_CANCELLED:
+      g_value_set_uint64 (value, self->n_cancelled);
+      break;
+
+    case PROP_N_FAILED:
+      g_value_set_uint64 (value, self->n_failed);
+      break;
+
+    case PROP_N_IN_FLIGHT:
+      g_value_set_uint (value, self->n_in_flight);
+      break;
+
+    case PROP_N_SUPERSEDED:
+      g_value_set_uint64 (value, self->n_superseded);
+      break;
+
+    case PROP_P50:
+      g_value_set_uint64 (value, ide_lsp_metrics_get_percentile (self, .50));
+      break;
+
+    case PROP_P95:
+      g_value_set_uint64 (value, ide_lsp_metrics_get_percentile (self, .95));
+      break;
+
+    case PROP_P99:
+      g_value_set_uint64 (value, ide_lsp_metrics_get_percentile (self, .99));
+      break;
+
+    case PROP_SAVED_USEC:
+      g_value_set_uint64 (value, self->saved_usec);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ide_lsp_metrics_set_property (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  IdeLspMetrics *self = IDE_LSP_METRICS (object);
+
+  switch (prop_id)
+    {
+    case PROP_CLIENT_NAME:
+      self->client_name = g_value_dup_string (value);
+      break;
+
+    case PROP_METHOD:
+      self->method = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+ide_lsp_metrics_class_init (IdeLspMetricsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = ide_lsp_metrics_finalize;
+  object_class->get_property = ide_lsp_metrics_get_property;
+  object_class->set_property = ide_lsp_metrics_set_property;
+
+  properties [PROP_BYTES_IN] =
+    g_param_spec_uint64 ("bytes-in", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_BYTES_OUT] =
+    g_param_spec_uint64 ("bytes-out", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * IdeLspMetrics:cancellation-rate:
+   *
+   * The fraction of completed calls which were cancelled before the
+   * language server replied.
+   *
+   * Since: 46
+   */
+  properties [PROP_CANCELLATION_RATE] =
+    g_param_spec_double ("cancellation-rate", NULL, NULL,
+                         0., 1., 0.,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_CLIENT_NAME] =
+    g_param_spec_string ("client-name", NULL, NULL,
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_METHOD] =
+    g_param_spec_string ("method", NULL, NULL,
+                         NULL,
+                         (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_N_CALLS] =
+    g_param_spec_uint64 ("n-calls", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_N_CANCELLED] =
+    g_param_spec_uint64 ("n-cancelled", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_N_FAILED] =
+    g_param_spec_uint64 ("n-failed", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_N_IN_FLIGHT] =
+    g_param_spec_uint ("n-in-flight", NULL, NULL,
+                       0, G_MAXUINT, 0,
+                       (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * IdeLspMetrics:n-superseded:
+   *
+   * The number of cancelled calls which were replaced by a newer call
+   * for the same document.
+   *
+   * Since: 46
+   */
+  properties [PROP_N_SUPERSEDED] =
+    g_param_spec_uint64 ("n-superseded", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * IdeLspMetrics:p50:
+   *
+   * The estimated median latency in microseconds.
+   *
+   * Since: 46
+   */
+  properties [PROP_P50] =
+    g_param_spec_uint64 ("p50", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_P95] =
+    g_param_spec_uint64 ("p95", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  properties [PROP_P99] =
+    g_param_spec_uint64 ("p99", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * IdeLspMetrics:saved-usec:
+   *
+   * An estimate, in microseconds, of language server time not spent on
+   * calls that were cancelled before being sent or acknowledged as
+   * cancelled by the server.
+   *
+   * Since: 46
+   */
+  properties [PROP_SAVED_USEC] =
+    g_param_spec_uint64 ("saved-usec", NULL, NULL,
+                         0, G_MAXUINT64, 0,
+                         (G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+ide_lsp_metrics_init (IdeLspMetrics *self)
+{
+}
+
+static void
+ide_lsp_metrics_ensure (void)
+{
+  if (all_metrics == NULL)
+    all_metrics = g_list_store_new (IDE_TYPE_LSP_METRICS);
+}
+
+IdeLspMetrics *
+_ide_lsp_metrics_new (const char *client_name,
+                      const char *method)
+{
+  IdeLspMetrics *self;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (client_name != NULL);
+  g_assert (method != NULL);
+
+  self = g_object_new (IDE_TYPE_LSP_METRICS,
+                       "client-name", client_name,
+                       "method", method,
+                       NULL);
+
+  ide_lsp_metrics_ensure ();
+  g_list_store_append (all_metrics, self);
+
+  return self;
+}
+
+void
+_ide_lsp_metrics_remove (IdeLspMetrics *self)
+{
+  guint position;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_LSP_METRICS (self));
+
+  if (all_metrics != NULL &&
+      g_list_store_find (all_metrics, self, &position))
+    g_list_store_remove (all_metrics, position);
+}
+
+void
+_ide_lsp_metrics_begin (IdeLspMetrics *self,
+                        gsize          bytes_out)
+{
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_LSP_METRICS (self));
+
+  self->n_in_flight++;
+  self->bytes_out += bytes_out;
+
+  g_object_freeze_notify (G_OBJECT (self));
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_IN_FLIGHT]);
+  if (bytes_out > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_BYTES_OUT]);
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+void
+_ide_lsp_metrics_end (IdeLspMetrics *self,
+                      gint64         begin_time,
+                      gsize          bytes_in,
+                      const GError  *error)
+{
+  gboolean cancelled;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_LSP_METRICS (self));
+  g_assert (self->n_in_flight > 0);
+
+  cancelled = g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+
+  self->n_in_flight--;
+  self->n_calls++;
+  self->bytes_in += bytes_in;
+
+  if (cancelled)
+    self->n_cancelled++;
+  else if (error != NULL)
+    self->n_failed++;
+
+  /* Cancelled calls did not wait for the server, so they would only
+   * skew the latency distribution towards zero.
+   */
+  if (!cancelled)
+    {
+      gint64 usec = MAX (0, g_get_monotonic_time () - begin_time);
+
+      self->histogram[latency_to_bucket (usec)]++;
+      self->total_usec += usec;
+      self->n_samples++;
+    }
+
+  g_object_freeze_notify (G_OBJECT (self));
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_IN_FLIGHT]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_CALLS]);
+  g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_CANCELLATION_RATE]);
+  if (bytes_in > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_BYTES_IN]);
+  if (cancelled)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_CANCELLED]);
+  else if (error != NULL)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_FAILED]);
+  if (!cancelled)
+    {
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_P50]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_P95]);
+      g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_P99]);
+    }
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+void
+_ide_lsp_metrics_cancelled (IdeLspMetrics *self,
+                            gboolean       superseded,
+                            gint64         saved_usec)
+{
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_LSP_METRICS (self));
+
+  if (superseded)
+    self->n_superseded++;
+  self->saved_usec += MAX (0, saved_usec);
+
+  g_object_freeze_notify (G_OBJECT (self));
+  if (superseded)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_N_SUPERSEDED]);
+  if (saved_usec > 0)
+    g_object_notify_by_pspec (G_OBJECT (self), properties [PROP_SAVED_USEC]);
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * ide_lsp_metrics_list:
+ *
+ * Gets a #GListModel of #IdeLspMetrics for every method called on a
+ * running #IdeLspClient.
+ *
+ * This function may only be called from the main thread.
+ *
+ * Returns: (transfer none): a #GListModel of #IdeLspMetrics
+ *
+ * Since: 46
+ */
+GListModel *
+ide_lsp_metrics_list (void)
+{
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
+
+  ide_lsp_metrics_ensure ();
+
+  return G_LIST_MODEL (all_metrics);
+}
+
+/**
+ * ide_lsp_metrics_dump:
+ *
+ * Formats the metrics of every running language server as JSON so that
+ * they may be compared across runs or processed by other tools.
+ *
+ * Latencies are in microseconds.
+ *
+ * Returns: (transfer full): a newly allocated string
+ *
+ * Since: 46
+ */
+char *
+ide_lsp_metrics_dump (void)
+{
+  g_autoptr(JsonBuilder) builder = NULL;
+  g_autoptr(JsonGenerator) generator = NULL;
+  g_autoptr(JsonNode) root = NULL;
+  GListModel *model;
+  guint n_items;
+
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
+
+  model = ide_lsp_metrics_list ();
+  n_items = g_list_model_get_n_items (model);
+  builder = json_builder_new ();
+
+  json_builder_begin_array (builder);
+
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr(IdeLspMetrics) self = g_list_model_get_item (model, i);
+
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "client");
+      json_builder_add_string_value (builder, self->client_name);
+      json_builder_set_member_name (builder, "method");
+      json_builder_add_string_value (builder, self->method);
+      json_builder_set_member_name (builder, "calls");
+      json_builder_add_int_value (builder, self->n_calls);
+      json_builder_set_member_name (builder, "in-flight");
+      json_builder_add_int_value (builder, self->n_in_flight);
+      json_builder_set_member_name (builder, "failed");
+      json_builder_add_int_value (builder, self->n_failed);
+      json_builder_set_member_name (builder, "cancelled");
+      json_builder_add_int_value (builder, self->n_cancelled);
+      json_builder_set_member_name (builder, "superseded");
+      json_builder_add_int_value (builder, self->n_superseded);
+      json_builder_set_member_name (builder, "saved-usec");
+      json_builder_add_int_value (builder, self->saved_usec);
+      json_builder_set_member_name (builder, "cancellation-rate");
+      json_builder_add_double_value (builder, ide_lsp_metrics_get_cancellation_rate (self));
+      json_builder_set_member_name (builder, "bytes-in");
+      json_builder_add_int_value (builder, self->bytes_in);
+      json_builder_set_member_name (builder, "bytes-out");
+      json_builder_add_int_value (builder, self->bytes_out);
+      json_builder_set_member_name (builder, "latency");
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "mean");
+      json_builder_add_int_value (builder, self->n_samples ? self->total_usec / self->n_samples : 0);
+      json_builder_set_member_name (builder, "p50");
+      json_builder_add_int_value (builder, ide_lsp_metrics_get_percentile (self, .50));
+      json_builder_set_member_name (builder, "p95");
+      json_builder_add_int_value (builder, ide_lsp_metrics_get_percentile (self, .95));
+      json_builder_set_member_name (builder, "p99");
+      json_builder_add_int_value (builder, ide_lsp_metrics_get_percentile (self, .99));
+      json_builder_end_object (builder);
+      json_builder_end_object (builder);
+    }
+
+  json_builder_end_array (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+
+  return json_generator_to_data (generator, NULL);
+}
+
+const char *
+ide_lsp_metrics_get_client_name (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), NULL);
+
+  return self->client_name;
+}
+
+const char *
+ide_lsp_metrics_get_method (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), NULL);
+
+  return self->method;
+}
+
+/**
+ * ide_lsp_metrics_get_n_calls:
+ * @self: a #IdeLspMetrics
+ *
+ * Gets the number of calls which have completed, including those that
+ * failed or were cancelled.
+ *
+ * Since: 46
+ */
+guint64
+ide_lsp_metrics_get_n_calls (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->n_calls;
+}
+
+guint
+ide_lsp_metrics_get_n_in_flight (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->n_in_flight;
+}
+
+guint64
+ide_lsp_metrics_get_n_failed (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->n_failed;
+}
+
+guint64
+ide_lsp_metrics_get_n_cancelled (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->n_cancelled;
+}
+
+guint64
+ide_lsp_metrics_get_n_superseded (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->n_superseded;
+}
+
+/**
+ * ide_lsp_metrics_get_saved_usec:
+ * @self: a #IdeLspMetrics
+ *
+ * Estimates the language server time avoided by cancelling calls that
+ * were no longer needed, based on the median latency of the method.
+ *
+ * Returns: the time in microseconds
+ *
+ * Since: 46
+ */
+guint64
+ide_lsp_metrics_get_saved_usec (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->saved_usec;
+}
+
+double
+ide_lsp_metrics_get_cancellation_rate (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0.);
+
+  if (self->n_calls == 0)
+    return 0.;
+
+  return (double)self->n_cancelled / (double)self->n_calls;
+}
+
+guint64
+ide_lsp_metrics_get_bytes_in (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->bytes_in;
+}
+
+guint64
+ide_lsp_metrics_get_bytes_out (IdeLspMetrics *self)
+{
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  return self->bytes_out;
+}
+
+/**
+ * ide_lsp_metrics_get_percentile:
+ * @self: a #IdeLspMetrics
+ * @percentile: the percentile between 0 and 1, such as .95
+ *
+ * Estimates the latency of calls at @percentile, excluding calls that
+ * were cancelled.
+ *
+ * Returns: the latency in microseconds, or 0 if there are no samples
+ *
+ * Since: 46
+ */
+guint64
+ide_lsp_metrics_get_percentile (IdeLspMetrics *self,
+                                double         percentile)
+{
+  guint64 target;
+  guint64 seen = 0;
+
+  g_return_val_if_fail (IDE_IS_LSP_METRICS (self), 0);
+
+  if (self->n_samples == 0)
+    return 0;
+
+  percentile = CLAMP (percentile, 0., 1.);
+  target = MAX (1, (guint64)(percentile * self->n_samples + .5));
+
+  for (guint i = 0; i < N_BUCKETS; i++)
+    {
+      seen += self->histogram[i];
+
+      if (seen >= target)
+        return bucket_to_latency (i);
+    }
+
+  return bucket_to_latency (N_BUCKETS - 1);
+}
@@ -0,0 +1,66 @@
+/* ide-lsp-metrics.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#if !defined (IDE_LSP_INSIDE) && !defined (IDE_LSP_COMPILATION)
+# error "Only <libide-lsp.h> can be included directly."
+#endif
+
+#include <libide-core.h>
+
+G_BEGIN_DECLS
+
+#define IDE_TYPE_LSP_METRICS (ide_lsp_metrics_get_type())
+
+IDE_AVAILABLE_IN_46
+G_DECLARE_FINAL_TYPE (IdeLspMetrics, ide_lsp_metrics, IDE, LSP_METRICS, GObject)
+
+IDE_AVAILABLE_IN_46
+GListModel *ide_lsp_metrics_list                  (void);
+IDE_AVAILABLE_IN_46
+char       *ide_lsp_metrics_dump                  (void);
+IDE_AVAILABLE_IN_46
+const char *ide_lsp_metrics_get_client_name       (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+const char *ide_lsp_metrics_get_method            (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_n_calls           (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint       ide_lsp_metrics_get_n_in_flight       (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_n_failed          (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_n_cancelled       (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_n_superseded      (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_saved_usec        (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+double      ide_lsp_metrics_get_cancellation_rate (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_bytes_in          (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_bytes_out         (IdeLspMetrics *self);
+IDE_AVAILABLE_IN_46
+guint64     ide_lsp_metrics_get_percentile        (IdeLspMetrics *self,
+                                                   double         percentile);
+
+G_END_DECLS
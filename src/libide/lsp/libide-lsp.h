@@ -38,6 +38,7 @@
 #include "ide-lsp-formatter.h"
 #include "ide-lsp-highlighter.h"
 #include "ide-lsp-hover-provider.h"
+#include "ide-lsp-metrics.h"
 #include "ide-lsp-plugin.h"
 #include "ide-lsp-rename-provider.h"
 #include "ide-lsp-search-provider.h"
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 #include "ide-extension-util-private.h"
+#include "ide-private.h"
 
 gboolean
 ide_extension_util_can_use_plugin (PeasEngine     *engine,
@@ -157,6 +158,7 @@ ide_extension_new (PeasEngine     *engine,
 {
   g_autoptr(GArray) params = NULL;
   GObject *ret;
+  gint64 begin_time;
   va_list args;
 
   g_return_val_if_fail (!engine || PEAS_IS_ENGINE (engine), NULL);
@@ -165,9 +167,22 @@ ide_extension_new (PeasEngine     *engine,
   if (engine == NULL)
     engine = peas_engine_get_default ();
 
+  begin_time = g_get_monotonic_time ();
+
   va_start (args, first_property);
   ret = peas_engine_create_extension_valist (engine, plugin_info, type, first_property, args);
   va_end (args);
 
+  /* Part of the startup timeline so addins slow to construct stand out */
+  if (_ide_trace_has_mark ())
+    {
+      g_autofree char *message = NULL;
+
+      message = g_strdup_printf ("%s: %s",
+                                 peas_plugin_info_get_module_name (plugin_info),
+                                 ret ? G_OBJECT_TYPE_NAME (ret) : g_type_name (type));
+      _ide_trace_mark (begin_time, g_get_monotonic_time (), "plugins", "construct", message);
+    }
+
   return ret;
 }
@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include <ctype.h>
+#include <glib/gi18n.h>
 #include <string.h>
 
 #include "ide-fuzzy-mutable-index.h"
@@ -56,6 +57,7 @@ struct _IdeFuzzyMutableIndex
   GPtrArray      *id_to_value;
   GHashTable     *char_tables;
   GHashTable     *removed;
+  gsize           charged;
   guint           in_bulk_insert : 1;
   guint           case_sensitive : 1;
 };
@@ -86,6 +88,17 @@ typedef struct
    GHashTable   *matches;
 } IdeFuzzyMutableIndexLookup;
 
+static IdeMemoryAccount *
+get_memory_account (void)
+{
+  static IdeMemoryAccount *account;
+
+  if (g_once_init_enter (&account))
+    g_once_init_leave (&account, ide_memory_account_get ("fuzzy-index", _("Fuzzy Search Indexes")));
+
+  return account;
+}
+
 static gint
 ide_fuzzy_mutable_index_item_compare (gconstpointer a,
                                       gconstpointer b)
@@ -251,6 +264,7 @@ ide_fuzzy_mutable_index_insert (IdeFuzzyMutableIndex *fuzzy,
 {
   const gchar *tmp;
   gchar *downcase = NULL;
+  gsize charged;
   gsize offset;
   guint id;
 
@@ -265,6 +279,8 @@ ide_fuzzy_mutable_index_insert (IdeFuzzyMutableIndex *fuzzy,
   g_array_append_val (fuzzy->id_to_text_offset, offset);
   g_ptr_array_add (fuzzy->id_to_value, value);
 
+  charged = fuzzy->heap->len - offset + sizeof offset + sizeof value;
+
   if (!fuzzy->case_sensitive)
     key = downcase;
 
@@ -286,8 +302,12 @@ ide_fuzzy_mutable_index_insert (IdeFuzzyMutableIndex *fuzzy,
       item.pos = (guint)(gsize)(tmp - key);
 
       g_array_append_val (table, item);
+      charged += sizeof item;
     }
 
+  fuzzy->charged += charged;
+  ide_memory_account_charge (get_memory_account (), charged);
+
   if (G_UNLIKELY (!fuzzy->in_bulk_insert))
     {
       for (tmp = key; *tmp; tmp = g_utf8_next_char (tmp))
@@ -319,6 +339,8 @@ ide_fuzzy_mutable_index_unref (IdeFuzzyMutableIndex *fuzzy)
 
   if (G_UNLIKELY (g_atomic_int_dec_and_test (&fuzzy->ref_count)))
     {
+      ide_memory_account_discharge (get_memory_account (), fuzzy->charged);
+
       g_byte_array_unref (fuzzy->heap);
       fuzzy->heap = NULL;
 
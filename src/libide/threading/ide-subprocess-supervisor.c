@@ -22,8 +22,11 @@
 
 #include "config.h"
 
+#include <stdio.h>
+
 #include <libide-core.h>
 
+#include "ide-flatpak-subprocess-private.h"
 #include "ide-marshal.h"
 
 #include "ide-subprocess.h"
@@ -44,6 +47,11 @@ typedef struct
   gint64 last_spawn_time;
   guint restart_timeout;
   guint supervising : 1;
+
+  /* Resident memory of the subprocess, sampled on demand */
+  IdeMemoryAccount *account;
+  gulong sample_handler;
+  gsize charged;
 } IdeSubprocessSupervisorPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (IdeSubprocessSupervisor, ide_subprocess_supervisor, G_TYPE_OBJECT)
@@ -58,6 +66,94 @@ enum {
 
 static guint signals [N_SIGNALS];
 
+static void
+ide_subprocess_supervisor_sample_cb (IdeSubprocessSupervisor *self,
+                                     IdeMemoryAccount        *account)
+{
+  IdeSubprocessSupervisorPrivate *priv = ide_subprocess_supervisor_get_instance_private (self);
+  gsize rss = 0;
+
+  g_assert (IDE_IS_SUBPROCESS_SUPERVISOR (self));
+  g_assert (IDE_IS_MEMORY_ACCOUNT (account));
+
+#ifdef __linux__
+  if (priv->identifier != NULL)
+    {
+      g_autofree char *path = g_strdup_printf ("/proc/%s/statm", priv->identifier);
+      g_autofree char *contents = NULL;
+      guint64 size;
+      guint64 resident;
+
+      /* Only works for processes within our PID namespace. Processes
+       * spawned on the host are not tracked, see track_account().
+       */
+      if (g_file_get_contents (path, &contents, NULL, NULL) &&
+          sscanf (contents, "%"G_GUINT64_FORMAT" %"G_GUINT64_FORMAT, &size, &resident) == 2)
+        rss = resident * ide_get_system_page_size ();
+    }
+#endif
+
+  if (rss > priv->charged)
+    ide_memory_account_charge (account, rss - priv->charged);
+  else
+    ide_memory_account_discharge (account, priv->charged - rss);
+
+  priv->charged = rss;
+}
+
+static void
+ide_subprocess_supervisor_release_account (IdeSubprocessSupervisor *self)
+{
+  IdeSubprocessSupervisorPrivate *priv = ide_subprocess_supervisor_get_instance_private (self);
+
+  g_assert (IDE_IS_SUBPROCESS_SUPERVISOR (self));
+
+  if (priv->account != NULL)
+    {
+      g_clear_signal_handler (&priv->sample_handler, priv->account);
+      ide_memory_account_discharge (priv->account, priv->charged);
+      priv->charged = 0;
+      priv->account = NULL;
+    }
+}
+
+static void
+ide_subprocess_supervisor_track_account (IdeSubprocessSupervisor *self)
+{
+  IdeSubprocessSupervisorPrivate *priv = ide_subprocess_supervisor_get_instance_private (self);
+  const gchar * const *argv;
+  g_autofree gchar *basename = NULL;
+  g_autofree gchar *name = NULL;
+
+  g_assert (IDE_IS_SUBPROCESS_SUPERVISOR (self));
+
+  ide_subprocess_supervisor_release_account (self);
+
+  /* When Builder runs inside Flatpak, processes spawned on the host are
+   * identified by their host PID which has no meaning within our PID
+   * namespace, so their memory use is unknown to us.
+   */
+  if (priv->subprocess == NULL || IDE_IS_FLATPAK_SUBPROCESS (priv->subprocess))
+    return;
+
+  if (priv->launcher == NULL ||
+      !(argv = ide_subprocess_launcher_get_argv (priv->launcher)) ||
+      argv[0] == NULL)
+    return;
+
+  /* Group processes by program, such as "process.gnome-builder-clang" */
+  basename = g_path_get_basename (argv[0]);
+  name = g_strdup_printf ("process.%s", basename);
+
+  priv->account = ide_memory_account_get (name, basename);
+  priv->sample_handler =
+    g_signal_connect_object (priv->account,
+                             "sample",
+                             G_CALLBACK (ide_subprocess_supervisor_sample_cb),
+                             self,
+                             G_CONNECT_SWAPPED);
+}
+
 static void
 ide_subprocess_supervisor_reset (IdeSubprocessSupervisor *self)
 {
@@ -76,6 +172,8 @@ ide_subprocess_supervisor_reset (IdeSubprocessSupervisor *self)
        */
       ide_subprocess_force_exit (subprocess);
     }
+
+  ide_subprocess_supervisor_release_account (self);
 }
 
 static gboolean
@@ -129,6 +227,8 @@ ide_subprocess_supervisor_finalize (GObject *object)
       g_clear_object (&priv->subprocess);
     }
 
+  ide_subprocess_supervisor_release_account (self);
+
   g_clear_object (&priv->launcher);
   g_clear_pointer (&priv->identifier, g_free);
 
@@ -414,6 +514,7 @@ ide_subprocess_supervisor_wait_cb (GObject      *object,
   if (priv->subprocess == subprocess)
     {
       g_clear_object (&priv->subprocess);
+      ide_subprocess_supervisor_release_account (self);
 
       if (priv->supervising)
         {
@@ -450,11 +551,13 @@ ide_subprocess_supervisor_set_subprocess (IdeSubprocessSupervisor *self,
   if (g_set_object (&priv->subprocess, subprocess))
     {
       g_clear_pointer (&priv->identifier, g_free);
+      ide_subprocess_supervisor_release_account (self);
 
       if (subprocess != NULL)
         {
           priv->last_spawn_time = g_get_monotonic_time ();
           priv->identifier = g_strdup (ide_subprocess_get_identifier (subprocess));
+          ide_subprocess_supervisor_track_account (self);
 
           g_debug ("Setting subprocess to %s", priv->identifier);
 
@@ -23,6 +23,8 @@
 
 #include <libide-core.h>
 
+#include "ide-private.h"
+
 #include "ide-task.h"
 #include "ide-thread-pool.h"
 #include "ide-thread-private.h"
@@ -520,10 +522,13 @@ ide_task_thread_func (gpointer data)
   IdeTask *self = task;
   gpointer task_data = NULL;
   IdeTaskThreadFunc thread_func;
+  const char *name;
+  gint64 begin_time = 0;
 
   g_assert (IDE_IS_TASK (task));
 
   g_mutex_lock (&self->mutex);
+  name = self->name;
   source_object = self->source_object ? g_object_ref (self->source_object) : NULL;
   cancellable = self->cancellable ? g_object_ref (self->cancellable) : NULL;
   if (self->task_data)
@@ -534,8 +539,14 @@ ide_task_thread_func (gpointer data)
 
   g_assert (thread_func != NULL);
 
+  if (_ide_trace_has_mark ())
+    begin_time = g_get_monotonic_time ();
+
   thread_func (task, source_object, task_data, cancellable);
 
+  if (begin_time != 0)
+    _ide_trace_mark (begin_time, g_get_monotonic_time (), "ide-task", "run-in-thread", name ?: "unnamed");
+
   g_clear_object (&source_object);
   g_clear_object (&cancellable);
 
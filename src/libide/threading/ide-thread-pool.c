@@ -24,13 +24,17 @@
 
 #include <libide-core.h>
 
+#include "ide-private.h"
+
 #include "ide-thread-pool.h"
 #include "ide-thread-private.h"
 
 typedef struct
 {
-  int type;
-  int priority;
+  int    type;
+  int    priority;
+  int    kind;
+  gint64 queued_at;
   union {
     struct {
       GTask           *task;
@@ -50,14 +54,16 @@ struct _IdeThreadPool
   guint              max_threads;
   guint              worker_max_threads;
   gboolean           exclusive;
+  const char        *name;
+  int                n_queued;
 };
 
 static IdeThreadPool thread_pools[] = {
-  { NULL, IDE_THREAD_POOL_DEFAULT, 10, 1, FALSE },
-  { NULL, IDE_THREAD_POOL_COMPILER, 8, 8, FALSE },
-  { NULL, IDE_THREAD_POOL_INDEXER,  1, 1, FALSE },
-  { NULL, IDE_THREAD_POOL_IO,       8, 1, FALSE },
-  { NULL, IDE_THREAD_POOL_LAST,     0, 0, FALSE }
+  { NULL, IDE_THREAD_POOL_DEFAULT, 10, 1, FALSE, "default" },
+  { NULL, IDE_THREAD_POOL_COMPILER, 8, 8, FALSE, "compiler" },
+  { NULL, IDE_THREAD_POOL_INDEXER,  1, 1, FALSE, "indexer" },
+  { NULL, IDE_THREAD_POOL_IO,       8, 1, FALSE, "io" },
+  { NULL, IDE_THREAD_POOL_LAST,     0, 0, FALSE, NULL }
 };
 
 enum {
@@ -65,6 +71,23 @@ enum {
   TYPE_FUNC,
 };
 
+static void
+ide_thread_pool_queue (GThreadPool *pool,
+                       WorkItem    *work_item)
+{
+  IdeThreadPool *p = &thread_pools[work_item->kind];
+  int n_queued = g_atomic_int_add (&p->n_queued, 1) + 1;
+
+  /* Only pay for the clock when someone is recording */
+  if (_ide_trace_has_mark ())
+    {
+      work_item->queued_at = g_get_monotonic_time ();
+      _ide_trace_counter ("thread-pool", p->name, n_queued);
+    }
+
+  g_thread_pool_push (pool, work_item, NULL);
+}
+
 static inline GThreadPool *
 ide_thread_pool_get_pool (IdeThreadPoolKind kind)
 {
@@ -107,10 +130,11 @@ ide_thread_pool_push_task (IdeThreadPoolKind  kind,
       work_item = g_slice_new0 (WorkItem);
       work_item->type = TYPE_TASK;
       work_item->priority = g_task_get_priority (task);
+      work_item->kind = kind;
       work_item->task.task = g_object_ref (task);
       work_item->task.func = func;
 
-      g_thread_pool_push (pool, work_item, NULL);
+      ide_thread_pool_queue (pool, work_item);
     }
   else
     {
@@ -168,10 +192,11 @@ ide_thread_pool_push_with_priority (IdeThreadPoolKind kind,
       work_item = g_slice_new0 (WorkItem);
       work_item->type = TYPE_FUNC;
       work_item->priority = priority;
+      work_item->kind = kind;
       work_item->func.callback = func;
       work_item->func.data = func_data;
 
-      g_thread_pool_push (pool, work_item, NULL);
+      ide_thread_pool_queue (pool, work_item);
     }
   else
     {
@@ -186,9 +211,23 @@ ide_thread_pool_worker (gpointer data,
                         gpointer user_data)
 {
   WorkItem *work_item = data;
+  IdeThreadPool *p;
+  int n_queued;
 
   g_assert (work_item != NULL);
 
+  p = &thread_pools[work_item->kind];
+  n_queued = g_atomic_int_add (&p->n_queued, -1) - 1;
+
+  /* Record how long the item waited for a worker thread. Items queued
+   * before marks were enabled have no timestamp and are skipped.
+   */
+  if (work_item->queued_at != 0 && _ide_trace_has_mark ())
+    {
+      _ide_trace_mark (work_item->queued_at, g_get_monotonic_time (), "thread-pool", "queued", p->name);
+      _ide_trace_counter ("thread-pool", p->name, n_queued);
+    }
+
   if (work_item->type == TYPE_TASK)
     {
       gpointer source_object = g_task_get_source_object (work_item->task.task);
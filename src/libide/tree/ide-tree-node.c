@@ -161,6 +161,16 @@ _ide_tree_node_collapsed (IdeTreeNode *self)
 
       self->children_built = FALSE;
 
+      /* If we are still building children (such as a large directory
+       * being populated in batches) then detach from that task so that
+       * its completion does not mark the collapsed node as built.
+       */
+      if (self->build_children_task != NULL)
+        {
+          g_clear_object (&self->build_children_task);
+          _ide_tree_node_set_loading (self, FALSE);
+        }
+
       children = g_list_copy (self->children.head);
       length = self->children.length;
 
@@ -978,15 +988,71 @@ ide_tree_node_insert_before (IdeTreeNode *self,
   self->parent = parent;
 
   if (next_sibling != NULL)
-    g_queue_insert_before_link (&parent->children, &next_sibling->link, &self->link);
+    {
+      g_queue_insert_before_link (&parent->children, &next_sibling->link, &self->link);
+      child_position = g_queue_link_index (&parent->children, &self->link);
+    }
   else
-    g_queue_push_tail_link (&parent->children, &self->link);
-
-  child_position = g_queue_link_index (&parent->children, &self->link);
+    {
+      g_queue_push_tail_link (&parent->children, &self->link);
+      child_position = parent->children.length - 1;
+    }
 
   g_list_model_items_changed (G_LIST_MODEL (parent), child_position, 0, 1);
 }
 
+/**
+ * ide_tree_node_append_children:
+ * @self: an #IdeTreeNode
+ * @children: (array length=n_children): an array of #IdeTreeNode
+ * @n_children: the number of elements in @children
+ *
+ * Appends @children to the end of @self in order.
+ *
+ * This is equivalent to calling ide_tree_node_insert_before() for each
+ * of @children with a %NULL sibling, but only a single
+ * #GListModel::items-changed is emitted which is much cheaper for the
+ * #GtkTreeListModel when populating large directories.
+ *
+ * Since: 46
+ */
+void
+ide_tree_node_append_children (IdeTreeNode  *self,
+                               IdeTreeNode **children,
+                               guint         n_children)
+{
+  guint position;
+
+  g_return_if_fail (IDE_IS_TREE_NODE (self));
+  g_return_if_fail (children != NULL || n_children == 0);
+
+  if (n_children == 0)
+    return;
+
+  position = self->children.length;
+
+  for (guint i = 0; i < n_children; i++)
+    {
+      IdeTreeNode *child = children[i];
+
+      g_return_if_fail (IDE_IS_TREE_NODE (child));
+      g_return_if_fail (child->parent == NULL);
+      g_return_if_fail (child->link.prev == NULL);
+      g_return_if_fail (child->link.next == NULL);
+      g_return_if_fail (child->link.data == child);
+    }
+
+  for (guint i = 0; i < n_children; i++)
+    {
+      IdeTreeNode *child = g_object_ref (children[i]);
+
+      child->parent = self;
+      g_queue_push_tail_link (&self->children, &child->link);
+    }
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n_children);
+}
+
 /**
  * ide_tree_node_insert_sorted:
  * @self: an #IdeTreeNode
@@ -1341,6 +1407,14 @@ _ide_tree_node_children_built (IdeTreeNode *self)
   return self->children_built;
 }
 
+gboolean
+_ide_tree_node_get_loading (IdeTreeNode *self)
+{
+  g_return_val_if_fail (IDE_IS_TREE_NODE (self), FALSE);
+
+  return self->loading;
+}
+
 guint
 _ide_tree_node_get_child_index (IdeTreeNode *parent,
                                 IdeTreeNode *child)
@@ -176,6 +176,10 @@ IDE_AVAILABLE_IN_ALL
 void              ide_tree_node_insert_before          (IdeTreeNode         *node,
                                                         IdeTreeNode         *parent,
                                                         IdeTreeNode         *next_sibling);
+IDE_AVAILABLE_IN_46
+void              ide_tree_node_append_children        (IdeTreeNode         *self,
+                                                        IdeTreeNode        **children,
+                                                        guint                n_children);
 IDE_AVAILABLE_IN_ALL
 void              ide_tree_node_insert_sorted          (IdeTreeNode         *self,
                                                         IdeTreeNode         *child,
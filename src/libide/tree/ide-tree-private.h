@@ -31,6 +31,7 @@ GtkTreeListRow *_ide_tree_get_row_at_node      (IdeTree                 *self,
                                                 IdeTreeNode             *node,
                                                 gboolean                 expand_to_row);
 gboolean        _ide_tree_node_children_built  (IdeTreeNode             *self);
+gboolean        _ide_tree_node_get_loading     (IdeTreeNode             *self);
 guint           _ide_tree_node_get_child_index (IdeTreeNode             *parent,
                                                 IdeTreeNode             *child);
 IdeTree        *_ide_tree_node_get_tree        (IdeTreeNode             *self);
@@ -165,6 +165,30 @@ ide_vcs_real_push_branch_finish (IdeVcs        *self,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
+static void
+ide_vcs_real_get_head_commit_async (IdeVcs              *self,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  g_task_report_new_error (self,
+                           callback,
+                           user_data,
+                           ide_vcs_real_get_head_commit_async,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NOT_SUPPORTED,
+                           "Not supported by %s",
+                           G_OBJECT_TYPE_NAME (self));
+}
+
+static char *
+ide_vcs_real_get_head_commit_finish (IdeVcs        *self,
+                                     GAsyncResult  *result,
+                                     GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 static void
 ide_vcs_default_init (IdeVcsInterface *iface)
 {
@@ -178,6 +202,8 @@ ide_vcs_default_init (IdeVcsInterface *iface)
   iface->switch_branch_finish = ide_vcs_real_switch_branch_finish;
   iface->push_branch_async = ide_vcs_real_push_branch_async;
   iface->push_branch_finish = ide_vcs_real_push_branch_finish;
+  iface->get_head_commit_async = ide_vcs_real_get_head_commit_async;
+  iface->get_head_commit_finish = ide_vcs_real_get_head_commit_finish;
 
   g_object_interface_install_property (iface,
                                        g_param_spec_string ("branch-name",
@@ -647,6 +673,56 @@ ide_vcs_push_branch_finish (IdeVcs        *self,
   return IDE_VCS_GET_IFACE (self)->push_branch_finish (self, result, error);
 }
 
+/**
+ * ide_vcs_get_head_commit_async:
+ * @self: an #IdeVcs
+ * @cancellable: (nullable): a #GCancellable or %NULL
+ * @callback: a callback to execute upon completion
+ * @user_data: user data for @callback
+ *
+ * Asynchronously gets the identifier of the commit which the working
+ * directory is based on, such as the object id of HEAD with git.
+ *
+ * Since: 46
+ */
+void
+ide_vcs_get_head_commit_async (IdeVcs              *self,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (IDE_IS_VCS (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  IDE_VCS_GET_IFACE (self)->get_head_commit_async (self, cancellable, callback, user_data);
+}
+
+/**
+ * ide_vcs_get_head_commit_finish:
+ * @self: an #IdeVcs
+ * @result: a #GAsyncResult
+ * @error: location for a #GError
+ *
+ * Completes a request to ide_vcs_get_head_commit_async().
+ *
+ * Returns: (transfer full): the commit identifier, or %NULL and @error
+ *   is set.
+ *
+ * Since: 46
+ */
+char *
+ide_vcs_get_head_commit_finish (IdeVcs        *self,
+                                GAsyncResult  *result,
+                                GError       **error)
+{
+  g_return_val_if_fail (IDE_IS_MAIN_THREAD (), NULL);
+  g_return_val_if_fail (IDE_IS_VCS (self), NULL);
+  g_return_val_if_fail (G_IS_ASYNC_RESULT (result), NULL);
+
+  return IDE_VCS_GET_IFACE (self)->get_head_commit_finish (self, result, error);
+}
+
 /**
  * ide_vcs_get_display_name:
  * @self: a #IdeVcs
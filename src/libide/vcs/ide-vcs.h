@@ -89,6 +89,13 @@ struct _IdeVcsInterface
   gboolean                (*push_branch_finish)        (IdeVcs               *self,
                                                         GAsyncResult         *result,
                                                         GError              **error);
+  void                    (*get_head_commit_async)     (IdeVcs               *self,
+                                                        GCancellable         *cancellable,
+                                                        GAsyncReadyCallback   callback,
+                                                        gpointer              user_data);
+  char                   *(*get_head_commit_finish)    (IdeVcs               *self,
+                                                        GAsyncResult         *result,
+                                                        GError              **error);
 };
 
 IDE_AVAILABLE_IN_ALL
@@ -165,5 +172,14 @@ gboolean      ide_vcs_push_branch_finish   (IdeVcs               *self,
                                             GError              **error);
 IDE_AVAILABLE_IN_ALL
 char         *ide_vcs_get_display_name     (IdeVcs               *self);
+IDE_AVAILABLE_IN_46
+void          ide_vcs_get_head_commit_async (IdeVcs               *self,
+                                             GCancellable         *cancellable,
+                                             GAsyncReadyCallback   callback,
+                                             gpointer              user_data);
+IDE_AVAILABLE_IN_46
+char         *ide_vcs_get_head_commit_finish (IdeVcs               *self,
+                                              GAsyncResult         *result,
+                                              GError              **error);
 
 G_END_DECLS
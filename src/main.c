@@ -98,11 +98,72 @@ trace_log (GLogLevelFlags  log_level,
   sysprof_collector_log (log_level, domain, message);
 }
 
+static void
+trace_mark (gint64       begin_time_usec,
+            gint64       end_time_usec,
+            const gchar *group,
+            const gchar *name,
+            const gchar *message)
+{
+  sysprof_collector_mark (begin_time_usec * 1000L,
+                          (end_time_usec - begin_time_usec) * 1000L,
+                          group,
+                          name,
+                          message);
+}
+
+static void
+trace_counter (const gchar *group,
+               const gchar *name,
+               gint64       value)
+{
+  static GMutex mutex;
+  static GHashTable *counters;
+  SysprofCaptureCounterValue counter_value;
+  g_autofree char *key = NULL;
+  guint id;
+
+  if (!sysprof_collector_is_active ())
+    return;
+
+  key = g_strdup_printf ("%s/%s", group, name);
+
+  g_mutex_lock (&mutex);
+
+  if (counters == NULL)
+    counters = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  /* Counters are defined the first time they are seen */
+  if (!(id = GPOINTER_TO_UINT (g_hash_table_lookup (counters, key))))
+    {
+      SysprofCaptureCounter counter = {{0}};
+
+      id = sysprof_collector_request_counters (1);
+
+      g_strlcpy (counter.category, group, sizeof counter.category);
+      g_strlcpy (counter.name, name, sizeof counter.name);
+      g_strlcpy (counter.description, name, sizeof counter.description);
+      counter.id = id;
+      counter.type = SYSPROF_CAPTURE_COUNTER_INT64;
+      counter.value.v64 = value;
+
+      sysprof_collector_define_counters (&counter, 1);
+      g_hash_table_insert (counters, g_steal_pointer (&key), GUINT_TO_POINTER (id));
+    }
+
+  g_mutex_unlock (&mutex);
+
+  counter_value.v64 = value;
+  sysprof_collector_set_counters (&id, &counter_value, 1);
+}
+
 static IdeTraceVTable trace_vtable = {
   trace_load,
   trace_unload,
   trace_function,
   trace_log,
+  trace_mark,
+  trace_counter,
 };
 #endif
 
@@ -266,6 +327,12 @@ main (gint   argc,
 
 #ifdef ENABLE_TRACING_SYSCAP
   _ide_trace_init (&trace_vtable);
+
+  /* Only record marks by default when running under sysprof so that we
+   * do not pay for formatting them otherwise. They may be toggled at
+   * runtime with the "app.trace-marks" action.
+   */
+  _ide_trace_set_marks_enabled (sysprof_collector_is_active ());
 #endif
 
   g_message ("Initializing with %s desktop and GTK+ %d.%d.%d.",
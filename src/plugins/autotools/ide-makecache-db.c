@@ -0,0 +1,417 @@
+/* ide-makecache-db.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "ide-makecache-db"
+
+#include "config.h"
+
+#include <libide-core.h>
+
+#include "ide-makecache-db.h"
+
+/* Bump this whenever the format or the meaning of the stored values
+ * changes so that stale databases are discarded.
+ */
+#define DB_VERSION 2
+#define DB_TYPE    "(ua{s(xsas)}a{s(xsas)})"
+
+/*
+ * IdeMakecacheDb persists what we discovered by querying make so that
+ * reopening a project does not need to run make in every directory again.
+ *
+ * Both sections map a key to the directory and mtime of the Makefile the
+ * value was extracted from, so entries are ignored as soon as that
+ * Makefile is regenerated and dropped once the directory is gone.
+ *
+ *  - targets: build directory to a flat array of name/install-dir pairs
+ *  - flags: relative source path to compiler flags
+ */
+struct _IdeMakecacheDb
+{
+  GMutex      mutex;
+  char       *path;
+  GHashTable *targets;
+  GHashTable *flags;
+  guint       dirty : 1;
+};
+
+typedef struct
+{
+  gint64   mtime;
+  char    *directory;
+  char   **values;
+} Entry;
+
+static void
+entry_free (gpointer data)
+{
+  Entry *entry = data;
+
+  g_free (entry->directory);
+  g_strfreev (entry->values);
+  g_slice_free (Entry, entry);
+}
+
+static Entry *
+entry_new (const char         *directory,
+           gint64              mtime,
+           const char * const *values)
+{
+  Entry *entry = g_slice_new (Entry);
+
+  entry->mtime = mtime;
+  entry->directory = g_strdup (directory);
+  entry->values = g_strdupv ((char **)values);
+
+  return entry;
+}
+
+static void
+load_section (GHashTable *ht,
+              GVariant   *section)
+{
+  GVariantIter iter;
+  const char *key;
+  const char *directory;
+  const char **values;
+  gint64 mtime;
+
+  g_variant_iter_init (&iter, section);
+  while (g_variant_iter_next (&iter, "{&s(x&s^a&s)}", &key, &mtime, &directory, &values))
+    {
+      g_hash_table_insert (ht, g_strdup (key), entry_new (directory, mtime, values));
+      g_free (values);
+    }
+}
+
+static GVariant *
+save_section (GHashTable *ht)
+{
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const char *key;
+  Entry *entry;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(xsas)}"));
+
+  g_hash_table_iter_init (&iter, ht);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&entry))
+    g_variant_builder_add (&builder, "{s(xs^as)}", key, entry->mtime, entry->directory, entry->values);
+
+  return g_variant_builder_end (&builder);
+}
+
+static void
+prune_section (GHashTable *ht,
+               GHashTable *mtimes)
+{
+  GHashTableIter iter;
+  Entry *entry;
+
+  g_hash_table_iter_init (&iter, ht);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+    {
+      const gint64 *mtime = g_hash_table_lookup (mtimes, entry->directory);
+
+      if (mtime == NULL || *mtime != entry->mtime)
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
+/**
+ * ide_makecache_db_new:
+ * @path: the path to the database file
+ *
+ * Creates a new database, loading the contents of @path if it exists
+ * and was written by a compatible version.
+ */
+IdeMakecacheDb *
+ide_makecache_db_new (const char *path)
+{
+  g_autoptr(GVariant) variant = NULL;
+  g_autoptr(GVariant) targets = NULL;
+  g_autoptr(GVariant) flags = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *contents = NULL;
+  IdeMakecacheDb *self;
+  gsize len = 0;
+  guint version = 0;
+
+  g_return_val_if_fail (path != NULL, NULL);
+
+  self = g_slice_new0 (IdeMakecacheDb);
+  g_mutex_init (&self->mutex);
+  self->path = g_strdup (path);
+  self->targets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, entry_free);
+  self->flags = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, entry_free);
+
+  if (!g_file_get_contents (path, &contents, &len, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_debug ("Failed to load makecache database: %s", error->message);
+      return self;
+    }
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (DB_TYPE),
+                                     contents, len, FALSE,
+                                     g_free, g_steal_pointer (&contents));
+  g_variant_ref_sink (variant);
+
+  if (!g_variant_is_normal_form (variant))
+    return self;
+
+  g_variant_get (variant, "(u@a{s(xsas)}@a{s(xsas)})", &version, &targets, &flags);
+
+  if (version != DB_VERSION)
+    return self;
+
+  load_section (self->targets, targets);
+  load_section (self->flags, flags);
+
+  IDE_TRACE_MSG ("Loaded makecache database with %u directories and %u files",
+                 g_hash_table_size (self->targets),
+                 g_hash_table_size (self->flags));
+
+  return self;
+}
+
+void
+ide_makecache_db_free (IdeMakecacheDb *self)
+{
+  if (self != NULL)
+    {
+      g_clear_pointer (&self->path, g_free);
+      g_clear_pointer (&self->targets, g_hash_table_unref);
+      g_clear_pointer (&self->flags, g_hash_table_unref);
+      g_mutex_clear (&self->mutex);
+      g_slice_free (IdeMakecacheDb, self);
+    }
+}
+
+/**
+ * ide_makecache_db_save:
+ * @self: an #IdeMakecacheDb
+ *
+ * Writes the database to disk if it has changed since it was loaded
+ * or last saved.
+ */
+gboolean
+ide_makecache_db_save (IdeMakecacheDb  *self,
+                       GError         **error)
+{
+  g_autoptr(GVariant) variant = NULL;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+
+  {
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    if (!self->dirty)
+      return TRUE;
+
+    variant = g_variant_new ("(u@a{s(xsas)}@a{s(xsas)})",
+                             DB_VERSION,
+                             save_section (self->targets),
+                             save_section (self->flags));
+    g_variant_ref_sink (variant);
+
+    self->dirty = FALSE;
+  }
+
+  return g_file_set_contents (self->path,
+                              g_variant_get_data (variant),
+                              g_variant_get_size (variant),
+                              error);
+}
+
+/**
+ * ide_makecache_db_get_mtime:
+ * @directory: a build directory
+ *
+ * Gets the modification time of the Makefile within @directory in
+ * microseconds, or 0 if it could not be determined.
+ */
+gint64
+ide_makecache_db_get_mtime (const char *directory)
+{
+  g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(GFile) file = NULL;
+
+  g_return_val_if_fail (directory != NULL, 0);
+
+  file = g_file_new_build_filename (directory, "Makefile", NULL);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+
+  if (info == NULL)
+    return 0;
+
+  return g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+         g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+}
+
+/**
+ * ide_makecache_db_prune:
+ * @self: an #IdeMakecacheDb
+ * @directories: the build directories found by the current discovery
+ * @mtimes: the mtime of the Makefile in each of @directories
+ * @n_directories: the number of elements in @directories and @mtimes
+ *
+ * Removes entries extracted from directories which no longer exist or
+ * whose Makefile has since been regenerated, so the database does not
+ * grow with every build directory that was ever discovered.
+ */
+void
+ide_makecache_db_prune (IdeMakecacheDb     *self,
+                        const char * const *directories,
+                        const gint64       *mtimes,
+                        guint               n_directories)
+{
+  g_autoptr(GMutexLocker) locker = NULL;
+  g_autoptr(GHashTable) current = NULL;
+  guint n_entries;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (n_directories == 0 || directories != NULL);
+  g_return_if_fail (n_directories == 0 || mtimes != NULL);
+
+  current = g_hash_table_new (g_str_hash, g_str_equal);
+  for (guint i = 0; i < n_directories; i++)
+    g_hash_table_insert (current, (char *)directories[i], (gint64 *)&mtimes[i]);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  n_entries = g_hash_table_size (self->targets) + g_hash_table_size (self->flags);
+
+  prune_section (self->targets, current);
+  prune_section (self->flags, current);
+
+  if (n_entries != g_hash_table_size (self->targets) + g_hash_table_size (self->flags))
+    self->dirty = TRUE;
+}
+
+static char **
+lookup (IdeMakecacheDb *self,
+        GHashTable     *ht,
+        const char     *key,
+        const char     *directory,
+        gint64          mtime)
+{
+  g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+  const Entry *entry;
+
+  if (mtime == 0 ||
+      !(entry = g_hash_table_lookup (ht, key)) ||
+      entry->mtime != mtime ||
+      g_strcmp0 (entry->directory, directory) != 0)
+    return NULL;
+
+  return g_strdupv (entry->values);
+}
+
+static void
+insert (IdeMakecacheDb     *self,
+        GHashTable         *ht,
+        const char         *key,
+        const char         *directory,
+        gint64              mtime,
+        const char * const *values)
+{
+  g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+  if (mtime == 0)
+    return;
+
+  g_hash_table_insert (ht, g_strdup (key), entry_new (directory, mtime, values));
+  self->dirty = TRUE;
+}
+
+/**
+ * ide_makecache_db_lookup_targets:
+ * @self: an #IdeMakecacheDb
+ * @directory: the build directory containing the Makefile
+ * @mtime: the current mtime of the Makefile
+ *
+ * Returns: (transfer full) (nullable): name/install-dir pairs, or %NULL
+ *   if the directory must be queried again
+ */
+char **
+ide_makecache_db_lookup_targets (IdeMakecacheDb *self,
+                                 const char     *directory,
+                                 gint64          mtime)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (directory != NULL, NULL);
+
+  return lookup (self, self->targets, directory, directory, mtime);
+}
+
+void
+ide_makecache_db_set_targets (IdeMakecacheDb     *self,
+                              const char         *directory,
+                              gint64              mtime,
+                              const char * const *targets)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (directory != NULL);
+  g_return_if_fail (targets != NULL);
+
+  insert (self, self->targets, directory, directory, mtime, targets);
+}
+
+/**
+ * ide_makecache_db_lookup_flags:
+ * @self: an #IdeMakecacheDb
+ * @relative_path: the path of the source file relative to the build directory
+ * @directory: the build directory containing the Makefile
+ * @mtime: the current mtime of the Makefile the flags were extracted from
+ *
+ * Returns: (transfer full) (nullable): the compiler flags or %NULL
+ */
+char **
+ide_makecache_db_lookup_flags (IdeMakecacheDb *self,
+                               const char     *relative_path,
+                               const char     *directory,
+                               gint64          mtime)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (relative_path != NULL, NULL);
+  g_return_val_if_fail (directory != NULL, NULL);
+
+  return lookup (self, self->flags, relative_path, directory, mtime);
+}
+
+void
+ide_makecache_db_set_flags (IdeMakecacheDb     *self,
+                            const char         *relative_path,
+                            const char         *directory,
+                            gint64              mtime,
+                            const char * const *flags)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (relative_path != NULL);
+  g_return_if_fail (directory != NULL);
+  g_return_if_fail (flags != NULL);
+
+  insert (self, self->flags, relative_path, directory, mtime, flags);
+}
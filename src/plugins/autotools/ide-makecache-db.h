@@ -0,0 +1,57 @@
+/* ide-makecache-db.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _IdeMakecacheDb IdeMakecacheDb;
+
+IdeMakecacheDb  *ide_makecache_db_new            (const char           *path);
+void             ide_makecache_db_free           (IdeMakecacheDb       *self);
+gboolean         ide_makecache_db_save           (IdeMakecacheDb       *self,
+                                                  GError              **error);
+void             ide_makecache_db_prune          (IdeMakecacheDb       *self,
+                                                  const char * const   *directories,
+                                                  const gint64         *mtimes,
+                                                  guint                 n_directories);
+gint64           ide_makecache_db_get_mtime      (const char           *directory);
+char           **ide_makecache_db_lookup_targets (IdeMakecacheDb       *self,
+                                                  const char           *directory,
+                                                  gint64                mtime);
+void             ide_makecache_db_set_targets    (IdeMakecacheDb       *self,
+                                                  const char           *directory,
+                                                  gint64                mtime,
+                                                  const char * const   *targets);
+char           **ide_makecache_db_lookup_flags   (IdeMakecacheDb       *self,
+                                                  const char           *relative_path,
+                                                  const char           *directory,
+                                                  gint64                mtime);
+void             ide_makecache_db_set_flags      (IdeMakecacheDb       *self,
+                                                  const char           *relative_path,
+                                                  const char           *directory,
+                                                  gint64                mtime,
+                                                  const char * const   *flags);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (IdeMakecacheDb, ide_makecache_db_free)
+
+G_END_DECLS
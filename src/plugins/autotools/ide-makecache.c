@@ -38,6 +38,7 @@
 
 #include "ide-autotools-build-target.h"
 #include "ide-makecache.h"
+#include "ide-makecache-db.h"
 #include "ide-makecache-target.h"
 
 #define FAKE_CC      "__LIBIDE_FAKE_CC__"
@@ -57,6 +58,9 @@ struct _IdeMakecache
   IdeRuntime   *runtime;
   IdePipeline  *pipeline;
   const gchar  *make_name;
+
+  /* Persisted results of querying make, shared with worker threads */
+  IdeMakecacheDb *db;
 };
 
 typedef struct
@@ -81,8 +85,20 @@ typedef struct
   GFile                 *build_dir;
   IdeRuntime            *runtime;
   IdeSubprocessLauncher *launcher;
+
+  /* Protects launcher while directories are queried in parallel */
+  GMutex                 launcher_mutex;
 } GetBuildTargets;
 
+typedef struct
+{
+  IdeMakecache    *self;
+  GetBuildTargets *data;
+  GFile           *makedir;
+  gint64           mtime;
+  char           **pairs;
+} QueryDirectory;
+
 G_DEFINE_FINAL_TYPE (IdeMakecache, ide_makecache, IDE_TYPE_OBJECT)
 
 static void
@@ -94,6 +110,7 @@ get_build_targets_free (GetBuildTargets *data)
   g_clear_object (&data->build_dir);
   g_clear_object (&data->runtime);
   g_clear_object (&data->launcher);
+  g_mutex_clear (&data->launcher_mutex);
   g_slice_free (GetBuildTargets, data);
 }
 
@@ -628,6 +645,19 @@ ide_makecache_parse_line (IdeMakecache *self,
   IDE_RETURN (NULL);
 }
 
+static gchar *
+target_directory (IdeMakecache       *self,
+                  IdeMakecacheTarget *target)
+{
+  g_autofree gchar *parent = g_file_get_path (self->parent);
+  const gchar *subdir = ide_makecache_target_get_subdir (target);
+
+  /* Must match the paths of discovered directories, see
+   * ide_makecache_db_prune().
+   */
+  return g_canonicalize_filename (subdir ?: ".", parent);
+}
+
 static void
 ide_makecache_get_file_flags_worker (GTask        *task,
                                      gpointer      source_object,
@@ -649,6 +679,28 @@ ide_makecache_get_file_flags_worker (GTask        *task,
   g_assert (IDE_IS_MAKECACHE (lookup->self));
   g_assert (lookup->targets != NULL);
 
+  /* Check for flags extracted by a previous session first */
+  if (lookup->self->db != NULL)
+    {
+      for (j = 0; j < lookup->targets->len; j++)
+        {
+          IdeMakecacheTarget *target = g_ptr_array_index (lookup->targets, j);
+          g_autofree gchar *dir = NULL;
+          gchar **ret;
+
+          dir = target_directory (lookup->self, target);
+
+          if ((ret = ide_makecache_db_lookup_flags (lookup->self->db,
+                                                    lookup->relative_path,
+                                                    dir,
+                                                    ide_makecache_db_get_mtime (dir))))
+            {
+              g_task_return_pointer (task, ret, (GDestroyNotify)g_strfreev);
+              IDE_EXIT;
+            }
+        }
+    }
+
   for (j = 0; j < lookup->targets->len; j++)
     {
       IdeMakecacheTarget *target;
@@ -771,6 +823,21 @@ ide_makecache_get_file_flags_worker (GTask        *task,
       if (ret == NULL)
         continue;
 
+      if (lookup->self->db != NULL)
+        {
+          g_autofree gchar *dir = target_directory (lookup->self, target);
+          g_autoptr(GError) error = NULL;
+
+          ide_makecache_db_set_flags (lookup->self->db,
+                                      lookup->relative_path,
+                                      dir,
+                                      ide_makecache_db_get_mtime (dir),
+                                      (const char * const *)ret);
+
+          if (!ide_makecache_db_save (lookup->self->db, &error))
+            g_debug ("Failed to save makecache database: %s", error->message);
+        }
+
       g_task_return_pointer (task, ret, (GDestroyNotify)g_strfreev);
 
       IDE_EXIT;
@@ -1038,6 +1105,7 @@ ide_makecache_finalize (GObject *object)
 {
   IdeMakecache *self = (IdeMakecache *)object;
 
+  g_clear_pointer (&self->db, ide_makecache_db_free);
   g_clear_object (&self->file_targets_cache);
   g_clear_object (&self->file_flags_cache);
   g_clear_object (&self->runtime);
@@ -1058,6 +1126,18 @@ ide_makecache_class_init (IdeMakecacheClass *klass)
   object_class->finalize = ide_makecache_finalize;
 }
 
+static gsize
+ide_makecache_flags_size (gconstpointer value)
+{
+  const char * const *flags = value;
+  gsize size = sizeof (char *);
+
+  for (guint i = 0; flags[i]; i++)
+    size += sizeof (char *) + strlen (flags[i]) + 1;
+
+  return size;
+}
+
 static void
 ide_makecache_init (IdeMakecache *self)
 {
@@ -1088,6 +1168,8 @@ ide_makecache_init (IdeMakecache *self)
                                                NULL);
 
   ide_task_cache_set_name (self->file_flags_cache, "makecache: file-flags-cache");
+  ide_task_cache_set_size_func (self->file_flags_cache, ide_makecache_flags_size);
+  ide_task_cache_set_evictable (self->file_flags_cache, TRUE);
 }
 
 static void
@@ -1105,9 +1187,21 @@ ide_makecache_validate_worker (GTask        *task,
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
   if (!ide_makecache_validate_mapped_file (self->mapped, &error))
-    g_task_return_error (task, g_steal_pointer (&error));
-  else
-    g_task_return_pointer (task, g_object_ref (self), g_object_unref);
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  /* Load results of previous sessions while we're off the main thread */
+  if (self->db == NULL)
+    {
+      g_autofree gchar *parent = g_file_get_path (self->parent);
+      g_autofree gchar *db_path = g_build_filename (parent, "Makecache.db", NULL);
+
+      self->db = ide_makecache_db_new (db_path);
+    }
+
+  g_task_return_pointer (task, g_object_ref (self), g_object_unref);
 
   IDE_EXIT;
 }
@@ -1461,6 +1555,180 @@ find_install_dir (const gchar *key,
   return NULL;
 }
 
+/*
+ * Queries the automake variables of a single directory, producing a flat
+ * array of target name and install directory pairs. This runs from a
+ * thread pool so that many directories can be queried at once.
+ */
+static char **
+query_directory (IdeMakecache     *self,
+                 GetBuildTargets  *data,
+                 GFile            *makedir,
+                 GError          **error)
+{
+  g_autoptr(IdeSubprocess) subprocess = NULL;
+  g_autoptr(GHashTable) amdirs = NULL;
+  g_autoptr(GPtrArray) pairs = NULL;
+  g_autofree gchar *stdout_buf = NULL;
+  g_autofree gchar *path = NULL;
+  IdeLineReader reader;
+  gchar *line;
+  gsize line_len;
+
+  g_assert (IDE_IS_MAKECACHE (self));
+  g_assert (data != NULL);
+  g_assert (G_IS_FILE (makedir));
+
+  path = g_file_get_path (makedir);
+
+  /*
+   * Make sure we are running within the directory containing the
+   * Makefile that we care about. We use make's -C option because
+   * for runtimes such as flatpak make doesn't necessarily run in
+   * the same directory as the process.
+   *
+   * Spawn make, waiting for our stdin input which will add our debug
+   * printf target. The launcher is shared, so only the spawn needs
+   * to be serialized.
+   */
+  g_mutex_lock (&data->launcher_mutex);
+    {
+      const gchar * const *argv = ide_subprocess_launcher_get_argv (data->launcher);
+
+      for (guint i = 0; argv[i]; i++)
+        {
+          if (g_str_equal (argv[i], "-C"))
+            {
+              ide_subprocess_launcher_replace_argv (data->launcher, i + 1, path);
+              break;
+            }
+        }
+
+      subprocess = ide_subprocess_launcher_spawn (data->launcher, NULL, error);
+    }
+  g_mutex_unlock (&data->launcher_mutex);
+
+  if (subprocess == NULL)
+    return NULL;
+
+  /*
+   * Write our helper target that will include the Makefile and then print
+   * debug variables we care about.
+   */
+  if (!ide_subprocess_communicate_utf8 (subprocess, PRINT_VARS, NULL, &stdout_buf, NULL, error))
+    return NULL;
+
+  amdirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  pairs = g_ptr_array_new ();
+
+  /*
+   * Read through the output from make, and parse the installation targets
+   * that we care about. We do this as two passes because we cannot rely
+   * on the order of targets from make.
+   */
+  ide_line_reader_init (&reader, stdout_buf, -1);
+
+  while ((line = ide_line_reader_next (&reader, &line_len)))
+    {
+      const gchar *eq = memchr (line, '=', line_len);
+      g_autofree gchar *key = NULL;
+      g_autofree gchar *value = NULL;
+
+      /* Highly unlikely, but if we get a line without an =, ignore it */
+      if (eq == NULL)
+        continue;
+
+      /*
+       * If this is doesn't end in dir (bindir, libdir, etc), then we
+       * definitely don't care about it. We also don't care about it
+       * if its a program name that ends in dir, but that doesn't
+       * matter since we wont match it later.
+       */
+      key = g_strstrip (g_strndup (line, eq - line));
+      if (!g_str_has_suffix (key, "dir"))
+        continue;
+
+      /* Move past = */
+      eq++;
+
+      value = g_strstrip (g_strndup (eq, (line + line_len) - eq));
+      g_hash_table_insert (amdirs, g_steal_pointer (&key), g_steal_pointer (&value));
+    }
+
+  /*
+   * Now do a second pass and look for programs that match. If we have the
+   * resulting automake-dir in the amdirs, we should have a real path to
+   * use for the target.
+   */
+
+  ide_line_reader_init (&reader, stdout_buf, -1);
+
+  while (NULL != (line = ide_line_reader_next (&reader, &line_len)))
+    {
+      g_auto(GStrv) parts = NULL;
+      g_auto(GStrv) names = NULL;
+      const gchar *key;
+
+      /* Mutate string to simplify splitting */
+      line [line_len] = '\0';
+
+      parts = g_strsplit (line, "=", 2);
+
+      g_strstrip (parts [0]);
+      if (parts[1])
+        g_strstrip (parts [1]);
+
+      if (ide_str_empty0 (parts[0]) || ide_str_empty0 (parts[1]))
+        continue;
+
+      key = parts [0];
+      names = g_strsplit (parts [1], " ", 0);
+
+      for (guint i = 0; names [i]; i++)
+        {
+          g_autoptr(GFile) installdir = NULL;
+
+          installdir = find_install_dir (key, amdirs);
+          if (installdir == NULL)
+            continue;
+
+          g_ptr_array_add (pairs, g_path_get_basename (names[i]));
+          g_ptr_array_add (pairs, g_file_get_path (installdir));
+        }
+    }
+
+  g_ptr_array_add (pairs, NULL);
+
+  return (char **)g_ptr_array_free (g_steal_pointer (&pairs), FALSE);
+}
+
+static void
+query_directory_worker (gpointer item,
+                        gpointer user_data)
+{
+  QueryDirectory *query = item;
+  g_autoptr(GError) error = NULL;
+
+  g_assert (query != NULL);
+  g_assert (IDE_IS_MAKECACHE (query->self));
+
+  if (!(query->pairs = query_directory (query->self, query->data, query->makedir, &error)))
+    {
+      g_autofree gchar *path = g_file_get_path (query->makedir);
+      g_debug ("Failed to query targets in %s: %s", path, error->message);
+      return;
+    }
+
+  if (query->self->db != NULL)
+    {
+      g_autofree gchar *path = g_file_get_path (query->makedir);
+      ide_makecache_db_set_targets (query->self->db,
+                                    path,
+                                    query->mtime,
+                                    (const char * const *)query->pairs);
+    }
+}
+
 static void
 ide_makecache_get_build_targets_worker (GTask        *task,
                                         gpointer      source_object,
@@ -1471,11 +1739,10 @@ ide_makecache_get_build_targets_worker (GTask        *task,
   g_autoptr(GPtrArray) makedirs = NULL;
   g_autoptr(GPtrArray) targets = NULL;
   g_autoptr(GError) error = NULL;
-  g_autofree gchar *stdout_buf = NULL;
   GetBuildTargets *data = task_data;
-  gchar *line;
-  gsize line_len;
-  IdeLineReader reader;
+  QueryDirectory *queries = NULL;
+  GThreadPool *pool;
+  guint n_cached = 0;
 
   IDE_ENTRY;
 
@@ -1549,142 +1816,96 @@ ide_makecache_get_build_targets_worker (GTask        *task,
 
   /*
    * We need to extract various programs/libraries/targets from each of
-   * our make directories containing an automake-generated Makefile. With
-   * that knowledge, we can build our targets list and cache it for later.
+   * our make directories containing an automake-generated Makefile. Only
+   * directories whose Makefile changed since we last looked are queried,
+   * and those are queried in parallel since each one requires running make.
    */
 
-  targets = g_ptr_array_new_with_free_func (g_object_unref);
+  queries = g_new0 (QueryDirectory, makedirs->len);
+
+  if (!(pool = g_thread_pool_new (query_directory_worker,
+                                  NULL,
+                                  MAX (1, g_get_num_processors ()),
+                                  TRUE,
+                                  &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      IDE_GOTO (failure);
+    }
 
   for (guint j = 0; j < makedirs->len; j++)
     {
-      g_autoptr(IdeSubprocess) subprocess = NULL;
-      g_autoptr(GHashTable) amdirs = NULL;
+      QueryDirectory *query = &queries[j];
       g_autofree gchar *path = NULL;
-      const gchar * const *argv;
-      GFile *makedir;
 
-      /*
-       * Make sure we are running within the directory containing the
-       * Makefile that we care about. We use make's -C option because
-       * for runtimes such as flatpak make doesn't necessarily run in
-       * the same directory as the process.
-       */
-      makedir = g_ptr_array_index (makedirs, j);
-      path = g_file_get_path (makedir);
-      argv = ide_subprocess_launcher_get_argv (data->launcher);
+      query->self = self;
+      query->data = data;
+      query->makedir = g_ptr_array_index (makedirs, j);
 
-      for (guint i = 0; argv[i]; i++)
-        {
-          if (g_str_equal (argv[i], "-C"))
-            {
-              ide_subprocess_launcher_replace_argv (data->launcher, i + 1, path);
-              break;
-            }
-        }
-
-      /*
-       * Spawn make, waiting for our stdin input which will add our debug
-       * printf target.
-       */
-      if (!(subprocess = ide_subprocess_launcher_spawn (data->launcher, NULL, &error)))
-        {
-          g_task_return_error (task, g_steal_pointer (&error));
-          IDE_GOTO (failure);
-        }
+      path = g_file_get_path (query->makedir);
+      query->mtime = ide_makecache_db_get_mtime (path);
 
-      /*
-       * Write our helper target that will include the Makefile and then print
-       * debug variables we care about.
-       */
-      if (!ide_subprocess_communicate_utf8 (subprocess, PRINT_VARS, NULL, &stdout_buf, NULL, &error))
+      if (self->db != NULL &&
+          (query->pairs = ide_makecache_db_lookup_targets (self->db, path, query->mtime)))
         {
-          g_task_return_error (task, g_steal_pointer (&error));
-          IDE_GOTO (failure);
+          n_cached++;
+          continue;
         }
 
-      amdirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-
-      /*
-       * Read through the output from make, and parse the installation targets
-       * that we care about. We do this as two passes because we cannot rely
-       * on the order of targets from make.
-       */
-      ide_line_reader_init (&reader, stdout_buf, -1);
-
-      while ((line = ide_line_reader_next (&reader, &line_len)))
-        {
-          const gchar *eq = memchr (line, '=', line_len);
-          g_autofree gchar *key = NULL;
-          g_autofree gchar *value = NULL;
-
-          /* Highly unlikely, but if we get a line without an =, ignore it */
-          if (eq == NULL)
-            continue;
+      g_thread_pool_push (pool, query, NULL);
+    }
 
-          /*
-           * If this is doesn't end in dir (bindir, libdir, etc), then we
-           * definitely don't care about it. We also don't care about it
-           * if its a program name that ends in dir, but that doesn't
-           * matter since we wont match it later.
-           */
-          key = g_strstrip (g_strndup (line, eq - line));
-          if (!g_str_has_suffix (key, "dir"))
-            continue;
+  /* Wait for queries to complete */
+  g_thread_pool_free (pool, FALSE, TRUE);
 
-          /* Move past = */
-          eq++;
+  IDE_TRACE_MSG ("%u of %u directories loaded from makecache database",
+                 n_cached, makedirs->len);
 
-          value = g_strstrip (g_strndup (eq, (line + line_len) - eq));
-          g_hash_table_insert (amdirs, g_steal_pointer (&key), g_steal_pointer (&value));
-        }
+  targets = g_ptr_array_new_with_free_func (g_object_unref);
 
-      /*
-       * Now do a second pass and look for programs that match. If we have the
-       * resulting automake-dir in the amdirs, we should have a real path to
-       * use for the target.
-       */
+  for (guint j = 0; j < makedirs->len; j++)
+    {
+      QueryDirectory *query = &queries[j];
 
-      ide_line_reader_init (&reader, stdout_buf, -1);
+      if (query->pairs == NULL)
+        continue;
 
-      while (NULL != (line = ide_line_reader_next (&reader, &line_len)))
+      for (guint i = 0; query->pairs[i] && query->pairs[i+1]; i += 2)
         {
-          g_auto(GStrv) parts = NULL;
-          g_auto(GStrv) names = NULL;
-          const gchar *key;
-
-          /* Mutate string to simplify splitting */
-          line [line_len] = '\0';
+          g_autoptr(IdeBuildTarget) target = NULL;
+          g_autoptr(GFile) installdir = g_file_new_for_path (query->pairs[i+1]);
 
-          parts = g_strsplit (line, "=", 2);
-
-          g_strstrip (parts [0]);
-          if (parts[1])
-            g_strstrip (parts [1]);
-
-          if (ide_str_empty0 (parts[0]) || ide_str_empty0 (parts[1]))
-            continue;
+          target = g_object_new (IDE_TYPE_AUTOTOOLS_BUILD_TARGET,
+                                 "build-directory", query->makedir,
+                                 "install-directory", installdir,
+                                 "name", query->pairs[i],
+                                 NULL);
 
-          key = parts [0];
-          names = g_strsplit (parts [1], " ", 0);
+          g_ptr_array_add (targets, g_steal_pointer (&target));
+        }
+    }
 
-          for (guint i = 0; names [i]; i++)
-            {
-              g_autoptr(IdeBuildTarget) target = NULL;
-              g_autoptr(GFile) installdir = NULL;
-              g_autofree gchar *name = g_path_get_basename (names[i]);
+  if (self->db != NULL)
+    {
+      g_autoptr(GPtrArray) paths = g_ptr_array_new_with_free_func (g_free);
+      g_autofree gint64 *mtimes = g_new0 (gint64, makedirs->len);
 
-              installdir = find_install_dir (key, amdirs);
-              if (installdir == NULL)
-                continue;
+      /* Forget directories which were not discovered this time */
+      for (guint j = 0; j < makedirs->len; j++)
+        {
+          g_ptr_array_add (paths, g_file_get_path (queries[j].makedir));
+          mtimes[j] = queries[j].mtime;
+        }
 
-              target = g_object_new (IDE_TYPE_AUTOTOOLS_BUILD_TARGET,
-                                     "build-directory", makedir,
-                                     "install-directory", installdir,
-                                     "name", name,
-                                     NULL);
+      ide_makecache_db_prune (self->db,
+                              (const char * const *)paths->pdata,
+                              mtimes,
+                              paths->len);
 
-              g_ptr_array_add (targets, g_steal_pointer (&target));
-            }
+      if (!ide_makecache_db_save (self->db, &error))
+        {
+          g_debug ("Failed to save makecache database: %s", error->message);
+          g_clear_error (&error);
         }
     }
 
@@ -1693,6 +1914,13 @@ ide_makecache_get_build_targets_worker (GTask        *task,
                          (GDestroyNotify)g_ptr_array_unref);
 
 failure:
+  if (queries != NULL)
+    {
+      for (guint j = 0; j < makedirs->len; j++)
+        g_strfreev (queries[j].pairs);
+      g_free (queries);
+    }
+
   IDE_EXIT;
 }
 
@@ -1722,6 +1950,7 @@ ide_makecache_get_build_targets_async (IdeMakecache        *self,
   data->config = ide_config_manager_get_current (data->configmgr);
   data->runtime = g_object_ref (self->runtime);
   data->launcher = ide_pipeline_create_launcher (self->pipeline, NULL);
+  g_mutex_init (&data->launcher_mutex);
 
   g_task_set_task_data (task, data, (GDestroyNotify)get_build_targets_free);
 
@@ -108,6 +108,33 @@ gbp_buildui_status_popover_add_diagnsotic (GbpBuilduiStatusPopover *self,
                               NULL);
 }
 
+static void
+gbp_buildui_status_popover_compile_file_started (GbpBuilduiStatusPopover *self,
+                                                 GFile                   *file,
+                                                 IdeBuildManager         *build_manager)
+{
+  guint n_items;
+
+  g_assert (GBP_IS_BUILDUI_STATUS_POPOVER (self));
+  g_assert (G_IS_FILE (file));
+  g_assert (IDE_IS_BUILD_MANAGER (build_manager));
+
+  /* The file is being compiled again, drop what it reported last time */
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->diagnostics));
+
+  for (guint i = n_items; i > 0; i--)
+    {
+      g_autoptr(IdeDiagnostic) diagnostic = g_list_model_get_item (G_LIST_MODEL (self->diagnostics), i - 1);
+      GFile *diagnostic_file = ide_diagnostic_get_file (diagnostic);
+
+      if (diagnostic_file != NULL && g_file_equal (diagnostic_file, file))
+        {
+          g_hash_table_remove (self->deduplicator, diagnostic);
+          g_list_store_remove (self->diagnostics, i - 1);
+        }
+    }
+}
+
 static void
 gbp_buildui_status_popover_bind_pipeline (GbpBuilduiStatusPopover *self,
                                           IdePipeline             *pipeline,
@@ -293,6 +320,11 @@ gbp_buildui_status_popover_connect (GbpBuilduiStatusPopover *self,
   g_object_bind_property (build_manager, "pipeline",
                           self->pipeline_signals, "target",
                           G_BINDING_SYNC_CREATE);
+  g_signal_connect_object (build_manager,
+                           "compile-file-started",
+                           G_CALLBACK (gbp_buildui_status_popover_compile_file_started),
+                           self,
+                           G_CONNECT_SWAPPED);
 
   IDE_EXIT;
 }
@@ -22,6 +22,7 @@
 #define G_LOG_DOMAIN "gbp-cmake-build-system"
 
 #include <glib/gi18n.h>
+#include <string.h>
 
 #include "gbp-cmake-build-system.h"
 #include "gbp-cmake-build-target.h"
@@ -33,6 +34,14 @@ struct _GbpCMakeBuildSystem
   GFile              *project_file;
   IdeCompileCommands *compile_commands;
   GFileMonitor       *monitor;
+
+  /* The codemodel is kept when the reply directory changes so that an
+   * unchanged reply index can be reused without parsing it again.
+   */
+  GbpCmakeCodemodel  *codemodel;
+  GFileMonitor       *codemodel_monitor;
+  guint               codemodel_seq;
+  guint               codemodel_valid : 1;
 };
 
 static void async_initable_iface_init (GAsyncInitableIface     *iface);
@@ -337,6 +346,219 @@ gbp_cmake_build_system_load_commands_finish (GbpCMakeBuildSystem  *self,
   return ide_task_propagate_pointer (IDE_TASK (result), error);
 }
 
+static void
+gbp_cmake_build_system_reply_dir_changed (GbpCMakeBuildSystem *self,
+                                          GFile               *file,
+                                          GFile               *other_file,
+                                          GFileMonitorEvent    event,
+                                          GFileMonitor        *monitor)
+{
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (self));
+  g_assert (G_IS_FILE_MONITOR (monitor));
+
+  self->codemodel_valid = FALSE;
+
+  IDE_EXIT;
+}
+
+static void
+gbp_cmake_build_system_monitor_reply_dir (GbpCMakeBuildSystem *self,
+                                          const char          *builddir)
+{
+  g_autoptr(GFileMonitor) monitor = NULL;
+  g_autoptr(GFile) replydir = NULL;
+
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (self));
+  g_assert (builddir != NULL);
+
+  if (self->codemodel_monitor != NULL)
+    return;
+
+  replydir = g_file_new_build_filename (builddir, ".cmake", "api", "v1", "reply", NULL);
+  monitor = g_file_monitor_directory (replydir, G_FILE_MONITOR_NONE, NULL, NULL);
+
+  if (monitor == NULL)
+    return;
+
+  g_signal_connect_object (monitor,
+                           "changed",
+                           G_CALLBACK (gbp_cmake_build_system_reply_dir_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  self->codemodel_monitor = g_steal_pointer (&monitor);
+}
+
+/*
+ * Multi-config generators build CMAKE_DEFAULT_BUILD_TYPE by default, and
+ * single-config generators describe CMAKE_BUILD_TYPE, so look for those in
+ * the configure options to know which configuration of the codemodel is
+ * the one being built.
+ */
+static char *
+get_active_configuration (IdePipeline *pipeline)
+{
+  static const char *variables[] = { "CMAKE_DEFAULT_BUILD_TYPE", "CMAKE_BUILD_TYPE" };
+  g_auto(GStrv) argv = NULL;
+  IdeConfig *config;
+  const char *config_opts;
+  int argc = 0;
+
+  g_assert (IDE_IS_PIPELINE (pipeline));
+
+  if (!(config = ide_pipeline_get_config (pipeline)) ||
+      !(config_opts = ide_config_get_config_opts (config)) ||
+      !g_shell_parse_argv (config_opts, &argc, &argv, NULL))
+    return NULL;
+
+  for (guint v = 0; v < G_N_ELEMENTS (variables); v++)
+    {
+      gsize len = strlen (variables[v]);
+
+      for (guint i = 0; argv[i]; i++)
+        {
+          const char *arg = argv[i];
+          const char *eq;
+
+          if (!g_str_has_prefix (arg, "-D"))
+            continue;
+
+          /* -DNAME=value or -DNAME:TYPE=value */
+          arg += 2;
+          if (strncmp (arg, variables[v], len) != 0 ||
+              (arg[len] != '=' && arg[len] != ':') ||
+              !(eq = strchr (arg, '=')))
+            continue;
+
+          if (eq[1] != '\0')
+            return g_strdup (eq + 1);
+        }
+    }
+
+  return NULL;
+}
+
+static void
+gbp_cmake_build_system_load_codemodel_cb (GObject      *object,
+                                          GAsyncResult *result,
+                                          gpointer      user_data)
+{
+  g_autoptr(GbpCmakeCodemodel) codemodel = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  GbpCMakeBuildSystem *self;
+
+  IDE_ENTRY;
+
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+
+  if (!(codemodel = gbp_cmake_codemodel_load_finish (result, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  /* Only cache the result if the pipeline did not change meanwhile */
+  if (GPOINTER_TO_UINT (ide_task_get_task_data (task)) == self->codemodel_seq)
+    {
+      g_set_object (&self->codemodel, codemodel);
+      self->codemodel_valid = TRUE;
+    }
+
+  ide_task_return_pointer (task, g_steal_pointer (&codemodel), g_object_unref);
+
+  IDE_EXIT;
+}
+
+/**
+ * gbp_cmake_build_system_load_codemodel_async:
+ * @self: a #GbpCMakeBuildSystem
+ *
+ * Loads the codemodel from the reply of the cmake File API for the
+ * current pipeline. This does not advance the pipeline, so it will fail
+ * if cmake has not yet been configured.
+ */
+void
+gbp_cmake_build_system_load_codemodel_async (GbpCMakeBuildSystem *self,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+  g_autofree char *configuration = NULL;
+  IdeBuildManager *build_manager;
+  IdePipeline *pipeline;
+  IdeContext *context;
+  const char *builddir;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (GBP_IS_CMAKE_BUILD_SYSTEM (self));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_cmake_build_system_load_codemodel_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+
+  if (self->codemodel != NULL && self->codemodel_valid)
+    {
+      ide_task_return_pointer (task, g_object_ref (self->codemodel), g_object_unref);
+      IDE_EXIT;
+    }
+
+  context = ide_object_get_context (IDE_OBJECT (self));
+  build_manager = ide_build_manager_from_context (context);
+  pipeline = ide_build_manager_get_pipeline (build_manager);
+
+  if (pipeline == NULL || !(builddir = ide_pipeline_get_builddir (pipeline)))
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_NOT_INITIALIZED,
+                                 "No build pipeline is available");
+      IDE_EXIT;
+    }
+
+  /* Start monitoring before loading so that we don't miss a reply
+   * written while we are parsing the previous one.
+   */
+  gbp_cmake_build_system_monitor_reply_dir (self, builddir);
+  ide_task_set_task_data (task, GUINT_TO_POINTER (self->codemodel_seq), NULL);
+
+  configuration = get_active_configuration (pipeline);
+
+  gbp_cmake_codemodel_load_async (builddir,
+                                  configuration,
+                                  self->codemodel,
+                                  cancellable,
+                                  gbp_cmake_build_system_load_codemodel_cb,
+                                  g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
+GbpCmakeCodemodel *
+gbp_cmake_build_system_load_codemodel_finish (GbpCMakeBuildSystem  *self,
+                                              GAsyncResult         *result,
+                                              GError              **error)
+{
+  GbpCmakeCodemodel *ret;
+
+  IDE_ENTRY;
+
+  g_return_val_if_fail (GBP_IS_CMAKE_BUILD_SYSTEM (self), NULL);
+  g_return_val_if_fail (IDE_IS_TASK (result), NULL);
+
+  ret = ide_task_propagate_pointer (IDE_TASK (result), error);
+
+  IDE_RETURN (ret);
+}
+
 static void
 gbp_cmake_build_system_finalize (GObject *object)
 {
@@ -345,6 +567,13 @@ gbp_cmake_build_system_finalize (GObject *object)
   g_clear_object (&self->project_file);
   g_clear_object (&self->compile_commands);
   g_clear_object (&self->monitor);
+  g_clear_object (&self->codemodel);
+
+  if (self->codemodel_monitor != NULL)
+    {
+      g_file_monitor_cancel (self->codemodel_monitor);
+      g_clear_object (&self->codemodel_monitor);
+    }
 
   G_OBJECT_CLASS (gbp_cmake_build_system_parent_class)->finalize (object);
 }
@@ -429,6 +658,27 @@ gbp_cmake_build_system_get_priority (IdeBuildSystem *build_system)
   return -300;
 }
 
+static char **
+gbp_cmake_build_system_get_system_includes (GbpCMakeBuildSystem *self)
+{
+  IdeConfigManager *config_manager;
+  IdeContext *context;
+  IdeConfig *config;
+  IdeRuntime *runtime;
+
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (self));
+
+  /* Get non-standard system includes */
+  context = ide_object_get_context (IDE_OBJECT (self));
+  config_manager = ide_config_manager_from_context (context);
+  config = ide_config_manager_get_current (config_manager);
+
+  if ((runtime = ide_config_get_runtime (config)))
+    return ide_runtime_get_system_include_dirs (runtime);
+
+  return NULL;
+}
+
 static void
 gbp_cmake_build_system_get_build_flags_cb (GObject      *object,
                                            GAsyncResult *result,
@@ -441,10 +691,6 @@ gbp_cmake_build_system_get_build_flags_cb (GObject      *object,
   g_autoptr(GFile) directory = NULL;
   g_auto(GStrv) system_includes = NULL;
   g_auto(GStrv) build_flags = NULL;
-  IdeConfigManager *config_manager;
-  IdeContext *context;
-  IdeConfig *config;
-  IdeRuntime *runtime;
   GFile *file;
 
   g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (self));
@@ -462,13 +708,7 @@ gbp_cmake_build_system_get_build_flags_cb (GObject      *object,
   file = ide_task_get_task_data (task);
   g_assert (G_IS_FILE (file));
 
-  /* Get non-standard system includes */
-  context = ide_object_get_context (IDE_OBJECT (self));
-  config_manager = ide_config_manager_from_context (context);
-  config = ide_config_manager_get_current (config_manager);
-  if ((runtime = ide_config_get_runtime (config)))
-    system_includes = ide_runtime_get_system_include_dirs (runtime);
-
+  system_includes = gbp_cmake_build_system_get_system_includes (self);
   build_flags = ide_compile_commands_lookup (compile_commands,
                                              file,
                                              (const gchar * const *)system_includes,
@@ -481,6 +721,60 @@ gbp_cmake_build_system_get_build_flags_cb (GObject      *object,
     ide_task_return_pointer (task, g_steal_pointer (&build_flags), g_strfreev);
 }
 
+static void
+gbp_cmake_build_system_get_build_flags_codemodel_cb (GObject      *object,
+                                                     GAsyncResult *result,
+                                                     gpointer      user_data)
+{
+  GbpCMakeBuildSystem *self = (GbpCMakeBuildSystem *)object;
+  g_autoptr(GbpCmakeCodemodel) codemodel = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) system_includes = NULL;
+  g_auto(GStrv) build_flags = NULL;
+  GFile *file;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (self));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  file = ide_task_get_task_data (task);
+  g_assert (G_IS_FILE (file));
+
+  if ((codemodel = gbp_cmake_build_system_load_codemodel_finish (self, result, &error)))
+    {
+      system_includes = gbp_cmake_build_system_get_system_includes (self);
+      build_flags = gbp_cmake_codemodel_lookup_flags (codemodel,
+                                                      file,
+                                                      (const char * const *)system_includes,
+                                                      NULL);
+
+      if (build_flags != NULL)
+        {
+          ide_task_return_pointer (task, g_steal_pointer (&build_flags), g_strfreev);
+          IDE_EXIT;
+        }
+    }
+  else
+    {
+      g_debug ("Codemodel unavailable, using compile_commands.json: %s",
+               error->message);
+    }
+
+  /* Files not described by the codemodel (such as generated sources) or
+   * a project which has not been configured yet use compile_commands.json
+   * which will also advance the pipeline to CONFIGURE when necessary.
+   */
+  gbp_cmake_build_system_load_commands_async (self,
+                                              ide_task_get_cancellable (task),
+                                              gbp_cmake_build_system_get_build_flags_cb,
+                                              g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
 static void
 gbp_cmake_build_system_get_build_flags_async (IdeBuildSystem      *build_system,
                                               GFile               *file,
@@ -502,10 +796,10 @@ gbp_cmake_build_system_get_build_flags_async (IdeBuildSystem      *build_system,
   ide_task_set_source_tag (task, gbp_cmake_build_system_get_build_flags_async);
   ide_task_set_task_data (task, g_object_ref (file), g_object_unref);
 
-  gbp_cmake_build_system_load_commands_async (self,
-                                              cancellable,
-                                              gbp_cmake_build_system_get_build_flags_cb,
-                                              g_steal_pointer (&task));
+  gbp_cmake_build_system_load_codemodel_async (self,
+                                               cancellable,
+                                               gbp_cmake_build_system_get_build_flags_codemodel_cb,
+                                               g_steal_pointer (&task));
 
   IDE_EXIT;
 }
@@ -554,6 +848,17 @@ gbp_cmake_build_system_notify_pipeline (GbpCMakeBuildSystem *self,
    */
   g_clear_object (&self->compile_commands);
 
+  /* The reply directory lives in the build directory of the pipeline */
+  g_clear_object (&self->codemodel);
+  self->codemodel_valid = FALSE;
+  self->codemodel_seq++;
+
+  if (self->codemodel_monitor != NULL)
+    {
+      g_file_monitor_cancel (self->codemodel_monitor);
+      g_clear_object (&self->codemodel_monitor);
+    }
+
   IDE_EXIT;
 }
 
@@ -23,10 +23,20 @@
 
 #include <libide-foundry.h>
 
+#include "gbp-cmake-codemodel.h"
+
 G_BEGIN_DECLS
 
 #define GBP_TYPE_CMAKE_BUILD_SYSTEM (gbp_cmake_build_system_get_type())
 
 G_DECLARE_FINAL_TYPE (GbpCMakeBuildSystem, gbp_cmake_build_system, GBP, CMAKE_BUILD_SYSTEM, IdeObject)
 
+void               gbp_cmake_build_system_load_codemodel_async  (GbpCMakeBuildSystem  *self,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+GbpCmakeCodemodel *gbp_cmake_build_system_load_codemodel_finish (GbpCMakeBuildSystem  *self,
+                                                                 GAsyncResult         *result,
+                                                                 GError              **error);
+
 G_END_DECLS
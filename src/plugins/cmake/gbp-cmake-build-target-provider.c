@@ -18,9 +18,8 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include "gbp-cmake-build-system.h"
 #include "gbp-cmake-build-target-provider.h"
-#include "gbp-cmake-build-target.h"
-#include <json-glib/json-glib.h>
 
 struct _GbpCmakeBuildTargetProvider
 {
@@ -49,58 +48,39 @@ gbp_cmake_build_target_provider_init (GbpCmakeBuildTargetProvider *self)
 }
 
 static void
-gbp_cmake_build_target_provider_create_target (GbpCmakeBuildTargetProvider  *self,
-                                               GPtrArray                   **ret,
-                                               IdeContext                   *context,
-                                               JsonObject                   *obj)
+gbp_cmake_build_target_provider_load_codemodel_cb (GObject      *object,
+                                                   GAsyncResult *result,
+                                                   gpointer      user_data)
 {
-  g_autoptr(IdeBuildTarget) target = NULL;
-  g_autoptr(GFile) install_directory = NULL;
-  g_autofree gchar *install_dir = NULL;
-  g_autofree gchar *install_dir_abs = NULL;
-  g_autofree gchar *name = NULL;
-  JsonArray *artefacts;
-  JsonObject *path_object;
-  JsonObject *install;
-  JsonObject *prefix;
-  JsonArray *destination_array;
-  JsonObject *destination;
-  const gchar *artefacts_path;
-  const gchar *prefix_path;
-  const gchar *destination_path;
-
-  g_return_if_fail (GBP_IS_CMAKE_BUILD_TARGET_PROVIDER (self));
-
-  /* ignore target if no install rule is present */
-  if (!json_object_has_member (obj, "install"))
-    return;
-
-  artefacts = json_object_get_array_member (obj, "artifacts");
-  /* currently we support only one artefact executable */
-  path_object = json_array_get_object_element (artefacts, 0);
-  artefacts_path = json_object_get_string_member (path_object, "path");
-
-  install = json_object_get_object_member (obj, "install");
-  prefix = json_object_get_object_member (install, "prefix");
-  prefix_path = json_object_get_string_member (prefix, "path");
-  destination_array = json_object_get_array_member (install, "destinations");
-  destination = json_array_get_object_element (destination_array, 0);
-  destination_path = json_object_get_string_member (destination, "path");
-
-  install_dir = g_path_get_dirname (artefacts_path);
-  if (g_str_has_prefix (destination_path, prefix_path))
-    install_dir_abs = g_strdup (destination_path);
-  else
-    install_dir_abs = g_build_path (G_DIR_SEPARATOR_S, prefix_path, destination_path, NULL);
-
-  install_directory = g_file_new_for_path (install_dir_abs);
-
-  name = g_path_get_basename (artefacts_path);
-  target = gbp_cmake_build_target_new (context, install_directory, name);
-
-  g_debug ("Found target %s with install directory %s", name, install_dir_abs);
-
-  g_ptr_array_add (*ret, g_steal_pointer (&target));
+  GbpCMakeBuildSystem *build_system = (GbpCMakeBuildSystem *)object;
+  g_autoptr(GbpCmakeCodemodel) codemodel = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  GbpCmakeBuildTargetProvider *self;
+  IdeContext *context;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (build_system));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  g_assert (GBP_IS_CMAKE_BUILD_TARGET_PROVIDER (self));
+
+  if (!(codemodel = gbp_cmake_build_system_load_codemodel_finish (build_system, result, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  context = ide_object_get_context (IDE_OBJECT (self));
+
+  ide_task_return_pointer (task,
+                           gbp_cmake_codemodel_list_targets (codemodel, context),
+                           g_ptr_array_unref);
+
+  IDE_EXIT;
 }
 
 static void
@@ -111,14 +91,8 @@ gbp_cmake_build_target_provider_get_targets_async (IdeBuildTargetProvider *provi
 {
   GbpCmakeBuildTargetProvider *self = GBP_CMAKE_BUILD_TARGET_PROVIDER (provider);
   g_autoptr(IdeTask) task = NULL;
-  g_autoptr(GPtrArray) ret = NULL;
-  g_autoptr(GFile) reply = NULL;
-  g_autoptr(GFileEnumerator) enumerator = NULL;
-  g_autofree gchar *replydir = NULL;
+  IdeBuildSystem *build_system;
   IdeContext *context;
-  IdeBuildManager *build_manager;
-  IdePipeline *pipeline;
-  const gchar *builddir;
 
   IDE_ENTRY;
 
@@ -130,54 +104,24 @@ gbp_cmake_build_target_provider_get_targets_async (IdeBuildTargetProvider *provi
   ide_task_set_priority (task, G_PRIORITY_LOW);
 
   context = ide_object_get_context (IDE_OBJECT (self));
-  build_manager = ide_build_manager_from_context (context);
-  pipeline = ide_build_manager_get_pipeline (build_manager);
-  builddir = ide_pipeline_get_builddir (pipeline);
+  build_system = ide_build_system_from_context (context);
 
-  replydir = g_build_path (G_DIR_SEPARATOR_S, builddir, ".cmake", "api", "v1", "reply", NULL);
-
-  if (!g_file_test (replydir, G_FILE_TEST_EXISTS))
+  if (!GBP_IS_CMAKE_BUILD_SYSTEM (build_system))
     {
       ide_task_return_new_error (task,
                                  G_IO_ERROR,
-                                 G_IO_ERROR_EXISTS,
-                                 "Response codemodel does not exists, ignoring");
+                                 G_IO_ERROR_NOT_SUPPORTED,
+                                 "Not a CMake-based build-system, ignoring request");
       IDE_EXIT;
     }
 
-  ret = g_ptr_array_new_with_free_func (g_object_unref);
-  reply = g_file_new_for_path (replydir);
-  enumerator = g_file_enumerate_children (reply, G_FILE_ATTRIBUTE_STANDARD_NAME, G_FILE_QUERY_INFO_NONE, cancellable, NULL);
-
-  while (TRUE)
-    {
-      g_autoptr(GFileInputStream) stream = NULL;
-      g_autoptr(JsonParser) parser = NULL;
-      GFile *file;
-      JsonNode *root;
-      JsonObject *jobject;
-
-      if (!g_file_enumerator_iterate (enumerator, NULL, &file, cancellable, NULL))
-        goto out;
-      if (!file)
-        break;
-
-      stream = g_file_read (file, cancellable, NULL);
-      parser = json_parser_new ();
-      json_parser_load_from_stream (parser, G_INPUT_STREAM (stream), cancellable, NULL);
-
-      root = json_parser_get_root (parser);
-      jobject = json_node_get_object (root);
-      if (json_object_has_member (jobject, "type") &&
-          ide_str_equal0 (json_object_get_string_member (jobject, "type"), "EXECUTABLE"))
-        {
-          gbp_cmake_build_target_provider_create_target (self, &ret, context, jobject);
-        }
-    }
-
-out:
-  IDE_PROBE;
-  ide_task_return_pointer (task, g_steal_pointer (&ret), g_ptr_array_unref);
+  /* Shares the codemodel used for build flags rather than parsing
+   * every file in the reply directory again.
+   */
+  gbp_cmake_build_system_load_codemodel_async (GBP_CMAKE_BUILD_SYSTEM (build_system),
+                                               cancellable,
+                                               gbp_cmake_build_target_provider_load_codemodel_cb,
+                                               g_steal_pointer (&task));
 
   IDE_EXIT;
 }
@@ -0,0 +1,832 @@
+/* gbp-cmake-codemodel.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-cmake-codemodel"
+
+#include "config.h"
+
+#include <json-glib/json-glib.h>
+
+#include "ide-compile-commands-private.h"
+
+#include "gbp-cmake-build-target.h"
+#include "gbp-cmake-codemodel.h"
+
+/*
+ * GbpCmakeCodemodel is a compact view of the reply to the "codemodel"
+ * query written by GbpCmakeBuildStageCodemodel. Rather than keeping an
+ * argv per file like compile_commands.json, every source file points at
+ * the compile group of its target, which is shared by all the files
+ * compiled with the same flags.
+ *
+ * It is immutable once loaded so it may be shared between threads.
+ */
+
+typedef struct
+{
+  char  **flags;
+  GFile  *directory;
+} CompileGroup;
+
+typedef struct
+{
+  char *name;
+  char *install_dir;
+} InstalledTarget;
+
+struct _GbpCmakeCodemodel
+{
+  GObject     parent_instance;
+
+  /* Name of the reply index file we were loaded from */
+  char       *index;
+
+  /* Name of the configuration requested when loading, if any */
+  char       *configuration;
+
+  /* Owned CompileGroup, shared by files */
+  GPtrArray  *groups;
+
+  /* Absolute path of source file to CompileGroup */
+  GHashTable *files;
+
+  /* InstalledTarget for installed executables */
+  GPtrArray  *executables;
+};
+
+G_DEFINE_FINAL_TYPE (GbpCmakeCodemodel, gbp_cmake_codemodel, G_TYPE_OBJECT)
+
+static const char *alternates[] = { ".c", ".cc", ".cpp", ".cxx", ".C" };
+
+static void
+compile_group_free (CompileGroup *group)
+{
+  g_clear_pointer (&group->flags, g_strfreev);
+  g_clear_object (&group->directory);
+  g_slice_free (CompileGroup, group);
+}
+
+static void
+installed_target_free (InstalledTarget *target)
+{
+  g_clear_pointer (&target->name, g_free);
+  g_clear_pointer (&target->install_dir, g_free);
+  g_slice_free (InstalledTarget, target);
+}
+
+static void
+gbp_cmake_codemodel_finalize (GObject *object)
+{
+  GbpCmakeCodemodel *self = (GbpCmakeCodemodel *)object;
+
+  g_clear_pointer (&self->index, g_free);
+  g_clear_pointer (&self->configuration, g_free);
+  g_clear_pointer (&self->files, g_hash_table_unref);
+  g_clear_pointer (&self->groups, g_ptr_array_unref);
+  g_clear_pointer (&self->executables, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (gbp_cmake_codemodel_parent_class)->finalize (object);
+}
+
+static void
+gbp_cmake_codemodel_class_init (GbpCmakeCodemodelClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gbp_cmake_codemodel_finalize;
+}
+
+static void
+gbp_cmake_codemodel_init (GbpCmakeCodemodel *self)
+{
+  self->groups = g_ptr_array_new_with_free_func ((GDestroyNotify)compile_group_free);
+  self->files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  self->executables = g_ptr_array_new_with_free_func ((GDestroyNotify)installed_target_free);
+}
+
+static const char *
+get_string (JsonObject *object,
+            const char *member)
+{
+  JsonNode *node;
+
+  if (object != NULL &&
+      (node = json_object_get_member (object, member)) &&
+      JSON_NODE_HOLDS_VALUE (node))
+    return json_node_get_string (node);
+
+  return NULL;
+}
+
+static JsonObject *
+get_object (JsonObject *object,
+            const char *member)
+{
+  JsonNode *node;
+
+  if (object != NULL &&
+      (node = json_object_get_member (object, member)) &&
+      JSON_NODE_HOLDS_OBJECT (node))
+    return json_node_get_object (node);
+
+  return NULL;
+}
+
+static JsonArray *
+get_array (JsonObject *object,
+           const char *member)
+{
+  JsonNode *node;
+
+  if (object != NULL &&
+      (node = json_object_get_member (object, member)) &&
+      JSON_NODE_HOLDS_ARRAY (node))
+    return json_node_get_array (node);
+
+  return NULL;
+}
+
+static JsonObject *
+get_object_element (JsonArray *array,
+                    guint      index_)
+{
+  JsonNode *node;
+
+  if (array != NULL &&
+      index_ < json_array_get_length (array) &&
+      (node = json_array_get_element (array, index_)) &&
+      JSON_NODE_HOLDS_OBJECT (node))
+    return json_node_get_object (node);
+
+  return NULL;
+}
+
+static JsonParser *
+load_reply (const char    *replydir,
+            const char    *name,
+            GCancellable  *cancellable,
+            GError       **error)
+{
+  g_autoptr(JsonParser) parser = NULL;
+  g_autofree char *path = NULL;
+
+  if (name == NULL || strchr (name, G_DIR_SEPARATOR) != NULL)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_FILENAME,
+                   "Invalid reply file name");
+      return NULL;
+    }
+
+  path = g_build_filename (replydir, name, NULL);
+  parser = json_parser_new ();
+
+  if (!json_parser_load_from_file (parser, path, error))
+    return NULL;
+
+  if (!JSON_NODE_HOLDS_OBJECT (json_parser_get_root (parser)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_INVALID_DATA,
+                   "%s is not a JSON object",
+                   name);
+      return NULL;
+    }
+
+  return g_steal_pointer (&parser);
+}
+
+static char *
+find_newest_index (const char    *replydir,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+  g_autoptr(GFileEnumerator) enumerator = NULL;
+  g_autoptr(GFile) directory = NULL;
+  g_autofree char *newest = NULL;
+  gpointer infoptr;
+
+  directory = g_file_new_for_path (replydir);
+  enumerator = g_file_enumerate_children (directory,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          cancellable,
+                                          error);
+  if (enumerator == NULL)
+    return NULL;
+
+  /* Index files are named with a timestamp, so the newest sorts last */
+  while ((infoptr = g_file_enumerator_next_file (enumerator, cancellable, NULL)))
+    {
+      g_autoptr(GFileInfo) info = infoptr;
+      const char *name = g_file_info_get_name (info);
+
+      if (g_str_has_prefix (name, "index-") &&
+          g_str_has_suffix (name, ".json") &&
+          g_strcmp0 (name, newest) > 0)
+        g_set_str (&newest, name);
+    }
+
+  if (newest == NULL)
+    g_set_error (error,
+                 G_IO_ERROR,
+                 G_IO_ERROR_NOT_FOUND,
+                 "No codemodel reply index found");
+
+  return g_steal_pointer (&newest);
+}
+
+static char *
+resolve_path (const char *base,
+              const char *path)
+{
+  if (path == NULL)
+    return NULL;
+
+  if (g_path_is_absolute (path))
+    return g_canonicalize_filename (path, NULL);
+
+  return g_canonicalize_filename (path, base);
+}
+
+static void
+add_fragment_argv (GPtrArray  *argv,
+                   const char *fragment)
+{
+  g_auto(GStrv) parsed = NULL;
+  int argc = 0;
+
+  if (fragment == NULL || !g_shell_parse_argv (fragment, &argc, &parsed, NULL))
+    return;
+
+  for (guint i = 0; parsed[i]; i++)
+    g_ptr_array_add (argv, g_steal_pointer (&parsed[i]));
+}
+
+static CompileGroup *
+compile_group_new (JsonObject *object,
+                   const char *source_dir,
+                   GFile      *directory)
+{
+  g_autoptr(GPtrArray) flags = g_ptr_array_new_with_free_func (g_free);
+  g_auto(GStrv) fragments = NULL;
+  CompileGroup *group;
+  JsonArray *ar;
+  JsonObject *sysroot;
+  const char *path;
+
+  /* Fragments are the raw flags (CMAKE_<LANG>_FLAGS, compile options)
+   * so they get the same filtering as compile_commands.json.
+   */
+  if ((ar = get_array (object, "compileCommandFragments")))
+    {
+      GPtrArray *argv = g_ptr_array_new ();
+
+      for (guint i = 0; i < json_array_get_length (ar); i++)
+        add_fragment_argv (argv, get_string (get_object_element (ar, i), "fragment"));
+
+      g_ptr_array_add (argv, NULL);
+      fragments = (char **)g_ptr_array_free (argv, FALSE);
+
+      _ide_compile_commands_filter_c (directory, NULL, &fragments);
+
+      for (guint i = 0; fragments[i]; i++)
+        g_ptr_array_add (flags, g_steal_pointer (&fragments[i]));
+    }
+
+  if ((ar = get_array (object, "includes")))
+    {
+      for (guint i = 0; i < json_array_get_length (ar); i++)
+        {
+          JsonObject *include = get_object_element (ar, i);
+          g_autofree char *resolved = resolve_path (source_dir, get_string (include, "path"));
+          JsonNode *is_system;
+
+          if (resolved == NULL)
+            continue;
+
+          if ((is_system = json_object_get_member (include, "isSystem")) &&
+              JSON_NODE_HOLDS_VALUE (is_system) &&
+              json_node_get_boolean (is_system))
+            {
+              g_ptr_array_add (flags, g_strdup ("-isystem"));
+              g_ptr_array_add (flags, g_steal_pointer (&resolved));
+            }
+          else
+            {
+              g_ptr_array_add (flags, g_strdup_printf ("-I%s", resolved));
+            }
+        }
+    }
+
+  if ((ar = get_array (object, "defines")))
+    {
+      for (guint i = 0; i < json_array_get_length (ar); i++)
+        {
+          const char *define = get_string (get_object_element (ar, i), "define");
+
+          if (define != NULL)
+            g_ptr_array_add (flags, g_strdup_printf ("-D%s", define));
+        }
+    }
+
+  if ((sysroot = get_object (object, "sysroot")) &&
+      (path = get_string (sysroot, "path")))
+    g_ptr_array_add (flags, g_strdup_printf ("--sysroot=%s", path));
+
+  g_ptr_array_add (flags, NULL);
+
+  group = g_slice_new0 (CompileGroup);
+  group->flags = (char **)g_ptr_array_free (g_steal_pointer (&flags), FALSE);
+  group->directory = g_object_ref (directory);
+
+  return group;
+}
+
+static void
+load_installed (GbpCmakeCodemodel *self,
+                JsonObject        *target)
+{
+  g_autofree char *name = NULL;
+  g_autofree char *install_dir = NULL;
+  InstalledTarget *installed;
+  JsonObject *install;
+  const char *artifact;
+  const char *prefix;
+  const char *destination;
+
+  if (g_strcmp0 (get_string (target, "type"), "EXECUTABLE") != 0 ||
+      !(install = get_object (target, "install")) ||
+      !(artifact = get_string (get_object_element (get_array (target, "artifacts"), 0), "path")) ||
+      !(prefix = get_string (get_object (install, "prefix"), "path")) ||
+      !(destination = get_string (get_object_element (get_array (install, "destinations"), 0), "path")))
+    return;
+
+  name = g_path_get_basename (artifact);
+
+  if (g_str_has_prefix (destination, prefix) || g_path_is_absolute (destination))
+    install_dir = g_strdup (destination);
+  else
+    install_dir = g_build_filename (prefix, destination, NULL);
+
+  installed = g_slice_new0 (InstalledTarget);
+  installed->name = g_steal_pointer (&name);
+  installed->install_dir = g_steal_pointer (&install_dir);
+  g_ptr_array_add (self->executables, installed);
+}
+
+static void
+load_target (GbpCmakeCodemodel *self,
+             JsonObject        *target,
+             const char        *source_dir,
+             const char        *build_dir)
+{
+  g_autoptr(GFile) directory = NULL;
+  g_autofree char *target_build_dir = NULL;
+  CompileGroup **groups = NULL;
+  JsonArray *compile_groups;
+  JsonArray *sources;
+  guint n_groups;
+
+  load_installed (self, target);
+
+  if (!(compile_groups = get_array (target, "compileGroups")) ||
+      !(n_groups = json_array_get_length (compile_groups)))
+    return;
+
+  target_build_dir = resolve_path (build_dir, get_string (get_object (target, "paths"), "build"));
+  directory = g_file_new_for_path (target_build_dir ? target_build_dir : build_dir);
+
+  groups = g_new0 (CompileGroup *, n_groups);
+
+  for (guint i = 0; i < n_groups; i++)
+    {
+      JsonObject *object = get_object_element (compile_groups, i);
+
+      if (object == NULL)
+        continue;
+
+      groups[i] = compile_group_new (object, source_dir, directory);
+      g_ptr_array_add (self->groups, groups[i]);
+    }
+
+  if ((sources = get_array (target, "sources")))
+    {
+      for (guint i = 0; i < json_array_get_length (sources); i++)
+        {
+          JsonObject *source = get_object_element (sources, i);
+          g_autofree char *path = resolve_path (source_dir, get_string (source, "path"));
+          CompileGroup *group = NULL;
+          JsonNode *index_node;
+
+          if (path == NULL)
+            continue;
+
+          /* Headers listed in the target have no compile group, so use
+           * the first one of the target as that is a good approximation.
+           */
+          if ((index_node = json_object_get_member (source, "compileGroupIndex")) &&
+              JSON_NODE_HOLDS_VALUE (index_node))
+            {
+              gint64 idx = json_node_get_int (index_node);
+
+              if (idx >= 0 && idx < n_groups)
+                group = groups[idx];
+            }
+          else if (!g_hash_table_contains (self->files, path))
+            {
+              group = groups[0];
+            }
+
+          if (group != NULL)
+            g_hash_table_insert (self->files, g_steal_pointer (&path), group);
+        }
+    }
+
+  g_free (groups);
+}
+
+typedef struct
+{
+  char *builddir;
+  char *configuration;
+} Load;
+
+static void
+load_free (Load *load)
+{
+  g_clear_pointer (&load->builddir, g_free);
+  g_clear_pointer (&load->configuration, g_free);
+  g_slice_free (Load, load);
+}
+
+static JsonObject *
+find_configuration (JsonArray  *configurations,
+                    const char *name)
+{
+  /* Multi-config generators list every configuration, the first being
+   * the default one. Single-config generators only have one.
+   */
+  if (name != NULL)
+    {
+      for (guint i = 0; configurations && i < json_array_get_length (configurations); i++)
+        {
+          JsonObject *configuration = get_object_element (configurations, i);
+          const char *configuration_name = get_string (configuration, "name");
+
+          if (configuration_name != NULL &&
+              g_ascii_strcasecmp (configuration_name, name) == 0)
+            return configuration;
+        }
+    }
+
+  return get_object_element (configurations, 0);
+}
+
+static void
+gbp_cmake_codemodel_load_worker (IdeTask      *task,
+                                 gpointer      source_object,
+                                 gpointer      task_data,
+                                 GCancellable *cancellable)
+{
+  Load *load = task_data;
+  const char *builddir;
+  g_autoptr(GbpCmakeCodemodel) self = NULL;
+  g_autoptr(JsonParser) index_parser = NULL;
+  g_autoptr(JsonParser) codemodel_parser = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *replydir = NULL;
+  g_autofree char *index = NULL;
+  g_autofree char *source_dir = NULL;
+  g_autofree char *build_dir = NULL;
+  GbpCmakeCodemodel *previous;
+  const char *codemodel_file = NULL;
+  JsonObject *configuration;
+  JsonObject *paths;
+  JsonObject *root;
+  JsonArray *objects;
+  JsonArray *targets;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_TASK (task));
+  g_assert (load != NULL);
+  g_assert (load->builddir != NULL);
+
+  builddir = load->builddir;
+  replydir = g_build_filename (builddir, ".cmake", "api", "v1", "reply", NULL);
+
+  if (!(index = find_newest_index (replydir, cancellable, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  /* Nothing changed since the last time we loaded */
+  previous = g_object_get_data (G_OBJECT (task), "PREVIOUS_CODEMODEL");
+  if (previous != NULL &&
+      g_strcmp0 (previous->index, index) == 0 &&
+      g_strcmp0 (previous->configuration, load->configuration) == 0)
+    {
+      ide_task_return_pointer (task, g_object_ref (previous), g_object_unref);
+      IDE_EXIT;
+    }
+
+  if (!(index_parser = load_reply (replydir, index, cancellable, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  root = json_node_get_object (json_parser_get_root (index_parser));
+  objects = get_array (root, "objects");
+
+  for (guint i = 0; objects && i < json_array_get_length (objects); i++)
+    {
+      JsonObject *object = get_object_element (objects, i);
+
+      if (g_strcmp0 (get_string (object, "kind"), "codemodel") == 0)
+        {
+          codemodel_file = get_string (object, "jsonFile");
+          break;
+        }
+    }
+
+  if (!(codemodel_parser = load_reply (replydir, codemodel_file, cancellable, &error)))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  root = json_node_get_object (json_parser_get_root (codemodel_parser));
+  paths = get_object (root, "paths");
+  source_dir = g_strdup (get_string (paths, "source"));
+  build_dir = g_strdup (get_string (paths, "build"));
+
+  if (source_dir == NULL || build_dir == NULL)
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_INVALID_DATA,
+                                 "Codemodel is missing source or build paths");
+      IDE_EXIT;
+    }
+
+  self = g_object_new (GBP_TYPE_CMAKE_CODEMODEL, NULL);
+  self->index = g_steal_pointer (&index);
+  self->configuration = g_strdup (load->configuration);
+
+  configuration = find_configuration (get_array (root, "configurations"), load->configuration);
+  targets = get_array (configuration, "targets");
+
+  for (guint i = 0; targets && i < json_array_get_length (targets); i++)
+    {
+      g_autoptr(JsonParser) target_parser = NULL;
+      g_autoptr(GError) target_error = NULL;
+      const char *json_file = get_string (get_object_element (targets, i), "jsonFile");
+
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      if (!(target_parser = load_reply (replydir, json_file, cancellable, &target_error)))
+        {
+          g_debug ("Failed to load cmake target: %s", target_error->message);
+          continue;
+        }
+
+      load_target (self,
+                   json_node_get_object (json_parser_get_root (target_parser)),
+                   source_dir,
+                   build_dir);
+    }
+
+  if (ide_task_return_error_if_cancelled (task))
+    IDE_EXIT;
+
+  IDE_TRACE_MSG ("Loaded codemodel with %u files sharing %u compile groups",
+                 g_hash_table_size (self->files), self->groups->len);
+
+  ide_task_return_pointer (task, g_steal_pointer (&self), g_object_unref);
+
+  IDE_EXIT;
+}
+
+/**
+ * gbp_cmake_codemodel_load_async:
+ * @builddir: the cmake build directory
+ * @configuration: (nullable): the configuration to load, such as "Debug"
+ * @previous: (nullable): a previously loaded codemodel
+ *
+ * Loads the newest codemodel reply from @builddir. If @previous was
+ * loaded from the same reply index, it is returned instead of parsing
+ * the reply again.
+ *
+ * Multi-config generators describe every configuration. The targets of
+ * @configuration are used when it is found, otherwise those of the
+ * default configuration.
+ */
+void
+gbp_cmake_codemodel_load_async (const char          *builddir,
+                                const char          *configuration,
+                                GbpCmakeCodemodel   *previous,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+  Load *load;
+
+  g_return_if_fail (builddir != NULL);
+  g_return_if_fail (!previous || GBP_IS_CMAKE_CODEMODEL (previous));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (NULL, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_cmake_codemodel_load_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+
+  load = g_slice_new0 (Load);
+  load->builddir = g_strdup (builddir);
+  load->configuration = g_strdup (configuration);
+  ide_task_set_task_data (task, load, load_free);
+
+  if (previous != NULL)
+    g_object_set_data_full (G_OBJECT (task),
+                            "PREVIOUS_CODEMODEL",
+                            g_object_ref (previous),
+                            g_object_unref);
+
+  ide_task_run_in_thread (task, gbp_cmake_codemodel_load_worker);
+}
+
+GbpCmakeCodemodel *
+gbp_cmake_codemodel_load_finish (GAsyncResult  *result,
+                                 GError       **error)
+{
+  g_return_val_if_fail (IDE_IS_TASK (result), NULL);
+
+  return ide_task_propagate_pointer (IDE_TASK (result), error);
+}
+
+const char *
+gbp_cmake_codemodel_get_index (GbpCmakeCodemodel *self)
+{
+  g_return_val_if_fail (GBP_IS_CMAKE_CODEMODEL (self), NULL);
+
+  return self->index;
+}
+
+static const CompileGroup *
+find_group (GbpCmakeCodemodel *self,
+            const char        *path)
+{
+  const CompileGroup *group;
+  const char *dot;
+
+  if ((group = g_hash_table_lookup (self->files, path)))
+    return group;
+
+  /* Headers which are not part of a target may still have a source file
+   * of the same name next to them which we can borrow flags from.
+   */
+  if ((dot = strrchr (path, '.')) && strchr (dot, G_DIR_SEPARATOR) == NULL)
+    {
+      g_autofree char *prefix = g_strndup (path, dot - path);
+
+      for (guint i = 0; i < G_N_ELEMENTS (alternates); i++)
+        {
+          g_autofree char *alternate = g_strconcat (prefix, alternates[i], NULL);
+
+          if ((group = g_hash_table_lookup (self->files, alternate)))
+            return group;
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * gbp_cmake_codemodel_lookup_flags:
+ * @self: a #GbpCmakeCodemodel
+ * @file: the source file
+ * @system_includes: (nullable): additional system include directories
+ * @directory: (out) (optional): location for the directory to compile from
+ *
+ * Returns: (transfer full) (nullable): the compiler flags for @file or
+ *   %NULL if @file is not known to the codemodel
+ */
+char **
+gbp_cmake_codemodel_lookup_flags (GbpCmakeCodemodel   *self,
+                                  GFile               *file,
+                                  const char * const  *system_includes,
+                                  GFile              **directory)
+{
+  g_autofree char *path = NULL;
+  const CompileGroup *group;
+  GPtrArray *ar;
+
+  g_return_val_if_fail (GBP_IS_CMAKE_CODEMODEL (self), NULL);
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  if (!(path = g_file_get_path (file)) ||
+      !(group = find_group (self, path)))
+    return NULL;
+
+  ar = g_ptr_array_new ();
+
+  if (system_includes != NULL)
+    {
+      for (guint i = 0; system_includes[i]; i++)
+        g_ptr_array_add (ar, g_strdup_printf ("-I%s", system_includes[i]));
+    }
+
+  for (guint i = 0; group->flags[i]; i++)
+    g_ptr_array_add (ar, g_strdup (group->flags[i]));
+
+  g_ptr_array_add (ar, NULL);
+
+  if (directory != NULL)
+    *directory = g_object_ref (group->directory);
+
+  return (char **)g_ptr_array_free (ar, FALSE);
+}
+
+/**
+ * gbp_cmake_codemodel_list_targets:
+ *
+ * Returns: (transfer full) (element-type IdeBuildTarget): build targets
+ *   for the installed executables
+ */
+GPtrArray *
+gbp_cmake_codemodel_list_targets (GbpCmakeCodemodel *self,
+                                  IdeContext        *context)
+{
+  GPtrArray *ret;
+
+  g_return_val_if_fail (GBP_IS_CMAKE_CODEMODEL (self), NULL);
+  g_return_val_if_fail (!context || IDE_IS_CONTEXT (context), NULL);
+
+  ret = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (guint i = 0; i < self->executables->len; i++)
+    {
+      const InstalledTarget *installed = g_ptr_array_index (self->executables, i);
+      g_autoptr(GFile) install_directory = g_file_new_for_path (installed->install_dir);
+
+      g_ptr_array_add (ret, gbp_cmake_build_target_new (context, install_directory, installed->name));
+    }
+
+  return ret;
+}
+
+/**
+ * gbp_cmake_codemodel_list_commands:
+ *
+ * Returns: (transfer full): a #GListModel of #IdeRunCommand for the
+ *   installed executables
+ */
+GListModel *
+gbp_cmake_codemodel_list_commands (GbpCmakeCodemodel *self)
+{
+  GListStore *store;
+
+  g_return_val_if_fail (GBP_IS_CMAKE_CODEMODEL (self), NULL);
+
+  store = g_list_store_new (IDE_TYPE_RUN_COMMAND);
+
+  for (guint i = 0; i < self->executables->len; i++)
+    {
+      const InstalledTarget *installed = g_ptr_array_index (self->executables, i);
+      g_autoptr(IdeRunCommand) run_command = ide_run_command_new ();
+      g_autofree char *id = g_strdup_printf ("cmake:%s", installed->name);
+      g_autofree char *path = g_build_filename (installed->install_dir, installed->name, NULL);
+
+      ide_run_command_set_kind (run_command, IDE_RUN_COMMAND_KIND_APPLICATION);
+      ide_run_command_set_id (run_command, id);
+      ide_run_command_set_display_name (run_command, installed->name);
+      ide_run_command_append_argv (run_command, path);
+      ide_run_command_set_can_default (run_command, TRUE);
+
+      g_list_store_append (store, run_command);
+    }
+
+  return G_LIST_MODEL (store);
+}
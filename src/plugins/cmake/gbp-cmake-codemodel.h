@@ -0,0 +1,48 @@
+/* gbp-cmake-codemodel.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libide-foundry.h>
+
+G_BEGIN_DECLS
+
+#define GBP_TYPE_CMAKE_CODEMODEL (gbp_cmake_codemodel_get_type())
+
+G_DECLARE_FINAL_TYPE (GbpCmakeCodemodel, gbp_cmake_codemodel, GBP, CMAKE_CODEMODEL, GObject)
+
+void                gbp_cmake_codemodel_load_async      (const char           *builddir,
+                                                         const char           *configuration,
+                                                         GbpCmakeCodemodel    *previous,
+                                                         GCancellable         *cancellable,
+                                                         GAsyncReadyCallback   callback,
+                                                         gpointer              user_data);
+GbpCmakeCodemodel  *gbp_cmake_codemodel_load_finish     (GAsyncResult         *result,
+                                                         GError              **error);
+const char         *gbp_cmake_codemodel_get_index       (GbpCmakeCodemodel    *self);
+char              **gbp_cmake_codemodel_lookup_flags    (GbpCmakeCodemodel    *self,
+                                                         GFile                *file,
+                                                         const char * const   *system_includes,
+                                                         GFile               **directory);
+GPtrArray          *gbp_cmake_codemodel_list_targets    (GbpCmakeCodemodel    *self,
+                                                         IdeContext           *context);
+GListModel         *gbp_cmake_codemodel_list_commands   (GbpCmakeCodemodel    *self);
+
+G_END_DECLS
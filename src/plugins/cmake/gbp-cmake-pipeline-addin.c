@@ -158,6 +158,7 @@ gbp_cmake_pipeline_addin_load (IdePipelineAddin *addin,
     {
       GbpCMakeBuildStageCrossFile *cross_file_stage;
       cross_file_stage = gbp_cmake_build_stage_cross_file_new (toolchain);
+      ide_pipeline_stage_set_concurrent (IDE_PIPELINE_STAGE (cross_file_stage), TRUE);
       crossbuild_file = gbp_cmake_build_stage_cross_file_get_path (cross_file_stage, pipeline);
 
       id = ide_pipeline_attach (pipeline, IDE_PIPELINE_PHASE_PREPARE, 0, IDE_PIPELINE_STAGE (cross_file_stage));
@@ -122,6 +122,51 @@ gbp_cmake_run_command_provider_list_commands_load_cb (GObject      *object,
   IDE_EXIT;
 }
 
+static void
+gbp_cmake_run_command_provider_list_commands_codemodel_cb (GObject      *object,
+                                                           GAsyncResult *result,
+                                                           gpointer      user_data)
+{
+  GbpCMakeBuildSystem *build_system = (GbpCMakeBuildSystem *)object;
+  g_autoptr(GbpCmakeCodemodel) codemodel = NULL;
+  g_autoptr(GListModel) commands = NULL;
+  g_autoptr(GFile) manifest_file = NULL;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *manifest_path = NULL;
+  IdePipeline *pipeline;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_CMAKE_BUILD_SYSTEM (build_system));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  if ((codemodel = gbp_cmake_build_system_load_codemodel_finish (build_system, result, &error)))
+    {
+      commands = gbp_cmake_codemodel_list_commands (codemodel);
+
+      if (g_list_model_get_n_items (commands) > 0)
+        {
+          ide_task_return_pointer (task, g_steal_pointer (&commands), g_object_unref);
+          IDE_EXIT;
+        }
+    }
+
+  /* Fallback to what was installed by the last "make install" */
+  pipeline = ide_task_get_task_data (task);
+  manifest_path = ide_pipeline_build_builddir_path (pipeline, "install_manifest.txt", NULL);
+  manifest_file = g_file_new_for_path (manifest_path);
+
+  g_file_load_contents_async (manifest_file,
+                              ide_task_get_cancellable (task),
+                              gbp_cmake_run_command_provider_list_commands_load_cb,
+                              g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
 static void
 gbp_cmake_run_command_provider_list_commands_async (IdeRunCommandProvider *provider,
                                                     GCancellable          *cancellable,
@@ -129,8 +174,6 @@ gbp_cmake_run_command_provider_list_commands_async (IdeRunCommandProvider *provi
                                                     gpointer               user_data)
 {
   g_autoptr(IdeTask) task = NULL;
-  g_autoptr(GFile) manifest_file = NULL;
-  g_autofree char *manifest_path = NULL;
   IdeBuildManager *build_manager;
   IdeBuildSystem *build_system;
   IdePipeline *pipeline;
@@ -169,13 +212,12 @@ gbp_cmake_run_command_provider_list_commands_async (IdeRunCommandProvider *provi
       IDE_EXIT;
     }
 
-  manifest_path = ide_pipeline_build_builddir_path (pipeline, "install_manifest.txt", NULL);
-  manifest_file = g_file_new_for_path (manifest_path);
+  ide_task_set_task_data (task, g_object_ref (pipeline), g_object_unref);
 
-  g_file_load_contents_async (manifest_file,
-                              cancellable,
-                              gbp_cmake_run_command_provider_list_commands_load_cb,
-                              g_steal_pointer (&task));
+  gbp_cmake_build_system_load_codemodel_async (GBP_CMAKE_BUILD_SYSTEM (build_system),
+                                               cancellable,
+                                               gbp_cmake_run_command_provider_list_commands_codemodel_cb,
+                                               g_steal_pointer (&task));
 
   IDE_EXIT;
 }
@@ -486,6 +486,22 @@ ide_ctags_index_get_size (IdeCtagsIndex *self)
   return 0;
 }
 
+gsize
+ide_ctags_index_get_memory_size (IdeCtagsIndex *self)
+{
+  gsize size = 0;
+
+  g_return_val_if_fail (IDE_IS_CTAGS_INDEX (self), 0);
+
+  if (self->index != NULL)
+    size += self->index->len * sizeof (IdeCtagsIndexEntry);
+
+  if (self->buffer != NULL)
+    size += g_bytes_get_size (self->buffer);
+
+  return size;
+}
+
 static const IdeCtagsIndexEntry *
 ide_ctags_index_lookup_full (IdeCtagsIndex *self,
                              const gchar   *keyword,
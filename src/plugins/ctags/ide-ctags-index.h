@@ -79,6 +79,7 @@ gchar                    *ide_ctags_index_resolve_path  (IdeCtagsIndex
 GFile                    *ide_ctags_index_get_file      (IdeCtagsIndex            *self);
 gboolean                  ide_ctags_index_get_is_empty  (IdeCtagsIndex            *self);
 gsize                     ide_ctags_index_get_size      (IdeCtagsIndex            *self);
+gsize                     ide_ctags_index_get_memory_size (IdeCtagsIndex          *self);
 const gchar              *ide_ctags_index_get_path_root (IdeCtagsIndex            *self);
 const IdeCtagsIndexEntry *ide_ctags_index_lookup        (IdeCtagsIndex            *self,
                                                          const gchar              *keyword,
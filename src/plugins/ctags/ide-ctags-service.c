@@ -822,6 +822,12 @@ ide_ctags_service_class_init (IdeCtagsServiceClass *klass)
   g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
+static gsize
+ide_ctags_service_index_size (gconstpointer value)
+{
+  return ide_ctags_index_get_memory_size ((IdeCtagsIndex *)value);
+}
+
 static void
 ide_ctags_service_init (IdeCtagsService *self)
 {
@@ -844,6 +850,11 @@ ide_ctags_service_init (IdeCtagsService *self)
                                       NULL);
 
   ide_task_cache_set_name (self->indexes, "ctags index cache");
+
+  /* Completion and highlighting read every index with get_values(), so
+   * this cache is the only copy and must not be evicted.
+   */
+  ide_task_cache_set_size_func (self->indexes, ide_ctags_service_index_size);
 }
 
 /**
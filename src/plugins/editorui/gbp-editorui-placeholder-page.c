@@ -0,0 +1,177 @@
+/* gbp-editorui-placeholder-page.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-editorui-placeholder-page"
+
+#include "config.h"
+
+#include <libide-io.h>
+
+#include "gbp-editorui-placeholder-page.h"
+
+/* A placeholder keeps the position of a page restored from the session
+ * until the buffer has been loaded and an IdeEditorPage can replace it.
+ */
+struct _GbpEditoruiPlaceholderPage
+{
+  IdePage     parent_instance;
+
+  GFile      *file;
+  char       *language_id;
+  GtkSpinner *spinner;
+
+  guint       insert_line;
+  guint       insert_line_offset;
+  guint       bounds_line;
+  guint       bounds_line_offset;
+};
+
+G_DEFINE_FINAL_TYPE (GbpEditoruiPlaceholderPage, gbp_editorui_placeholder_page, IDE_TYPE_PAGE)
+
+static GFile *
+gbp_editorui_placeholder_page_get_file_or_directory (IdePage *page)
+{
+  return g_object_ref (GBP_EDITORUI_PLACEHOLDER_PAGE (page)->file);
+}
+
+static void
+gbp_editorui_placeholder_page_finalize (GObject *object)
+{
+  GbpEditoruiPlaceholderPage *self = (GbpEditoruiPlaceholderPage *)object;
+
+  g_clear_object (&self->file);
+  g_clear_pointer (&self->language_id, g_free);
+
+  G_OBJECT_CLASS (gbp_editorui_placeholder_page_parent_class)->finalize (object);
+}
+
+static void
+gbp_editorui_placeholder_page_class_init (GbpEditoruiPlaceholderPageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  IdePageClass *page_class = IDE_PAGE_CLASS (klass);
+
+  object_class->finalize = gbp_editorui_placeholder_page_finalize;
+
+  page_class->get_file_or_directory = gbp_editorui_placeholder_page_get_file_or_directory;
+}
+
+static void
+gbp_editorui_placeholder_page_init (GbpEditoruiPlaceholderPage *self)
+{
+  self->spinner = g_object_new (GTK_TYPE_SPINNER,
+                                "halign", GTK_ALIGN_CENTER,
+                                "valign", GTK_ALIGN_CENTER,
+                                "hexpand", TRUE,
+                                "vexpand", TRUE,
+                                "width-request", 32,
+                                "height-request", 32,
+                                NULL);
+  ide_page_add_content_widget (IDE_PAGE (self), GTK_WIDGET (self->spinner));
+}
+
+GbpEditoruiPlaceholderPage *
+gbp_editorui_placeholder_page_new (GFile      *file,
+                                   const char *language_id)
+{
+  GbpEditoruiPlaceholderPage *self;
+  g_autofree char *name = NULL;
+  g_autofree char *content_type = NULL;
+  g_autoptr(GIcon) icon = NULL;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  self = g_object_new (GBP_TYPE_EDITORUI_PLACEHOLDER_PAGE, NULL);
+  self->file = g_object_ref (file);
+  self->language_id = g_strdup (language_id);
+
+  /* Guess from the name only, avoiding I/O until the page is loaded */
+  name = g_file_get_basename (file);
+  content_type = g_content_type_guess (name, NULL, 0, NULL);
+  icon = ide_g_content_type_get_symbolic_icon (content_type, name);
+
+  panel_widget_set_title (PANEL_WIDGET (self), name);
+  panel_widget_set_icon (PANEL_WIDGET (self), icon);
+
+  return self;
+}
+
+GFile *
+gbp_editorui_placeholder_page_get_file (GbpEditoruiPlaceholderPage *self)
+{
+  g_return_val_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self), NULL);
+
+  return self->file;
+}
+
+const char *
+gbp_editorui_placeholder_page_get_language_id (GbpEditoruiPlaceholderPage *self)
+{
+  g_return_val_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self), NULL);
+
+  return self->language_id;
+}
+
+void
+gbp_editorui_placeholder_page_get_selection (GbpEditoruiPlaceholderPage *self,
+                                             guint                      *insert_line,
+                                             guint                      *insert_line_offset,
+                                             guint                      *bounds_line,
+                                             guint                      *bounds_line_offset)
+{
+  g_return_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self));
+
+  *insert_line = self->insert_line;
+  *insert_line_offset = self->insert_line_offset;
+  *bounds_line = self->bounds_line;
+  *bounds_line_offset = self->bounds_line_offset;
+}
+
+void
+gbp_editorui_placeholder_page_set_selection (GbpEditoruiPlaceholderPage *self,
+                                             guint                       insert_line,
+                                             guint                       insert_line_offset,
+                                             guint                       bounds_line,
+                                             guint                       bounds_line_offset)
+{
+  g_return_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self));
+
+  self->insert_line = insert_line;
+  self->insert_line_offset = insert_line_offset;
+  self->bounds_line = bounds_line;
+  self->bounds_line_offset = bounds_line_offset;
+}
+
+gboolean
+gbp_editorui_placeholder_page_get_loading (GbpEditoruiPlaceholderPage *self)
+{
+  g_return_val_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self), FALSE);
+
+  return gtk_spinner_get_spinning (self->spinner);
+}
+
+void
+gbp_editorui_placeholder_page_set_loading (GbpEditoruiPlaceholderPage *self,
+                                           gboolean                    loading)
+{
+  g_return_if_fail (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (self));
+
+  gtk_spinner_set_spinning (self->spinner, loading);
+}
@@ -0,0 +1,49 @@
+/* gbp-editorui-placeholder-page.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libide-gui.h>
+
+G_BEGIN_DECLS
+
+#define GBP_TYPE_EDITORUI_PLACEHOLDER_PAGE (gbp_editorui_placeholder_page_get_type())
+
+G_DECLARE_FINAL_TYPE (GbpEditoruiPlaceholderPage, gbp_editorui_placeholder_page, GBP, EDITORUI_PLACEHOLDER_PAGE, IdePage)
+
+GbpEditoruiPlaceholderPage *gbp_editorui_placeholder_page_new             (GFile                      *file,
+                                                                           const char                 *language_id);
+GFile                      *gbp_editorui_placeholder_page_get_file        (GbpEditoruiPlaceholderPage *self);
+const char                 *gbp_editorui_placeholder_page_get_language_id (GbpEditoruiPlaceholderPage *self);
+void                        gbp_editorui_placeholder_page_get_selection   (GbpEditoruiPlaceholderPage *self,
+                                                                           guint                      *insert_line,
+                                                                           guint                      *insert_line_offset,
+                                                                           guint                      *bounds_line,
+                                                                           guint                      *bounds_line_offset);
+void                        gbp_editorui_placeholder_page_set_selection   (GbpEditoruiPlaceholderPage *self,
+                                                                           guint                       insert_line,
+                                                                           guint                       insert_line_offset,
+                                                                           guint                       bounds_line,
+                                                                           guint                       bounds_line_offset);
+gboolean                    gbp_editorui_placeholder_page_get_loading     (GbpEditoruiPlaceholderPage *self);
+void                        gbp_editorui_placeholder_page_set_loading     (GbpEditoruiPlaceholderPage *self,
+                                                                           gboolean                    loading);
+
+G_END_DECLS
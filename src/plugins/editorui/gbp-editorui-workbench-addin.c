@@ -26,6 +26,7 @@
 #include <libide-gui.h>
 #include <libide-sourceview.h>
 
+#include "gbp-editorui-placeholder-page.h"
 #include "gbp-editorui-workbench-addin.h"
 
 struct _GbpEditoruiWorkbenchAddin
@@ -151,6 +152,61 @@ find_preferred_workspace_cb (IdeWorkspace *workspace,
     *out_workspace = workspace;
 }
 
+typedef struct
+{
+  GFile                      *file;
+  GbpEditoruiPlaceholderPage *placeholder;
+} FindPlaceholder;
+
+static void
+find_placeholder_cb (IdePage  *page,
+                     gpointer  user_data)
+{
+  FindPlaceholder *find = user_data;
+
+  g_assert (IDE_IS_PAGE (page));
+  g_assert (find != NULL);
+
+  if (find->placeholder == NULL &&
+      GBP_IS_EDITORUI_PLACEHOLDER_PAGE (page) &&
+      g_file_equal (find->file,
+                    gbp_editorui_placeholder_page_get_file (GBP_EDITORUI_PLACEHOLDER_PAGE (page))))
+    find->placeholder = GBP_EDITORUI_PLACEHOLDER_PAGE (page);
+}
+
+/*
+ * Pages restored from the session start out as placeholders until their
+ * buffer is loaded. Raising the placeholder loads it immediately and it
+ * will then be replaced with an editor page for the buffer, so use that
+ * rather than adding a second page for the same file.
+ */
+static gboolean
+focus_placeholder (IdeWorkspace           *workspace,
+                   const OpenFileTaskData *state)
+{
+  FindPlaceholder find = { state->file, NULL };
+
+  g_assert (IDE_IS_WORKSPACE (workspace));
+  g_assert (state != NULL);
+
+  ide_workspace_foreach_page (workspace, find_placeholder_cb, &find);
+
+  if (find.placeholder == NULL)
+    return FALSE;
+
+  if (state->at_line > -1)
+    gbp_editorui_placeholder_page_set_selection (find.placeholder,
+                                                 state->at_line,
+                                                 MAX (0, state->at_line_offset),
+                                                 state->at_line,
+                                                 MAX (0, state->at_line_offset));
+
+  panel_widget_raise (PANEL_WIDGET (find.placeholder));
+  gtk_widget_grab_focus (GTK_WIDGET (find.placeholder));
+
+  return TRUE;
+}
+
 static void
 gbp_editorui_workbench_addin_open_cb (GObject      *object,
                                       GAsyncResult *result,
@@ -206,6 +262,9 @@ gbp_editorui_workbench_addin_open_cb (GObject      *object,
   g_assert (state != NULL);
   g_assert (G_IS_FILE (state->file));
 
+  if (focus_placeholder (workspace, state))
+    IDE_GOTO (failure);
+
   if (state->at_line > -1)
     {
       g_autoptr(IdeLocation) location = NULL;
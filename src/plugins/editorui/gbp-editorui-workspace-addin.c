@@ -29,9 +29,13 @@
 
 #include "ide-workspace-private.h"
 
+#include "gbp-editorui-placeholder-page.h"
 #include "gbp-editorui-position-label.h"
 #include "gbp-editorui-workspace-addin.h"
 
+/* Background loads of restored pages which are not yet visible */
+#define MAX_RESTORE_IN_FLIGHT 2
+
 struct _GbpEditoruiWorkspaceAddin
 {
   GObject                   parent_instance;
@@ -68,19 +72,17 @@ struct _GbpEditoruiWorkspaceAddin
   guint                     queued_cursor_moved;
 
   IdeEditorPage            *page;
+
+  /* Placeholders from session restore waiting to be loaded */
+  GQueue                    restore_queue;
+  guint                     restore_source;
+  guint                     n_restoring;
 };
 
 typedef struct
 {
-  IdeWorkspace *workspace;
-  PanelPosition *position;
-  char *uri;
-  char *language_id;
-  guint sel_insert_line;
-  guint sel_insert_line_offset;
-  guint sel_bounds_line;
-  guint sel_bounds_line_offset;
-  gboolean has_focus;
+  GbpEditoruiWorkspaceAddin  *self;
+  GbpEditoruiPlaceholderPage *placeholder;
 } RestorePage;
 
 static IdeActionMixin action_mixin;
@@ -101,10 +103,8 @@ static void
 static void
 restore_page_free (RestorePage *rp)
 {
-  g_clear_object (&rp->workspace);
-  g_clear_object (&rp->position);
-  g_clear_pointer (&rp->uri, g_free);
-  g_clear_pointer (&rp->language_id, g_free);
+  g_clear_object (&rp->self);
+  g_clear_object (&rp->placeholder);
   g_slice_free (RestorePage, rp);
 }
 
@@ -608,6 +608,8 @@ gbp_editorui_workspace_addin_unload (IdeWorkspaceAddin *addin,
   g_clear_object (&self->editor_settings);
 
   g_clear_handle_id (&self->queued_cursor_moved, g_source_remove);
+  g_clear_handle_id (&self->restore_source, g_source_remove);
+  g_queue_clear_full (&self->restore_queue, g_object_unref);
 
   clear_from_statusbar (self->statusbar, &self->indentation);
   clear_from_statusbar (self->statusbar, &self->position);
@@ -720,6 +722,40 @@ gbp_editorui_workspace_addin_save_session_page_cb (IdePage  *page,
       if (page == ide_workspace_get_most_recent_page (workspace))
         ide_session_item_set_metadata (item, "has-focus", "b", TRUE);
 
+      ide_session_append (session, item);
+    }
+  else if (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (page))
+    {
+      GbpEditoruiPlaceholderPage *placeholder = GBP_EDITORUI_PLACEHOLDER_PAGE (page);
+      g_autoptr(PanelPosition) position = ide_page_get_position (page);
+      g_autoptr(IdeSessionItem) item = ide_session_item_new ();
+      GFile *file = gbp_editorui_placeholder_page_get_file (placeholder);
+      g_autofree char *uri = g_file_get_uri (file);
+      IdeWorkspace *workspace = ide_widget_get_workspace (GTK_WIDGET (page));
+      const char *language_id = gbp_editorui_placeholder_page_get_language_id (placeholder);
+      guint insert_line, insert_line_offset;
+      guint bounds_line, bounds_line_offset;
+
+      /* Not loaded yet, so save what it was restored with */
+      gbp_editorui_placeholder_page_get_selection (placeholder,
+                                                   &insert_line, &insert_line_offset,
+                                                   &bounds_line, &bounds_line_offset);
+
+      ide_session_item_set_module_name (item, "editorui");
+      ide_session_item_set_type_hint (item, "IdeEditorPage");
+      ide_session_item_set_workspace (item, ide_workspace_get_id (workspace));
+      ide_session_item_set_position (item, position);
+      ide_session_item_set_metadata (item, "uri", "s", uri);
+      ide_session_item_set_metadata (item, "selection", "((uu)(uu))",
+                                     insert_line, insert_line_offset,
+                                     bounds_line, bounds_line_offset);
+
+      if (language_id != NULL)
+        ide_session_item_set_metadata (item, "language-id", "s", language_id);
+
+      if (page == ide_workspace_get_most_recent_page (workspace))
+        ide_session_item_set_metadata (item, "has-focus", "b", TRUE);
+
       ide_session_append (session, item);
     }
 }
@@ -740,6 +776,43 @@ gbp_editorui_workspace_addin_save_session (IdeWorkspaceAddin *addin,
                               session);
 }
 
+static void gbp_editorui_workspace_addin_queue_restore (GbpEditoruiWorkspaceAddin *self);
+
+typedef struct
+{
+  IdeBuffer *buffer;
+  IdePage   *page;
+} FindEditorPage;
+
+static void
+find_editor_page_cb (IdePage  *page,
+                     gpointer  user_data)
+{
+  FindEditorPage *find = user_data;
+
+  g_assert (IDE_IS_PAGE (page));
+  g_assert (find != NULL);
+
+  if (find->page == NULL &&
+      IDE_IS_EDITOR_PAGE (page) &&
+      ide_editor_page_get_buffer (IDE_EDITOR_PAGE (page)) == find->buffer)
+    find->page = page;
+}
+
+static IdePage *
+find_editor_page (IdeWorkspace *workspace,
+                  IdeBuffer    *buffer)
+{
+  FindEditorPage find = { buffer, NULL };
+
+  g_assert (IDE_IS_WORKSPACE (workspace));
+  g_assert (IDE_IS_BUFFER (buffer));
+
+  ide_workspace_foreach_page (workspace, find_editor_page_cb, &find);
+
+  return find.page;
+}
+
 static void
 restore_page_cb (GObject      *object,
                  GAsyncResult *result,
@@ -748,7 +821,10 @@ restore_page_cb (GObject      *object,
   IdeBufferManager *buffer_manager = (IdeBufferManager *)object;
   g_autoptr(IdeBuffer) buffer = NULL;
   g_autoptr(GError) error = NULL;
+  GbpEditoruiPlaceholderPage *placeholder;
+  GbpEditoruiWorkspaceAddin *self;
   RestorePage *rp = user_data;
+  IdeWorkspace *workspace;
 
   IDE_ENTRY;
 
@@ -756,39 +832,89 @@ restore_page_cb (GObject      *object,
   g_assert (IDE_IS_BUFFER_MANAGER (buffer_manager));
   g_assert (G_IS_ASYNC_RESULT (result));
   g_assert (rp != NULL);
+  g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (rp->self));
+  g_assert (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (rp->placeholder));
+
+  self = rp->self;
+  placeholder = rp->placeholder;
 
-  if ((buffer = ide_buffer_manager_load_file_finish (buffer_manager, result, &error)))
+  self->n_restoring--;
+  gbp_editorui_placeholder_page_set_loading (placeholder, FALSE);
+
+  buffer = ide_buffer_manager_load_file_finish (buffer_manager, result, &error);
+
+  /* The placeholder may have been closed while we were loading. Nothing
+   * holds the buffer then, so hold and release it to let the buffer
+   * manager unload it unless another page has it open.
+   */
+  if (!(workspace = ide_widget_get_workspace (GTK_WIDGET (placeholder))))
+    {
+      if (buffer != NULL)
+        ide_buffer_release (ide_buffer_hold (buffer));
+      IDE_GOTO (cleanup);
+    }
+
+  if (buffer != NULL && find_editor_page (workspace, buffer) != NULL)
+    {
+      /* The file was opened some other way while we were loading */
+      IDE_TRACE_MSG ("%s is already open, dropping placeholder",
+                     g_file_peek_path (gbp_editorui_placeholder_page_get_file (placeholder)));
+    }
+  else if (buffer != NULL)
     {
+      g_autoptr(PanelPosition) position = ide_page_get_position (IDE_PAGE (placeholder));
+      const char *language_id = gbp_editorui_placeholder_page_get_language_id (placeholder);
+      gboolean was_visible = gtk_widget_get_mapped (GTK_WIDGET (placeholder));
+      gboolean has_focus = ide_workspace_get_most_recent_page (workspace) == IDE_PAGE (placeholder) ||
+                           gtk_widget_has_focus (GTK_WIDGET (placeholder));
       GtkWidget *page = ide_editor_page_new (buffer);
+      guint insert_line, insert_line_offset;
+      guint bounds_line, bounds_line_offset;
+
+      if (!ide_str_empty0 (language_id))
+        ide_buffer_set_language_id (buffer, language_id);
 
-      if (!ide_str_empty0 (rp->language_id))
-        ide_buffer_set_language_id (buffer, rp->language_id);
+      gbp_editorui_placeholder_page_get_selection (placeholder,
+                                                   &insert_line, &insert_line_offset,
+                                                   &bounds_line, &bounds_line_offset);
 
-      if (rp->sel_insert_line || rp->sel_insert_line_offset ||
-          rp->sel_bounds_line || rp->sel_bounds_line_offset)
+      if (insert_line || insert_line_offset || bounds_line || bounds_line_offset)
         {
           GtkTextIter insert;
           GtkTextIter bounds;
 
           gtk_text_buffer_get_iter_at_line_offset (GTK_TEXT_BUFFER (buffer),
                                                    &insert,
-                                                   rp->sel_insert_line,
-                                                   rp->sel_insert_line_offset);
+                                                   insert_line,
+                                                   insert_line_offset);
           gtk_text_buffer_get_iter_at_line_offset (GTK_TEXT_BUFFER (buffer),
                                                    &bounds,
-                                                   rp->sel_bounds_line,
-                                                   rp->sel_bounds_line_offset);
+                                                   bounds_line,
+                                                   bounds_line_offset);
           gtk_text_buffer_select_range (GTK_TEXT_BUFFER (buffer), &insert, &bounds);
         }
 
-      ide_workspace_add_page (rp->workspace, IDE_PAGE (page), rp->position);
+      /* Take the place of the placeholder within its frame */
+      ide_workspace_add_page (workspace, IDE_PAGE (page), position);
 
-      if (rp->has_focus)
-        {
-          panel_widget_raise (PANEL_WIDGET (page));
-          gtk_widget_grab_focus (GTK_WIDGET (page));
-        }
+      if (was_visible || has_focus)
+        panel_widget_raise (PANEL_WIDGET (page));
+
+      if (has_focus)
+        gtk_widget_grab_focus (GTK_WIDGET (page));
     }
+  else
+    {
+      g_debug ("Failed to restore %s: %s",
+               g_file_peek_path (gbp_editorui_placeholder_page_get_file (placeholder)),
+               error->message);
+    }
+
+  ide_page_destroy (IDE_PAGE (placeholder));
+
+cleanup:
+  if (self->workspace != NULL)
+    gbp_editorui_workspace_addin_queue_restore (self);
 
   restore_page_free (rp);
 
@@ -796,61 +922,163 @@ restore_page_cb (GObject      *object,
 }
 
 static void
-gbp_editorui_workspace_addin_restore_page (GbpEditoruiWorkspaceAddin *self,
-                                           IdeSessionItem            *item)
+gbp_editorui_workspace_addin_load_placeholder (GbpEditoruiWorkspaceAddin  *self,
+                                               GbpEditoruiPlaceholderPage *placeholder)
 {
-  IdeBufferManager *buffer_manager;
   g_autoptr(IdeNotification) notif = NULL;
-  g_autoptr(GFile) file = NULL;
-  RestorePage *rp;
+  IdeBufferManager *buffer_manager;
   IdeContext *context;
+  RestorePage *rp;
 
   IDE_ENTRY;
 
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (self));
-  g_assert (IDE_IS_SESSION_ITEM (item));
+  g_assert (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (placeholder));
+
+  if (self->workspace == NULL ||
+      gbp_editorui_placeholder_page_get_loading (placeholder))
+    IDE_EXIT;
+
+  if (g_queue_remove (&self->restore_queue, placeholder))
+    g_object_unref (placeholder);
 
   context = ide_workspace_get_context (self->workspace);
   buffer_manager = ide_buffer_manager_from_context (context);
 
   rp = g_slice_new0 (RestorePage);
-  g_set_object (&rp->workspace, self->workspace);
-  g_set_object (&rp->position, ide_session_item_get_position (item));
+  rp->self = g_object_ref (self);
+  rp->placeholder = g_object_ref (placeholder);
+
+  self->n_restoring++;
+  gbp_editorui_placeholder_page_set_loading (placeholder, TRUE);
+
+  notif = ide_notification_new ();
+
+  ide_buffer_manager_load_file_async (buffer_manager,
+                                      gbp_editorui_placeholder_page_get_file (placeholder),
+                                      IDE_BUFFER_OPEN_FLAGS_NONE,
+                                      notif,
+                                      NULL,
+                                      restore_page_cb,
+                                      g_steal_pointer (&rp));
+
+  IDE_EXIT;
+}
+
+static gboolean
+gbp_editorui_workspace_addin_restore_cb (gpointer data)
+{
+  GbpEditoruiWorkspaceAddin *self = data;
+
+  g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (self));
+
+  self->restore_source = 0;
+
+  while (self->n_restoring < MAX_RESTORE_IN_FLIGHT &&
+         !g_queue_is_empty (&self->restore_queue))
+    {
+      g_autoptr(GbpEditoruiPlaceholderPage) placeholder = g_queue_pop_head (&self->restore_queue);
+
+      /* Skip placeholders closed before they were loaded */
+      if (ide_widget_get_workspace (GTK_WIDGET (placeholder)) != NULL)
+        gbp_editorui_workspace_addin_load_placeholder (self, placeholder);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gbp_editorui_workspace_addin_queue_restore (GbpEditoruiWorkspaceAddin *self)
+{
+  g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (self));
+
+  if (self->restore_source == 0 && !g_queue_is_empty (&self->restore_queue))
+    self->restore_source = g_idle_add_full (G_PRIORITY_LOW,
+                                            gbp_editorui_workspace_addin_restore_cb,
+                                            self,
+                                            NULL);
+}
+
+static void
+gbp_editorui_workspace_addin_placeholder_map_cb (GbpEditoruiWorkspaceAddin  *self,
+                                                 GbpEditoruiPlaceholderPage *placeholder)
+{
+  g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (self));
+  g_assert (GBP_IS_EDITORUI_PLACEHOLDER_PAGE (placeholder));
+
+  /* Pages the user can see are loaded immediately rather than waiting
+   * for their turn in the background queue.
+   */
+  gbp_editorui_workspace_addin_load_placeholder (self, placeholder);
+}
+
+static void
+gbp_editorui_workspace_addin_restore_page (GbpEditoruiWorkspaceAddin *self,
+                                           IdeSessionItem            *item)
+{
+  GbpEditoruiPlaceholderPage *placeholder;
+  g_autofree char *uri = NULL;
+  g_autofree char *language_id = NULL;
+  g_autoptr(GFile) file = NULL;
+  gboolean has_focus = FALSE;
+  guint sel_insert_line = 0;
+  guint sel_insert_line_offset = 0;
+  guint sel_bounds_line = 0;
+  guint sel_bounds_line_offset = 0;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_EDITORUI_WORKSPACE_ADDIN (self));
+  g_assert (IDE_IS_SESSION_ITEM (item));
 
   if (ide_session_item_has_metadata_with_type (item, "uri", G_VARIANT_TYPE ("s")))
-    ide_session_item_get_metadata (item, "uri", "s", &rp->uri);
+    ide_session_item_get_metadata (item, "uri", "s", &uri);
 
   if (ide_session_item_has_metadata_with_type (item, "language-id", G_VARIANT_TYPE ("s")))
-    ide_session_item_get_metadata (item, "language-id", "s", &rp->language_id);
+    ide_session_item_get_metadata (item, "language-id", "s", &language_id);
 
   if (ide_session_item_has_metadata_with_type (item, "has-focus", G_VARIANT_TYPE ("b")))
-    ide_session_item_get_metadata (item, "has-focus", "b", &rp->has_focus);
+    ide_session_item_get_metadata (item, "has-focus", "b", &has_focus);
 
   if (ide_session_item_has_metadata_with_type (item, "selection", G_VARIANT_TYPE ("((uu)(uu))")))
     ide_session_item_get_metadata (item, "selection", "((uu)(uu))",
-                                   &rp->sel_insert_line,
-                                   &rp->sel_insert_line_offset,
-                                   &rp->sel_bounds_line,
-                                   &rp->sel_bounds_line_offset);
+                                   &sel_insert_line,
+                                   &sel_insert_line_offset,
+                                   &sel_bounds_line,
+                                   &sel_bounds_line_offset);
 
-  if (!(file = g_file_new_for_uri (rp->uri)))
-    IDE_GOTO (failure);
+  if (uri == NULL || !(file = g_file_new_for_uri (uri)))
+    IDE_EXIT;
 
-  notif = ide_notification_new ();
+  /* Add a lightweight placeholder now so that the page keeps its place
+   * in the frame. Buffers are loaded when the placeholder becomes visible
+   * or, for the others, a few at a time in the background.
+   */
+  placeholder = gbp_editorui_placeholder_page_new (file, language_id);
+  gbp_editorui_placeholder_page_set_selection (placeholder,
+                                               sel_insert_line,
+                                               sel_insert_line_offset,
+                                               sel_bounds_line,
+                                               sel_bounds_line_offset);
+  g_signal_connect_object (placeholder,
+                           "map",
+                           G_CALLBACK (gbp_editorui_workspace_addin_placeholder_map_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
 
-  ide_buffer_manager_load_file_async (buffer_manager,
-                                      file,
-                                      IDE_BUFFER_OPEN_FLAGS_NONE,
-                                      notif,
-                                      NULL,
-                                      restore_page_cb,
-                                      g_steal_pointer (&rp));
+  g_queue_push_tail (&self->restore_queue, g_object_ref (placeholder));
 
-  IDE_EXIT;
+  ide_workspace_add_page (self->workspace, IDE_PAGE (placeholder), ide_session_item_get_position (item));
 
-failure:
-  restore_page_free (rp);
+  if (has_focus)
+    {
+      panel_widget_raise (PANEL_WIDGET (placeholder));
+      gtk_widget_grab_focus (GTK_WIDGET (placeholder));
+    }
+
+  gbp_editorui_workspace_addin_queue_restore (self);
 
   IDE_EXIT;
 }
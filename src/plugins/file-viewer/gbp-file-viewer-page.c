@@ -0,0 +1,446 @@
+/* gbp-file-viewer-page.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-file-viewer-page"
+
+#include "config.h"
+
+#include <glib/gi18n.h>
+
+#include <libide-threading.h>
+
+#include "gbp-file-viewer-page.h"
+#include "gbp-mapped-document.h"
+
+struct _GbpFileViewerPage
+{
+  IdePage              parent_instance;
+
+  GFile               *file;
+  GbpMappedDocument   *document;
+  GtkSingleSelection  *selection;
+  GCancellable        *index_cancellable;
+  GCancellable        *search_cancellable;
+
+  GtkListView         *list_view;
+  GtkSearchBar        *search_bar;
+  GtkSearchEntry      *search_entry;
+
+  /* Line to reveal once the index has reached it, or G_MAXUINT */
+  guint                pending_line;
+};
+
+enum {
+  PROP_0,
+  PROP_FILE,
+  N_PROPS
+};
+
+G_DEFINE_FINAL_TYPE (GbpFileViewerPage, gbp_file_viewer_page, IDE_TYPE_PAGE)
+
+static GParamSpec *properties [N_PROPS];
+
+static void
+gbp_file_viewer_page_reveal_line (GbpFileViewerPage *self,
+                                  guint              line)
+{
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+
+  if (self->document == NULL)
+    return;
+
+  /* Lines are added as the index grows, so wait for it to get there */
+  if (line >= g_list_model_get_n_items (G_LIST_MODEL (self->document)))
+    {
+      self->pending_line = line;
+      return;
+    }
+
+  self->pending_line = G_MAXUINT;
+
+  gtk_single_selection_set_selected (self->selection, line);
+  gtk_widget_activate_action (GTK_WIDGET (self->list_view), "list.scroll-to-item", "u", line);
+}
+
+static void
+gbp_file_viewer_page_items_changed_cb (GbpFileViewerPage *self,
+                                       guint              position,
+                                       guint              removed,
+                                       guint              added,
+                                       GListModel        *model)
+{
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+  g_assert (G_IS_LIST_MODEL (model));
+
+  if (self->pending_line != G_MAXUINT && self->pending_line < position + added)
+    gbp_file_viewer_page_reveal_line (self, self->pending_line);
+}
+
+static void
+gbp_file_viewer_page_index_cb (GObject      *object,
+                               GAsyncResult *result,
+                               gpointer      user_data)
+{
+  GbpMappedDocument *document = (GbpMappedDocument *)object;
+  g_autoptr(GbpFileViewerPage) self = user_data;
+  g_autoptr(GError) error = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_MAPPED_DOCUMENT (document));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+
+  ide_page_set_progress (IDE_PAGE (self), NULL);
+
+  if (!gbp_mapped_document_index_finish (document, result, &error))
+    {
+      if (!ide_error_ignore (error))
+        ide_page_report_error (IDE_PAGE (self),
+                               /* translators: %s is replaced with the error message */
+                               _("Failed to index file: %s"),
+                               error->message);
+      IDE_EXIT;
+    }
+
+  IDE_TRACE_MSG ("Indexed %u lines",
+                 g_list_model_get_n_items (G_LIST_MODEL (document)));
+
+  IDE_EXIT;
+}
+
+static void
+gbp_file_viewer_page_search_cb (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  GbpMappedDocument *document = (GbpMappedDocument *)object;
+  g_autoptr(GbpFileViewerPage) self = user_data;
+  g_autoptr(GError) error = NULL;
+  guint line;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_MAPPED_DOCUMENT (document));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+
+  if (!gbp_mapped_document_search_finish (document, result, &line, &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        gtk_widget_add_css_class (GTK_WIDGET (self->search_entry), "error");
+      IDE_EXIT;
+    }
+
+  gbp_file_viewer_page_reveal_line (self, line);
+
+  IDE_EXIT;
+}
+
+static void
+search_entry_activate_cb (GbpFileViewerPage *self,
+                          GtkSearchEntry    *entry)
+{
+  const char *text;
+  guint from_line;
+
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+  g_assert (GTK_IS_SEARCH_ENTRY (entry));
+
+  if (self->document == NULL)
+    return;
+
+  text = gtk_editable_get_text (GTK_EDITABLE (entry));
+  if (ide_str_empty0 (text))
+    return;
+
+  g_cancellable_cancel (self->search_cancellable);
+  g_clear_object (&self->search_cancellable);
+  self->search_cancellable = g_cancellable_new ();
+
+  /* Search continues after the previous match, or from the top */
+  from_line = gtk_single_selection_get_selected (self->selection);
+  if (from_line == GTK_INVALID_LIST_POSITION)
+    from_line = 0;
+
+  gbp_mapped_document_search_async (self->document,
+                                    text,
+                                    from_line,
+                                    self->search_cancellable,
+                                    gbp_file_viewer_page_search_cb,
+                                    g_object_ref (self));
+}
+
+static void
+search_entry_changed_cb (GbpFileViewerPage *self,
+                         GtkSearchEntry    *entry)
+{
+  g_assert (GBP_IS_FILE_VIEWER_PAGE (self));
+  g_assert (GTK_IS_SEARCH_ENTRY (entry));
+
+  gtk_widget_remove_css_class (GTK_WIDGET (entry), "error");
+}
+
+static void
+search_action (GtkWidget  *widget,
+               const char *action_name,
+               GVariant   *param)
+{
+  GbpFileViewerPage *self = GBP_FILE_VIEWER_PAGE (widget);
+
+  gtk_search_bar_set_search_mode (self->search_bar, TRUE);
+  gtk_widget_grab_focus (GTK_WIDGET (self->search_entry));
+}
+
+static void
+setup_row_cb (GtkSignalListItemFactory *factory,
+              GtkListItem              *list_item,
+              gpointer                  user_data)
+{
+  GtkWidget *inscription;
+
+  inscription = g_object_new (GTK_TYPE_INSCRIPTION,
+                              "xalign", 0.0f,
+                              "text-overflow", GTK_INSCRIPTION_OVERFLOW_ELLIPSIZE_END,
+                              NULL);
+  gtk_list_item_set_child (list_item, inscription);
+}
+
+static void
+bind_row_cb (GtkSignalListItemFactory *factory,
+             GtkListItem              *list_item,
+             gpointer                  user_data)
+{
+  GtkStringObject *item = gtk_list_item_get_item (list_item);
+  GtkInscription *inscription = GTK_INSCRIPTION (gtk_list_item_get_child (list_item));
+
+  gtk_inscription_set_text (inscription, gtk_string_object_get_string (item));
+}
+
+static void
+gbp_file_viewer_page_constructed (GObject *object)
+{
+  GbpFileViewerPage *self = (GbpFileViewerPage *)object;
+  g_autoptr(IdeNotification) notif = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *title = NULL;
+
+  G_OBJECT_CLASS (gbp_file_viewer_page_parent_class)->constructed (object);
+
+  g_return_if_fail (G_IS_FILE (self->file));
+
+  title = g_file_get_basename (self->file);
+  panel_widget_set_title (PANEL_WIDGET (self), title);
+  panel_widget_set_tooltip (PANEL_WIDGET (self), g_file_peek_path (self->file));
+
+  if (!(self->document = gbp_mapped_document_new (self->file, &error)))
+    {
+      ide_page_set_failed (IDE_PAGE (self), TRUE);
+      ide_page_report_error (IDE_PAGE (self),
+                             /* translators: %s is replaced with the error message */
+                             _("Failed to open file: %s"),
+                             error->message);
+      return;
+    }
+
+  g_signal_connect_object (self->document,
+                           "items-changed",
+                           G_CALLBACK (gbp_file_viewer_page_items_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  self->selection = gtk_single_selection_new (g_object_ref (G_LIST_MODEL (self->document)));
+  gtk_single_selection_set_autoselect (self->selection, FALSE);
+  gtk_single_selection_set_can_unselect (self->selection, TRUE);
+  gtk_list_view_set_model (self->list_view, GTK_SELECTION_MODEL (self->selection));
+
+  notif = ide_notification_new ();
+  ide_page_set_progress (IDE_PAGE (self), notif);
+
+  self->index_cancellable = g_cancellable_new ();
+  gbp_mapped_document_index_async (self->document,
+                                   notif,
+                                   self->index_cancellable,
+                                   gbp_file_viewer_page_index_cb,
+                                   g_object_ref (self));
+}
+
+static GFile *
+gbp_file_viewer_page_get_file_or_directory (IdePage *page)
+{
+  GbpFileViewerPage *self = GBP_FILE_VIEWER_PAGE (page);
+
+  return self->file ? g_object_ref (self->file) : NULL;
+}
+
+static void
+gbp_file_viewer_page_dispose (GObject *object)
+{
+  GbpFileViewerPage *self = (GbpFileViewerPage *)object;
+
+  g_cancellable_cancel (self->index_cancellable);
+  g_cancellable_cancel (self->search_cancellable);
+
+  if (self->list_view != NULL)
+    gtk_list_view_set_model (self->list_view, NULL);
+
+  g_clear_object (&self->index_cancellable);
+  g_clear_object (&self->search_cancellable);
+  g_clear_object (&self->selection);
+  g_clear_object (&self->document);
+
+  G_OBJECT_CLASS (gbp_file_viewer_page_parent_class)->dispose (object);
+}
+
+static void
+gbp_file_viewer_page_finalize (GObject *object)
+{
+  GbpFileViewerPage *self = (GbpFileViewerPage *)object;
+
+  g_clear_object (&self->file);
+
+  G_OBJECT_CLASS (gbp_file_viewer_page_parent_class)->finalize (object);
+}
+
+static void
+gbp_file_viewer_page_get_property (GObject    *object,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  GbpFileViewerPage *self = GBP_FILE_VIEWER_PAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_FILE:
+      g_value_set_object (value, self->file);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gbp_file_viewer_page_set_property (GObject      *object,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  GbpFileViewerPage *self = GBP_FILE_VIEWER_PAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_FILE:
+      self->file = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gbp_file_viewer_page_class_init (GbpFileViewerPageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+  IdePageClass *page_class = IDE_PAGE_CLASS (klass);
+
+  object_class->constructed = gbp_file_viewer_page_constructed;
+  object_class->dispose = gbp_file_viewer_page_dispose;
+  object_class->finalize = gbp_file_viewer_page_finalize;
+  object_class->get_property = gbp_file_viewer_page_get_property;
+  object_class->set_property = gbp_file_viewer_page_set_property;
+
+  page_class->get_file_or_directory = gbp_file_viewer_page_get_file_or_directory;
+
+  properties [PROP_FILE] =
+    g_param_spec_object ("file", NULL, NULL,
+                         G_TYPE_FILE,
+                         (G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/plugins/file-viewer/gbp-file-viewer-page.ui");
+  gtk_widget_class_bind_template_child (widget_class, GbpFileViewerPage, list_view);
+  gtk_widget_class_bind_template_child (widget_class, GbpFileViewerPage, search_bar);
+  gtk_widget_class_bind_template_child (widget_class, GbpFileViewerPage, search_entry);
+  gtk_widget_class_bind_template_callback (widget_class, search_entry_activate_cb);
+  gtk_widget_class_bind_template_callback (widget_class, search_entry_changed_cb);
+
+  gtk_widget_class_install_action (widget_class, "file-viewer.search", NULL, search_action);
+  gtk_widget_class_add_binding_action (widget_class, GDK_KEY_f, GDK_CONTROL_MASK, "file-viewer.search", NULL);
+}
+
+static void
+gbp_file_viewer_page_init (GbpFileViewerPage *self)
+{
+  g_autoptr(GtkListItemFactory) factory = NULL;
+
+  self->pending_line = G_MAXUINT;
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  panel_widget_set_icon_name (PANEL_WIDGET (self), "text-x-generic-symbolic");
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_row_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_row_cb), NULL);
+  gtk_list_view_set_factory (self->list_view, factory);
+
+  gtk_search_bar_connect_entry (self->search_bar, GTK_EDITABLE (self->search_entry));
+  gtk_search_bar_set_key_capture_widget (self->search_bar, GTK_WIDGET (self));
+}
+
+GbpFileViewerPage *
+gbp_file_viewer_page_new (GFile *file)
+{
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  return g_object_new (GBP_TYPE_FILE_VIEWER_PAGE,
+                       "file", file,
+                       NULL);
+}
+
+GFile *
+gbp_file_viewer_page_get_file (GbpFileViewerPage *self)
+{
+  g_return_val_if_fail (GBP_IS_FILE_VIEWER_PAGE (self), NULL);
+
+  return self->file;
+}
+
+/**
+ * gbp_file_viewer_page_scroll_to_line:
+ * @self: a #GbpFileViewerPage
+ * @line: the line number, starting from zero
+ *
+ * Selects @line and scrolls it into view. If the line has not yet been
+ * indexed, it will be revealed once the index reaches it.
+ */
+void
+gbp_file_viewer_page_scroll_to_line (GbpFileViewerPage *self,
+                                     guint              line)
+{
+  g_return_if_fail (GBP_IS_FILE_VIEWER_PAGE (self));
+
+  gbp_file_viewer_page_reveal_line (self, line);
+}
@@ -0,0 +1,36 @@
+/* gbp-file-viewer-page.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libide-gui.h>
+
+G_BEGIN_DECLS
+
+#define GBP_TYPE_FILE_VIEWER_PAGE (gbp_file_viewer_page_get_type())
+
+G_DECLARE_FINAL_TYPE (GbpFileViewerPage, gbp_file_viewer_page, GBP, FILE_VIEWER_PAGE, IdePage)
+
+GbpFileViewerPage *gbp_file_viewer_page_new            (GFile             *file);
+GFile             *gbp_file_viewer_page_get_file       (GbpFileViewerPage *self);
+void               gbp_file_viewer_page_scroll_to_line (GbpFileViewerPage *self,
+                                                        guint              line);
+
+G_END_DECLS
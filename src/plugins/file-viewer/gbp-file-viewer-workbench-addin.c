@@ -0,0 +1,202 @@
+/* gbp-file-viewer-workbench-addin.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-file-viewer-workbench-addin"
+
+#include "config.h"
+
+#include <libide-threading.h>
+
+#include "gbp-file-viewer-page.h"
+#include "gbp-file-viewer-workbench-addin.h"
+
+struct _GbpFileViewerWorkbenchAddin
+{
+  GObject       parent_instance;
+  IdeWorkbench *workbench;
+  GSettings    *settings;
+};
+
+typedef struct
+{
+  GFile             *file;
+  GbpFileViewerPage *page;
+} LocatePage;
+
+static gboolean
+gbp_file_viewer_workbench_addin_can_open_with_info (IdeWorkbenchAddin *addin,
+                                                    GFile             *file,
+                                                    GFileInfo         *info,
+                                                    gint              *priority)
+{
+  GbpFileViewerWorkbenchAddin *self = (GbpFileViewerWorkbenchAddin *)addin;
+  guint64 max_size;
+
+  g_assert (GBP_IS_FILE_VIEWER_WORKBENCH_ADDIN (self));
+  g_assert (G_IS_FILE (file));
+  g_assert (G_IS_FILE_INFO (info));
+  g_assert (priority != NULL);
+
+  /* Files are read through a local file descriptor, so they must be local */
+  if (g_file_peek_path (file) == NULL ||
+      (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE) &&
+       ide_str_equal0 (g_file_info_get_content_type (info), "inode/directory")))
+    return FALSE;
+
+  /* Available with the "file-viewer" hint, but after the editor and
+   * external programs unless the file is too large for the editor.
+   */
+  *priority = G_MAXINT / 2 + 1;
+
+  /* The workbench queried the size along with the content-type */
+  max_size = self->settings ? g_settings_get_uint64 (self->settings, "large-file-viewer-size") : 0;
+  if (max_size > 0 &&
+      g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE) &&
+      (guint64)g_file_info_get_size (info) > max_size)
+    *priority = -100;
+
+  return TRUE;
+}
+
+static void
+locate_page (IdePage  *page,
+             gpointer  user_data)
+{
+  LocatePage *locate = user_data;
+
+  g_assert (IDE_IS_PAGE (page));
+  g_assert (locate != NULL);
+
+  if (locate->page != NULL || !GBP_IS_FILE_VIEWER_PAGE (page))
+    return;
+
+  if (g_file_equal (locate->file, gbp_file_viewer_page_get_file (GBP_FILE_VIEWER_PAGE (page))))
+    locate->page = GBP_FILE_VIEWER_PAGE (page);
+}
+
+static void
+gbp_file_viewer_workbench_addin_open_async (IdeWorkbenchAddin   *addin,
+                                            GFile               *file,
+                                            const gchar         *content_type,
+                                            int                  at_line,
+                                            int                  at_line_offset,
+                                            IdeBufferOpenFlags   flags,
+                                            PanelPosition       *position,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             user_data)
+{
+  GbpFileViewerWorkbenchAddin *self = (GbpFileViewerWorkbenchAddin *)addin;
+  g_autoptr(IdeTask) task = NULL;
+  LocatePage locate = {0};
+  IdeWorkspace *workspace;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_FILE_VIEWER_WORKBENCH_ADDIN (self));
+  g_assert (!self->workbench || IDE_IS_WORKBENCH (self->workbench));
+  g_assert (G_IS_FILE (file));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_file_viewer_workbench_addin_open_async);
+
+  if (self->workbench == NULL)
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_CANCELLED,
+                                 "Extension was unloaded");
+      IDE_EXIT;
+    }
+
+  locate.file = file;
+  ide_workbench_foreach_page (self->workbench, locate_page, &locate);
+
+  if (locate.page == NULL)
+    {
+      workspace = ide_workbench_get_current_workspace (self->workbench);
+      locate.page = gbp_file_viewer_page_new (file);
+      ide_workspace_add_page (workspace, IDE_PAGE (locate.page), position);
+    }
+
+  if (at_line >= 0)
+    gbp_file_viewer_page_scroll_to_line (locate.page, at_line);
+
+  panel_widget_raise (PANEL_WIDGET (locate.page));
+
+  ide_task_return_boolean (task, TRUE);
+
+  IDE_EXIT;
+}
+
+static gboolean
+gbp_file_viewer_workbench_addin_open_finish (IdeWorkbenchAddin  *addin,
+                                             GAsyncResult       *result,
+                                             GError            **error)
+{
+  g_assert (GBP_IS_FILE_VIEWER_WORKBENCH_ADDIN (addin));
+  g_assert (IDE_IS_TASK (result));
+
+  return ide_task_propagate_boolean (IDE_TASK (result), error);
+}
+
+static void
+gbp_file_viewer_workbench_addin_load (IdeWorkbenchAddin *addin,
+                                      IdeWorkbench      *workbench)
+{
+  GbpFileViewerWorkbenchAddin *self = GBP_FILE_VIEWER_WORKBENCH_ADDIN (addin);
+
+  self->workbench = workbench;
+  self->settings = g_settings_new ("org.gnome.builder.editor");
+}
+
+static void
+gbp_file_viewer_workbench_addin_unload (IdeWorkbenchAddin *addin,
+                                        IdeWorkbench      *workbench)
+{
+  GbpFileViewerWorkbenchAddin *self = GBP_FILE_VIEWER_WORKBENCH_ADDIN (addin);
+
+  g_clear_object (&self->settings);
+  self->workbench = NULL;
+}
+
+static void
+workbench_addin_iface_init (IdeWorkbenchAddinInterface *iface)
+{
+  iface->can_open_with_info = gbp_file_viewer_workbench_addin_can_open_with_info;
+  iface->open_async = gbp_file_viewer_workbench_addin_open_async;
+  iface->open_finish = gbp_file_viewer_workbench_addin_open_finish;
+  iface->load = gbp_file_viewer_workbench_addin_load;
+  iface->unload = gbp_file_viewer_workbench_addin_unload;
+}
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (GbpFileViewerWorkbenchAddin, gbp_file_viewer_workbench_addin, G_TYPE_OBJECT,
+                               G_IMPLEMENT_INTERFACE (IDE_TYPE_WORKBENCH_ADDIN, workbench_addin_iface_init))
+
+static void
+gbp_file_viewer_workbench_addin_class_init (GbpFileViewerWorkbenchAddinClass *klass)
+{
+}
+
+static void
+gbp_file_viewer_workbench_addin_init (GbpFileViewerWorkbenchAddin *self)
+{
+}
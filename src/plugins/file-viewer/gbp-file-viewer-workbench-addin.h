@@ -0,0 +1,31 @@
+/* gbp-file-viewer-workbench-addin.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libide-gui.h>
+
+G_BEGIN_DECLS
+
+#define GBP_TYPE_FILE_VIEWER_WORKBENCH_ADDIN (gbp_file_viewer_workbench_addin_get_type())
+
+G_DECLARE_FINAL_TYPE (GbpFileViewerWorkbenchAddin, gbp_file_viewer_workbench_addin, GBP, FILE_VIEWER_WORKBENCH_ADDIN, GObject)
+
+G_END_DECLS
@@ -0,0 +1,796 @@
+/* gbp-mapped-document.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-mapped-document"
+
+#include "config.h"
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#include <libide-threading.h>
+
+#include "gbp-mapped-document.h"
+
+/* Only the offset of every CHECKPOINT_INTERVAL'th line is stored so that
+ * the index of a file with a hundred million lines stays a few megabytes.
+ * Locating any other line is a short memchr() walk from its checkpoint.
+ */
+#define CHECKPOINT_INTERVAL 256
+
+/* The file is never mapped. Touching a mapping past the end of a file
+ * which was truncated underneath us (logrotate's copytruncate, for
+ * example) raises SIGBUS and takes down the whole process. Instead the
+ * contents are read with pread() into bounded windows, where truncation
+ * simply reads as the end of the file.
+ */
+#define READ_WINDOW_SIZE (1024 * 1024)
+#define LOCATE_WINDOW_SIZE (16 * 1024)
+
+/* Amount of the file indexed between publishing progress (and checking
+ * for cancellation) from the indexer thread.
+ */
+#define SCAN_CHUNK_SIZE (32 * 1024 * 1024)
+
+/* Longer lines are truncated for display, they are not useful to render
+ * and would make the row measurement cost unbounded.
+ */
+#define MAX_LINE_LENGTH 4096
+
+struct _GbpMappedDocument
+{
+  GObject      parent_instance;
+
+  GFile       *file;
+  int          fd;
+
+  /* Size of the file when it was opened. The file may be truncated or
+   * grow afterwards, reads stop at whatever the end of the file is.
+   */
+  gsize        length;
+
+  /* Protected by mutex, appended to by the indexer thread */
+  GMutex       mutex;
+  GArray      *checkpoints;
+  guint        n_indexed;
+
+  /* Number of lines announced to the GListModel consumers */
+  guint        n_items;
+  int          flush_queued;
+
+  guint        indexed : 1;
+};
+
+typedef struct
+{
+  char  *needle;
+  gsize  needle_len;
+  guint  from_line;
+} Search;
+
+static GType
+gbp_mapped_document_get_item_type (GListModel *model)
+{
+  return GTK_TYPE_STRING_OBJECT;
+}
+
+static guint
+gbp_mapped_document_get_n_items (GListModel *model)
+{
+  return GBP_MAPPED_DOCUMENT (model)->n_items;
+}
+
+static gpointer
+gbp_mapped_document_get_item (GListModel *model,
+                              guint       position)
+{
+  GbpMappedDocument *self = GBP_MAPPED_DOCUMENT (model);
+  g_autofree char *text = NULL;
+
+  if (position >= self->n_items)
+    return NULL;
+
+  text = gbp_mapped_document_dup_line (self, position);
+
+  return gtk_string_object_new (text);
+}
+
+static void
+list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = gbp_mapped_document_get_item_type;
+  iface->get_n_items = gbp_mapped_document_get_n_items;
+  iface->get_item = gbp_mapped_document_get_item;
+}
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (GbpMappedDocument, gbp_mapped_document, G_TYPE_OBJECT,
+                               G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, list_model_iface_init))
+
+static void
+search_free (Search *search)
+{
+  g_clear_pointer (&search->needle, g_free);
+  g_slice_free (Search, search);
+}
+
+static void
+gbp_mapped_document_finalize (GObject *object)
+{
+  GbpMappedDocument *self = (GbpMappedDocument *)object;
+
+  g_clear_pointer (&self->checkpoints, g_array_unref);
+
+  if (self->fd != -1)
+    {
+      g_close (self->fd, NULL);
+      self->fd = -1;
+    }
+
+  g_clear_object (&self->file);
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (gbp_mapped_document_parent_class)->finalize (object);
+}
+
+static void
+gbp_mapped_document_class_init (GbpMappedDocumentClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gbp_mapped_document_finalize;
+}
+
+static void
+gbp_mapped_document_init (GbpMappedDocument *self)
+{
+  goffset first = 0;
+
+  g_mutex_init (&self->mutex);
+
+  self->fd = -1;
+  self->checkpoints = g_array_new (FALSE, FALSE, sizeof (goffset));
+  g_array_append_val (self->checkpoints, first);
+}
+
+/**
+ * gbp_mapped_document_new:
+ * @file: a #GFile with a native path
+ * @error: a location for a #GError
+ *
+ * Opens @file read-only. No contents are read until lines are requested
+ * or the index is built with gbp_mapped_document_index_async().
+ *
+ * Returns: (transfer full): a #GbpMappedDocument or %NULL
+ */
+GbpMappedDocument *
+gbp_mapped_document_new (GFile   *file,
+                         GError **error)
+{
+  g_autoptr(GbpMappedDocument) self = NULL;
+  struct stat stbuf;
+  const char *path;
+  int fd;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  if (!(path = g_file_peek_path (file)))
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_NOT_SUPPORTED,
+                   "Only local files may be viewed");
+      return NULL;
+    }
+
+  if ((fd = g_open (path, O_RDONLY | O_CLOEXEC, 0)) == -1 ||
+      fstat (fd, &stbuf) != 0)
+    {
+      int errsv = errno;
+
+      if (fd != -1)
+        g_close (fd, NULL);
+
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           g_io_error_from_errno (errsv),
+                           g_strerror (errsv));
+      return NULL;
+    }
+
+  self = g_object_new (GBP_TYPE_MAPPED_DOCUMENT, NULL);
+  self->file = g_object_ref (file);
+  self->fd = fd;
+  self->length = stbuf.st_size;
+
+  return g_steal_pointer (&self);
+}
+
+GFile *
+gbp_mapped_document_get_file (GbpMappedDocument *self)
+{
+  g_return_val_if_fail (GBP_IS_MAPPED_DOCUMENT (self), NULL);
+
+  return self->file;
+}
+
+gboolean
+gbp_mapped_document_get_indexed (GbpMappedDocument *self)
+{
+  g_return_val_if_fail (GBP_IS_MAPPED_DOCUMENT (self), FALSE);
+
+  return self->indexed;
+}
+
+/*
+ * gbp_mapped_document_read:
+ *
+ * Reads up to @len bytes at @offset into @buffer. Errors and truncation
+ * of the file read as the end of the file.
+ *
+ * Returns: the number of bytes read, which is less than @len at the end
+ *   of the file
+ */
+static gsize
+gbp_mapped_document_read (GbpMappedDocument *self,
+                          char              *buffer,
+                          gsize              len,
+                          gsize              offset)
+{
+  gsize pos = 0;
+
+  while (pos < len)
+    {
+      gssize n_read = pread (self->fd, buffer + pos, len - pos, offset + pos);
+
+      if (n_read < 0 && errno == EINTR)
+        continue;
+
+      if (n_read <= 0)
+        break;
+
+      pos += n_read;
+    }
+
+  return pos;
+}
+
+/*
+ * gbp_mapped_document_skip_lines:
+ *
+ * Returns: the offset following the @n_lines'th newline after @offset,
+ *   or the end of the file if there are fewer lines
+ */
+static gsize
+gbp_mapped_document_skip_lines (GbpMappedDocument *self,
+                                gsize              offset,
+                                guint              n_lines)
+{
+  char buffer[LOCATE_WINDOW_SIZE];
+
+  while (n_lines > 0)
+    {
+      gsize n_read = gbp_mapped_document_read (self, buffer, sizeof buffer, offset);
+      const char *iter = buffer;
+      const char *end = buffer + n_read;
+      const char *nl;
+
+      while (n_lines > 0 && (nl = memchr (iter, '\n', end - iter)))
+        {
+          iter = nl + 1;
+          n_lines--;
+        }
+
+      offset += iter - buffer;
+
+      if (n_lines == 0)
+        break;
+
+      offset += end - iter;
+
+      if (n_read < sizeof buffer)
+        break;
+    }
+
+  return offset;
+}
+
+static gsize
+gbp_mapped_document_locate_line (GbpMappedDocument *self,
+                                 guint              line)
+{
+  guint checkpoint = line / CHECKPOINT_INTERVAL;
+  guint skip = line % CHECKPOINT_INTERVAL;
+  gsize offset;
+
+  g_mutex_lock (&self->mutex);
+  g_assert (checkpoint < self->checkpoints->len);
+  offset = g_array_index (self->checkpoints, goffset, checkpoint);
+  g_mutex_unlock (&self->mutex);
+
+  return gbp_mapped_document_skip_lines (self, offset, skip);
+}
+
+static guint
+gbp_mapped_document_line_at_offset (GbpMappedDocument *self,
+                                    gsize              offset)
+{
+  char buffer[LOCATE_WINDOW_SIZE];
+  gsize begin;
+  guint line;
+  guint lo = 0;
+  guint hi;
+
+  /* Find the last checkpoint at or before @offset. Checkpoints are
+   * sorted as they are appended in file order.
+   */
+  g_mutex_lock (&self->mutex);
+  hi = self->checkpoints->len;
+  while (hi - lo > 1)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (g_array_index (self->checkpoints, goffset, mid) <= (goffset)offset)
+        lo = mid;
+      else
+        hi = mid;
+    }
+  begin = g_array_index (self->checkpoints, goffset, lo);
+  g_mutex_unlock (&self->mutex);
+
+  line = lo * CHECKPOINT_INTERVAL;
+
+  /* Count the newlines between the checkpoint and @offset */
+  while (begin < offset)
+    {
+      gsize want = MIN (sizeof buffer, offset - begin);
+      gsize n_read = gbp_mapped_document_read (self, buffer, want, begin);
+      const char *iter = buffer;
+      const char *end = buffer + n_read;
+      const char *nl;
+
+      while ((nl = memchr (iter, '\n', end - iter)))
+        {
+          iter = nl + 1;
+          line++;
+        }
+
+      if (n_read < want)
+        break;
+
+      begin += n_read;
+    }
+
+  return line;
+}
+
+/**
+ * gbp_mapped_document_dup_line:
+ * @self: a #GbpMappedDocument
+ * @line: the line number, starting from zero
+ *
+ * Copies the contents of @line as valid UTF-8, without the trailing
+ * newline. Very long lines are truncated.
+ *
+ * Returns: (transfer full): a newly allocated string
+ */
+char *
+gbp_mapped_document_dup_line (GbpMappedDocument *self,
+                              guint              line)
+{
+  char buffer[MAX_LINE_LENGTH + 1];
+  const char *end;
+  gsize offset;
+  gsize len;
+
+  g_return_val_if_fail (GBP_IS_MAPPED_DOCUMENT (self), NULL);
+  g_return_val_if_fail (line < self->n_items, NULL);
+
+  /* Lines past a truncation read as empty */
+  offset = gbp_mapped_document_locate_line (self, line);
+  len = gbp_mapped_document_read (self, buffer, sizeof buffer, offset);
+
+  if ((end = memchr (buffer, '\n', len)))
+    len = end - buffer;
+
+  if (len > 0 && buffer[len - 1] == '\r')
+    len--;
+
+  if (len > MAX_LINE_LENGTH)
+    {
+      g_autofree char *truncated = g_utf8_make_valid (buffer, MAX_LINE_LENGTH);
+      return g_strconcat (truncated, "…", NULL);
+    }
+
+  return g_utf8_make_valid (buffer, len);
+}
+
+static void
+gbp_mapped_document_flush (GbpMappedDocument *self)
+{
+  guint n_indexed;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_MAPPED_DOCUMENT (self));
+
+  g_atomic_int_set (&self->flush_queued, FALSE);
+
+  g_mutex_lock (&self->mutex);
+  n_indexed = self->n_indexed;
+  g_mutex_unlock (&self->mutex);
+
+  if (n_indexed > self->n_items)
+    {
+      guint position = self->n_items;
+
+      self->n_items = n_indexed;
+      g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n_indexed - position);
+    }
+}
+
+static gboolean
+gbp_mapped_document_flush_cb (gpointer data)
+{
+  gbp_mapped_document_flush (data);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gbp_mapped_document_publish (GbpMappedDocument *self,
+                             GArray            *checkpoints,
+                             guint              n_lines)
+{
+  g_assert (!IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_MAPPED_DOCUMENT (self));
+
+  g_mutex_lock (&self->mutex);
+  g_array_append_vals (self->checkpoints, checkpoints->data, checkpoints->len);
+  self->n_indexed = n_lines;
+  g_mutex_unlock (&self->mutex);
+
+  g_array_set_size (checkpoints, 0);
+
+  /* Coalesce updates if the main loop has not caught up yet */
+  if (g_atomic_int_compare_and_exchange (&self->flush_queued, FALSE, TRUE))
+    g_idle_add_full (G_PRIORITY_DEFAULT,
+                     gbp_mapped_document_flush_cb,
+                     g_object_ref (self),
+                     g_object_unref);
+}
+
+static void
+gbp_mapped_document_index_worker (IdeTask      *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  GbpMappedDocument *self = source_object;
+  IdeNotification *notif = task_data;
+  g_autoptr(GArray) checkpoints = NULL;
+  g_autofree char *buffer = NULL;
+  gsize next_publish = SCAN_CHUNK_SIZE;
+  guint n_lines = 0;
+  gsize pos = 0;
+  char last = '\n';
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_TASK (task));
+  g_assert (GBP_IS_MAPPED_DOCUMENT (self));
+  g_assert (!notif || IDE_IS_NOTIFICATION (notif));
+
+  checkpoints = g_array_new (FALSE, FALSE, sizeof (goffset));
+  buffer = g_malloc (READ_WINDOW_SIZE);
+
+  for (;;)
+    {
+      gsize n_read = gbp_mapped_document_read (self, buffer, READ_WINDOW_SIZE, pos);
+      const char *iter = buffer;
+      const char *end = buffer + n_read;
+      const char *nl;
+
+      if (n_read == 0)
+        break;
+
+      while ((nl = memchr (iter, '\n', end - iter)))
+        {
+          iter = nl + 1;
+          n_lines++;
+
+          if (n_lines % CHECKPOINT_INTERVAL == 0)
+            {
+              goffset offset = pos + (iter - buffer);
+              g_array_append_val (checkpoints, offset);
+            }
+        }
+
+      last = end[-1];
+      pos += n_read;
+
+      if (pos >= next_publish)
+        {
+          next_publish = pos + SCAN_CHUNK_SIZE;
+
+          gbp_mapped_document_publish (self, checkpoints, n_lines);
+
+          if (notif != NULL && self->length > 0)
+            ide_notification_set_progress (notif, MIN (1.0, (double)pos / (double)self->length));
+
+          if (ide_task_return_error_if_cancelled (task))
+            IDE_EXIT;
+        }
+
+      if (n_read < READ_WINDOW_SIZE)
+        break;
+    }
+
+  /* Trailing line without a newline */
+  if (last != '\n')
+    n_lines++;
+
+  gbp_mapped_document_publish (self, checkpoints, n_lines);
+
+  ide_task_return_boolean (task, TRUE);
+
+  IDE_EXIT;
+}
+
+/**
+ * gbp_mapped_document_index_async:
+ * @self: a #GbpMappedDocument
+ * @notif: (nullable): an #IdeNotification to update with progress
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: a #GAsyncReadyCallback
+ * @user_data: closure data for @callback
+ *
+ * Scans the document for line breaks in a thread. Lines are added to
+ * the #GListModel as they are discovered, so the beginning of the file
+ * can be displayed long before the scan completes.
+ */
+void
+gbp_mapped_document_index_async (GbpMappedDocument   *self,
+                                 IdeNotification     *notif,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (GBP_IS_MAPPED_DOCUMENT (self));
+  g_return_if_fail (!notif || IDE_IS_NOTIFICATION (notif));
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_mapped_document_index_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+
+  if (notif != NULL)
+    ide_task_set_task_data (task, g_object_ref (notif), g_object_unref);
+
+  if (self->indexed)
+    {
+      ide_task_return_boolean (task, TRUE);
+      IDE_EXIT;
+    }
+
+  ide_task_run_in_thread (task, gbp_mapped_document_index_worker);
+
+  IDE_EXIT;
+}
+
+gboolean
+gbp_mapped_document_index_finish (GbpMappedDocument  *self,
+                                  GAsyncResult       *result,
+                                  GError            **error)
+{
+  gboolean ret;
+
+  IDE_ENTRY;
+
+  g_return_val_if_fail (GBP_IS_MAPPED_DOCUMENT (self), FALSE);
+  g_return_val_if_fail (IDE_IS_TASK (result), FALSE);
+
+  if ((ret = ide_task_propagate_boolean (IDE_TASK (result), error)))
+    {
+      /* Don't wait for the idle so callers see every line */
+      gbp_mapped_document_flush (self);
+      self->indexed = TRUE;
+    }
+
+  IDE_RETURN (ret);
+}
+
+static gboolean
+scan_range (GbpMappedDocument *self,
+            gsize              begin,
+            gsize              end,
+            const Search      *search,
+            GCancellable      *cancellable,
+            gsize             *found)
+{
+  g_autofree char *buffer = NULL;
+  gsize overlap = search->needle_len - 1;
+  gsize window = READ_WINDOW_SIZE + overlap;
+
+  /* Read windows which overlap by the needle length so matches spanning
+   * two reads are found. memmem() is vectorized by libc.
+   */
+  if (begin >= end || end - begin < search->needle_len)
+    return FALSE;
+
+  buffer = g_malloc (window);
+
+  for (;;)
+    {
+      gsize want = MIN (window, end - begin);
+      gsize n_read = gbp_mapped_document_read (self, buffer, want, begin);
+      const char *match;
+
+      if ((match = memmem (buffer, n_read, search->needle, search->needle_len)))
+        {
+          *found = begin + (match - buffer);
+          return TRUE;
+        }
+
+      /* Reached @end or a truncated end of file */
+      if (n_read < want || begin + n_read >= end)
+        break;
+
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      begin += n_read - overlap;
+    }
+
+  return FALSE;
+}
+
+static void
+gbp_mapped_document_search_worker (IdeTask      *task,
+                                   gpointer      source_object,
+                                   gpointer      task_data,
+                                   GCancellable *cancellable)
+{
+  GbpMappedDocument *self = source_object;
+  Search *search = task_data;
+  gsize found;
+  gsize begin;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_TASK (task));
+  g_assert (GBP_IS_MAPPED_DOCUMENT (self));
+  g_assert (search != NULL);
+  g_assert (search->needle_len > 0);
+
+  /* Start after the current line and wrap around to it */
+  begin = gbp_mapped_document_locate_line (self, search->from_line);
+  begin = gbp_mapped_document_skip_lines (self, begin, 1);
+
+  if (!scan_range (self, begin, G_MAXSIZE, search, cancellable, &found) &&
+      !scan_range (self, 0, begin + search->needle_len - 1, search, cancellable, &found))
+    found = G_MAXSIZE;
+
+  if (ide_task_return_error_if_cancelled (task))
+    IDE_EXIT;
+
+  if (found == G_MAXSIZE)
+    ide_task_return_new_error (task,
+                               G_IO_ERROR,
+                               G_IO_ERROR_NOT_FOUND,
+                               "No matches were found");
+  else
+    ide_task_return_int (task, gbp_mapped_document_line_at_offset (self, found));
+
+  IDE_EXIT;
+}
+
+/**
+ * gbp_mapped_document_search_async:
+ * @self: a #GbpMappedDocument
+ * @needle: the text to search for
+ * @from_line: the line to start searching after
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: a #GAsyncReadyCallback
+ * @user_data: closure data for @callback
+ *
+ * Searches for the next line containing @needle after @from_line,
+ * wrapping around to the beginning of the document.
+ *
+ * The search reads through the file in bounded windows and does not
+ * require the index to be complete.
+ */
+void
+gbp_mapped_document_search_async (GbpMappedDocument   *self,
+                                  const char          *needle,
+                                  guint                from_line,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+  Search *search;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (GBP_IS_MAPPED_DOCUMENT (self));
+  g_return_if_fail (needle != NULL);
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_mapped_document_search_async);
+
+  if (needle[0] == 0 || self->n_items == 0)
+    {
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_NOT_FOUND,
+                                 "No matches were found");
+      IDE_EXIT;
+    }
+
+  search = g_slice_new0 (Search);
+  search->needle = g_strdup (needle);
+  search->needle_len = strlen (needle);
+  search->from_line = MIN (from_line, self->n_items - 1);
+  ide_task_set_task_data (task, search, search_free);
+
+  ide_task_run_in_thread (task, gbp_mapped_document_search_worker);
+
+  IDE_EXIT;
+}
+
+gboolean
+gbp_mapped_document_search_finish (GbpMappedDocument  *self,
+                                   GAsyncResult       *result,
+                                   guint              *line,
+                                   GError            **error)
+{
+  g_autoptr(GError) local_error = NULL;
+  gssize ret;
+
+  IDE_ENTRY;
+
+  g_return_val_if_fail (GBP_IS_MAPPED_DOCUMENT (self), FALSE);
+  g_return_val_if_fail (IDE_IS_TASK (result), FALSE);
+
+  ret = ide_task_propagate_int (IDE_TASK (result), &local_error);
+
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      IDE_RETURN (FALSE);
+    }
+
+  if (line != NULL)
+    *line = ret;
+
+  IDE_RETURN (TRUE);
+}
@@ -0,0 +1,56 @@
+/* gbp-mapped-document.h
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libide-core.h>
+
+G_BEGIN_DECLS
+
+#define GBP_TYPE_MAPPED_DOCUMENT (gbp_mapped_document_get_type())
+
+G_DECLARE_FINAL_TYPE (GbpMappedDocument, gbp_mapped_document, GBP, MAPPED_DOCUMENT, GObject)
+
+GbpMappedDocument *gbp_mapped_document_new           (GFile                *file,
+                                                      GError              **error);
+GFile             *gbp_mapped_document_get_file      (GbpMappedDocument    *self);
+gboolean           gbp_mapped_document_get_indexed   (GbpMappedDocument    *self);
+char              *gbp_mapped_document_dup_line      (GbpMappedDocument    *self,
+                                                      guint                 line);
+void               gbp_mapped_document_index_async   (GbpMappedDocument    *self,
+                                                      IdeNotification      *notif,
+                                                      GCancellable         *cancellable,
+                                                      GAsyncReadyCallback   callback,
+                                                      gpointer              user_data);
+gboolean           gbp_mapped_document_index_finish  (GbpMappedDocument    *self,
+                                                      GAsyncResult         *result,
+                                                      GError              **error);
+void               gbp_mapped_document_search_async  (GbpMappedDocument    *self,
+                                                      const char           *needle,
+                                                      guint                 from_line,
+                                                      GCancellable         *cancellable,
+                                                      GAsyncReadyCallback   callback,
+                                                      gpointer              user_data);
+gboolean           gbp_mapped_document_search_finish (GbpMappedDocument    *self,
+                                                      GAsyncResult         *result,
+                                                      guint                *line,
+                                                      GError              **error);
+
+G_END_DECLS
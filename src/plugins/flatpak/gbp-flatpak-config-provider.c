@@ -27,6 +27,7 @@
 
 #include "gbp-flatpak-client.h"
 #include "gbp-flatpak-config-provider.h"
+#include "gbp-flatpak-download-stage.h"
 #include "gbp-flatpak-manifest.h"
 
 #define DISCOVERY_MAX_DEPTH 3
@@ -145,6 +146,20 @@ gbp_flatpak_config_provider_save_finish (IdeConfigProvider  *provider,
   return ide_task_propagate_boolean (IDE_TASK (result), error);
 }
 
+typedef struct
+{
+  GFile *file;
+  char  *content_hash;
+} LoadManifest;
+
+static void
+load_manifest_free (LoadManifest *state)
+{
+  g_clear_object (&state->file);
+  g_clear_pointer (&state->content_hash, g_free);
+  g_slice_free (LoadManifest, state);
+}
+
 static void
 load_manifest_worker (IdeTask      *task,
                       gpointer      source_object,
@@ -155,15 +170,37 @@ load_manifest_worker (IdeTask      *task,
   g_autoptr(GbpFlatpakManifest) manifest = NULL;
   g_autoptr(GError) error = NULL;
   g_autofree gchar *name = NULL;
-  GFile *file = task_data;
+  LoadManifest *state = task_data;
 
   g_assert (IDE_IS_TASK (task));
   g_assert (GBP_IS_FLATPAK_CONFIG_PROVIDER (self));
-  g_assert (G_IS_FILE (file));
+  g_assert (state != NULL);
+  g_assert (G_IS_FILE (state->file));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
-  name = g_file_get_basename (file);
-  manifest = gbp_flatpak_manifest_new (file, name);
+  /* Avoid parsing the manifest again if the contents did not change,
+   * which is common when the file is touched or saved without edits.
+   */
+  if (state->content_hash != NULL)
+    {
+      g_autofree char *contents = NULL;
+      g_autofree char *content_hash = NULL;
+      gsize len = 0;
+
+      if (g_file_load_contents (state->file, cancellable, &contents, &len, NULL, NULL))
+        {
+          content_hash = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *)contents, len);
+
+          if (ide_str_equal0 (content_hash, state->content_hash))
+            {
+              ide_task_return_pointer (task, NULL, NULL);
+              return;
+            }
+        }
+    }
+
+  name = g_file_get_basename (state->file);
+  manifest = gbp_flatpak_manifest_new (state->file, name);
   ide_object_append (IDE_OBJECT (self), IDE_OBJECT (manifest));
 
   if (!g_initable_init (G_INITABLE (manifest), cancellable, &error))
@@ -184,28 +221,34 @@ load_manifest_worker (IdeTask      *task,
 
 static void
 load_manifest_async (GbpFlatpakConfigProvider *self,
-                     GFile                           *file,
-                     GCancellable                    *cancellable,
-                     GAsyncReadyCallback              callback,
-                     gpointer                         user_data)
+                     GFile                    *file,
+                     const char               *content_hash,
+                     GCancellable             *cancellable,
+                     GAsyncReadyCallback       callback,
+                     gpointer                  user_data)
 {
   g_autoptr(IdeTask) task = NULL;
+  LoadManifest *state;
 
   g_assert (GBP_IS_FLATPAK_CONFIG_PROVIDER (self));
   g_assert (G_IS_FILE (file));
   g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
 
+  state = g_slice_new0 (LoadManifest);
+  state->file = g_object_ref (file);
+  state->content_hash = g_strdup (content_hash);
+
   task = ide_task_new (self, cancellable, callback, user_data);
   ide_task_set_source_tag (task, load_manifest_async);
   ide_task_set_priority (task, G_PRIORITY_LOW);
-  ide_task_set_task_data (task, g_object_ref (file), g_object_unref);
+  ide_task_set_task_data (task, state, (GDestroyNotify)load_manifest_free);
   ide_task_run_in_thread (task, load_manifest_worker);
 }
 
 static GbpFlatpakManifest *
 load_manifest_finish (GbpFlatpakConfigProvider  *self,
-                      GAsyncResult                     *result,
-                      GError                          **error)
+                      GAsyncResult              *result,
+                      GError                   **error)
 {
   g_assert (GBP_IS_FLATPAK_CONFIG_PROVIDER (self));
   g_assert (IDE_IS_TASK (result));
@@ -214,6 +257,47 @@ load_manifest_finish (GbpFlatpakConfigProvider  *self,
   return ide_task_propagate_pointer (IDE_TASK (result), error);
 }
 
+static void
+find_download_stage_cb (gpointer data,
+                        gpointer user_data)
+{
+  GbpFlatpakDownloadStage **stage = user_data;
+
+  g_assert (IDE_IS_PIPELINE_STAGE (data));
+  g_assert (stage != NULL);
+
+  if (GBP_IS_FLATPAK_DOWNLOAD_STAGE (data))
+    *stage = data;
+}
+
+static void
+invalidate_dependencies (GbpFlatpakConfigProvider *self,
+                         GbpFlatpakManifest       *manifest)
+{
+  GbpFlatpakDownloadStage *stage = NULL;
+  IdeBuildManager *build_manager;
+  IdePipeline *pipeline;
+  IdeContext *context;
+
+  g_assert (GBP_IS_FLATPAK_CONFIG_PROVIDER (self));
+  g_assert (GBP_IS_FLATPAK_MANIFEST (manifest));
+
+  context = ide_object_get_context (IDE_OBJECT (self));
+  build_manager = ide_build_manager_from_context (context);
+
+  if (!(pipeline = ide_build_manager_get_pipeline (build_manager)) ||
+      ide_pipeline_get_config (pipeline) != IDE_CONFIG (manifest))
+    return;
+
+  ide_pipeline_foreach_stage (pipeline, find_download_stage_cb, &stage);
+
+  if (stage != NULL)
+    gbp_flatpak_download_stage_invalidate (stage);
+
+  ide_pipeline_invalidate_phase (pipeline,
+                                 IDE_PIPELINE_PHASE_DOWNLOADS | IDE_PIPELINE_PHASE_DEPENDENCIES);
+}
+
 static void
 reload_manifest_cb (GObject      *object,
                     GAsyncResult *result,
@@ -223,6 +307,7 @@ reload_manifest_cb (GObject      *object,
   g_autoptr(GbpFlatpakManifest) old_manifest = user_data;
   g_autoptr(GbpFlatpakManifest) new_manifest = NULL;
   g_autoptr(GError) error = NULL;
+  GbpFlatpakManifestChange change;
   IdeConfigManager *manager;
   IdeConfig *current;
   IdeContext *context;
@@ -236,7 +321,8 @@ reload_manifest_cb (GObject      *object,
 
   if (new_manifest == NULL)
     {
-      g_warning ("Failed to reload manifest: %s", error->message);
+      if (error != NULL)
+        g_warning ("Failed to reload manifest: %s", error->message);
 
       /* Watch for future changes */
       g_signal_connect_object (old_manifest,
@@ -247,6 +333,28 @@ reload_manifest_cb (GObject      *object,
       return;
     }
 
+  change = gbp_flatpak_manifest_diff (old_manifest, new_manifest);
+
+  /* Replacing the configuration tears down the whole pipeline, so only
+   * do that when something affecting the project itself changed. Other
+   * modules only require downloading and building dependencies again.
+   */
+  if (!(change & GBP_FLATPAK_MANIFEST_CHANGE_PROJECT))
+    {
+      gbp_flatpak_manifest_update_from (old_manifest, new_manifest);
+      ide_clear_and_destroy_object (&new_manifest);
+
+      if (change & GBP_FLATPAK_MANIFEST_CHANGE_DEPENDENCIES)
+        invalidate_dependencies (self, old_manifest);
+
+      g_signal_connect_object (old_manifest,
+                               "needs-reload",
+                               G_CALLBACK (manifest_needs_reload),
+                               self,
+                               G_CONNECT_SWAPPED);
+      return;
+    }
+
   g_ptr_array_remove (self->configs, old_manifest);
   g_ptr_array_add (self->configs, g_object_ref (new_manifest));
 
@@ -286,6 +394,7 @@ manifest_needs_reload (GbpFlatpakConfigProvider *self,
 
   load_manifest_async (self,
                        file,
+                       gbp_flatpak_manifest_get_content_hash (manifest),
                        NULL,
                        reload_manifest_cb,
                        g_object_ref (manifest));
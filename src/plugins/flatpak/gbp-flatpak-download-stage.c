@@ -25,6 +25,7 @@
 
 #include "gbp-flatpak-download-stage.h"
 #include "gbp-flatpak-manifest.h"
+#include "gbp-flatpak-sources.h"
 #include "gbp-flatpak-util.h"
 
 struct _GbpFlatpakDownloadStage
@@ -33,6 +34,12 @@ struct _GbpFlatpakDownloadStage
 
   char *state_dir;
 
+  /* Sources of dependency modules which we prefetch concurrently
+   * before flatpak-builder runs, as it only downloads serially.
+   */
+  GPtrArray *archives;
+  char *downloads_dir;
+
   guint invalid : 1;
   guint force_update : 1;
 };
@@ -137,6 +144,16 @@ gbp_flatpak_download_stage_query (IdePipelineStage *stage,
       ide_run_command_append_argv (run_command, staging_dir);
       ide_run_command_append_argv (run_command, manifest_path);
 
+      g_clear_pointer (&self->archives, g_ptr_array_unref);
+      g_clear_pointer (&self->downloads_dir, g_free);
+
+      self->archives = gbp_flatpak_manifest_list_archives (GBP_FLATPAK_MANIFEST (config));
+
+      if (!ide_str_empty0 (self->state_dir))
+        self->downloads_dir = g_build_filename (self->state_dir, "downloads", NULL);
+      else
+        self->downloads_dir = g_build_filename (src_dir, ".flatpak-builder", "downloads", NULL);
+
       ide_pipeline_stage_command_set_build_command (IDE_PIPELINE_STAGE_COMMAND (self), run_command);
       ide_pipeline_stage_set_completed (stage, FALSE);
 
@@ -158,6 +175,137 @@ create_run_context_cb (IdePipelineStageCommand *stage,
   return run_context;
 }
 
+static void
+gbp_flatpak_download_stage_build_cb (GObject      *object,
+                                     GAsyncResult *result,
+                                     gpointer      user_data)
+{
+  IdePipelineStage *stage = (IdePipelineStage *)object;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_FLATPAK_DOWNLOAD_STAGE (stage));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  if (!IDE_PIPELINE_STAGE_CLASS (gbp_flatpak_download_stage_parent_class)->build_finish (stage, result, &error))
+    ide_task_return_error (task, g_steal_pointer (&error));
+  else
+    ide_task_return_boolean (task, TRUE);
+
+  IDE_EXIT;
+}
+
+static void
+gbp_flatpak_download_stage_prefetch_cb (GObject      *object,
+                                        GAsyncResult *result,
+                                        gpointer      user_data)
+{
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  GbpFlatpakDownloadStage *self;
+  IdePipeline *pipeline;
+  guint n_fetched = 0;
+
+  IDE_ENTRY;
+
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  pipeline = ide_task_get_task_data (task);
+
+  g_assert (GBP_IS_FLATPAK_DOWNLOAD_STAGE (self));
+  g_assert (IDE_IS_PIPELINE (pipeline));
+
+  /* Failures are not fatal, flatpak-builder will retry the
+   * download and report the error itself.
+   */
+  if (!gbp_flatpak_sources_prefetch_finish (result, &n_fetched, &error))
+    ide_pipeline_stage_log (IDE_PIPELINE_STAGE (self),
+                            IDE_BUILD_LOG_STDERR,
+                            error->message,
+                            -1);
+
+  IDE_TRACE_MSG ("Prefetched %u module sources", n_fetched);
+
+  if (ide_task_return_error_if_cancelled (task))
+    IDE_EXIT;
+
+  IDE_PIPELINE_STAGE_CLASS (gbp_flatpak_download_stage_parent_class)->build_async (IDE_PIPELINE_STAGE (self),
+                                                                                    pipeline,
+                                                                                    ide_task_get_cancellable (task),
+                                                                                    gbp_flatpak_download_stage_build_cb,
+                                                                                    g_object_ref (task));
+
+  IDE_EXIT;
+}
+
+static void
+gbp_flatpak_download_stage_build_async (IdePipelineStage    *stage,
+                                        IdePipeline         *pipeline,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GbpFlatpakDownloadStage *self = (GbpFlatpakDownloadStage *)stage;
+  g_autoptr(GPtrArray) archives = NULL;
+  g_autoptr(GSettings) settings = NULL;
+  g_autoptr(IdeTask) task = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_FLATPAK_DOWNLOAD_STAGE (self));
+  g_assert (IDE_IS_PIPELINE (pipeline));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_flatpak_download_stage_build_async);
+  ide_task_set_task_data (task, g_object_ref (pipeline), g_object_unref);
+
+  archives = g_steal_pointer (&self->archives);
+
+  if (archives == NULL || archives->len == 0 || self->downloads_dir == NULL)
+    {
+      IDE_PIPELINE_STAGE_CLASS (gbp_flatpak_download_stage_parent_class)->build_async (stage,
+                                                                                        pipeline,
+                                                                                        cancellable,
+                                                                                        gbp_flatpak_download_stage_build_cb,
+                                                                                        g_steal_pointer (&task));
+      IDE_EXIT;
+    }
+
+  settings = g_settings_new ("org.gnome.builder.flatpak");
+
+  gbp_flatpak_sources_prefetch_async (archives,
+                                      self->downloads_dir,
+                                      g_settings_get_uint (settings, "download-parallelism"),
+                                      cancellable,
+                                      gbp_flatpak_download_stage_prefetch_cb,
+                                      g_steal_pointer (&task));
+
+  IDE_EXIT;
+}
+
+static gboolean
+gbp_flatpak_download_stage_build_finish (IdePipelineStage  *stage,
+                                         GAsyncResult      *result,
+                                         GError           **error)
+{
+  gboolean ret;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_FLATPAK_DOWNLOAD_STAGE (stage));
+  g_assert (IDE_IS_TASK (result));
+
+  ret = ide_task_propagate_boolean (IDE_TASK (result), error);
+
+  IDE_RETURN (ret);
+}
+
 static void
 gbp_flatpak_download_stage_finalize (GObject *object)
 {
@@ -166,6 +314,8 @@ gbp_flatpak_download_stage_finalize (GObject *object)
   g_assert (GBP_IS_FLATPAK_DOWNLOAD_STAGE (self));
 
   g_clear_pointer (&self->state_dir, g_free);
+  g_clear_pointer (&self->downloads_dir, g_free);
+  g_clear_pointer (&self->archives, g_ptr_array_unref);
 
   G_OBJECT_CLASS (gbp_flatpak_download_stage_parent_class)->finalize (object);
 }
@@ -199,6 +349,8 @@ gbp_flatpak_download_stage_class_init (GbpFlatpakDownloadStageClass *klass)
   object_class->set_property = gbp_flatpak_download_stage_set_property;
 
   stage_class->query = gbp_flatpak_download_stage_query;
+  stage_class->build_async = gbp_flatpak_download_stage_build_async;
+  stage_class->build_finish = gbp_flatpak_download_stage_build_finish;
 
   /**
    * GbpFlatpakDownloadStage:state-dir:
@@ -238,3 +390,11 @@ gbp_flatpak_download_stage_force_update (GbpFlatpakDownloadStage *self)
   self->force_update = TRUE;
   self->invalid = TRUE;
 }
+
+void
+gbp_flatpak_download_stage_invalidate (GbpFlatpakDownloadStage *self)
+{
+  g_return_if_fail (GBP_IS_FLATPAK_DOWNLOAD_STAGE (self));
+
+  self->invalid = TRUE;
+}
@@ -29,5 +29,6 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GbpFlatpakDownloadStage, gbp_flatpak_download_stage, GBP, FLATPAK_DOWNLOAD_STAGE, IdePipelineStageLauncher)
 
 void gbp_flatpak_download_stage_force_update (GbpFlatpakDownloadStage *self);
+void gbp_flatpak_download_stage_invalidate   (GbpFlatpakDownloadStage *self);
 
 G_END_DECLS
@@ -32,6 +32,7 @@
 #include "gbp-flatpak-manifest.h"
 #include "gbp-flatpak-runtime.h"
 #include "gbp-flatpak-sdk.h"
+#include "gbp-flatpak-sources.h"
 #include "gbp-flatpak-util.h"
 #include "gbp-flatpak-workbench-addin.h"
 
@@ -47,6 +48,14 @@ struct _GbpFlatpakManifest
 
   JsonNode         *root;
 
+  /* SHA-256 of the file contents, used to skip reparsing when the file
+   * monitor fires but nothing changed. The fingerprints are taken from
+   * the parsed tree so that formatting changes are ignored.
+   */
+  gchar            *content_hash;
+  gchar            *project_hash;
+  gchar            *tree_hash;
+
   /* These are related to the toplevel object, which are project-wide
    * configuration options.
    */
@@ -517,6 +526,70 @@ no_match:
   return NULL;
 }
 
+static void
+checksum_node (GChecksum     *checksum,
+               JsonGenerator *generator,
+               JsonNode      *node)
+{
+  g_autofree char *data = NULL;
+  gsize len = 0;
+
+  json_generator_set_root (generator, node);
+  data = json_generator_to_data (generator, &len);
+  g_checksum_update (checksum, (const guchar *)data, len);
+}
+
+/*
+ * The "project" fingerprint covers everything that can affect how the
+ * primary module is configured and built, which is every toplevel member
+ * but "modules" as well as the primary module itself. The "tree"
+ * fingerprint covers the whole document so that changes to dependency
+ * modules can be detected separately.
+ */
+static void
+update_fingerprints (GbpFlatpakManifest *self)
+{
+  g_autoptr(JsonGenerator) generator = NULL;
+  g_autoptr(GChecksum) project = NULL;
+  g_autoptr(GChecksum) tree = NULL;
+  g_autoptr(JsonNode) primary = NULL;
+  g_autoptr(GList) members = NULL;
+  JsonObject *root_obj;
+
+  g_assert (GBP_IS_FLATPAK_MANIFEST (self));
+  g_assert (self->root != NULL);
+  g_assert (self->primary != NULL);
+
+  generator = json_generator_new ();
+  project = g_checksum_new (G_CHECKSUM_SHA256);
+  tree = g_checksum_new (G_CHECKSUM_SHA256);
+  root_obj = json_node_get_object (self->root);
+  members = json_object_get_members (root_obj);
+
+  for (const GList *iter = members; iter; iter = iter->next)
+    {
+      const char *name = iter->data;
+
+      if (g_strcmp0 (name, "modules") == 0)
+        continue;
+
+      g_checksum_update (project, (const guchar *)name, -1);
+      checksum_node (project, generator, json_object_get_member (root_obj, name));
+    }
+
+  primary = json_node_new (JSON_NODE_OBJECT);
+  json_node_set_object (primary, self->primary);
+  checksum_node (project, generator, primary);
+
+  checksum_node (tree, generator, self->root);
+
+  g_free (self->project_hash);
+  self->project_hash = g_strdup (g_checksum_get_string (project));
+
+  g_free (self->tree_hash);
+  self->tree_hash = g_strdup (g_checksum_get_string (tree));
+}
+
 static gboolean
 gbp_flatpak_manifest_initable_init (GInitable     *initable,
                                     GCancellable  *cancellable,
@@ -550,6 +623,8 @@ gbp_flatpak_manifest_initable_init (GInitable     *initable,
 
   parser = json_parser_new ();
 
+  self->content_hash = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *)contents, len);
+
   if (!json_parser_load_from_data (parser, contents, len, error))
     return FALSE;
 
@@ -661,6 +736,8 @@ gbp_flatpak_manifest_initable_init (GInitable     *initable,
   self->root = json_node_ref (root);
   self->primary = json_object_ref (primary);
 
+  update_fingerprints (self);
+
   if (!validate_properties (self, error))
     return FALSE;
 
@@ -848,6 +925,9 @@ gbp_flatpak_manifest_finalize (GObject *object)
   g_clear_object (&self->file_monitor);
 
   g_clear_pointer (&self->root, json_node_unref);
+  g_clear_pointer (&self->content_hash, g_free);
+  g_clear_pointer (&self->project_hash, g_free);
+  g_clear_pointer (&self->tree_hash, g_free);
 
   g_clear_pointer (&self->build_args, g_strfreev);
   g_clear_pointer (&self->command, g_free);
@@ -1251,6 +1331,11 @@ gbp_flatpak_manifest_save_async (GbpFlatpakManifest  *self,
   data[len] = '\n';
   bytes = g_bytes_new_take (g_steal_pointer (&data), len + 1);
 
+  /* Track what we wrote so that our own change notification is a no-op */
+  g_free (self->content_hash);
+  self->content_hash = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+  update_fingerprints (self);
+
   gbp_flatpak_manifest_block_monitor (self);
 
   /*
@@ -1542,3 +1627,194 @@ gbp_flatpak_manifest_get_base_version (GbpFlatpakManifest *self)
 
   return self->base_version;
 }
+
+static void
+collect_archives (JsonObject  *parent,
+                  const char  *primary_module,
+                  GPtrArray   *archives,
+                  GHashTable  *seen)
+{
+  JsonArray *ar;
+  JsonNode *modules;
+  guint n_elements;
+
+  g_assert (parent != NULL);
+  g_assert (archives != NULL);
+  g_assert (seen != NULL);
+
+  if (!(modules = json_object_get_member (parent, "modules")) ||
+      !JSON_NODE_HOLDS_ARRAY (modules) ||
+      !(ar = json_node_get_array (modules)))
+    return;
+
+  n_elements = json_array_get_length (ar);
+
+  for (guint i = 0; i < n_elements; i++)
+    {
+      JsonNode *element = json_array_get_element (ar, i);
+      JsonNode *sources;
+      JsonObject *obj;
+      JsonArray *sources_ar;
+      const char *name;
+
+      /* Modules referenced by filename are left to flatpak-builder */
+      if (!JSON_NODE_HOLDS_OBJECT (element) ||
+          !(obj = json_node_get_object (element)))
+        continue;
+
+      name = json_object_get_string_member (obj, "name");
+
+      /* The primary module is the project itself, nothing to fetch */
+      if (ide_str_equal0 (name, primary_module))
+        continue;
+
+      collect_archives (obj, primary_module, archives, seen);
+
+      if (!(sources = json_object_get_member (obj, "sources")) ||
+          !JSON_NODE_HOLDS_ARRAY (sources) ||
+          !(sources_ar = json_node_get_array (sources)))
+        continue;
+
+      for (guint j = 0; j < json_array_get_length (sources_ar); j++)
+        {
+          JsonNode *source_node = json_array_get_element (sources_ar, j);
+          GbpFlatpakArchive *archive;
+          JsonObject *source;
+          JsonNode *type;
+          JsonNode *url;
+          JsonNode *sha256;
+
+          if (!JSON_NODE_HOLDS_OBJECT (source_node) ||
+              !(source = json_node_get_object (source_node)) ||
+              !(type = json_object_get_member (source, "type")) ||
+              !JSON_NODE_HOLDS_VALUE (type) ||
+              !(url = json_object_get_member (source, "url")) ||
+              !JSON_NODE_HOLDS_VALUE (url) ||
+              !(sha256 = json_object_get_member (source, "sha256")) ||
+              !JSON_NODE_HOLDS_VALUE (sha256))
+            continue;
+
+          if (!ide_str_equal0 (json_node_get_string (type), "archive") &&
+              !ide_str_equal0 (json_node_get_string (type), "file"))
+            continue;
+
+          if (ide_str_empty0 (json_node_get_string (url)) ||
+              ide_str_empty0 (json_node_get_string (sha256)) ||
+              g_hash_table_contains (seen, json_node_get_string (sha256)))
+            continue;
+
+          archive = g_slice_new0 (GbpFlatpakArchive);
+          archive->url = g_strdup (json_node_get_string (url));
+          archive->sha256 = g_ascii_strdown (json_node_get_string (sha256), -1);
+          g_ptr_array_add (archives, archive);
+
+          g_hash_table_add (seen, archive->sha256);
+        }
+    }
+}
+
+/**
+ * gbp_flatpak_manifest_list_archives:
+ * @self: a #GbpFlatpakManifest
+ *
+ * Gets the "archive" and "file" sources of every module but the primary
+ * module which can be verified with a sha256 checksum. Duplicate checksums
+ * are only listed once.
+ *
+ * Returns: (transfer full) (element-type GbpFlatpakArchive): an array
+ */
+GPtrArray *
+gbp_flatpak_manifest_list_archives (GbpFlatpakManifest *self)
+{
+  g_autoptr(GHashTable) seen = NULL;
+  GPtrArray *archives;
+
+  g_return_val_if_fail (GBP_IS_FLATPAK_MANIFEST (self), NULL);
+
+  archives = g_ptr_array_new_with_free_func ((GDestroyNotify)gbp_flatpak_archive_free);
+
+  if (self->root == NULL || !JSON_NODE_HOLDS_OBJECT (self->root))
+    return archives;
+
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  collect_archives (json_node_get_object (self->root),
+                    self->primary_module,
+                    archives,
+                    seen);
+
+  return archives;
+}
+
+/**
+ * gbp_flatpak_manifest_get_content_hash:
+ *
+ * Gets the SHA-256 checksum of the manifest contents as they were last
+ * loaded from or saved to disk.
+ */
+const char *
+gbp_flatpak_manifest_get_content_hash (GbpFlatpakManifest *self)
+{
+  g_return_val_if_fail (GBP_IS_FLATPAK_MANIFEST (self), NULL);
+
+  return self->content_hash;
+}
+
+/**
+ * gbp_flatpak_manifest_diff:
+ * @self: a #GbpFlatpakManifest
+ * @other: a #GbpFlatpakManifest loaded from the same file
+ *
+ * Compares the parsed trees of @self and @other to determine what kind
+ * of change was made to the manifest.
+ *
+ * Returns: a #GbpFlatpakManifestChange
+ */
+GbpFlatpakManifestChange
+gbp_flatpak_manifest_diff (GbpFlatpakManifest *self,
+                           GbpFlatpakManifest *other)
+{
+  GbpFlatpakManifestChange change = GBP_FLATPAK_MANIFEST_CHANGE_NONE;
+
+  g_return_val_if_fail (GBP_IS_FLATPAK_MANIFEST (self), GBP_FLATPAK_MANIFEST_CHANGE_NONE);
+  g_return_val_if_fail (GBP_IS_FLATPAK_MANIFEST (other), GBP_FLATPAK_MANIFEST_CHANGE_NONE);
+
+  if (ide_str_equal0 (self->tree_hash, other->tree_hash))
+    return GBP_FLATPAK_MANIFEST_CHANGE_NONE;
+
+  if (!ide_str_equal0 (self->project_hash, other->project_hash) ||
+      !ide_str_equal0 (self->primary_module, other->primary_module))
+    change |= GBP_FLATPAK_MANIFEST_CHANGE_PROJECT;
+  else
+    change |= GBP_FLATPAK_MANIFEST_CHANGE_DEPENDENCIES;
+
+  return change;
+}
+
+/**
+ * gbp_flatpak_manifest_update_from:
+ * @self: a #GbpFlatpakManifest
+ * @other: a #GbpFlatpakManifest loaded from the same file
+ *
+ * Takes the parsed tree from @other so that @self may be kept as the
+ * configuration when gbp_flatpak_manifest_diff() reports that the project
+ * itself was not changed.
+ */
+void
+gbp_flatpak_manifest_update_from (GbpFlatpakManifest *self,
+                                  GbpFlatpakManifest *other)
+{
+  g_return_if_fail (GBP_IS_FLATPAK_MANIFEST (self));
+  g_return_if_fail (GBP_IS_FLATPAK_MANIFEST (other));
+  g_return_if_fail (other->root != NULL);
+  g_return_if_fail (other->primary != NULL);
+
+  g_clear_pointer (&self->root, json_node_unref);
+  g_clear_pointer (&self->primary, json_object_unref);
+
+  self->root = json_node_ref (other->root);
+  self->primary = json_object_ref (other->primary);
+
+  g_set_str (&self->content_hash, other->content_hash);
+  g_set_str (&self->project_hash, other->project_hash);
+  g_set_str (&self->tree_hash, other->tree_hash);
+}
@@ -27,6 +27,13 @@
 
 G_BEGIN_DECLS
 
+typedef enum
+{
+  GBP_FLATPAK_MANIFEST_CHANGE_NONE         = 0,
+  GBP_FLATPAK_MANIFEST_CHANGE_DEPENDENCIES = 1 << 0,
+  GBP_FLATPAK_MANIFEST_CHANGE_PROJECT      = 1 << 1,
+} GbpFlatpakManifestChange;
+
 #define GBP_TYPE_FLATPAK_MANIFEST (gbp_flatpak_manifest_get_type())
 
 G_DECLARE_FINAL_TYPE (GbpFlatpakManifest, gbp_flatpak_manifest, GBP, FLATPAK_MANIFEST, IdeConfig)
@@ -48,6 +55,13 @@ const gchar          *gbp_flatpak_manifest_get_platform              (GbpFlatpak
 gchar               **gbp_flatpak_manifest_get_runtimes              (GbpFlatpakManifest   *self,
                                                                       const gchar          *for_arch);
 const char           *gbp_flatpak_manifest_get_branch                (GbpFlatpakManifest   *self);
+GPtrArray            *gbp_flatpak_manifest_list_archives             (GbpFlatpakManifest   *self);
+const char           *gbp_flatpak_manifest_get_content_hash          (GbpFlatpakManifest   *self);
+GbpFlatpakManifestChange
+                      gbp_flatpak_manifest_diff                      (GbpFlatpakManifest   *self,
+                                                                      GbpFlatpakManifest   *other);
+void                  gbp_flatpak_manifest_update_from               (GbpFlatpakManifest   *self,
+                                                                      GbpFlatpakManifest   *other);
 void                  gbp_flatpak_manifest_save_async                (GbpFlatpakManifest   *self,
                                                                       GCancellable         *cancellable,
                                                                       GAsyncReadyCallback   callback,
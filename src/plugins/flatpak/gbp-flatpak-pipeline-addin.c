@@ -179,6 +179,7 @@ register_mkdirs_stage (GbpFlatpakPipelineAddin  *self,
 
   mkdirs = ide_pipeline_stage_mkdirs_new (context);
   ide_pipeline_stage_set_name (mkdirs, _("Creating flatpak workspace"));
+  ide_pipeline_stage_set_concurrent (mkdirs, TRUE);
 
   repo_dir = gbp_flatpak_get_repo_dir (context);
   staging_dir = gbp_flatpak_get_staging_dir (pipeline);
@@ -489,6 +490,8 @@ register_downloads_stage (GbpFlatpakPipelineAddin  *self,
   stage = g_object_new (GBP_TYPE_FLATPAK_DOWNLOAD_STAGE,
                         "name", _("Downloading dependencies"),
                         "state-dir", self->state_dir,
+                        "concurrent", TRUE,
+                        "resource", self->state_dir,
                         NULL);
   stage_id = ide_pipeline_attach (pipeline, IDE_PIPELINE_PHASE_DOWNLOADS, 0, stage);
   ide_pipeline_addin_track (IDE_PIPELINE_ADDIN (self), stage_id);
@@ -626,3 +626,323 @@ gbp_flatpak_sources_apply_patch (const gchar  *path,
 
   return TRUE;
 }
+
+void
+gbp_flatpak_archive_free (GbpFlatpakArchive *archive)
+{
+  if (archive != NULL)
+    {
+      g_clear_pointer (&archive->url, g_free);
+      g_clear_pointer (&archive->sha256, g_free);
+      g_slice_free (GbpFlatpakArchive, archive);
+    }
+}
+
+typedef struct
+{
+  GPtrArray    *archives;
+  char         *downloads_dir;
+  GCancellable *cancellable;
+  GMutex        mutex;
+  GError       *error;
+  guint         n_parallel;
+  int           n_fetched;
+} Prefetch;
+
+static void
+prefetch_free (Prefetch *state)
+{
+  g_clear_pointer (&state->archives, g_ptr_array_unref);
+  g_clear_pointer (&state->downloads_dir, g_free);
+  g_clear_object (&state->cancellable);
+  g_clear_error (&state->error);
+  g_mutex_clear (&state->mutex);
+  g_slice_free (Prefetch, state);
+}
+
+static GInputStream *
+open_archive_uri (GUri          *uri,
+                  SoupSession   *session,
+                  GCancellable  *cancellable,
+                  GError       **error)
+{
+  g_autoptr(SoupMessage) msg = NULL;
+  g_autoptr(GInputStream) input = NULL;
+  g_autofree char *uri_string = NULL;
+  const char *scheme = g_uri_get_scheme (uri);
+
+  if (g_strcmp0 (scheme, "http") != 0 && g_strcmp0 (scheme, "https") != 0)
+    {
+      g_autoptr(GFile) file = NULL;
+
+      /* Allows using local mirrors with file:// */
+      uri_string = g_uri_to_string (uri);
+      file = g_file_new_for_uri (uri_string);
+
+      return G_INPUT_STREAM (g_file_read (file, cancellable, error));
+    }
+
+  msg = soup_message_new_from_uri ("GET", uri);
+  if (!(input = soup_session_send (session, msg, cancellable, error)))
+    return NULL;
+
+  if (!SOUP_STATUS_IS_SUCCESSFUL (soup_message_get_status (msg)))
+    {
+      uri_string = g_uri_to_string (uri);
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Failed to download %s: %s",
+                   uri_string,
+                   soup_message_get_reason_phrase (msg));
+      return NULL;
+    }
+
+  return g_steal_pointer (&input);
+}
+
+/*
+ * Downloads @archive into the flatpak-builder downloads directory using
+ * the same layout as flatpak-builder (downloads/<sha256>/<basename>) so
+ * that it will find the file and skip downloading it itself. The state
+ * directory is shared by all projects, so this also acts as a content
+ * addressed cache across them.
+ *
+ * The contents are streamed to a temporary file while being hashed and
+ * only moved into place once the checksum matches.
+ */
+static gboolean
+prefetch_archive (const GbpFlatpakArchive  *archive,
+                  const char               *downloads_dir,
+                  GCancellable             *cancellable,
+                  gboolean                 *fetched,
+                  GError                  **error)
+{
+  g_autoptr(SoupSession) session = NULL;
+  g_autoptr(GFileOutputStream) output = NULL;
+  g_autoptr(GInputStream) input = NULL;
+  g_autoptr(GChecksum) checksum = NULL;
+  g_autoptr(GFile) tmpfile = NULL;
+  g_autoptr(GFile) file = NULL;
+  g_autoptr(GUri) uri = NULL;
+  g_autofree char *basename = NULL;
+  g_autofree char *dir = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *tmppath = NULL;
+  g_autofree guint8 *buf = NULL;
+  const char *sha256;
+
+  g_assert (archive != NULL);
+  g_assert (downloads_dir != NULL);
+
+  *fetched = FALSE;
+
+  if (!(uri = g_uri_parse (archive->url, G_URI_FLAGS_NONE, error)))
+    return FALSE;
+
+  basename = g_path_get_basename (g_uri_get_path (uri));
+  if (basename[0] == 0 || basename[0] == '/' || basename[0] == '.')
+    return TRUE;
+
+  dir = g_build_filename (downloads_dir, archive->sha256, NULL);
+  path = g_build_filename (dir, basename, NULL);
+
+  if (g_file_test (path, G_FILE_TEST_EXISTS))
+    return TRUE;
+
+  if (g_mkdir_with_parents (dir, 0750) != 0)
+    {
+      int errsv = errno;
+      g_set_error (error,
+                   G_IO_ERROR,
+                   g_io_error_from_errno (errsv),
+                   "%s", g_strerror (errsv));
+      return FALSE;
+    }
+
+  session = get_soup_session ();
+
+  if (!(input = open_archive_uri (uri, session, cancellable, error)))
+    return FALSE;
+
+  tmppath = g_strdup_printf ("%s.part", path);
+  tmpfile = g_file_new_for_path (tmppath);
+
+  if (!(output = g_file_replace (tmpfile, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION, cancellable, error)))
+    return FALSE;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  buf = g_malloc (64 * 1024);
+
+  for (;;)
+    {
+      gssize n_read = g_input_stream_read (input, buf, 64 * 1024, cancellable, error);
+
+      if (n_read < 0)
+        goto failure;
+
+      if (n_read == 0)
+        break;
+
+      g_checksum_update (checksum, buf, n_read);
+
+      if (!g_output_stream_write_all (G_OUTPUT_STREAM (output), buf, n_read, NULL, cancellable, error))
+        goto failure;
+    }
+
+  if (!g_output_stream_close (G_OUTPUT_STREAM (output), cancellable, error))
+    goto failure;
+
+  sha256 = g_checksum_get_string (checksum);
+
+  if (g_strcmp0 (sha256, archive->sha256) != 0)
+    {
+      g_set_error (error,
+                   G_IO_ERROR,
+                   G_IO_ERROR_FAILED,
+                   "Wrong sha256 for %s, expected %s, was %s",
+                   archive->url, archive->sha256, sha256);
+      goto failure;
+    }
+
+  file = g_file_new_for_path (path);
+  if (!g_file_move (tmpfile, file, G_FILE_COPY_OVERWRITE, cancellable, NULL, NULL, error))
+    goto failure;
+
+  *fetched = TRUE;
+
+  return TRUE;
+
+failure:
+  g_file_delete (tmpfile, NULL, NULL);
+
+  return FALSE;
+}
+
+static void
+prefetch_worker (gpointer data,
+                 gpointer user_data)
+{
+  const GbpFlatpakArchive *archive = data;
+  Prefetch *state = user_data;
+  g_autoptr(GError) error = NULL;
+  gboolean fetched = FALSE;
+
+  g_assert (archive != NULL);
+  g_assert (state != NULL);
+
+  if (g_cancellable_is_cancelled (state->cancellable))
+    return;
+
+  if (!prefetch_archive (archive, state->downloads_dir, state->cancellable, &fetched, &error))
+    {
+      g_debug ("Failed to prefetch %s: %s", archive->url, error->message);
+
+      g_mutex_lock (&state->mutex);
+      if (state->error == NULL)
+        state->error = g_steal_pointer (&error);
+      g_mutex_unlock (&state->mutex);
+
+      return;
+    }
+
+  if (fetched)
+    g_atomic_int_inc (&state->n_fetched);
+}
+
+static void
+gbp_flatpak_sources_prefetch_thread (GTask        *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  Prefetch *state = task_data;
+  g_autoptr(GError) error = NULL;
+  GThreadPool *pool;
+
+  g_assert (G_IS_TASK (task));
+  g_assert (state != NULL);
+
+  if (!(pool = g_thread_pool_new (prefetch_worker, state, state->n_parallel, TRUE, &error)))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  for (guint i = 0; i < state->archives->len; i++)
+    g_thread_pool_push (pool, g_ptr_array_index (state->archives, i), NULL);
+
+  /* Waits for all queued downloads to complete */
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  if (state->error != NULL)
+    g_task_return_error (task, g_steal_pointer (&state->error));
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * gbp_flatpak_sources_prefetch_async:
+ * @archives: (element-type GbpFlatpakArchive): archives to download
+ * @downloads_dir: the flatpak-builder downloads directory
+ * @n_parallel: the max number of concurrent downloads
+ *
+ * Downloads @archives into @downloads_dir using up to @n_parallel
+ * concurrent transfers. Archives which are already available are
+ * skipped. All archives are attempted even if some of them fail, in
+ * which case the first error is propagated.
+ */
+void
+gbp_flatpak_sources_prefetch_async (GPtrArray           *archives,
+                                    const char          *downloads_dir,
+                                    guint                n_parallel,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  Prefetch *state;
+
+  g_return_if_fail (archives != NULL);
+  g_return_if_fail (downloads_dir != NULL);
+  g_return_if_fail (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  state = g_slice_new0 (Prefetch);
+  state->archives = g_ptr_array_ref (archives);
+  state->downloads_dir = g_strdup (downloads_dir);
+  state->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  state->n_parallel = CLAMP (n_parallel, 1, 32);
+  g_mutex_init (&state->mutex);
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gbp_flatpak_sources_prefetch_async);
+  g_task_set_task_data (task, state, (GDestroyNotify)prefetch_free);
+
+  if (archives->len == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  g_task_run_in_thread (task, gbp_flatpak_sources_prefetch_thread);
+}
+
+gboolean
+gbp_flatpak_sources_prefetch_finish (GAsyncResult  *result,
+                                     guint         *n_fetched,
+                                     GError       **error)
+{
+  Prefetch *state;
+
+  g_return_val_if_fail (G_IS_TASK (result), FALSE);
+
+  state = g_task_get_task_data (G_TASK (result));
+
+  if (n_fetched != NULL)
+    *n_fetched = g_atomic_int_get (&state->n_fetched);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -20,13 +20,35 @@
 
 #pragma once
 
-GFile    *gbp_flatpak_sources_fetch_archive (const gchar  *url,
-                                             const gchar  *sha,
-                                             const gchar  *module_name,
-                                             GFile        *destination,
-                                             guint         strip_components,
-                                             GError      **error);
-gboolean  gbp_flatpak_sources_apply_patch   (const gchar  *path,
-                                             GFile        *source_dir,
-                                             guint         strip_components,
-                                             GError      **error);
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct
+{
+  char *url;
+  char *sha256;
+} GbpFlatpakArchive;
+
+void      gbp_flatpak_archive_free            (GbpFlatpakArchive    *archive);
+void      gbp_flatpak_sources_prefetch_async  (GPtrArray            *archives,
+                                               const char           *downloads_dir,
+                                               guint                 n_parallel,
+                                               GCancellable         *cancellable,
+                                               GAsyncReadyCallback   callback,
+                                               gpointer              user_data);
+gboolean  gbp_flatpak_sources_prefetch_finish (GAsyncResult         *result,
+                                               guint                *n_fetched,
+                                               GError              **error);
+GFile    *gbp_flatpak_sources_fetch_archive   (const gchar          *url,
+                                               const gchar          *sha,
+                                               const gchar          *module_name,
+                                               GFile                *destination,
+                                               guint                 strip_components,
+                                               GError              **error);
+gboolean  gbp_flatpak_sources_apply_patch     (const gchar          *path,
+                                               GFile                *source_dir,
+                                               guint                 strip_components,
+                                               GError              **error);
+
+G_END_DECLS
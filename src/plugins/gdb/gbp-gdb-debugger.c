@@ -34,7 +34,10 @@
 
 #include "gbp-gdb-debugger.h"
 
-#define READ_BUFFER_LEN 4096
+/* Large enough that a full -stack-list-variables or -data-list-register-values
+ * reply for a deep frame usually arrives in a single read.
+ */
+#define READ_BUFFER_LEN (64 * 1024)
 
 struct _GbpGdbDebugger
 {
@@ -51,6 +54,7 @@ struct _GbpGdbDebugger
 
   GQueue                    writequeue;
   GQueue                    cmdqueue;
+  GHashTable               *cmdlinks;
   guint                     cmdseq;
 
   guint                     has_connected : 1;
@@ -66,6 +70,9 @@ typedef struct
 
 G_DEFINE_FINAL_TYPE (GbpGdbDebugger, gbp_gdb_debugger, IDE_TYPE_DEBUGGER)
 
+/* Maps the "reason" of *stopped records to IdeDebuggerStopReason */
+static GHashTable *stop_reasons;
+
 #define DEBUG_LOG(dir,msg)                                 \
   G_STMT_START {                                           \
     IdeLineReader reader;                                  \
@@ -196,6 +203,8 @@ gbp_gdb_debugger_panic (GbpGdbDebugger *self)
   self->cmdqueue.tail = NULL;
   self->cmdqueue.length = 0;
 
+  g_hash_table_remove_all (self->cmdlinks);
+
   for (const GList *iter = list; iter != NULL; iter = iter->next)
     {
       g_autoptr(IdeTask) task = iter->data;
@@ -246,24 +255,21 @@ gbp_gdb_debugger_find_task (GbpGdbDebugger           *self,
 
   if (g_ascii_isdigit (output->line[0]))
     {
-      g_autofree gchar *id = NULL;
-      guint i;
-
-      for (i = 1; g_ascii_isdigit (output->line[i]); i++)
-        continue;
+      GList *link;
+      guint id = 0;
 
-      id = g_strndup (output->line, i);
+      /* Tokens are always < 10000 (see gbp_gdb_debugger_exec_async()) */
+      for (guint i = 0; i < 5 && g_ascii_isdigit (output->line[i]); i++)
+        id = (id * 10) + (output->line[i] - '0');
 
-      for (GList *iter = self->cmdqueue.head; iter; iter = iter->next)
+      if ((link = g_hash_table_lookup (self->cmdlinks, GUINT_TO_POINTER (id))))
         {
-          IdeTask *task = iter->data;
-          const gchar *task_id = ide_task_get_task_data (task);
+          IdeTask *task = link->data;
 
-          if (strcmp (id, task_id) == 0)
-            {
-              g_queue_delete_link (&self->cmdqueue, iter);
-              return task;
-            }
+          g_hash_table_remove (self->cmdlinks, GUINT_TO_POINTER (id));
+          g_queue_delete_link (&self->cmdqueue, link);
+
+          return task;
         }
     }
 
@@ -457,6 +463,17 @@ parse_disposition_from_string (const gchar *str)
   return IDE_DEBUGGER_DISPOSITION_KEEP;
 }
 
+static IdeDebuggerStopReason
+parse_stop_reason_from_string (const gchar *str)
+{
+  gpointer value;
+
+  if (str != NULL && g_hash_table_lookup_extended (stop_reasons, str, NULL, &value))
+    return GPOINTER_TO_INT (value);
+
+  return IDE_DEBUGGER_STOP_UNKNOWN;
+}
+
 static void
 gbp_gdb_debugger_handle_breakpoint (GbpGdbDebugger              *self,
                                     struct gdbwire_mi_output    *output,
@@ -653,32 +670,7 @@ gbp_gdb_debugger_handle_stopped (GbpGdbDebugger                 *self,
         }
     }
 
-  if (FALSE) {}
-  else if (g_strcmp0 (reason, "exited-normally") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_EXITED_NORMALLY;
-  else if (g_strcmp0 (reason, "breakpoint-hit") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_BREAKPOINT_HIT;
-  else if (g_strcmp0 (reason, "function-finished") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_FUNCTION_FINISHED;
-  else if (g_strcmp0 (reason, "location-reached") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_LOCATION_REACHED;
-  else if (g_strcmp0 (reason, "exited-signaled") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_EXITED_SIGNALED;
-  else if (g_strcmp0 (reason, "exited") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_EXITED;
-  else if (g_strcmp0 (reason, "exited-normally") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_EXITED_NORMALLY;
-  else if (g_strcmp0 (reason, "signal-received") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_SIGNAL_RECEIVED;
-  else if (g_strcmp0 (reason, "solib-event") == 0 ||
-           g_strcmp0 (reason, "fork") == 0 ||
-           g_strcmp0 (reason, "vfork") == 0 ||
-           g_strcmp0 (reason, "syscall-entry") == 0 ||
-           g_strcmp0 (reason, "syscall-return") == 0 ||
-           g_strcmp0 (reason, "exec") == 0)
-    stop_reason = IDE_DEBUGGER_STOP_CATCH;
-  else
-    stop_reason = IDE_DEBUGGER_STOP_UNKNOWN;
+  stop_reason = parse_stop_reason_from_string (reason);
 
   breakpoint = ide_debugger_breakpoint_new (id);
   ide_debugger_breakpoint_set_thread (breakpoint, thread_id);
@@ -2603,6 +2595,8 @@ gbp_gdb_debugger_destroy (IdeObject *object)
   self->cmdqueue.tail = NULL;
   self->cmdqueue.length = 0;
 
+  g_hash_table_remove_all (self->cmdlinks);
+
   for (const GList *iter = list; iter != NULL; iter = iter->next)
     {
       g_autoptr(IdeTask) task = iter->data;
@@ -2641,6 +2635,7 @@ gbp_gdb_debugger_finalize (GObject *object)
   g_clear_pointer (&self->parser, gdbwire_mi_parser_destroy);
   g_clear_pointer (&self->read_buffer, g_free);
   g_clear_pointer (&self->register_names, g_hash_table_unref);
+  g_clear_pointer (&self->cmdlinks, g_hash_table_unref);
   g_queue_clear (&self->cmdqueue);
 
   G_OBJECT_CLASS (gbp_gdb_debugger_parent_class)->finalize (object);
@@ -2649,10 +2644,34 @@ gbp_gdb_debugger_finalize (GObject *object)
 static void
 gbp_gdb_debugger_class_init (GbpGdbDebuggerClass *klass)
 {
+  static const struct {
+    const gchar           *reason;
+    IdeDebuggerStopReason  stop_reason;
+  } reasons[] = {
+    { "breakpoint-hit", IDE_DEBUGGER_STOP_BREAKPOINT_HIT },
+    { "exec", IDE_DEBUGGER_STOP_CATCH },
+    { "exited", IDE_DEBUGGER_STOP_EXITED },
+    { "exited-normally", IDE_DEBUGGER_STOP_EXITED_NORMALLY },
+    { "exited-signaled", IDE_DEBUGGER_STOP_EXITED_SIGNALED },
+    { "fork", IDE_DEBUGGER_STOP_CATCH },
+    { "function-finished", IDE_DEBUGGER_STOP_FUNCTION_FINISHED },
+    { "location-reached", IDE_DEBUGGER_STOP_LOCATION_REACHED },
+    { "signal-received", IDE_DEBUGGER_STOP_SIGNAL_RECEIVED },
+    { "solib-event", IDE_DEBUGGER_STOP_CATCH },
+    { "syscall-entry", IDE_DEBUGGER_STOP_CATCH },
+    { "syscall-return", IDE_DEBUGGER_STOP_CATCH },
+    { "vfork", IDE_DEBUGGER_STOP_CATCH },
+  };
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   IdeObjectClass *ide_object_class = IDE_OBJECT_CLASS (klass);
   IdeDebuggerClass *debugger_class = IDE_DEBUGGER_CLASS (klass);
 
+  stop_reasons = g_hash_table_new (g_str_hash, g_str_equal);
+  for (guint i = 0; i < G_N_ELEMENTS (reasons); i++)
+    g_hash_table_insert (stop_reasons,
+                         (gpointer)reasons[i].reason,
+                         GINT_TO_POINTER (reasons[i].stop_reason));
+
   object_class->finalize = gbp_gdb_debugger_finalize;
 
   ide_object_class->destroy = gbp_gdb_debugger_destroy;
@@ -2700,6 +2719,7 @@ gbp_gdb_debugger_init (GbpGdbDebugger *self)
   self->read_buffer = g_malloc (READ_BUFFER_LEN);
 
   g_queue_init (&self->cmdqueue);
+  self->cmdlinks = g_hash_table_new (NULL, NULL);
 }
 
 GbpGdbDebugger *
@@ -2943,6 +2963,9 @@ gbp_gdb_debugger_exec_async (GbpGdbDebugger      *self,
        * on the GInputStream and decoded via gdbwire.
        */
       g_queue_push_tail (&self->cmdqueue, g_object_ref (task));
+      g_hash_table_insert (self->cmdlinks,
+                           GUINT_TO_POINTER (id),
+                           g_queue_peek_tail_link (&self->cmdqueue));
     }
   else
     {
@@ -350,16 +350,16 @@ gdbwire_string_increase_capacity(struct gdbwire_string *string)
 {
     /**
      * The algorithm chosen to increase the capacity is arbitrary.
-     * It starts at 128 bytes. It then doubles it's size in bytes like this,
-     *   128, 256, 512, 1024, 2048, 4096
-     * After it reaches 4096 it then grows by 4096 bytes at a time.
+     * It starts at 128 bytes and then doubles it's size in bytes.
+     *
+     * Growing geometrically keeps appends amortized O(1) even for the
+     * very long records gdb produces for large stack frames or
+     * variable listings.
      */
     if (string->capacity == 0) {
         string->capacity = 128;
-    } else if (string->capacity < 4096) {
-        string->capacity *= 2;
     } else {
-        string->capacity += 4096;
+        string->capacity *= 2;
     }
 
     /* At this point string->capacity is set to the new size, so realloc */
@@ -399,17 +399,19 @@ gdbwire_string_append_data(struct gdbwire_string *string, const char *data,
         size_t size)
 {
     int result = (string && data) ? 0 : -1;
-    size_t data_index = 0;
 
-    for (; string && data && data_index < size; ++data_index, ++string->size) {
-        if (string->size >= string->capacity) {
+    if (result == 0) {
+        while (string->size + size > string->capacity) {
             result = gdbwire_string_increase_capacity(string);
             if (result == -1) {
-                break;
+                return result;
             }
         }
 
-        string->data[string->size] = data[data_index];
+        if (size > 0) {
+            memcpy(string->data + string->size, data, size);
+            string->size += size;
+        }
     }
 
     return result;
@@ -490,12 +492,8 @@ gdbwire_string_erase(struct gdbwire_string *string, size_t pos, size_t count)
             /* If so, move characters from the from position
                to the to position */
             } else {
-                char *to_cur = &data[pos], *from_cur = &data[from_pos];
-
                 /* shift everything after the erase request to the left */
-                for (; from_pos < data_size; ++from_pos, ++to_cur, ++from_cur) {
-                    *to_cur = *from_cur;
-                }
+                memmove(&data[pos], &data[from_pos], data_size - from_pos);
             }
             string->size -= count_erased;
             result = 0;
@@ -1891,8 +1889,13 @@ gdbwire_mi_parser_parse_line(struct gdbwire_mi_parser *parser,
  *
  * @param buffer
  * The entire buffer the user has pushed onto the gdbwire_mi parser
- * through gdbwire_mi_parser_push. If a line is found, the returned line
- * will be removed from this buffer.
+ * through gdbwire_mi_parser_push.
+ *
+ * @param offset
+ * The position in buffer to start searching from. If a line is found,
+ * this is advanced past the end of the line. The line is not removed
+ * from the buffer so that the caller may erase all of the consumed
+ * lines at once rather than shifting the buffer once per line.
  *
  * @param line
  * Will return as an allocated line if a line is available or NULL
@@ -1905,52 +1908,58 @@ gdbwire_mi_parser_parse_line(struct gdbwire_mi_parser *parser,
  */
 static enum gdbwire_result
 gdbwire_mi_parser_get_next_line(struct gdbwire_string *buffer,
-        struct gdbwire_string **line)
+        size_t *offset, struct gdbwire_string **line)
 {
     enum gdbwire_result result = GDBWIRE_OK;
 
-    GDBWIRE_ASSERT(buffer && line);
+    GDBWIRE_ASSERT(buffer && offset && line);
 
     char *data = gdbwire_string_data(buffer);
     size_t size = gdbwire_string_size(buffer);
-    size_t pos = gdbwire_string_find_first_of(buffer, "\r\n");
+    size_t begin = *offset;
+    size_t pos;
+
+    *line = 0;
 
     /**
      * Search to see if a newline has been reached in gdb/mi.
      * If a line of data has been recieved, process it.
      */
+    for (pos = begin; pos < size; ++pos) {
+        if (data[pos] == '\n' || data[pos] == '\r') {
+            break;
+        }
+    }
+
     if (pos != size) {
         int status;
 
         /**
-         * We have the position of the newline character from
-         * gdbwire_string_find_first_of. However, the length must be
-         * calculated to make a copy of the line.
+         * The length must be calculated to make a copy of the line.
          *
          * This is either pos + 1 (for \r or \n) or pos + 1 + 1 for (\r\n).
          * Check for\r\n for the special case.
          */
-        size_t line_length = (data[pos] == '\r' && (pos + 1 < size) &&
+        size_t end = (data[pos] == '\r' && (pos + 1 < size) &&
                 data[pos + 1] == '\n') ? pos + 2 : pos + 1;
 
         /**
          * - allocate the buffer
          * - append the new line
          * - append a null terminating character
-         * - if successful, delete the new line found from buffer
+         * - if successful, advance past the line in buffer
          * - any failures cleanup and return an error
          */
         *line = gdbwire_string_create();
         GDBWIRE_ASSERT(*line);
 
-        status = gdbwire_string_append_data(*line, data, line_length);
+        status = gdbwire_string_append_data(*line, data + begin, end - begin);
         GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
 
         status = gdbwire_string_append_data(*line, "\0", 1);
         GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
 
-        status = gdbwire_string_erase(buffer, 0, line_length);
-        GDBWIRE_ASSERT_GOTO(status == 0, result, cleanup);
+        *offset = end;
     }
 
     return result;
@@ -1975,6 +1984,7 @@ gdbwire_mi_parser_push_data(struct gdbwire_mi_parser *parser, const char *data,
     struct gdbwire_string *line = 0;
     enum gdbwire_result result = GDBWIRE_OK;
     int has_newline = 0;
+    size_t consumed = 0;
     size_t index;
 
     GDBWIRE_ASSERT(parser && data);
@@ -1998,8 +2008,15 @@ gdbwire_mi_parser_push_data(struct gdbwire_mi_parser *parser, const char *data,
     GDBWIRE_ASSERT(gdbwire_string_append_data(parser->buffer, data, size) == 0);
 
     if (has_newline) {
+        /**
+         * Each complete line is handed to the callback as soon as it has
+         * been parsed. The consumed lines are erased from the buffer once
+         * after the loop so that a chunk containing many records does not
+         * shift the remaining data for every record.
+         */
         for (;;) {
-            result = gdbwire_mi_parser_get_next_line(parser->buffer, &line);
+            result = gdbwire_mi_parser_get_next_line(parser->buffer,
+                &consumed, &line);
             GDBWIRE_ASSERT_GOTO(result == GDBWIRE_OK, result, cleanup);
 
             if (line) {
@@ -2015,6 +2032,10 @@ gdbwire_mi_parser_push_data(struct gdbwire_mi_parser *parser, const char *data,
     }
 
 cleanup:
+    if (consumed > 0) {
+        gdbwire_string_erase(parser->buffer, 0, consumed);
+    }
+
     return result;
 }
 /***** End of gdbwire_mi_parser.c ********************************************/
@@ -5753,6 +5774,98 @@ void gdbwire_mi_error(yyscan_t yyscanner,
     (*gdbwire_mi_output)->variant.error.pos = pos;
 }
 
+/**
+ * An entry in one of the open addressed tables used to map the name of
+ * a result or async class to its enumeration.
+ *
+ * The tables are generated offline from the FNV-1a hash of each name so
+ * that they need no initialization. Empty slots have a NULL name.
+ */
+struct gdbwire_mi_class_entry {
+    const char *name;
+    unsigned int hash;
+    int value;
+};
+
+static const struct gdbwire_mi_class_entry gdbwire_mi_result_classes[16] = {
+    [0] = { "connected", 0x54eed4d0u, GDBWIRE_MI_CONNECTED },
+    [1] = { "done", 0x26f38071u, GDBWIRE_MI_DONE },
+    [2] = { "error", 0x21918751u, GDBWIRE_MI_ERROR },
+    [5] = { "exit", 0xcded1a85u, GDBWIRE_MI_EXIT },
+    [12] = { "running", 0x147eb74cu, GDBWIRE_MI_RUNNING },
+};
+
+static const struct gdbwire_mi_class_entry gdbwire_mi_async_classes[64] = {
+    [4] = { "thread-group-added", 0x2b12e144u, GDBWIRE_MI_ASYNC_THREAD_GROUP_ADDED },
+    [6] = { "breakpoint-modified", 0x234dd506u, GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED },
+    [7] = { "thread-group-exited", 0x584a81c7u, GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED },
+    [8] = { "memory-changed", 0x0d966787u, GDBWIRE_MI_ASYNC_MEMORY_CHANGED },
+    [12] = { "running", 0x147eb74cu, GDBWIRE_MI_ASYNC_RUNNING },
+    [13] = { "thread-created", 0xbcdc420cu, GDBWIRE_MI_ASYNC_THREAD_CREATED },
+    [14] = { "stopped", 0x6ee2f34eu, GDBWIRE_MI_ASYNC_STOPPED },
+    [15] = { "thread-group-started", 0x1894f34fu, GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED },
+    [16] = { "cmd-param-changed", 0x5a2eb5ceu, GDBWIRE_MI_ASYNC_CMD_PARAM_CHANGED },
+    [18] = { "traceframe-changed", 0x95c6cbd2u, GDBWIRE_MI_ASYNC_TRACEFRAME_CHANGED },
+    [19] = { "tsv-created", 0x6c231153u, GDBWIRE_MI_ASYNC_TSV_CREATED },
+    [20] = { "tsv-deleted", 0xa02a8712u, GDBWIRE_MI_ASYNC_TSV_DELETED },
+    [21] = { "thread-exited", 0xa9ebb255u, GDBWIRE_MI_ASYNC_THREAD_EXITED },
+    [23] = { "breakpoint-created", 0x44ba7217u, GDBWIRE_MI_ASYNC_BREAKPOINT_CREATED },
+    [24] = { "record-started", 0x30e694d8u, GDBWIRE_MI_ASYNC_RECORD_STARTED },
+    [26] = { "thread-group-removed", 0x62ef541au, GDBWIRE_MI_ASYNC_THREAD_GROUP_REMOVED },
+    [40] = { "record-stopped", 0x5898b9e8u, GDBWIRE_MI_ASYNC_RECORD_STOPPED },
+    [46] = { "breakpoint-deleted", 0xe0e0df2eu, GDBWIRE_MI_ASYNC_BREAKPOINT_DELETED },
+    [53] = { "library-unloaded", 0x8c998875u, GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED },
+    [57] = { "download", 0x3108b3f9u, GDBWIRE_MI_ASYNC_DOWNLOAD },
+    [58] = { "tsv-modified", 0xe61b9c3au, GDBWIRE_MI_ASYNC_TSV_MODIFIED },
+    [61] = { "thread-selected", 0x0783d2bdu, GDBWIRE_MI_ASYNC_THREAD_SELECTED },
+    [62] = { "library-loaded", 0x3471343eu, GDBWIRE_MI_ASYNC_LIBRARY_LOADED },
+};
+
+static unsigned int gdbwire_mi_class_hash(const char *str)
+{
+    unsigned int hash = 0x811c9dc5u;
+
+    for (; *str; ++str) {
+        hash ^= (unsigned char)*str;
+        hash *= 0x01000193u;
+    }
+
+    return hash;
+}
+
+/**
+ * Look up the enumeration value of a result or async class name.
+ *
+ * @param table
+ * One of the class tables above.
+ *
+ * @param size
+ * The number of slots in table, a power of two.
+ *
+ * @param text
+ * The class name as found in the MI output.
+ *
+ * @param fallback
+ * The value to return when text is not a known class.
+ *
+ * @return
+ * The matching enumeration value or fallback.
+ */
+static int gdbwire_mi_class_lookup(const struct gdbwire_mi_class_entry *table,
+        unsigned int size, const char *text, int fallback)
+{
+    unsigned int hash = gdbwire_mi_class_hash(text);
+    unsigned int i;
+
+    for (i = hash & (size - 1); table[i].name; i = (i + 1) & (size - 1)) {
+        if (table[i].hash == hash && strcmp(table[i].name, text) == 0) {
+            return table[i].value;
+        }
+    }
+
+    return fallback;
+}
+
 /**
  * GDB/MI escapes characters in the c-string rule.
  *
@@ -7264,74 +7377,20 @@ yyreduce:
   case 19: /* result_class: STRING_LITERAL  */
                              {
   char *text = gdbwire_mi_get_text(yyscanner);
-  if (strcmp("done", text) == 0) {
-    (yyval.u_result_class) = GDBWIRE_MI_DONE;
-  } else if (strcmp("running", text) == 0) {
-    (yyval.u_result_class) = GDBWIRE_MI_RUNNING;
-  } else if (strcmp("connected", text) == 0) {
-    (yyval.u_result_class) = GDBWIRE_MI_CONNECTED;
-  } else if (strcmp("error", text) == 0) {
-    (yyval.u_result_class) = GDBWIRE_MI_ERROR;
-  } else if (strcmp("exit", text) == 0) {
-    (yyval.u_result_class) = GDBWIRE_MI_EXIT;
-  } else {
-    (yyval.u_result_class) = GDBWIRE_MI_UNSUPPORTED;
-  }
+  (yyval.u_result_class) = gdbwire_mi_class_lookup(
+      gdbwire_mi_result_classes,
+      sizeof gdbwire_mi_result_classes / sizeof gdbwire_mi_result_classes[0],
+      text, GDBWIRE_MI_UNSUPPORTED);
 }
     break;
 
   case 20: /* async_class: STRING_LITERAL  */
                             {
   char *text = gdbwire_mi_get_text(yyscanner);
-  if (strcmp("download", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_DOWNLOAD;
-  } else if (strcmp("stopped", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_STOPPED;
-  } else if (strcmp("running", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_RUNNING;
-  } else if (strcmp("thread-group-added", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_GROUP_ADDED;
-  } else if (strcmp("thread-group-removed", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_GROUP_REMOVED;
-  } else if (strcmp("thread-group-started", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED;
-  } else if (strcmp("thread-group-exited", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED;
-  } else if (strcmp("thread-created", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_CREATED;
-  } else if (strcmp("thread-exited", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_EXITED;
-  } else if (strcmp("thread-selected", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_THREAD_SELECTED;
-  } else if (strcmp("library-loaded", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_LIBRARY_LOADED;
-  } else if (strcmp("library-unloaded", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED;
-  } else if (strcmp("traceframe-changed", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_TRACEFRAME_CHANGED;
-  } else if (strcmp("tsv-created", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_TSV_CREATED;
-  } else if (strcmp("tsv-modified", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_TSV_MODIFIED;
-  } else if (strcmp("tsv-deleted", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_TSV_DELETED;
-  } else if (strcmp("breakpoint-created", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_BREAKPOINT_CREATED;
-  } else if (strcmp("breakpoint-modified", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED;
-  } else if (strcmp("breakpoint-deleted", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_BREAKPOINT_DELETED;
-  } else if (strcmp("record-started", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_RECORD_STARTED;
-  } else if (strcmp("record-stopped", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_RECORD_STOPPED;
-  } else if (strcmp("cmd-param-changed", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_CMD_PARAM_CHANGED;
-  } else if (strcmp("memory-changed", text) == 0) {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_MEMORY_CHANGED;
-  } else {
-      (yyval.u_async_class) = GDBWIRE_MI_ASYNC_UNSUPPORTED;
-  }
+  (yyval.u_async_class) = gdbwire_mi_class_lookup(
+      gdbwire_mi_async_classes,
+      sizeof gdbwire_mi_async_classes / sizeof gdbwire_mi_async_classes[0],
+      text, GDBWIRE_MI_ASYNC_UNSUPPORTED);
 }
     break;
 
@@ -270,6 +270,37 @@ ipc_git_repository_impl_handle_path_is_ignored (IpcGitRepository      *repositor
   return TRUE;
 }
 
+static gboolean
+ipc_git_repository_impl_handle_get_head_commit (IpcGitRepository      *repository,
+                                                GDBusMethodInvocation *invocation)
+{
+  IpcGitRepositoryImpl *self = (IpcGitRepositoryImpl *)repository;
+  g_autoptr(GgitRef) head = NULL;
+  g_autoptr(GgitOId) oid = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *commit_id = NULL;
+
+  g_assert (IPC_IS_GIT_REPOSITORY_IMPL (self));
+  g_assert (G_IS_DBUS_METHOD_INVOCATION (invocation));
+
+  if (!(head = ggit_repository_get_head (self->repository, &error)))
+    return complete_wrapped_error (invocation, error);
+
+  if (!(oid = ggit_ref_get_target (head)))
+    {
+      g_dbus_method_invocation_return_error_literal (invocation,
+                                                     G_IO_ERROR,
+                                                     G_IO_ERROR_NOT_FOUND,
+                                                     "HEAD does not point to a commit");
+      return TRUE;
+    }
+
+  commit_id = ggit_oid_to_string (oid);
+  ipc_git_repository_complete_get_head_commit (repository, invocation, commit_id);
+
+  return TRUE;
+}
+
 static gint
 compare_refs (gconstpointer a,
               gconstpointer b)
@@ -1079,6 +1110,7 @@ git_repository_iface_init (IpcGitRepositoryIface *iface)
   iface->handle_close = ipc_git_repository_impl_handle_close;
   iface->handle_commit = ipc_git_repository_impl_handle_commit;
   iface->handle_create_change_monitor = ipc_git_repository_impl_handle_create_change_monitor;
+  iface->handle_get_head_commit = ipc_git_repository_impl_handle_get_head_commit;
   iface->handle_list_refs_by_kind = ipc_git_repository_impl_handle_list_refs_by_kind;
   iface->handle_list_status = ipc_git_repository_impl_handle_list_status;
   iface->handle_load_config = ipc_git_repository_impl_handle_load_config;
@@ -54,6 +54,7 @@ gbp_git_pipeline_addin_load (IdePipelineAddin *addin,
     return;
 
   submodule = gbp_git_submodule_stage_new (context);
+  ide_pipeline_stage_set_concurrent (IDE_PIPELINE_STAGE (submodule), TRUE);
   stage_id = ide_pipeline_attach (pipeline,
                                   IDE_PIPELINE_PHASE_PREPARE | IDE_PIPELINE_PHASE_AFTER,
                                   100,
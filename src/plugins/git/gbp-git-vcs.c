@@ -554,6 +554,63 @@ gbp_git_vcs_list_status_finish (IdeVcs        *vcs,
   return ide_task_propagate_object (IDE_TASK (result), error);
 }
 
+static void
+gbp_git_vcs_get_head_commit_cb (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  IpcGitRepository *repository = (IpcGitRepository *)object;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *commit_id = NULL;
+
+  g_assert (IPC_IS_GIT_REPOSITORY (repository));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (IDE_IS_TASK (task));
+
+  if (!ipc_git_repository_call_get_head_commit_finish (repository, &commit_id, result, &error))
+    {
+      g_dbus_error_strip_remote_error (error);
+      ide_task_return_error (task, g_steal_pointer (&error));
+    }
+  else
+    ide_task_return_pointer (task, g_steal_pointer (&commit_id), g_free);
+}
+
+static void
+gbp_git_vcs_get_head_commit_async (IdeVcs              *vcs,
+                                   GCancellable        *cancellable,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  GbpGitVcs *self = (GbpGitVcs *)vcs;
+  g_autoptr(IdeTask) task = NULL;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_GIT_VCS (self));
+  g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_git_vcs_get_head_commit_async);
+
+  ipc_git_repository_call_get_head_commit (self->repository,
+                                           cancellable,
+                                           gbp_git_vcs_get_head_commit_cb,
+                                           g_steal_pointer (&task));
+}
+
+static char *
+gbp_git_vcs_get_head_commit_finish (IdeVcs        *vcs,
+                                    GAsyncResult  *result,
+                                    GError       **error)
+{
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_GIT_VCS (vcs));
+  g_assert (IDE_IS_TASK (result));
+
+  return ide_task_propagate_pointer (IDE_TASK (result), error);
+}
+
 static char *
 gbp_git_vcs_get_display_name (IdeVcs *vcs)
 {
@@ -578,6 +635,8 @@ vcs_iface_init (IdeVcsInterface *iface)
   iface->list_tags_finish = gbp_git_vcs_list_tags_finish;
   iface->list_status_async = gbp_git_vcs_list_status_async;
   iface->list_status_finish = gbp_git_vcs_list_status_finish;
+  iface->get_head_commit_async = gbp_git_vcs_get_head_commit_async;
+  iface->get_head_commit_finish = gbp_git_vcs_get_head_commit_finish;
 }
 
 G_DEFINE_FINAL_TYPE_WITH_CODE (GbpGitVcs, gbp_git_vcs, IDE_TYPE_OBJECT,
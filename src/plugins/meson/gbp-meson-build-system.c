@@ -533,6 +533,16 @@ gbp_meson_build_system_get_build_flags_for_files_cb (GObject      *object,
       g_hash_table_insert (ret, g_object_ref (file), g_steal_pointer (&flags));
     }
 
+#ifdef IDE_ENABLE_TRACE
+  {
+    guint n_hits, n_misses, n_unique;
+
+    ide_compile_commands_get_stats (compile_commands, &n_hits, &n_misses, &n_unique);
+    IDE_TRACE_MSG ("Resolved flags for %u files: %u hits, %u misses, %u unique",
+                   files->len, n_hits, n_misses, n_unique);
+  }
+#endif
+
   ide_task_return_pointer (task, g_steal_pointer (&ret), g_hash_table_unref);
 }
 
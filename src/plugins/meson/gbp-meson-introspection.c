@@ -23,6 +23,7 @@
 #include "config.h"
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <json-glib/json-glib.h>
 
 #include <libide-core.h>
@@ -30,6 +31,7 @@
 #include <libide-threading.h>
 
 #include "gbp-meson-build-system.h"
+#include "gbp-meson-build-target.h"
 #include "gbp-meson-introspection.h"
 
 struct _GbpMesonIntrospection
@@ -42,6 +44,9 @@ struct _GbpMesonIntrospection
 
   GListStore *run_commands;
 
+  /* Array of MesonTarget, used to create build targets on request */
+  GPtrArray *targets;
+
   char *descriptive_name;
   char *subproject_dir;
   char *version;
@@ -50,6 +55,39 @@ struct _GbpMesonIntrospection
   guint has_built_once : 1;
 };
 
+typedef struct
+{
+  char            *name;
+  char            *filename;
+  IdeArtifactKind  kind;
+} MesonTarget;
+
+/* Introspection results, filled on a worker thread (or from the output of
+ * `meson introspect`) and then moved into the stage on the main thread.
+ */
+typedef struct
+{
+  char      *builddir;
+  char      *etag;
+  GPtrArray *run_commands;
+  GPtrArray *targets;
+  char      *descriptive_name;
+  char      *subproject_dir;
+  char      *version;
+} Load;
+
+/* Names match both the members of `meson introspect --all` and the
+ * meson-info/intro-<name>.json files.
+ */
+static const char *intro_files[] = {
+  "buildoptions",
+  "projectinfo",
+  "tests",
+  "benchmarks",
+  "installed",
+  "targets",
+};
+
 G_DEFINE_FINAL_TYPE (GbpMesonIntrospection, gbp_meson_introspection, IDE_TYPE_PIPELINE_STAGE)
 
 static gboolean
@@ -183,36 +221,72 @@ get_environ_member (JsonObject   *object,
 }
 
 static void
-gbp_meson_introspection_load_buildoptions (GbpMesonIntrospection *self,
-                                           JsonArray             *buildoptions)
+meson_target_free (MesonTarget *target)
+{
+  g_clear_pointer (&target->name, g_free);
+  g_clear_pointer (&target->filename, g_free);
+  g_slice_free (MesonTarget, target);
+}
+
+static void
+load_free (Load *load)
+{
+  g_clear_pointer (&load->builddir, g_free);
+  g_clear_pointer (&load->etag, g_free);
+  g_clear_pointer (&load->run_commands, g_ptr_array_unref);
+  g_clear_pointer (&load->targets, g_ptr_array_unref);
+  g_clear_pointer (&load->descriptive_name, g_free);
+  g_clear_pointer (&load->subproject_dir, g_free);
+  g_clear_pointer (&load->version, g_free);
+  g_slice_free (Load, load);
+}
+
+static Load *
+load_new (IdePipeline *pipeline,
+          const char  *etag)
+{
+  Load *load;
+
+  load = g_slice_new0 (Load);
+  load->builddir = g_strdup (ide_pipeline_get_builddir (pipeline));
+  load->etag = g_strdup (etag);
+  load->run_commands = g_ptr_array_new_with_free_func (g_object_unref);
+  load->targets = g_ptr_array_new_with_free_func ((GDestroyNotify)meson_target_free);
+
+  return load;
+}
+
+static void
+gbp_meson_introspection_load_buildoptions (Load      *load,
+                                           JsonArray *buildoptions)
 {
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (buildoptions != NULL);
 
   IDE_EXIT;
 }
 
 static void
-gbp_meson_introspection_load_projectinfo (GbpMesonIntrospection *self,
-                                          JsonObject            *projectinfo)
+gbp_meson_introspection_load_projectinfo (Load       *load,
+                                          JsonObject *projectinfo)
 {
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (projectinfo != NULL);
 
-  get_string_member (projectinfo, "version", &self->version);
-  get_string_member (projectinfo, "descriptive_name", &self->descriptive_name);
-  get_string_member (projectinfo, "subproject_dir", &self->subproject_dir);
+  get_string_member (projectinfo, "version", &load->version);
+  get_string_member (projectinfo, "descriptive_name", &load->descriptive_name);
+  get_string_member (projectinfo, "subproject_dir", &load->subproject_dir);
 
   IDE_EXIT;
 }
 
 static void
-gbp_meson_introspection_load_test (GbpMesonIntrospection *self,
-                                   JsonObject            *test)
+gbp_meson_introspection_load_test (Load       *load,
+                                   JsonObject *test)
 {
   g_autoptr(IdeRunCommand) run_command = NULL;
   g_auto(GStrv) cmd = NULL;
@@ -221,12 +295,17 @@ gbp_meson_introspection_load_test (GbpMesonIntrospection *self,
   g_autofree char *name = NULL;
   g_autofree char *workdir = NULL;
   g_autofree char *id = NULL;
+  gboolean is_parallel;
 
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (test != NULL);
 
+  /* Tests are parallel unless declared otherwise */
+  if (!get_bool_member (test, "is_parallel", &is_parallel))
+    is_parallel = TRUE;
+
   get_strv_member (test, "cmd", &cmd);
   get_strv_member (test, "suite", &suite);
   get_environ_member (test, "env", &env);
@@ -243,21 +322,22 @@ gbp_meson_introspection_load_test (GbpMesonIntrospection *self,
   ide_run_command_set_argv (run_command, (const char * const *)cmd);
   ide_run_command_set_cwd (run_command, workdir);
   ide_run_command_set_can_default (run_command, FALSE);
+  ide_run_command_set_can_parallelize (run_command, is_parallel);
 
-  g_list_store_append (self->run_commands, run_command);
+  g_ptr_array_add (load->run_commands, g_steal_pointer (&run_command));
 
   IDE_EXIT;
 }
 
 static void
-gbp_meson_introspection_load_tests (GbpMesonIntrospection *self,
-                                    JsonArray             *tests)
+gbp_meson_introspection_load_tests (Load      *load,
+                                    JsonArray *tests)
 {
   guint n_items;
 
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (tests != NULL);
 
   n_items = json_array_get_length (tests);
@@ -270,33 +350,33 @@ gbp_meson_introspection_load_tests (GbpMesonIntrospection *self,
       if (node != NULL &&
           JSON_NODE_HOLDS_OBJECT (node) &&
           (obj = json_node_get_object (node)))
-        gbp_meson_introspection_load_test (self, obj);
+        gbp_meson_introspection_load_test (load, obj);
     }
 
   IDE_EXIT;
 }
 
 static void
-gbp_meson_introspection_load_benchmarks (GbpMesonIntrospection *self,
-                                         JsonArray             *benchmarks)
+gbp_meson_introspection_load_benchmarks (Load      *load,
+                                         JsonArray *benchmarks)
 {
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (benchmarks != NULL);
 
   IDE_EXIT;
 }
 
 static void
-gbp_meson_introspection_load_targets (GbpMesonIntrospection *self,
-                                      JsonArray             *targets)
+gbp_meson_introspection_load_targets (Load      *load,
+                                      JsonArray *targets)
 {
   guint length;
 
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (targets != NULL);
 
   length = json_array_get_length (targets);
@@ -307,6 +387,8 @@ gbp_meson_introspection_load_targets (GbpMesonIntrospection *self,
       g_autofree char *id = NULL;
       g_autofree char *name = NULL;
       g_autofree char *type = NULL;
+      g_auto(GStrv) filename = NULL;
+      IdeArtifactKind kind = 0;
       JsonObject *obj;
 
       if (!JSON_NODE_HOLDS_OBJECT (node) || !(obj = json_node_get_object (node)))
@@ -315,13 +397,33 @@ gbp_meson_introspection_load_targets (GbpMesonIntrospection *self,
       get_string_member (obj, "id", &id);
       get_string_member (obj, "name", &name);
       get_string_member (obj, "type", &type);
+      get_strv_member (obj, "filename", &filename);
+
+      if (ide_str_equal0 (type, "executable"))
+        kind = IDE_ARTIFACT_KIND_EXECUTABLE;
+      else if (ide_str_equal0 (type, "static library"))
+        kind = IDE_ARTIFACT_KIND_STATIC_LIBRARY;
+      else if (ide_str_equal0 (type, "shared library"))
+        kind = IDE_ARTIFACT_KIND_SHARED_LIBRARY;
+
+      /* Other target types (custom, shared module, jar, run) are listed
+       * too, with no particular artifact kind.
+       */
+      if (name != NULL && type != NULL && !ide_str_empty0 (filename))
+        {
+          MesonTarget *target = g_slice_new0 (MesonTarget);
+
+          target->name = g_strdup (name);
+          target->filename = g_strdup (filename[0]);
+          target->kind = kind;
+
+          g_ptr_array_add (load->targets, target);
+        }
 
       if (ide_str_equal0 (type, "executable") || ide_str_equal0 (type, "custom"))
         {
-          g_auto(GStrv) filename = NULL;
           gboolean installed = FALSE;
 
-          get_strv_member (obj, "filename", &filename);
           get_bool_member (obj, "installed", &installed);
 
           if (!ide_str_empty0 (filename))
@@ -362,7 +464,7 @@ gbp_meson_introspection_load_targets (GbpMesonIntrospection *self,
               else
                 ide_run_command_set_priority (run_command, 1000);
 
-              g_list_store_append (self->run_commands, run_command);
+              g_ptr_array_add (load->run_commands, g_steal_pointer (&run_command));
             }
         }
     }
@@ -371,26 +473,107 @@ gbp_meson_introspection_load_targets (GbpMesonIntrospection *self,
 }
 
 static void
-gbp_meson_introspection_load_installed (GbpMesonIntrospection *self,
-                                        JsonObject            *installed)
+gbp_meson_introspection_load_installed (Load       *load,
+                                        JsonObject *installed)
 {
   IDE_ENTRY;
 
-  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (load != NULL);
   g_assert (installed != NULL);
 
   IDE_EXIT;
 }
 
+static void
+gbp_meson_introspection_load_member (Load       *load,
+                                     const char *name,
+                                     JsonNode   *member)
+{
+  g_assert (load != NULL);
+  g_assert (name != NULL);
+
+  if (member == NULL)
+    return;
+
+  if (ide_str_equal0 (name, "buildoptions") && JSON_NODE_HOLDS_ARRAY (member))
+    gbp_meson_introspection_load_buildoptions (load, json_node_get_array (member));
+  else if (ide_str_equal0 (name, "projectinfo") && JSON_NODE_HOLDS_OBJECT (member))
+    gbp_meson_introspection_load_projectinfo (load, json_node_get_object (member));
+  else if (ide_str_equal0 (name, "tests") && JSON_NODE_HOLDS_ARRAY (member))
+    gbp_meson_introspection_load_tests (load, json_node_get_array (member));
+  else if (ide_str_equal0 (name, "benchmarks") && JSON_NODE_HOLDS_ARRAY (member))
+    gbp_meson_introspection_load_benchmarks (load, json_node_get_array (member));
+  else if (ide_str_equal0 (name, "installed") && JSON_NODE_HOLDS_OBJECT (member))
+    gbp_meson_introspection_load_installed (load, json_node_get_object (member));
+  else if (ide_str_equal0 (name, "targets") && JSON_NODE_HOLDS_ARRAY (member))
+    gbp_meson_introspection_load_targets (load, json_node_get_array (member));
+}
+
+static void
+gbp_meson_introspection_load_json (Load       *load,
+                                   JsonObject *root)
+{
+  IDE_ENTRY;
+
+  g_assert (load != NULL);
+  g_assert (root != NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (intro_files); i++)
+    {
+      if (json_object_has_member (root, intro_files[i]))
+        gbp_meson_introspection_load_member (load,
+                                             intro_files[i],
+                                             json_object_get_member (root, intro_files[i]));
+    }
+
+  IDE_EXIT;
+}
+
+static char *
+intro_file_path (const char *builddir,
+                 const char *name)
+{
+  g_autofree char *basename = g_strdup_printf ("intro-%s.json", name);
+
+  return g_build_filename (builddir, "meson-info", basename, NULL);
+}
+
+/*
+ * Meson writes each intro-*.json file in meson-info/ whenever the project
+ * is (re)configured, so their modification times and sizes tell us if our
+ * cached introspection is still valid. Older versions of meson do not
+ * write meson-info/ and we fall back to build.ninja.
+ */
 static char *
 get_current_etag (IdePipeline *pipeline)
 {
   g_autofree char *build_dot_ninja = NULL;
   g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(GString) str = NULL;
   g_autoptr(GFile) file = NULL;
+  const char *builddir;
 
   g_assert (IDE_IS_PIPELINE (pipeline));
 
+  builddir = ide_pipeline_get_builddir (pipeline);
+  str = g_string_new (NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (intro_files); i++)
+    {
+      g_autofree char *path = intro_file_path (builddir, intro_files[i]);
+      GStatBuf st;
+
+      if (g_stat (path, &st) == 0)
+        g_string_append_printf (str,
+                                "%s:%"G_GINT64_FORMAT":%"G_GINT64_FORMAT";",
+                                intro_files[i],
+                                (gint64)st.st_mtime,
+                                (gint64)st.st_size);
+    }
+
+  if (str->len > 0)
+    return g_string_free (g_steal_pointer (&str), FALSE);
+
   build_dot_ninja = ide_pipeline_build_builddir_path (pipeline, "build.ninja", NULL);
   file = g_file_new_for_path (build_dot_ninja);
   info = g_file_query_info (file,
@@ -424,46 +607,106 @@ gbp_meson_introspection_query (IdePipelineStage *stage,
 }
 
 static void
-gbp_meson_introspection_load_json (GbpMesonIntrospection *self,
-                                   JsonObject            *root)
+gbp_meson_introspection_apply (GbpMesonIntrospection *self,
+                               Load                  *load)
 {
-  JsonNode *member;
-
   IDE_ENTRY;
 
   g_assert (IDE_IS_MAIN_THREAD ());
   g_assert (GBP_IS_MESON_INTROSPECTION (self));
-  g_assert (root != NULL);
+  g_assert (load != NULL);
 
-  if (json_object_has_member (root, "buildoptions") &&
-      (member = json_object_get_member (root, "buildoptions")) &&
-      JSON_NODE_HOLDS_ARRAY (member))
-    gbp_meson_introspection_load_buildoptions (self, json_node_get_array (member));
+  /* Replace all of our previously loaded state */
+  g_set_str (&self->etag, load->etag);
 
-  if (json_object_has_member (root, "projectinfo") &&
-      (member = json_object_get_member (root, "projectinfo")) &&
-      JSON_NODE_HOLDS_OBJECT (member))
-    gbp_meson_introspection_load_projectinfo (self, json_node_get_object (member));
+  g_clear_pointer (&self->descriptive_name, g_free);
+  g_clear_pointer (&self->subproject_dir, g_free);
+  g_clear_pointer (&self->version, g_free);
+  g_clear_pointer (&self->targets, g_ptr_array_unref);
 
-  if (json_object_has_member (root, "tests") &&
-      (member = json_object_get_member (root, "tests")) &&
-      JSON_NODE_HOLDS_ARRAY (member))
-    gbp_meson_introspection_load_tests (self, json_node_get_array (member));
+  self->descriptive_name = g_steal_pointer (&load->descriptive_name);
+  self->subproject_dir = g_steal_pointer (&load->subproject_dir);
+  self->version = g_steal_pointer (&load->version);
+  self->targets = g_steal_pointer (&load->targets);
 
-  if (json_object_has_member (root, "benchmarks") &&
-      (member = json_object_get_member (root, "benchmarks")) &&
-      JSON_NODE_HOLDS_ARRAY (member))
-    gbp_meson_introspection_load_benchmarks (self, json_node_get_array (member));
+  g_list_store_splice (self->run_commands,
+                       0,
+                       g_list_model_get_n_items (G_LIST_MODEL (self->run_commands)),
+                       load->run_commands->pdata,
+                       load->run_commands->len);
 
-  if (json_object_has_member (root, "installed") &&
-      (member = json_object_get_member (root, "installed")) &&
-      JSON_NODE_HOLDS_OBJECT (member))
-    gbp_meson_introspection_load_installed (self, json_node_get_object (member));
+  IDE_EXIT;
+}
+
+static void
+gbp_meson_introspection_load_worker (IdeTask      *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  Load *load = task_data;
+
+  IDE_ENTRY;
 
-  if (json_object_has_member (root, "targets") &&
-      (member = json_object_get_member (root, "targets")) &&
-      JSON_NODE_HOLDS_ARRAY (member))
-    gbp_meson_introspection_load_targets (self, json_node_get_array (member));
+  g_assert (IDE_IS_TASK (task));
+  g_assert (GBP_IS_MESON_INTROSPECTION (source_object));
+  g_assert (load != NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (intro_files); i++)
+    {
+      g_autofree char *path = intro_file_path (load->builddir, intro_files[i]);
+      g_autoptr(JsonParser) parser = NULL;
+      g_autoptr(GError) error = NULL;
+
+      if (ide_task_return_error_if_cancelled (task))
+        IDE_EXIT;
+
+      if (!g_file_test (path, G_FILE_TEST_IS_REGULAR))
+        continue;
+
+      parser = json_parser_new_immutable ();
+
+      if (!json_parser_load_from_file (parser, path, &error))
+        {
+          g_debug ("Failed to parse %s: %s", path, error->message);
+          continue;
+        }
+
+      gbp_meson_introspection_load_member (load,
+                                           intro_files[i],
+                                           json_parser_get_root (parser));
+    }
+
+  ide_task_return_boolean (task, TRUE);
+
+  IDE_EXIT;
+}
+
+static void
+gbp_meson_introspection_load_cb (GObject      *object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+  GbpMesonIntrospection *self = (GbpMesonIntrospection *)object;
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GError) error = NULL;
+
+  IDE_ENTRY;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (IDE_IS_TASK (result));
+  g_assert (IDE_IS_TASK (task));
+
+  if (!ide_task_propagate_boolean (IDE_TASK (result), &error))
+    {
+      ide_task_return_error (task, g_steal_pointer (&error));
+      IDE_EXIT;
+    }
+
+  gbp_meson_introspection_apply (self, ide_task_get_task_data (IDE_TASK (result)));
+
+  ide_task_return_boolean (task, TRUE);
 
   IDE_EXIT;
 }
@@ -477,9 +720,9 @@ gbp_meson_introspection_load_stream_cb (GObject      *object,
   GbpMesonIntrospection *self;
   g_autoptr(IdeTask) task = user_data;
   g_autoptr(GError) error = NULL;
-  const char *etag;
   JsonObject *obj;
   JsonNode *root;
+  Load *load;
 
   IDE_ENTRY;
 
@@ -495,19 +738,17 @@ gbp_meson_introspection_load_stream_cb (GObject      *object,
     }
 
   self = ide_task_get_source_object (task);
-  etag = ide_task_get_task_data (task);
+  load = ide_task_get_task_data (task);
 
   g_assert (GBP_IS_MESON_INTROSPECTION (self));
-  g_assert (etag != NULL);
-
-  /* Clear all of our previously loaded state */
-  g_set_str (&self->etag, etag);
-  g_list_store_remove_all (self->run_commands);
+  g_assert (load != NULL);
 
   if ((root = json_parser_get_root (parser)) &&
       JSON_NODE_HOLDS_OBJECT (root) &&
       (obj = json_node_get_object (root)))
-    gbp_meson_introspection_load_json (self, obj);
+    gbp_meson_introspection_load_json (load, obj);
+
+  gbp_meson_introspection_apply (self, load);
 
   ide_task_return_boolean (task, TRUE);
 
@@ -528,7 +769,9 @@ gbp_meson_introspection_build_async (IdePipelineStage    *stage,
   g_autoptr(GIOStream) io_stream = NULL;
   g_autoptr(IdeTask) task = NULL;
   g_autoptr(GError) error = NULL;
+  g_autofree char *targets_path = NULL;
   g_autofree char *meson = NULL;
+  g_autofree char *etag = NULL;
   IdeBuildSystem *build_system;
   IdeContext *context;
 
@@ -540,9 +783,29 @@ gbp_meson_introspection_build_async (IdePipelineStage    *stage,
 
   self->has_built_once = TRUE;
 
+  etag = get_current_etag (pipeline);
+
   task = ide_task_new (self, cancellable, callback, user_data);
   ide_task_set_source_tag (task, gbp_meson_introspection_build_async);
-  ide_task_set_task_data (task, get_current_etag (pipeline), g_free);
+
+  /* Read meson-info/ directly when available, which avoids spawning
+   * meson (and python) and lets us parse on a worker thread.
+   */
+  targets_path = intro_file_path (ide_pipeline_get_builddir (pipeline), "targets");
+
+  if (g_file_test (targets_path, G_FILE_TEST_IS_REGULAR))
+    {
+      g_autoptr(IdeTask) load_task = NULL;
+
+      load_task = ide_task_new (self, cancellable, gbp_meson_introspection_load_cb, g_steal_pointer (&task));
+      ide_task_set_source_tag (load_task, gbp_meson_introspection_load_worker);
+      ide_task_set_task_data (load_task, load_new (pipeline, etag), load_free);
+      ide_task_run_in_thread (load_task, gbp_meson_introspection_load_worker);
+
+      IDE_EXIT;
+    }
+
+  ide_task_set_task_data (task, load_new (pipeline, etag), load_free);
 
   context = ide_object_get_context (IDE_OBJECT (self));
   build_system = ide_build_system_from_context (context);
@@ -607,6 +870,7 @@ gbp_meson_introspection_destroy (IdeObject *object)
   GbpMesonIntrospection *self = (GbpMesonIntrospection *)object;
 
   g_clear_object (&self->run_commands);
+  g_clear_pointer (&self->targets, g_ptr_array_unref);
 
   g_clear_pointer (&self->descriptive_name, g_free);
   g_clear_pointer (&self->subproject_dir, g_free);
@@ -653,10 +917,68 @@ gbp_meson_introspection_new (IdePipeline *pipeline)
   return self;
 }
 
+static GPtrArray *
+gbp_meson_introspection_create_build_targets (GbpMesonIntrospection *self)
+{
+  g_autoptr(GPtrArray) ret = NULL;
+  g_autoptr(GFile) builddir = NULL;
+  IdeContext *context;
+
+  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+
+  ret = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (self->targets == NULL || self->pipeline == NULL)
+    return g_steal_pointer (&ret);
+
+  context = ide_object_get_context (IDE_OBJECT (self));
+  builddir = g_file_new_for_path (ide_pipeline_get_builddir (self->pipeline));
+
+  for (guint i = 0; i < self->targets->len; i++)
+    {
+      const MesonTarget *target = g_ptr_array_index (self->targets, i);
+      g_autofree char *base = NULL;
+      g_autofree char *dir_path = NULL;
+      g_autoptr(GFile) file = NULL;
+      g_autoptr(GFile) dir = NULL;
+
+      file = g_file_new_for_path (target->filename);
+      base = g_file_get_relative_path (builddir, file);
+      dir_path = g_path_get_dirname (target->filename);
+      dir = g_file_new_for_path (dir_path);
+
+      g_ptr_array_add (ret,
+                       gbp_meson_build_target_new (context,
+                                                   dir,
+                                                   base ? base : target->name,
+                                                   target->filename,
+                                                   target->kind));
+    }
+
+  return g_steal_pointer (&ret);
+}
+
+static void
+gbp_meson_introspection_complete (GbpMesonIntrospection *self,
+                                  IdeTask               *task)
+{
+  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (IDE_IS_TASK (task));
+
+  if (ide_task_get_source_tag (task) == gbp_meson_introspection_list_build_targets_async)
+    ide_task_return_pointer (task,
+                             gbp_meson_introspection_create_build_targets (self),
+                             g_ptr_array_unref);
+  else
+    ide_task_return_pointer (task,
+                             g_object_ref (self->run_commands),
+                             g_object_unref);
+}
+
 static void
-gbp_meson_introspection_list_run_commands_cb (GObject      *object,
-                                              GAsyncResult *result,
-                                              gpointer      user_data)
+gbp_meson_introspection_ensure_cb (GObject      *object,
+                                   GAsyncResult *result,
+                                   gpointer      user_data)
 {
   g_autoptr(IdeTask) task = user_data;
   GbpMesonIntrospection *self;
@@ -670,27 +992,28 @@ gbp_meson_introspection_list_run_commands_cb (GObject      *object,
   self = ide_task_get_source_object (task);
   g_assert (GBP_IS_MESON_INTROSPECTION (self));
 
-  ide_task_return_pointer (task, g_object_ref (self->run_commands), g_object_unref);
+  gbp_meson_introspection_complete (self, task);
 
   IDE_EXIT;
 }
 
-void
-gbp_meson_introspection_list_run_commands_async (GbpMesonIntrospection *self,
-                                                 GCancellable          *cancellable,
-                                                 GAsyncReadyCallback    callback,
-                                                 gpointer               user_data)
+/*
+ * Completes @task once introspection has been loaded at least once,
+ * running the stage (or configuring the project first) if necessary.
+ * Every consumer shares the same loaded results afterwards.
+ */
+static void
+gbp_meson_introspection_ensure (GbpMesonIntrospection *self,
+                                IdeTask               *task)
 {
-  g_autoptr(IdeTask) task = NULL;
+  GCancellable *cancellable;
 
   IDE_ENTRY;
 
-  g_return_if_fail (IDE_IS_MAIN_THREAD ());
-  g_return_if_fail (GBP_IS_MESON_INTROSPECTION (self));
-  g_return_if_fail (IDE_IS_PIPELINE (self->pipeline));
+  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (IDE_IS_TASK (task));
 
-  task = ide_task_new (self, cancellable, callback, user_data);
-  ide_task_set_source_tag (task, gbp_meson_introspection_list_run_commands_async);
+  cancellable = ide_task_get_cancellable (task);
 
   if (!self->has_built_once)
     {
@@ -703,19 +1026,41 @@ gbp_meson_introspection_list_run_commands_async (GbpMesonIntrospection *self,
         ide_pipeline_stage_build_async (IDE_PIPELINE_STAGE (self),
                                         self->pipeline,
                                         cancellable,
-                                        gbp_meson_introspection_list_run_commands_cb,
-                                        g_steal_pointer (&task));
+                                        gbp_meson_introspection_ensure_cb,
+                                        g_object_ref (task));
       else
         ide_pipeline_build_async (self->pipeline,
                                   IDE_PIPELINE_PHASE_CONFIGURE,
                                   cancellable,
-                                  gbp_meson_introspection_list_run_commands_cb,
-                                  g_steal_pointer (&task));
+                                  gbp_meson_introspection_ensure_cb,
+                                  g_object_ref (task));
 
       IDE_EXIT;
     }
 
-  ide_task_return_pointer (task, g_object_ref (self->run_commands), g_object_unref);
+  gbp_meson_introspection_complete (self, task);
+
+  IDE_EXIT;
+}
+
+void
+gbp_meson_introspection_list_run_commands_async (GbpMesonIntrospection *self,
+                                                 GCancellable          *cancellable,
+                                                 GAsyncReadyCallback    callback,
+                                                 gpointer               user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (GBP_IS_MESON_INTROSPECTION (self));
+  g_return_if_fail (IDE_IS_PIPELINE (self->pipeline));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_meson_introspection_list_run_commands_async);
+
+  gbp_meson_introspection_ensure (self, task);
 
   IDE_EXIT;
 }
@@ -736,3 +1081,49 @@ gbp_meson_introspection_list_run_commands_finish (GbpMesonIntrospection  *self,
 
   IDE_RETURN (ret);
 }
+
+void
+gbp_meson_introspection_list_build_targets_async (GbpMesonIntrospection *self,
+                                                  GCancellable          *cancellable,
+                                                  GAsyncReadyCallback    callback,
+                                                  gpointer               user_data)
+{
+  g_autoptr(IdeTask) task = NULL;
+
+  IDE_ENTRY;
+
+  g_return_if_fail (IDE_IS_MAIN_THREAD ());
+  g_return_if_fail (GBP_IS_MESON_INTROSPECTION (self));
+  g_return_if_fail (IDE_IS_PIPELINE (self->pipeline));
+
+  task = ide_task_new (self, cancellable, callback, user_data);
+  ide_task_set_source_tag (task, gbp_meson_introspection_list_build_targets_async);
+  ide_task_set_priority (task, G_PRIORITY_LOW);
+
+  gbp_meson_introspection_ensure (self, task);
+
+  IDE_EXIT;
+}
+
+/**
+ * gbp_meson_introspection_list_build_targets_finish:
+ *
+ * Returns: (transfer full) (element-type IdeBuildTarget): an array of
+ *   build targets
+ */
+GPtrArray *
+gbp_meson_introspection_list_build_targets_finish (GbpMesonIntrospection  *self,
+                                                   GAsyncResult           *result,
+                                                   GError                **error)
+{
+  GPtrArray *ret;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_MESON_INTROSPECTION (self));
+  g_assert (IDE_IS_TASK (result));
+
+  ret = ide_task_propagate_pointer (IDE_TASK (result), error);
+
+  IDE_RETURN (ret);
+}
@@ -0,0 +1,178 @@
+/* gbp-messages-lsp-panel.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-messages-lsp-panel"
+
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include <libide-gui.h>
+#include <libide-lsp.h>
+
+#include "gbp-messages-lsp-panel.h"
+
+struct _GbpMessagesLspPanel
+{
+  IdePane         parent_instance;
+
+  GtkColumnView  *column_view;
+  GtkNoSelection *selection;
+};
+
+G_DEFINE_FINAL_TYPE (GbpMessagesLspPanel, gbp_messages_lsp_panel, IDE_TYPE_PANE)
+
+static char *
+count_to_string (GObject *object,
+                 guint64  count)
+{
+  return g_strdup_printf ("%"G_GUINT64_FORMAT, count);
+}
+
+static char *
+in_flight_to_string (GObject *object,
+                     guint    n_in_flight)
+{
+  return g_strdup_printf ("%u", n_in_flight);
+}
+
+static char *
+usec_to_string (GObject *object,
+                guint64  usec)
+{
+  if (usec == 0)
+    return g_strdup ("—");
+
+  /* translators: %.1lf is replaced with a duration in milliseconds */
+  return g_strdup_printf (_("%.1lf ms"), usec / 1000.);
+}
+
+static char *
+rate_to_string (GObject *object,
+                double   rate)
+{
+  return g_strdup_printf ("%.0lf%%", rate * 100.);
+}
+
+static char *
+bytes_to_string (GObject *object,
+                 guint64  bytes)
+{
+  return g_format_size (bytes);
+}
+
+static void
+gbp_messages_lsp_panel_copy (GtkWidget  *widget,
+                             const char *action_name,
+                             GVariant   *param)
+{
+  g_autofree char *json = NULL;
+
+  g_assert (GBP_IS_MESSAGES_LSP_PANEL (widget));
+
+  json = ide_lsp_metrics_dump ();
+  gdk_clipboard_set_text (gtk_widget_get_clipboard (widget), json);
+}
+
+static void
+gbp_messages_lsp_panel_save_cb (GbpMessagesLspPanel  *self,
+                                int                   res,
+                                GtkFileChooserNative *native)
+{
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_MESSAGES_LSP_PANEL (self));
+  g_assert (GTK_IS_FILE_CHOOSER_NATIVE (native));
+
+  if (res == GTK_RESPONSE_ACCEPT)
+    {
+      g_autoptr(GFile) file = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (native));
+      g_autofree char *json = ide_lsp_metrics_dump ();
+      g_autoptr(GError) error = NULL;
+
+      if (file != NULL &&
+          !g_file_replace_contents (file, json, strlen (json), NULL, FALSE,
+                                    G_FILE_CREATE_REPLACE_DESTINATION,
+                                    NULL, NULL, &error))
+        g_warning ("Failed to save language server metrics: %s", error->message);
+    }
+
+  gtk_native_dialog_destroy (GTK_NATIVE_DIALOG (native));
+  g_object_unref (native);
+
+  IDE_EXIT;
+}
+
+static void
+gbp_messages_lsp_panel_save (GtkWidget  *widget,
+                             const char *action_name,
+                             GVariant   *param)
+{
+  GbpMessagesLspPanel *self = (GbpMessagesLspPanel *)widget;
+  GtkFileChooserNative *native;
+  GtkWidget *window;
+
+  IDE_ENTRY;
+
+  g_assert (GBP_IS_MESSAGES_LSP_PANEL (self));
+
+  window = gtk_widget_get_ancestor (GTK_WIDGET (self), GTK_TYPE_WINDOW);
+  native = gtk_file_chooser_native_new (_("Save Metrics"),
+                                        GTK_WINDOW (window),
+                                        GTK_FILE_CHOOSER_ACTION_SAVE,
+                                        _("_Save"),
+                                        _("_Cancel"));
+  gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (native), "lsp-metrics.json");
+
+  g_signal_connect_object (native,
+                           "response",
+                           G_CALLBACK (gbp_messages_lsp_panel_save_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  gtk_native_dialog_show (GTK_NATIVE_DIALOG (native));
+
+  IDE_EXIT;
+}
+
+static void
+gbp_messages_lsp_panel_class_init (GbpMessagesLspPanelClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/plugins/messages/gbp-messages-lsp-panel.ui");
+  gtk_widget_class_bind_template_child (widget_class, GbpMessagesLspPanel, column_view);
+  gtk_widget_class_bind_template_child (widget_class, GbpMessagesLspPanel, selection);
+  gtk_widget_class_bind_template_callback (widget_class, count_to_string);
+  gtk_widget_class_bind_template_callback (widget_class, in_flight_to_string);
+  gtk_widget_class_bind_template_callback (widget_class, usec_to_string);
+  gtk_widget_class_bind_template_callback (widget_class, rate_to_string);
+  gtk_widget_class_bind_template_callback (widget_class, bytes_to_string);
+
+  gtk_widget_class_install_action (widget_class, "lsp-panel.copy", NULL, gbp_messages_lsp_panel_copy);
+  gtk_widget_class_install_action (widget_class, "lsp-panel.save", NULL, gbp_messages_lsp_panel_save);
+}
+
+static void
+gbp_messages_lsp_panel_init (GbpMessagesLspPanel *self)
+{
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  gtk_no_selection_set_model (self->selection, ide_lsp_metrics_list ());
+}
@@ -0,0 +1,131 @@
+/* gbp-messages-memory-panel.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "gbp-messages-memory-panel"
+
+#include <glib/gi18n.h>
+
+#include <libide-gui.h>
+
+#include "gbp-messages-memory-panel.h"
+
+#define SAMPLE_INTERVAL_SECONDS 2
+
+struct _GbpMessagesMemoryPanel
+{
+  IdePane         parent_instance;
+
+  GtkColumnView  *column_view;
+  GtkNoSelection *selection;
+
+  guint           sample_source;
+};
+
+G_DEFINE_FINAL_TYPE (GbpMessagesMemoryPanel, gbp_messages_memory_panel, IDE_TYPE_PANE)
+
+static char *
+bytes_to_string (GObject *object,
+                 guint64  bytes)
+{
+  return g_format_size (bytes);
+}
+
+static char *
+budget_to_string (GObject *object,
+                  guint64  budget)
+{
+  if (budget == 0)
+    return g_strdup (_("Unlimited"));
+
+  return g_format_size (budget);
+}
+
+static gboolean
+gbp_messages_memory_panel_sample_cb (gpointer data)
+{
+  ide_memory_account_sample_all ();
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gbp_messages_memory_panel_map (GtkWidget *widget)
+{
+  GbpMessagesMemoryPanel *self = (GbpMessagesMemoryPanel *)widget;
+
+  g_assert (GBP_IS_MESSAGES_MEMORY_PANEL (self));
+
+  GTK_WIDGET_CLASS (gbp_messages_memory_panel_parent_class)->map (widget);
+
+  /* Polled accounts, such as helper daemons, only update while visible */
+  ide_memory_account_sample_all ();
+  g_clear_handle_id (&self->sample_source, g_source_remove);
+  self->sample_source = g_timeout_add_seconds (SAMPLE_INTERVAL_SECONDS,
+                                               gbp_messages_memory_panel_sample_cb,
+                                               NULL);
+}
+
+static void
+gbp_messages_memory_panel_unmap (GtkWidget *widget)
+{
+  GbpMessagesMemoryPanel *self = (GbpMessagesMemoryPanel *)widget;
+
+  g_assert (GBP_IS_MESSAGES_MEMORY_PANEL (self));
+
+  g_clear_handle_id (&self->sample_source, g_source_remove);
+
+  GTK_WIDGET_CLASS (gbp_messages_memory_panel_parent_class)->unmap (widget);
+}
+
+static void
+gbp_messages_memory_panel_dispose (GObject *object)
+{
+  GbpMessagesMemoryPanel *self = (GbpMessagesMemoryPanel *)object;
+
+  g_clear_handle_id (&self->sample_source, g_source_remove);
+
+  G_OBJECT_CLASS (gbp_messages_memory_panel_parent_class)->dispose (object);
+}
+
+static void
+gbp_messages_memory_panel_class_init (GbpMessagesMemoryPanelClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = gbp_messages_memory_panel_dispose;
+
+  widget_class->map = gbp_messages_memory_panel_map;
+  widget_class->unmap = gbp_messages_memory_panel_unmap;
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/plugins/messages/gbp-messages-memory-panel.ui");
+  gtk_widget_class_bind_template_child (widget_class, GbpMessagesMemoryPanel, column_view);
+  gtk_widget_class_bind_template_child (widget_class, GbpMessagesMemoryPanel, selection);
+  gtk_widget_class_bind_template_callback (widget_class, bytes_to_string);
+  gtk_widget_class_bind_template_callback (widget_class, budget_to_string);
+}
+
+static void
+gbp_messages_memory_panel_init (GbpMessagesMemoryPanel *self)
+{
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  gtk_no_selection_set_model (self->selection, ide_memory_account_list ());
+}
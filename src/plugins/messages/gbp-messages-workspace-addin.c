@@ -23,12 +23,16 @@
 #include <libide-gui.h>
 
 #include "gbp-messages-workspace-addin.h"
+#include "gbp-messages-lsp-panel.h"
+#include "gbp-messages-memory-panel.h"
 #include "gbp-messages-panel.h"
 
 struct _GbpMessagesWorkspaceAddin
 {
-  GObject           parent_instance;
-  GbpMessagesPanel *panel;
+  GObject                 parent_instance;
+  GbpMessagesPanel       *panel;
+  GbpMessagesMemoryPanel *memory_panel;
+  GbpMessagesLspPanel    *lsp_panel;
 };
 
 static void
@@ -46,6 +50,12 @@ gbp_messages_workspace_addin_load (IdeWorkspaceAddin *addin,
 
   self->panel = g_object_new (GBP_TYPE_MESSAGES_PANEL, NULL);
   ide_workspace_add_pane (workspace, IDE_PANE (self->panel), position);
+
+  self->memory_panel = g_object_new (GBP_TYPE_MESSAGES_MEMORY_PANEL, NULL);
+  ide_workspace_add_pane (workspace, IDE_PANE (self->memory_panel), position);
+
+  self->lsp_panel = g_object_new (GBP_TYPE_MESSAGES_LSP_PANEL, NULL);
+  ide_workspace_add_pane (workspace, IDE_PANE (self->lsp_panel), position);
 }
 
 static void
@@ -61,7 +71,15 @@ gbp_messages_workspace_addin_unload (IdeWorkspaceAddin *addin,
   frame = gtk_widget_get_ancestor (GTK_WIDGET (self->panel), PANEL_TYPE_FRAME);
   panel_frame_remove (PANEL_FRAME (frame), PANEL_WIDGET (self->panel));
 
+  frame = gtk_widget_get_ancestor (GTK_WIDGET (self->memory_panel), PANEL_TYPE_FRAME);
+  panel_frame_remove (PANEL_FRAME (frame), PANEL_WIDGET (self->memory_panel));
+
+  frame = gtk_widget_get_ancestor (GTK_WIDGET (self->lsp_panel), PANEL_TYPE_FRAME);
+  panel_frame_remove (PANEL_FRAME (frame), PANEL_WIDGET (self->lsp_panel));
+
   self->panel = NULL;
+  self->memory_panel = NULL;
+  self->lsp_panel = NULL;
 }
 
 static void
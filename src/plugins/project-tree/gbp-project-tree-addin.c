@@ -42,6 +42,9 @@ struct _GbpProjectTreeAddin
   IdeTree      *tree;
   GSettings    *settings;
 
+  /* IdeTreeNode -> IdeTask for directories still being populated */
+  GHashTable   *building;
+
   guint         sort_directories_first : 1;
   guint         show_ignored_files : 1;
 };
@@ -52,35 +55,131 @@ typedef struct
   IdeTreeNode *node;
 } FindFileNode;
 
-static gboolean
-project_file_is_ignored (IdeProjectFile *project_file,
-                         IdeVcs         *vcs)
+/* Number of nodes to insert per main loop iteration when populating
+ * a directory. Large directories (such as node_modules) are added in
+ * batches so that the UI remains responsive while they load.
+ */
+#define CHILDREN_BATCH_SIZE 250
+
+typedef struct
 {
-  g_autoptr(GFile) file = NULL;
+  IdeVcs    *vcs;
+  GPtrArray *files;
+  guint      sort_directories_first : 1;
+  guint      show_ignored_files : 1;
+} ListChildren;
 
-  g_assert (IDE_IS_PROJECT_FILE (project_file));
+typedef struct
+{
+  IdeProjectFile *file;
+  char           *collate_key;
+  guint           is_directory : 1;
+} SortEntry;
+
+typedef struct
+{
+  IdeTreeNode    *node;
+  IdeProjectFile *project_file;
+  GPtrArray      *files;
+  guint           position;
+  guint           n_children;
+  guint           source_id;
+} BuildChildren;
 
-  file = ide_project_file_ref_file (project_file);
+static void
+list_children_free (ListChildren *state)
+{
+  g_clear_object (&state->vcs);
+  g_clear_pointer (&state->files, g_ptr_array_unref);
+  g_slice_free (ListChildren, state);
+}
 
-  return ide_vcs_is_ignored (vcs, file, NULL);
+static void
+build_children_free (BuildChildren *state)
+{
+  g_clear_object (&state->node);
+  g_clear_object (&state->project_file);
+  g_clear_pointer (&state->files, g_ptr_array_unref);
+  g_slice_free (BuildChildren, state);
 }
 
-static gint
-compare_files (gconstpointer a,
-               gconstpointer b,
-               gpointer      user_data)
+static int
+sort_entry_compare (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      user_data)
 {
-  GbpProjectTreeAddin *self = user_data;
-  IdeProjectFile *file_a = *(IdeProjectFile **)a;
-  IdeProjectFile *file_b = *(IdeProjectFile **)b;
+  const SortEntry *entry_a = a;
+  const SortEntry *entry_b = b;
+  gboolean sort_directories_first = GPOINTER_TO_INT (user_data);
 
-  g_assert (IDE_IS_PROJECT_FILE (file_a));
-  g_assert (IDE_IS_PROJECT_FILE (file_b));
+  if (sort_directories_first && entry_a->is_directory != entry_b->is_directory)
+    return (int)entry_b->is_directory - (int)entry_a->is_directory;
 
-  if (self->sort_directories_first)
-    return ide_project_file_compare_directories_first (file_a, file_b);
-  else
-    return ide_project_file_compare (file_a, file_b);
+  return strcmp (entry_a->collate_key, entry_b->collate_key);
+}
+
+static void
+gbp_project_tree_addin_list_children_worker (IdeTask      *task,
+                                             gpointer      source_object,
+                                             gpointer      task_data,
+                                             GCancellable *cancellable)
+{
+  ListChildren *state = task_data;
+  g_autoptr(GArray) entries = NULL;
+  g_autoptr(GPtrArray) ret = NULL;
+
+  g_assert (!IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TASK (task));
+  g_assert (state != NULL);
+  g_assert (state->files != NULL);
+
+  entries = g_array_sized_new (FALSE, FALSE, sizeof (SortEntry), state->files->len);
+
+  /* Checking ignored files may require an RPC to the VCS daemon for
+   * each file, so we do that here rather than on the main thread and
+   * precalculate collation keys so sorting does not allocate.
+   */
+  for (guint i = 0; i < state->files->len; i++)
+    {
+      IdeProjectFile *file = g_ptr_array_index (state->files, i);
+      SortEntry entry;
+
+      if (!state->show_ignored_files)
+        {
+          g_autoptr(GFile) gfile = ide_project_file_ref_file (file);
+
+          if (ide_vcs_is_ignored (state->vcs, gfile, NULL))
+            continue;
+        }
+
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      entry.file = file;
+      entry.collate_key = g_utf8_collate_key_for_filename (ide_project_file_get_display_name (file), -1);
+      entry.is_directory = ide_project_file_is_directory (file);
+
+      g_array_append_val (entries, entry);
+    }
+
+  g_array_sort_with_data (entries,
+                          sort_entry_compare,
+                          GINT_TO_POINTER (state->sort_directories_first));
+
+  ret = g_ptr_array_new_full (entries->len, g_object_unref);
+
+  for (guint i = 0; i < entries->len; i++)
+    {
+      SortEntry *entry = &g_array_index (entries, SortEntry, i);
+
+      g_ptr_array_add (ret, g_object_ref (entry->file));
+      g_free (entry->collate_key);
+    }
+
+  if (ide_task_return_error_if_cancelled (task))
+    return;
+
+  ide_task_return_pointer (task, g_steal_pointer (&ret), g_ptr_array_unref);
 }
 
 static IdeTreeNode *
@@ -105,6 +204,167 @@ create_file_node (IdeProjectFile *file)
   return g_steal_pointer (&child);
 }
 
+static void
+gbp_project_tree_addin_clear_building (GbpProjectTreeAddin *self,
+                                       IdeTreeNode         *node,
+                                       IdeTask             *task)
+{
+  g_assert (GBP_IS_PROJECT_TREE_ADDIN (self));
+  g_assert (IDE_IS_TREE_NODE (node));
+  g_assert (IDE_IS_TASK (task));
+
+  if (self->building != NULL &&
+      g_hash_table_lookup (self->building, node) == (gpointer)task)
+    g_hash_table_remove (self->building, node);
+}
+
+static GHashTable *
+collect_child_files (IdeTreeNode *node)
+{
+  GHashTable *files = g_hash_table_new_full (g_file_hash,
+                                             (GEqualFunc)g_file_equal,
+                                             g_object_unref,
+                                             NULL);
+
+  for (IdeTreeNode *child = ide_tree_node_get_first_child (node);
+       child != NULL;
+       child = ide_tree_node_get_next_sibling (child))
+    {
+      if (ide_tree_node_holds (child, IDE_TYPE_PROJECT_FILE))
+        g_hash_table_add (files, ide_project_file_ref_file (ide_tree_node_get_item (child)));
+    }
+
+  return files;
+}
+
+static gboolean
+gbp_project_tree_addin_insert_batch (gpointer user_data)
+{
+  IdeTask *task = user_data;
+  g_autoptr(GHashTable) existing = NULL;
+  g_autoptr(GPtrArray) nodes = NULL;
+  GbpProjectTreeAddin *self;
+  BuildChildren *state;
+  guint end;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
+  g_assert (GBP_IS_PROJECT_TREE_ADDIN (self));
+  g_assert (state != NULL);
+  g_assert (IDE_IS_TREE_NODE (state->node));
+
+  if (ide_task_return_error_if_cancelled (task))
+    {
+      gbp_project_tree_addin_clear_building (self, state->node, task);
+      state->source_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  /* If the addin was disposed, the node was collapsed (and therefore
+   * reset) or another request has started populating it, then stop
+   * adding children.
+   */
+  if (self->building == NULL ||
+      g_hash_table_lookup (self->building, state->node) != (gpointer)task ||
+      !_ide_tree_node_get_loading (state->node))
+    {
+      gbp_project_tree_addin_clear_building (self, state->node, task);
+      ide_task_return_new_error (task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_CANCELLED,
+                                 "The operation was cancelled");
+      state->source_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  /* The file monitor may have added children since the last batch (or
+   * while listing the directory), skip those files rather than adding
+   * them twice.
+   */
+  if (ide_tree_node_get_n_children (state->node) != state->n_children)
+    existing = collect_child_files (state->node);
+
+  end = MIN (state->position + CHILDREN_BATCH_SIZE, state->files->len);
+  nodes = g_ptr_array_new_full (end - state->position, g_object_unref);
+
+  for (guint i = state->position; i < end; i++)
+    {
+      IdeProjectFile *file = g_ptr_array_index (state->files, i);
+
+      if (existing != NULL)
+        {
+          g_autoptr(GFile) gfile = ide_project_file_ref_file (file);
+
+          if (g_hash_table_contains (existing, gfile))
+            continue;
+        }
+
+      ide_object_append (IDE_OBJECT (state->project_file), IDE_OBJECT (file));
+      g_ptr_array_add (nodes, create_file_node (file));
+    }
+
+  ide_tree_node_append_children (state->node,
+                                 (IdeTreeNode **)(gpointer)nodes->pdata,
+                                 nodes->len);
+
+  state->position = end;
+  state->n_children = ide_tree_node_get_n_children (state->node);
+
+  if (state->position < state->files->len)
+    return G_SOURCE_CONTINUE;
+
+  gbp_project_tree_addin_clear_building (self, state->node, task);
+
+  ide_task_return_boolean (task, TRUE);
+
+  state->source_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gbp_project_tree_addin_list_children_cb (GObject      *object,
+                                         GAsyncResult *result,
+                                         gpointer      user_data)
+{
+  g_autoptr(IdeTask) task = user_data;
+  g_autoptr(GPtrArray) files = NULL;
+  g_autoptr(GError) error = NULL;
+  GbpProjectTreeAddin *self;
+  BuildChildren *state;
+
+  g_assert (IDE_IS_MAIN_THREAD ());
+  g_assert (IDE_IS_TASK (result));
+  g_assert (IDE_IS_TASK (task));
+
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
+  if (!(files = ide_task_propagate_pointer (IDE_TASK (result), &error)))
+    {
+      gbp_project_tree_addin_clear_building (self, state->node, task);
+      ide_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  state->files = g_steal_pointer (&files);
+  state->position = 0;
+  state->n_children = 0;
+
+  /* Insert the first batch immediately so that small directories are
+   * populated without an extra main loop cycle.
+   */
+  if (gbp_project_tree_addin_insert_batch (task) == G_SOURCE_CONTINUE)
+    state->source_id = g_idle_add_full (G_PRIORITY_LOW,
+                                        gbp_project_tree_addin_insert_batch,
+                                        g_object_ref (task),
+                                        g_object_unref);
+}
+
 static void
 gbp_project_tree_addin_file_list_children_cb (GObject      *object,
                                               GAsyncResult *result,
@@ -112,62 +372,50 @@ gbp_project_tree_addin_file_list_children_cb (GObject      *object,
 {
   IdeProjectFile *project_file = (IdeProjectFile *)object;
   g_autoptr(IdeTask) task = user_data;
+  g_autoptr(IdeTask) worker = NULL;
   g_autoptr(GPtrArray) children = NULL;
   g_autoptr(GError) error = NULL;
   GbpProjectTreeAddin *self;
-  IdeTreeNode *last = NULL;
-  IdeTreeNode *node;
+  BuildChildren *state;
+  ListChildren *list;
   IdeTreeNode *root;
   IdeContext *context;
-  IdeVcs *vcs;
 
   g_assert (IDE_IS_PROJECT_FILE (project_file));
   g_assert (G_IS_ASYNC_RESULT (result));
   g_assert (IDE_IS_TASK (task));
 
+  self = ide_task_get_source_object (task);
+  state = ide_task_get_task_data (task);
+
   if (!(children = ide_project_file_list_children_finish (project_file, result, &error)))
     {
+      gbp_project_tree_addin_clear_building (self, state->node, task);
       ide_task_return_error (task, g_steal_pointer (&error));
       return;
     }
 
   IDE_PTR_ARRAY_SET_FREE_FUNC (children, g_object_unref);
 
-  self = ide_task_get_source_object (task);
-  node = ide_task_get_task_data (task);
-  root = ide_tree_node_get_root (node);
+  root = ide_tree_node_get_root (state->node);
   context = ide_tree_node_get_item (root);
-  vcs = ide_vcs_from_context (context);
 
   g_assert (GBP_IS_PROJECT_TREE_ADDIN (self));
-  g_assert (IDE_IS_TREE_NODE (node));
-
-  g_ptr_array_sort_with_data (children, compare_files, self);
-
-  for (guint i = 0; i < children->len; i++)
-    {
-      IdeProjectFile *file = g_ptr_array_index (children, i);
-      g_autoptr(IdeTreeNode) child = NULL;
-
-      if (!self->show_ignored_files)
-        {
-          if (project_file_is_ignored (file, vcs))
-            continue;
-        }
-
-      ide_object_append (IDE_OBJECT (project_file), IDE_OBJECT (file));
-
-      child = create_file_node (file);
-
-      if (last == NULL)
-        ide_tree_node_insert_before (child, node, NULL);
-      else
-        ide_tree_node_insert_after (child, node, last);
-
-      last = child;
-    }
-
-  ide_task_return_boolean (task, TRUE);
+  g_assert (IDE_IS_TREE_NODE (state->node));
+
+  list = g_slice_new0 (ListChildren);
+  g_set_object (&list->vcs, ide_vcs_from_context (context));
+  list->files = g_steal_pointer (&children);
+  list->sort_directories_first = self->sort_directories_first;
+  list->show_ignored_files = self->show_ignored_files;
+
+  worker = ide_task_new (self,
+                         ide_task_get_cancellable (task),
+                         gbp_project_tree_addin_list_children_cb,
+                         g_object_ref (task));
+  ide_task_set_source_tag (worker, gbp_project_tree_addin_file_list_children_cb);
+  ide_task_set_task_data (worker, list, list_children_free);
+  ide_task_run_in_thread (worker, gbp_project_tree_addin_list_children_worker);
 }
 
 static void
@@ -177,15 +425,15 @@ gbp_project_tree_addin_build_children_async (IdeTreeAddin        *addin,
                                              GAsyncReadyCallback  callback,
                                              gpointer             user_data)
 {
+  GbpProjectTreeAddin *self = (GbpProjectTreeAddin *)addin;
   g_autoptr(IdeTask) task = NULL;
 
   g_assert (IDE_IS_MAIN_THREAD ());
-  g_assert (IDE_IS_TREE_ADDIN (addin));
+  g_assert (GBP_IS_PROJECT_TREE_ADDIN (self));
   g_assert (IDE_IS_TREE_NODE (node));
 
   task = ide_task_new (addin, cancellable, callback, user_data);
   ide_task_set_source_tag (task, gbp_project_tree_addin_build_children_async);
-  ide_task_set_task_data (task, g_object_ref (node), g_object_unref);
 
   if (ide_tree_node_holds (node, IDE_TYPE_CONTEXT))
     {
@@ -218,6 +466,15 @@ gbp_project_tree_addin_build_children_async (IdeTreeAddin        *addin,
   else if (ide_tree_node_holds (node, IDE_TYPE_PROJECT_FILE))
     {
       IdeProjectFile *project_file = ide_tree_node_get_item (node);
+      BuildChildren *state;
+
+      state = g_slice_new0 (BuildChildren);
+      state->node = g_object_ref (node);
+      state->project_file = g_object_ref (project_file);
+      ide_task_set_task_data (task, state, build_children_free);
+
+      /* Supersedes any previous request still populating @node */
+      g_hash_table_insert (self->building, node, task);
 
       ide_project_file_list_children_async (project_file,
                                             cancellable,
@@ -1021,6 +1278,32 @@ gbp_project_tree_addin_dispose (GObject *object)
 
   g_clear_object (&self->settings);
 
+  /* Stop populating directories. Requests which are still listing files
+   * notice the missing table once they try to insert children.
+   */
+  if (self->building != NULL)
+    {
+      g_autoptr(GHashTable) building = g_steal_pointer (&self->building);
+      GHashTableIter iter;
+      gpointer value;
+
+      g_hash_table_iter_init (&iter, building);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          g_autoptr(IdeTask) task = g_object_ref (value);
+          BuildChildren *state = ide_task_get_task_data (task);
+
+          if (state->source_id != 0)
+            {
+              g_clear_handle_id (&state->source_id, g_source_remove);
+              ide_task_return_new_error (task,
+                                         G_IO_ERROR,
+                                         G_IO_ERROR_CANCELLED,
+                                         "The operation was cancelled");
+            }
+        }
+    }
+
   G_OBJECT_CLASS (gbp_project_tree_addin_parent_class)->dispose (object);
 }
 
@@ -1035,6 +1318,7 @@ gbp_project_tree_addin_class_init (GbpProjectTreeAddinClass *klass)
 static void
 gbp_project_tree_addin_init (GbpProjectTreeAddin *self)
 {
+  self->building = g_hash_table_new (NULL, NULL);
   self->settings = g_settings_new ("org.gnome.builder.project-tree");
 
   g_signal_connect_object (self->settings,
@@ -23,6 +23,7 @@
 #include <glib/gi18n.h>
 #include <gtksourceview/gtksource.h>
 #include <math.h>
+#include <string.h>
 
 #include "ide-xml-analysis.h"
 #include "ide-xml-rng-parser.h"
@@ -525,6 +526,44 @@ ide_xml_service_get_diagnostics_finish (IdeXmlService  *self,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/* A rough size of a symbol node, its attributes and location */
+#define XML_SYMBOL_NODE_SIZE 256
+
+static gsize
+ide_xml_service_symbol_node_size (IdeXmlSymbolNode *node)
+{
+  const char *value = ide_xml_symbol_node_get_value (node);
+  const char *element_name = ide_xml_symbol_node_get_element_name (node);
+  guint n_children = ide_xml_symbol_node_get_n_direct_children (node);
+  gsize size = XML_SYMBOL_NODE_SIZE;
+
+  size += value ? strlen (value) : 0;
+  size += element_name ? strlen (element_name) : 0;
+
+  for (guint i = 0; i < n_children; i++)
+    {
+      g_autoptr(IdeSymbolNode) child = ide_xml_symbol_node_get_nth_direct_child (node, i);
+
+      if (child != NULL)
+        size += ide_xml_service_symbol_node_size (IDE_XML_SYMBOL_NODE (child));
+    }
+
+  return size;
+}
+
+static gsize
+ide_xml_service_analysis_size (gconstpointer value)
+{
+  IdeXmlAnalysis *analysis = (IdeXmlAnalysis *)value;
+  IdeXmlSymbolNode *root_node = ide_xml_analysis_get_root_node (analysis);
+  gsize size = sizeof *analysis;
+
+  if (root_node != NULL)
+    size += ide_xml_service_symbol_node_size (root_node);
+
+  return size;
+}
+
 static void
 ide_xml_service_parent_set (IdeObject *object,
                             IdeObject *parent)
@@ -557,6 +596,8 @@ ide_xml_service_parent_set (IdeObject *object,
                                        NULL);
 
   ide_task_cache_set_name (self->analyses, "xml analysis cache");
+  ide_task_cache_set_size_func (self->analyses, ide_xml_service_analysis_size);
+  ide_task_cache_set_evictable (self->analyses, TRUE);
 
   /* There's no eviction time on this cache */
   self->schemas = ide_task_cache_new ((GHashFunc)g_file_hash,
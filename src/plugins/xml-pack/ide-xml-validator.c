@@ -29,14 +29,29 @@
 
 #include "ide-xml-validator.h"
 
+/* Number of compiled schemas kept alive once no validator uses them */
+#define MAX_COMPILED_SCHEMAS 16
+
+/* Compiling a RelaxNG or XML Schema grammar is far more expensive than
+ * validating a document against it, so compiled schemas are shared by
+ * every validator in the process and keyed by a hash of their content.
+ */
+typedef struct
+{
+  volatile gint     ref_count;
+  IdeXmlSchemaKind  kind;
+  gchar            *key;
+  xmlRelaxNG       *rng;
+  xmlSchema        *xml_schema;
+} CompiledSchema;
+
 struct _IdeXmlValidator
 {
   IdeObject         parent_instance;
 
   GPtrArray        *diagnostics_array;
   xmlDtd           *dtd;
-  xmlRelaxNG       *rng;
-  xmlSchema        *xml_schema;
+  CompiledSchema   *compiled;
 
   IdeXmlSchemaKind  kind;
   guint             dtd_use_subsets : 1;
@@ -52,6 +67,146 @@ typedef struct _ValidState
 
 G_DEFINE_FINAL_TYPE (IdeXmlValidator, ide_xml_validator, IDE_TYPE_OBJECT)
 
+G_LOCK_DEFINE_STATIC (compiled_schemas);
+static GHashTable *compiled_schemas;
+static GQueue compiled_schemas_lru = G_QUEUE_INIT;
+
+static CompiledSchema *
+compiled_schema_ref (CompiledSchema *compiled)
+{
+  g_assert (compiled != NULL);
+  g_assert (compiled->ref_count > 0);
+
+  g_atomic_int_inc (&compiled->ref_count);
+
+  return compiled;
+}
+
+static void
+compiled_schema_unref (CompiledSchema *compiled)
+{
+  g_assert (compiled != NULL);
+  g_assert (compiled->ref_count > 0);
+
+  if (g_atomic_int_dec_and_test (&compiled->ref_count))
+    {
+      g_clear_pointer (&compiled->rng, xmlRelaxNGFree);
+      g_clear_pointer (&compiled->xml_schema, xmlSchemaFree);
+      g_clear_pointer (&compiled->key, g_free);
+      g_slice_free (CompiledSchema, compiled);
+    }
+}
+
+static CompiledSchema *
+compiled_schema_new (IdeXmlSchemaKind  kind,
+                     const gchar      *data,
+                     gsize             size)
+{
+  CompiledSchema *compiled;
+  xmlRelaxNGParserCtxt *rng_parser;
+  xmlSchemaParserCtxt *schema_parser;
+
+  g_assert (kind == SCHEMA_KIND_RNG || kind == SCHEMA_KIND_XML_SCHEMA);
+
+  compiled = g_slice_new0 (CompiledSchema);
+  compiled->ref_count = 1;
+  compiled->kind = kind;
+
+  if (kind == SCHEMA_KIND_RNG)
+    {
+      if (NULL != (rng_parser = xmlRelaxNGNewMemParserCtxt (data, size)))
+        {
+          compiled->rng = xmlRelaxNGParse (rng_parser);
+          xmlRelaxNGFreeParserCtxt (rng_parser);
+        }
+    }
+  else
+    {
+      if (NULL != (schema_parser = xmlSchemaNewMemParserCtxt (data, size)))
+        {
+          compiled->xml_schema = xmlSchemaParse (schema_parser);
+          xmlSchemaFreeParserCtxt (schema_parser);
+        }
+    }
+
+  if (compiled->rng == NULL && compiled->xml_schema == NULL)
+    {
+      compiled_schema_unref (compiled);
+      return NULL;
+    }
+
+  return compiled;
+}
+
+/* May be called from any thread */
+static CompiledSchema *
+compiled_schema_lookup (IdeXmlSchemaKind  kind,
+                        const gchar      *data,
+                        gsize             size)
+{
+  g_autofree gchar *checksum = NULL;
+  g_autofree gchar *key = NULL;
+  CompiledSchema *compiled;
+  CompiledSchema *other;
+
+  g_assert (kind == SCHEMA_KIND_RNG || kind == SCHEMA_KIND_XML_SCHEMA);
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *)data, size);
+  key = g_strdup_printf ("%u:%s", kind, checksum);
+
+  G_LOCK (compiled_schemas);
+
+  if (compiled_schemas == NULL)
+    compiled_schemas = g_hash_table_new_full (g_str_hash,
+                                              g_str_equal,
+                                              NULL,
+                                              (GDestroyNotify)compiled_schema_unref);
+
+  if ((compiled = g_hash_table_lookup (compiled_schemas, key)))
+    {
+      /* Move to the front of the LRU */
+      g_queue_remove (&compiled_schemas_lru, compiled);
+      g_queue_push_head (&compiled_schemas_lru, compiled);
+      compiled = compiled_schema_ref (compiled);
+    }
+
+  G_UNLOCK (compiled_schemas);
+
+  if (compiled != NULL)
+    return compiled;
+
+  /* Compile without holding the lock, another thread may race us
+   * but the first one to be inserted wins.
+   */
+  if (!(compiled = compiled_schema_new (kind, data, size)))
+    return NULL;
+
+  compiled->key = g_steal_pointer (&key);
+
+  G_LOCK (compiled_schemas);
+
+  if ((other = g_hash_table_lookup (compiled_schemas, compiled->key)))
+    {
+      compiled_schema_unref (compiled);
+      compiled = compiled_schema_ref (other);
+    }
+  else
+    {
+      g_hash_table_insert (compiled_schemas, compiled->key, compiled_schema_ref (compiled));
+      g_queue_push_head (&compiled_schemas_lru, compiled);
+
+      while (compiled_schemas_lru.length > MAX_COMPILED_SCHEMAS)
+        {
+          CompiledSchema *oldest = g_queue_pop_tail (&compiled_schemas_lru);
+          g_hash_table_remove (compiled_schemas, oldest->key);
+        }
+    }
+
+  G_UNLOCK (compiled_schemas);
+
+  return compiled;
+}
+
 IdeXmlSchemaKind
 ide_xml_validator_get_kind (IdeXmlValidator *self)
 {
@@ -167,7 +322,7 @@ ide_xml_validator_validate (IdeXmlValidator   *self,
     }
   else if (self->kind == SCHEMA_KIND_XML_SCHEMA)
     {
-      if (NULL == (xml_schema_valid_context = xmlSchemaNewValidCtxt (self->xml_schema)))
+      if (NULL == (xml_schema_valid_context = xmlSchemaNewValidCtxt (self->compiled->xml_schema)))
         goto end;
 
       xmlSchemaSetValidErrors (xml_schema_valid_context,
@@ -180,7 +335,7 @@ ide_xml_validator_validate (IdeXmlValidator   *self,
     }
   else if (self->kind == SCHEMA_KIND_RNG)
     {
-      if (NULL == (rng_valid_context = xmlRelaxNGNewValidCtxt (self->rng)))
+      if (NULL == (rng_valid_context = xmlRelaxNGNewValidCtxt (self->compiled->rng)))
         goto end;
 
       xmlRelaxNGSetValidErrors (rng_valid_context,
@@ -214,12 +369,14 @@ ide_xml_validator_set_schema (IdeXmlValidator  *self,
                               gsize             size)
 {
   xmlDoc *dtd_doc;
-  xmlRelaxNGParserCtxt *rng_parser;
-  xmlSchemaParserCtxt *schema_parser;
   gboolean ret = FALSE;
 
   g_assert (IDE_IS_XML_VALIDATOR (self));
 
+  g_clear_pointer (&self->dtd, xmlFreeDtd);
+  g_clear_pointer (&self->compiled, compiled_schema_unref);
+  self->dtd_use_subsets = FALSE;
+
   if (kind == SCHEMA_KIND_DTD)
     {
       if (data == NULL)
@@ -227,8 +384,7 @@ ide_xml_validator_set_schema (IdeXmlValidator  *self,
           self->dtd_use_subsets = TRUE;
           ret = TRUE;
         }
-
-      if (NULL != (dtd_doc = xmlParseMemory (data, size)))
+      else if (NULL != (dtd_doc = xmlParseMemory (data, size)))
         {
           if (NULL != (self->dtd = xmlNewDtd (dtd_doc, NULL, NULL, NULL)))
             ret = TRUE;
@@ -236,16 +392,9 @@ ide_xml_validator_set_schema (IdeXmlValidator  *self,
           xmlFreeDoc (dtd_doc);
         }
     }
-  else if (kind == SCHEMA_KIND_RNG)
-    {
-      if (NULL != (rng_parser = xmlRelaxNGNewMemParserCtxt (data, size)) &&
-          NULL != (self->rng = xmlRelaxNGParse (rng_parser)))
-        ret = TRUE;
-    }
-  else if (kind == SCHEMA_KIND_XML_SCHEMA)
+  else if (kind == SCHEMA_KIND_RNG || kind == SCHEMA_KIND_XML_SCHEMA)
     {
-      if (NULL != (schema_parser = xmlSchemaNewMemParserCtxt (data, size)) &&
-          NULL != (self->xml_schema = xmlSchemaParse (schema_parser)))
+      if (NULL != (self->compiled = compiled_schema_lookup (kind, data, size)))
         ret = TRUE;
     }
   else
@@ -262,8 +411,7 @@ ide_xml_validator_finalize (GObject *object)
   IdeXmlValidator *self = (IdeXmlValidator *)object;
 
   g_clear_pointer (&self->dtd, xmlFreeDtd);
-  g_clear_pointer (&self->rng, xmlRelaxNGFree);
-  g_clear_pointer (&self->xml_schema, xmlSchemaFree);
+  g_clear_pointer (&self->compiled, compiled_schema_unref);
   g_clear_pointer (&self->diagnostics_array, g_ptr_array_unref);
 
   G_OBJECT_CLASS (ide_xml_validator_parent_class)->finalize (object);
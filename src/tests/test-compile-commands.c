@@ -34,6 +34,9 @@ test_compile_commands_basic (void)
   g_autofree gchar *dir_path = NULL;
   g_auto(GStrv) cmdstrv = NULL;
   g_auto(GStrv) valastrv = NULL;
+  g_auto(GStrv) cachedstrv = NULL;
+  guint n_hits = 0;
+  guint n_misses = 0;
   gboolean r;
 
   commands = ide_compile_commands_new ();
@@ -68,6 +71,16 @@ test_compile_commands_basic (void)
   g_assert_cmpstr (valastrv[1], ==, "json-glib-1.0");
   g_assert_cmpstr (valastrv[2], ==, "--pkg");
   g_assert_cmpstr (valastrv[3], ==, "gtksourceview-4");
+
+  /* A second lookup should be served from the flags cache */
+  cachedstrv = ide_compile_commands_lookup (commands, expected_file, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (cachedstrv != NULL);
+  g_assert (cachedstrv != cmdstrv);
+  g_assert_true (g_strv_equal ((const gchar * const *)cachedstrv, (const gchar * const *)cmdstrv));
+  ide_compile_commands_get_stats (commands, &n_hits, &n_misses, NULL);
+  g_assert_cmpint (n_hits, ==, 1);
+  g_assert_cmpint (n_misses, ==, 2);
 }
 
 gint
@@ -0,0 +1,179 @@
+/* test-flatpak-sources.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <glib/gstdio.h>
+
+#include "plugins/flatpak/gbp-flatpak-sources.h"
+
+typedef struct
+{
+  GError   *error;
+  guint     n_fetched;
+  gboolean  done;
+} Prefetch;
+
+static const struct {
+  const char *name;
+  const char *contents;
+} mirrored[] = {
+  { "first-1.0.tar.xz", "contents of the first archive\n" },
+  { "second-2.0.tar.gz", "contents of the second archive\n" },
+};
+
+static GbpFlatpakArchive *
+archive_new (const char *mirror_dir,
+             const char *name,
+             const char *sha256)
+{
+  g_autofree char *path = g_build_filename (mirror_dir, name, NULL);
+  GbpFlatpakArchive *archive;
+
+  archive = g_slice_new0 (GbpFlatpakArchive);
+  archive->url = g_filename_to_uri (path, NULL, NULL);
+  archive->sha256 = g_strdup (sha256);
+
+  return archive;
+}
+
+static void
+prefetch_cb (GObject      *object,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  Prefetch *prefetch = user_data;
+
+  gbp_flatpak_sources_prefetch_finish (result, &prefetch->n_fetched, &prefetch->error);
+  prefetch->done = TRUE;
+}
+
+static void
+prefetch (GPtrArray  *archives,
+          const char *downloads_dir,
+          Prefetch   *state)
+{
+  gbp_flatpak_sources_prefetch_async (archives, downloads_dir, 2, NULL, prefetch_cb, state);
+
+  while (!state->done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+test_prefetch (void)
+{
+  g_autoptr(GPtrArray) archives = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *tmpdir = NULL;
+  g_autofree char *mirror_dir = NULL;
+  g_autofree char *downloads_dir = NULL;
+  g_autofree char *bad_sha256 = NULL;
+  g_autofree char *bad_dir = NULL;
+  g_autofree char *bad_path = NULL;
+  g_autofree char *bad_part = NULL;
+  Prefetch first = {0};
+  Prefetch second = {0};
+
+  tmpdir = g_dir_make_tmp ("test-flatpak-sources-XXXXXX", &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (tmpdir);
+
+  mirror_dir = g_build_filename (tmpdir, "mirror", NULL);
+  downloads_dir = g_build_filename (tmpdir, "downloads", NULL);
+  g_assert_cmpint (g_mkdir (mirror_dir, 0750), ==, 0);
+
+  archives = g_ptr_array_new_with_free_func ((GDestroyNotify)gbp_flatpak_archive_free);
+
+  for (guint i = 0; i < G_N_ELEMENTS (mirrored); i++)
+    {
+      g_autofree char *path = g_build_filename (mirror_dir, mirrored[i].name, NULL);
+      g_autofree char *sha256 = g_compute_checksum_for_string (G_CHECKSUM_SHA256, mirrored[i].contents, -1);
+
+      g_file_set_contents (path, mirrored[i].contents, -1, &error);
+      g_assert_no_error (error);
+
+      g_ptr_array_add (archives, archive_new (mirror_dir, mirrored[i].name, sha256));
+    }
+
+  /* The first archive again, but with the checksum of something else */
+  bad_sha256 = g_compute_checksum_for_string (G_CHECKSUM_SHA256, "not the archive\n", -1);
+  g_ptr_array_add (archives, archive_new (mirror_dir, mirrored[0].name, bad_sha256));
+
+  prefetch (archives, downloads_dir, &first);
+
+  /* Every archive is attempted and the mismatch is reported */
+  g_assert_error (first.error, G_IO_ERROR, G_IO_ERROR_FAILED);
+  g_assert_cmpint (first.n_fetched, ==, G_N_ELEMENTS (mirrored));
+  g_clear_error (&first.error);
+
+  /* Archives are stored as downloads/<sha256>/<basename> */
+  for (guint i = 0; i < G_N_ELEMENTS (mirrored); i++)
+    {
+      const GbpFlatpakArchive *archive = g_ptr_array_index (archives, i);
+      g_autofree char *path = g_build_filename (downloads_dir, archive->sha256, mirrored[i].name, NULL);
+      g_autofree char *contents = NULL;
+
+      g_file_get_contents (path, &contents, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (contents, ==, mirrored[i].contents);
+    }
+
+  /* Nothing is left in place when the checksum does not match */
+  bad_dir = g_build_filename (downloads_dir, bad_sha256, NULL);
+  bad_path = g_build_filename (bad_dir, mirrored[0].name, NULL);
+  bad_part = g_strdup_printf ("%s.part", bad_path);
+  g_assert_false (g_file_test (bad_path, G_FILE_TEST_EXISTS));
+  g_assert_false (g_file_test (bad_part, G_FILE_TEST_EXISTS));
+
+  /* Remove the mirror so that fetching anything again would fail */
+  g_ptr_array_remove_index (archives, archives->len - 1);
+  for (guint i = 0; i < G_N_ELEMENTS (mirrored); i++)
+    {
+      g_autofree char *path = g_build_filename (mirror_dir, mirrored[i].name, NULL);
+      g_assert_cmpint (g_unlink (path), ==, 0);
+    }
+
+  prefetch (archives, downloads_dir, &second);
+
+  g_assert_no_error (second.error);
+  g_assert_cmpint (second.n_fetched, ==, 0);
+
+  for (guint i = 0; i < archives->len; i++)
+    {
+      const GbpFlatpakArchive *archive = g_ptr_array_index (archives, i);
+      g_autofree char *dir = g_build_filename (downloads_dir, archive->sha256, NULL);
+      g_autofree char *path = g_build_filename (dir, mirrored[i].name, NULL);
+
+      g_assert_cmpint (g_unlink (path), ==, 0);
+      g_assert_cmpint (g_rmdir (dir), ==, 0);
+    }
+
+  g_rmdir (bad_dir);
+  g_assert_cmpint (g_rmdir (downloads_dir), ==, 0);
+  g_assert_cmpint (g_rmdir (mirror_dir), ==, 0);
+  g_assert_cmpint (g_rmdir (tmpdir), ==, 0);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Flatpak/Sources/prefetch", test_prefetch);
+  return g_test_run ();
+}
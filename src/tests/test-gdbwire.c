@@ -0,0 +1,236 @@
+/* test-gdbwire.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "plugins/gdb/gdbwire.h"
+
+/* Same as the read size of GbpGdbDebugger */
+#define READ_BUFFER_LEN (64 * 1024)
+
+typedef struct
+{
+  guint n_outputs[GDBWIRE_MI_OUTPUT_PARSE_ERROR + 1];
+  guint n_results[GDBWIRE_MI_UNSUPPORTED + 1];
+  guint n_async[GDBWIRE_MI_ASYNC_UNSUPPORTED + 1];
+} Replay;
+
+static void
+replay_output_cb (void                     *context,
+                  struct gdbwire_mi_output *output)
+{
+  Replay *replay = context;
+
+  replay->n_outputs[output->kind]++;
+
+  if (output->kind == GDBWIRE_MI_OUTPUT_RESULT)
+    replay->n_results[output->variant.result_record->result_class]++;
+  else if (output->kind == GDBWIRE_MI_OUTPUT_OOB &&
+           output->variant.oob_record->kind == GDBWIRE_MI_ASYNC)
+    replay->n_async[output->variant.oob_record->variant.async_record->async_class]++;
+
+  gdbwire_mi_output_free (output);
+}
+
+static void
+replay_transcript (const char *data,
+                   gsize       len,
+                   gsize       chunk_size,
+                   Replay     *replay)
+{
+  struct gdbwire_mi_parser_callbacks callbacks = { replay, replay_output_cb };
+  struct gdbwire_mi_parser *parser;
+
+  parser = gdbwire_mi_parser_create (callbacks);
+  g_assert_nonnull (parser);
+
+  for (gsize pos = 0; pos < len; pos += chunk_size)
+    {
+      enum gdbwire_result res;
+
+      res = gdbwire_mi_parser_push_data (parser, data + pos, MIN (chunk_size, len - pos));
+      g_assert_cmpint (res, ==, GDBWIRE_OK);
+    }
+
+  gdbwire_mi_parser_destroy (parser);
+}
+
+static char *
+load_transcript (gsize *len)
+{
+  g_autofree char *path = g_build_filename (TEST_DATA_DIR, "test-gdbwire.mi", NULL);
+  g_autoptr(GError) error = NULL;
+  char *contents = NULL;
+
+  g_file_get_contents (path, &contents, len, &error);
+  g_assert_no_error (error);
+
+  return contents;
+}
+
+static void
+test_gdbwire_replay (void)
+{
+  static const gsize chunk_sizes[] = { 1, 7, 4096, READ_BUFFER_LEN };
+  g_autofree char *contents = NULL;
+  gsize len;
+
+  contents = load_transcript (&len);
+
+  /* Records must come out the same however the reads were split */
+  for (guint i = 0; i < G_N_ELEMENTS (chunk_sizes); i++)
+    {
+      Replay replay = {{0}};
+
+      replay_transcript (contents, len, chunk_sizes[i], &replay);
+
+      g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_PARSE_ERROR], ==, 0);
+      g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_OOB], ==, 26);
+      g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_RESULT], ==, 12);
+      g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_PROMPT], ==, 15);
+
+      g_assert_cmpint (replay.n_results[GDBWIRE_MI_DONE], ==, 7);
+      g_assert_cmpint (replay.n_results[GDBWIRE_MI_RUNNING], ==, 3);
+      g_assert_cmpint (replay.n_results[GDBWIRE_MI_ERROR], ==, 1);
+      g_assert_cmpint (replay.n_results[GDBWIRE_MI_EXIT], ==, 1);
+
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_STOPPED], ==, 3);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_RUNNING], ==, 3);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_THREAD_CREATED], ==, 4);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_THREAD_EXITED], ==, 4);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_LIBRARY_LOADED], ==, 2);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED], ==, 2);
+      g_assert_cmpint (replay.n_async[GDBWIRE_MI_ASYNC_UNSUPPORTED], ==, 0);
+    }
+}
+
+static void
+test_gdbwire_classes (void)
+{
+  static const struct {
+    const char *name;
+    enum gdbwire_mi_async_class async_class;
+  } classes[] = {
+    { "download", GDBWIRE_MI_ASYNC_DOWNLOAD },
+    { "stopped", GDBWIRE_MI_ASYNC_STOPPED },
+    { "running", GDBWIRE_MI_ASYNC_RUNNING },
+    { "thread-group-added", GDBWIRE_MI_ASYNC_THREAD_GROUP_ADDED },
+    { "thread-group-removed", GDBWIRE_MI_ASYNC_THREAD_GROUP_REMOVED },
+    { "thread-group-started", GDBWIRE_MI_ASYNC_THREAD_GROUP_STARTED },
+    { "thread-group-exited", GDBWIRE_MI_ASYNC_THREAD_GROUP_EXITED },
+    { "thread-created", GDBWIRE_MI_ASYNC_THREAD_CREATED },
+    { "thread-exited", GDBWIRE_MI_ASYNC_THREAD_EXITED },
+    { "thread-selected", GDBWIRE_MI_ASYNC_THREAD_SELECTED },
+    { "library-loaded", GDBWIRE_MI_ASYNC_LIBRARY_LOADED },
+    { "library-unloaded", GDBWIRE_MI_ASYNC_LIBRARY_UNLOADED },
+    { "traceframe-changed", GDBWIRE_MI_ASYNC_TRACEFRAME_CHANGED },
+    { "tsv-created", GDBWIRE_MI_ASYNC_TSV_CREATED },
+    { "tsv-modified", GDBWIRE_MI_ASYNC_TSV_MODIFIED },
+    { "tsv-deleted", GDBWIRE_MI_ASYNC_TSV_DELETED },
+    { "breakpoint-created", GDBWIRE_MI_ASYNC_BREAKPOINT_CREATED },
+    { "breakpoint-modified", GDBWIRE_MI_ASYNC_BREAKPOINT_MODIFIED },
+    { "breakpoint-deleted", GDBWIRE_MI_ASYNC_BREAKPOINT_DELETED },
+    { "record-started", GDBWIRE_MI_ASYNC_RECORD_STARTED },
+    { "record-stopped", GDBWIRE_MI_ASYNC_RECORD_STOPPED },
+    { "cmd-param-changed", GDBWIRE_MI_ASYNC_CMD_PARAM_CHANGED },
+    { "memory-changed", GDBWIRE_MI_ASYNC_MEMORY_CHANGED },
+    { "thread-group", GDBWIRE_MI_ASYNC_UNSUPPORTED },
+    { "stoppedx", GDBWIRE_MI_ASYNC_UNSUPPORTED },
+  };
+  static const struct {
+    const char *name;
+    enum gdbwire_mi_result_class result_class;
+  } results[] = {
+    { "done", GDBWIRE_MI_DONE },
+    { "running", GDBWIRE_MI_RUNNING },
+    { "connected", GDBWIRE_MI_CONNECTED },
+    { "error", GDBWIRE_MI_ERROR },
+    { "exit", GDBWIRE_MI_EXIT },
+    { "stopped", GDBWIRE_MI_UNSUPPORTED },
+  };
+
+  for (guint i = 0; i < G_N_ELEMENTS (classes); i++)
+    {
+      g_autofree char *line = g_strdup_printf ("=%s,id=\"1\"\n", classes[i].name);
+      Replay replay = {{0}};
+
+      replay_transcript (line, strlen (line), READ_BUFFER_LEN, &replay);
+      g_assert_cmpint (replay.n_async[classes[i].async_class], ==, 1);
+    }
+
+  for (guint i = 0; i < G_N_ELEMENTS (results); i++)
+    {
+      g_autofree char *line = g_strdup_printf ("1^%s\n", results[i].name);
+      Replay replay = {{0}};
+
+      replay_transcript (line, strlen (line), READ_BUFFER_LEN, &replay);
+      g_assert_cmpint (replay.n_results[results[i].result_class], ==, 1);
+    }
+}
+
+static void
+test_gdbwire_replay_perf (void)
+{
+  g_autoptr(GString) transcript = NULL;
+  g_autofree char *contents = NULL;
+  Replay replay = {{0}};
+  gdouble elapsed;
+  gsize len;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Only run in perf mode (-m perf)");
+      return;
+    }
+
+  contents = load_transcript (&len);
+
+  /* Repeat the session so that reads carry many records, like stepping
+   * through a program with many threads and large frames does.
+   */
+  transcript = g_string_sized_new (len * 1000);
+  for (guint i = 0; i < 1000; i++)
+    g_string_append_len (transcript, contents, len);
+
+  g_test_timer_start ();
+  replay_transcript (transcript->str, transcript->len, READ_BUFFER_LEN, &replay);
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_PARSE_ERROR], ==, 0);
+  g_assert_cmpint (replay.n_outputs[GDBWIRE_MI_OUTPUT_RESULT], ==, 12 * 1000);
+
+  g_test_minimized_result (elapsed, "Replayed %"G_GSIZE_FORMAT" bytes in %lf seconds",
+                           transcript->len, elapsed);
+  g_test_maximized_result (transcript->len / elapsed / (1024 * 1024),
+                           "%.1lf MiB/s",
+                           transcript->len / elapsed / (1024 * 1024));
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Gdb/Wire/replay", test_gdbwire_replay);
+  g_test_add_func ("/Gdb/Wire/classes", test_gdbwire_classes);
+  g_test_add_func ("/Gdb/Wire/replay-perf", test_gdbwire_replay_perf);
+  return g_test_run ();
+}
@@ -129,6 +129,64 @@ test_ide_object_readd (void)
   g_assert_null (p);
 }
 
+typedef struct
+{
+  IdeObject *root;
+  IdeObject *leaf;
+  gint       done;
+} ThreadedReaders;
+
+static gpointer
+threaded_reader_func (gpointer data)
+{
+  ThreadedReaders *state = data;
+
+  while (!g_atomic_int_get (&state->done))
+    {
+      g_autoptr(IdeObject) root = ide_object_ref_root (state->leaf);
+      g_autoptr(GPtrArray) children = ide_object_get_children_typed (state->root, IDE_TYPE_OBJECT);
+
+      g_ptr_array_set_free_func (children, g_object_unref);
+
+      g_assert (root == state->root);
+
+      for (guint i = 0; i < children->len; i++)
+        g_assert_true (IDE_IS_OBJECT (g_ptr_array_index (children, i)));
+    }
+
+  return NULL;
+}
+
+static void
+test_ide_object_threaded_readers (void)
+{
+  g_autoptr(IdeObject) root = ide_object_new (IDE_TYPE_OBJECT, NULL);
+  g_autoptr(IdeObject) middle = ide_object_new (IDE_TYPE_OBJECT, root);
+  g_autoptr(IdeObject) leaf = ide_object_new (IDE_TYPE_OBJECT, middle);
+  ThreadedReaders state = { root, leaf, FALSE };
+  GThread *threads[4];
+
+  for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("reader", threaded_reader_func, &state);
+
+  for (guint i = 0; i < 10000; i++)
+    {
+      g_autoptr(IdeObject) child = ide_object_new (IDE_TYPE_OBJECT, root);
+
+      ide_object_remove (root, child);
+    }
+
+  g_atomic_int_set (&state.done, TRUE);
+
+  for (guint i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_assert_cmpint (1, ==, ide_object_get_n_children (root));
+  g_assert_cmpint (1, ==, ide_object_get_n_children (middle));
+
+  ide_object_destroy (root);
+}
+
 static void
 destroyed_cb (IdeObject *object,
               guint     *location)
@@ -291,6 +349,7 @@ main (gint argc,
   g_test_init (&argc, &argv, NULL);
   g_test_add_func ("/libide-core/IdeObject/basic", test_ide_object_basic);
   g_test_add_func ("/libide-core/IdeObject/re-add", test_ide_object_readd);
+  g_test_add_func ("/libide-core/IdeObject/threaded-readers", test_ide_object_threaded_readers);
   g_test_add_func ("/libide-core/IdeNotification/basic", test_ide_notification_basic);
   g_test_add_func ("/libide-core/IdeNotification/destroy", test_ide_notification_destroy);
   return g_test_run ();
@@ -37,12 +37,118 @@ test_path_expand (void)
   test_expand ("foo", g_build_filename (g_get_home_dir (), "foo", NULL));
 }
 
+static void
+populate_cb (IdeTaskCache  *cache,
+             gconstpointer  key,
+             GTask         *task,
+             gpointer       user_data)
+{
+  g_task_return_pointer (task, g_strdup (key), g_free);
+}
+
+static gsize
+value_size (gconstpointer value)
+{
+  return 1000;
+}
+
+static void
+get_cb (GObject      *object,
+        GAsyncResult *result,
+        gpointer      user_data)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofree char *value = NULL;
+  gboolean *done = user_data;
+
+  value = ide_task_cache_get_finish (IDE_TASK_CACHE (object), result, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (value);
+
+  *done = TRUE;
+}
+
+static void
+cache_get (IdeTaskCache *cache,
+           const char   *key)
+{
+  gboolean done = FALSE;
+
+  ide_task_cache_get_async (cache, key, FALSE, NULL, get_cb, &done);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static IdeTaskCache *
+create_cache (gboolean evictable)
+{
+  IdeTaskCache *cache;
+
+  cache = ide_task_cache_new (g_str_hash,
+                              g_str_equal,
+                              (GBoxedCopyFunc)g_strdup,
+                              g_free,
+                              (GBoxedCopyFunc)g_strdup,
+                              g_free,
+                              0,
+                              populate_cb,
+                              NULL,
+                              NULL);
+  ide_task_cache_set_size_func (cache, value_size);
+  ide_task_cache_set_evictable (cache, evictable);
+
+  return cache;
+}
+
+static void
+test_task_cache_budget (void)
+{
+  IdeMemoryAccount *account = ide_memory_account_get ("task-cache", NULL);
+  g_autoptr(IdeTaskCache) cache = create_cache (TRUE);
+  g_autoptr(IdeTaskCache) pinned = create_cache (FALSE);
+  IdeTaskCacheStats stats;
+
+  /* Room for two entries, but not three */
+  ide_memory_account_set_budget (account, 2500);
+
+  cache_get (pinned, "x");
+  cache_get (pinned, "y");
+  cache_get (pinned, "z");
+
+  cache_get (cache, "a");
+  cache_get (cache, "b");
+
+  /* Peeking marks "a" as used, leaving "b" the least recently used */
+  g_assert_cmpstr (ide_task_cache_peek (cache, "a"), ==, "a");
+
+  cache_get (cache, "c");
+  while (g_main_context_iteration (NULL, FALSE)) { }
+
+  g_assert_cmpstr (ide_task_cache_peek (cache, "a"), ==, "a");
+  g_assert_null (ide_task_cache_peek (cache, "b"));
+  g_assert_cmpstr (ide_task_cache_peek (cache, "c"), ==, "c");
+  g_assert_false (ide_memory_account_is_over_budget (account));
+
+  ide_task_cache_get_stats (cache, &stats);
+  g_assert_cmpint (stats.n_items, ==, 2);
+  g_assert_cmpint (stats.evicted, ==, 1);
+
+  /* Caches which are not evictable are neither charged nor evicted */
+  ide_task_cache_get_stats (pinned, &stats);
+  g_assert_cmpint (stats.n_items, ==, 3);
+  g_assert_cmpint (stats.evicted, ==, 0);
+  g_assert_cmpstr (ide_task_cache_peek (pinned, "x"), ==, "x");
+
+  ide_memory_account_set_budget (account, 0);
+}
+
 gint
 main (int argc,
       char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
   g_test_add_func ("/libide-io/path/expand", test_path_expand);
+  g_test_add_func ("/libide-io/task-cache/budget", test_task_cache_budget);
   return g_test_run ();
 }
 
@@ -0,0 +1,274 @@
+/* test-makecache-db.c
+ *
+ * Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <glib/gstdio.h>
+
+#include "plugins/autotools/ide-makecache-db.h"
+
+static const char *targets[] = { "foo", "/usr/bin", "libfoo.la", "/usr/lib", NULL };
+static const char *flags[] = { "-I.", "-DFOO=1", "-Wall", NULL };
+
+typedef struct
+{
+  char *tmpdir;
+  char *db_path;
+  char *builddir;
+  char *subdir;
+} Fixture;
+
+static char *
+make_builddir (const char *path)
+{
+  g_autofree char *makefile = g_build_filename (path, "Makefile", NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_assert_cmpint (g_mkdir_with_parents (path, 0750), ==, 0);
+  g_file_set_contents (makefile, "all:\n", -1, &error);
+  g_assert_no_error (error);
+
+  return g_strdup (path);
+}
+
+static void
+set_makefile_mtime (const char *directory,
+                    guint64     mtime)
+{
+  g_autoptr(GFile) file = g_file_new_build_filename (directory, "Makefile", NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_attribute_uint64 (file,
+                               G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                               mtime,
+                               G_FILE_QUERY_INFO_NONE,
+                               NULL,
+                               &error);
+  g_assert_no_error (error);
+}
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofree char *builddir = NULL;
+  g_autofree char *subdir = NULL;
+
+  fixture->tmpdir = g_dir_make_tmp ("test-makecache-db-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  fixture->db_path = g_build_filename (fixture->tmpdir, "makecache.db", NULL);
+
+  builddir = g_build_filename (fixture->tmpdir, "build", NULL);
+  subdir = g_build_filename (builddir, "src", NULL);
+  fixture->builddir = make_builddir (builddir);
+  fixture->subdir = make_builddir (subdir);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+  const char *dirs[] = { fixture->subdir, fixture->builddir };
+
+  for (guint i = 0; i < G_N_ELEMENTS (dirs); i++)
+    {
+      g_autofree char *makefile = g_build_filename (dirs[i], "Makefile", NULL);
+
+      g_unlink (makefile);
+      g_rmdir (dirs[i]);
+    }
+
+  g_unlink (fixture->db_path);
+  g_rmdir (fixture->tmpdir);
+
+  g_clear_pointer (&fixture->tmpdir, g_free);
+  g_clear_pointer (&fixture->db_path, g_free);
+  g_clear_pointer (&fixture->builddir, g_free);
+  g_clear_pointer (&fixture->subdir, g_free);
+}
+
+static void
+test_round_trip (Fixture       *fixture,
+                 gconstpointer  data)
+{
+  g_autoptr(IdeMakecacheDb) db = NULL;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) found_targets = NULL;
+  g_auto(GStrv) found_flags = NULL;
+  gint64 mtime;
+
+  mtime = ide_makecache_db_get_mtime (fixture->subdir);
+  g_assert_cmpint (mtime, >, 0);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, mtime));
+
+  ide_makecache_db_set_targets (db, fixture->subdir, mtime, targets);
+  ide_makecache_db_set_flags (db, "src/foo.c", fixture->subdir, mtime, flags);
+  ide_makecache_db_save (db, &error);
+  g_assert_no_error (error);
+  g_clear_pointer (&db, ide_makecache_db_free);
+
+  db = ide_makecache_db_new (fixture->db_path);
+
+  found_targets = ide_makecache_db_lookup_targets (db, fixture->subdir, mtime);
+  g_assert_nonnull (found_targets);
+  g_assert_true (g_strv_equal ((const char * const *)found_targets, targets));
+
+  found_flags = ide_makecache_db_lookup_flags (db, "src/foo.c", fixture->subdir, mtime);
+  g_assert_nonnull (found_flags);
+  g_assert_true (g_strv_equal ((const char * const *)found_flags, flags));
+
+  /* Flags are only valid for the directory they were extracted from */
+  g_assert_null (ide_makecache_db_lookup_flags (db, "src/foo.c", fixture->builddir, mtime));
+  g_assert_null (ide_makecache_db_lookup_flags (db, "src/bar.c", fixture->subdir, mtime));
+}
+
+static void
+test_version (Fixture       *fixture,
+              gconstpointer  data)
+{
+  g_autoptr(IdeMakecacheDb) db = NULL;
+  g_autoptr(GVariant) variant = NULL;
+  g_autoptr(GError) error = NULL;
+  GVariantBuilder sections[2];
+  gint64 mtime;
+
+  mtime = ide_makecache_db_get_mtime (fixture->subdir);
+
+  /* Same layout, but written by a version we don't know about */
+  for (guint i = 0; i < G_N_ELEMENTS (sections); i++)
+    {
+      g_variant_builder_init (&sections[i], G_VARIANT_TYPE ("a{s(xsas)}"));
+      g_variant_builder_add (&sections[i], "{s(xs^as)}",
+                             i == 0 ? fixture->subdir : "src/foo.c",
+                             mtime,
+                             fixture->subdir,
+                             i == 0 ? targets : flags);
+    }
+
+  variant = g_variant_new ("(ua{s(xsas)}a{s(xsas)})", G_MAXUINT, &sections[0], &sections[1]);
+  g_variant_ref_sink (variant);
+
+  g_file_set_contents (fixture->db_path,
+                       g_variant_get_data (variant),
+                       g_variant_get_size (variant),
+                       &error);
+  g_assert_no_error (error);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, mtime));
+  g_assert_null (ide_makecache_db_lookup_flags (db, "src/foo.c", fixture->subdir, mtime));
+
+  /* Garbage must be ignored too */
+  g_clear_pointer (&db, ide_makecache_db_free);
+  g_file_set_contents (fixture->db_path, "garbage", -1, &error);
+  g_assert_no_error (error);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, mtime));
+}
+
+static void
+test_mtime (Fixture       *fixture,
+            gconstpointer  data)
+{
+  g_autoptr(IdeMakecacheDb) db = NULL;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) found = NULL;
+  gint64 mtime;
+  gint64 new_mtime;
+
+  set_makefile_mtime (fixture->subdir, 1000000);
+  mtime = ide_makecache_db_get_mtime (fixture->subdir);
+  g_assert_cmpint (mtime / G_USEC_PER_SEC, ==, 1000000);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  ide_makecache_db_set_targets (db, fixture->subdir, mtime, targets);
+  ide_makecache_db_set_flags (db, "src/foo.c", fixture->subdir, mtime, flags);
+  ide_makecache_db_save (db, &error);
+  g_assert_no_error (error);
+  g_clear_pointer (&db, ide_makecache_db_free);
+
+  /* Regenerating the Makefile invalidates what was extracted from it */
+  set_makefile_mtime (fixture->subdir, 2000000);
+  new_mtime = ide_makecache_db_get_mtime (fixture->subdir);
+  g_assert_cmpint (new_mtime, !=, mtime);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, new_mtime));
+  g_assert_null (ide_makecache_db_lookup_flags (db, "src/foo.c", fixture->subdir, new_mtime));
+
+  /* Without a Makefile there is nothing to validate against */
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, 0));
+
+  found = ide_makecache_db_lookup_targets (db, fixture->subdir, mtime);
+  g_assert_nonnull (found);
+}
+
+static void
+test_prune (Fixture       *fixture,
+            gconstpointer  data)
+{
+  g_autoptr(IdeMakecacheDb) db = NULL;
+  g_autoptr(GError) error = NULL;
+  g_auto(GStrv) found = NULL;
+  const char *directories[] = { fixture->builddir, NULL };
+  gint64 mtimes[1];
+  gint64 mtime;
+
+  mtime = ide_makecache_db_get_mtime (fixture->subdir);
+  mtimes[0] = ide_makecache_db_get_mtime (fixture->builddir);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  ide_makecache_db_set_targets (db, fixture->builddir, mtimes[0], targets);
+  ide_makecache_db_set_targets (db, fixture->subdir, mtime, targets);
+  ide_makecache_db_set_flags (db, "foo.c", fixture->builddir, mtimes[0], flags);
+  ide_makecache_db_set_flags (db, "src/foo.c", fixture->subdir, mtime, flags);
+
+  /* The subdirectory was not discovered this time */
+  ide_makecache_db_prune (db, directories, mtimes, 1);
+  ide_makecache_db_save (db, &error);
+  g_assert_no_error (error);
+  g_clear_pointer (&db, ide_makecache_db_free);
+
+  db = ide_makecache_db_new (fixture->db_path);
+  g_assert_null (ide_makecache_db_lookup_targets (db, fixture->subdir, mtime));
+  g_assert_null (ide_makecache_db_lookup_flags (db, "src/foo.c", fixture->subdir, mtime));
+
+  found = ide_makecache_db_lookup_flags (db, "foo.c", fixture->builddir, mtimes[0]);
+  g_assert_nonnull (found);
+  g_clear_pointer (&found, g_strfreev);
+
+  found = ide_makecache_db_lookup_targets (db, fixture->builddir, mtimes[0]);
+  g_assert_nonnull (found);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  g_test_add ("/Autotools/MakecacheDb/round-trip", Fixture, NULL, fixture_setup, test_round_trip, fixture_teardown);
+  g_test_add ("/Autotools/MakecacheDb/version", Fixture, NULL, fixture_setup, test_version, fixture_teardown);
+  g_test_add ("/Autotools/MakecacheDb/mtime", Fixture, NULL, fixture_setup, test_mtime, fixture_teardown);
+  g_test_add ("/Autotools/MakecacheDb/prune", Fixture, NULL, fixture_setup, test_prune, fixture_teardown);
+  return g_test_run ();
+}